@@ -0,0 +1,94 @@
+#ifndef DETECTOR_POOL_H
+#define DETECTOR_POOL_H
+
+#include "ONNX.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ONNX {
+    struct DetectorStreamStats {
+        std::string name;
+        uint64_t inferences = 0;
+        double busyMs = 0.0;            // 占用检测器实例的总时间
+        double waitMs = 0.0;            // 等待分配实例的总时间
+        double maxWaitMs = 0.0;
+    };
+
+    // 多条流水线共享的检测器池：instances 个模型实例（各自的 ORT 会话与缓冲），
+    // 各流水线的检测线程借用一个实例，在自己的线程中推理后归还。
+    // 公平调度：每条流同时最多借用一个实例，有多条流在等待时空闲实例按轮转顺序分配，
+    // 刚归还的流排在其他等待的流之后，繁忙的流不会让其他流饿死
+    class DetectorPool {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        DetectorPool(const std::string& modelPath, const std::string& classesPath, const YOLOConfig& config, size_t instances);
+        DetectorPool(const DetectorPool&) = delete;
+        DetectorPool& operator=(const DetectorPool&) = delete;
+
+        [[nodiscard]] bool IsLoaded() const;
+        [[nodiscard]] size_t size() const { return detectors.size(); }
+
+        // 登记一条流并返回其编号，在各流水线启动前调用
+        size_t addStream(const std::string& name);
+
+        // 借用期间独占一个实例，析构时归还
+        class Lease {
+        public:
+            Lease(Lease&& other) noexcept;
+            Lease& operator=(Lease&&) = delete;
+            ~Lease();
+            YOLO& operator*() const { return *pool->detectors[instance]; }
+            YOLO* operator->() const { return pool->detectors[instance].get(); }
+
+        private:
+            friend class DetectorPool;
+            Lease(DetectorPool* pool, size_t stream, size_t instance, Clock::time_point granted);
+            DetectorPool* pool;
+            size_t stream;
+            size_t instance;
+            Clock::time_point granted;
+        };
+
+        // 阻塞直到轮到该流且有空闲实例
+        Lease acquire(size_t stream);
+        // 借用、检测（scaledImg 为按 LetterBoxSize 缩放好的图像）并归还
+        bool detect(size_t stream, const cv::Mat& scaledImg, const cv::Size& srcSize, std::vector<OutputDet>& output);
+
+        // 更换所有实例的网络输入尺寸：空闲实例立即更换，借出的实例在下次借出时更换。
+        // 模型输入宽高不是动态的或尺寸不是 32 的倍数时返回 false
+        bool setNetSize(const cv::Size& size);
+        [[nodiscard]] cv::Size netSize() const;
+        // 各实例的网络输入与类别相同，以下只读接口不需要借用
+        [[nodiscard]] cv::Size LetterBoxSize(const cv::Size& srcSize) const { return YOLO::LetterBoxSize(srcSize, netSize()); }
+        [[nodiscard]] const std::vector<std::string>& classNames() const { return detectors.front()->_className; }
+
+        [[nodiscard]] std::vector<DetectorStreamStats> stats() const;
+
+    private:
+        struct StreamSlot {
+            bool waiting = false;
+            int granted = -1;           // 分配给该流、尚未取走的实例
+            Clock::time_point since;    // 开始等待的时间
+            DetectorStreamStats stats;
+        };
+
+        void dispatchLocked();
+        void release(size_t stream, size_t instance, Clock::time_point granted);
+
+        std::vector<std::unique_ptr<YOLO>> detectors;
+        mutable std::mutex mtx;
+        std::condition_variable granted_cv;
+        std::vector<size_t> idle;       // 空闲实例
+        std::vector<StreamSlot> streams;
+        size_t cursor = 0;              // 下一次从这条流开始查找等待者
+        cv::Size net_size;              // 请求的网络输入尺寸
+    };
+}
+
+#endif //DETECTOR_POOL_H
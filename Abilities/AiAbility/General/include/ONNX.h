@@ -17,20 +17,63 @@ namespace ONNX {
         cv::Rect box;
     };
 
+    // 单张图片解码后、NMS 之前的候选框
+    struct Candidates{
+        std::vector<int> classIds;
+        std::vector<float> confidences;
+        std::vector<cv::Rect> boxes;
+    };
+
+    // 检测器运行参数，默认值与编译期宏一致
+    struct YOLOConfig{
+        int netWidth = NET_WIDTH;            // 网络输入宽度（动态 shape 模型有效）
+        int netHeight = NET_HEIGHT;          // 网络输入高度
+        float classThreshold = CLASS_THERESHOLD;
+        float nmsThreshold = 0.45;
+        int batchSize = 1;
+        int intraOpThreads = 0;              // ORT 算子内线程数，0 为 ORT 默认
+        std::vector<int> intraOpCpus;        // 线程池线程依次绑定的 CPU（发起推理的线程不受影响），空为不绑定
+    };
+
     class YOLO{
     public:
-        YOLO(const std::string& model_path, const std::string& yaml_path);
+        YOLO(const std::string& model_path, const std::string& yaml_path, const YOLOConfig& config = YOLOConfig());
         ~YOLO() = default;
 
         cv::Mat yoloDetect(cv::Mat& srcImg);
         bool ReadModel(const std::string& modelPath);
         bool OnnxDetect(const cv::Mat& srcImg, std::vector<OutputDet>& output);
+        // scaledImg 为已按 LetterBoxSize 缩放好的图像（如金字塔中的层），检测框映射回 srcSize 坐标系
+        bool OnnxDetect(const cv::Mat& scaledImg, const cv::Size& srcSize, std::vector<OutputDet>& output);
+        // srcSize 的图像在 LetterBox 中等比例缩放后（不含 padding）的尺寸
+        [[nodiscard]] cv::Size LetterBoxSize(const cv::Size& srcSize) const { return LetterBoxSize(srcSize, NetSize()); }
+        [[nodiscard]] static cv::Size LetterBoxSize(const cv::Size& srcSize, const cv::Size& netSize);
+        // 更换网络输入尺寸（须为 32 的倍数），只对输入宽高为动态的模型有效；下一次推理时重建输入输出张量
+        bool SetNetSize(const cv::Size& size);
+        void DrawResult(cv::Mat& img, const std::vector<OutputDet>& result) const;
+        // output 调整为每张图片一项，各项原有内容被覆盖
         bool OnnxBatchDetect(std::vector<cv::Mat>& srcImgs, std::vector<std::vector<OutputDet>>& output);
         static void DrawPred(cv::Mat& img, const std::vector<OutputDet>& result, const std::vector<std::string>& classNames, const std::vector<cv::Scalar>& color);
+        // 推理流水线的各个阶段，OnnxBatchDetect 依次调用，也供基准测试单独计时。
+        // 各阶段写入检测器内部预先分配的缓冲，输入尺寸与 batch 不变时稳定运行中不分配内存；
+        // 因此同一个检测器只能由一个线程使用
+        // 返回的 blob 引用内部缓冲，下次 Preprocess 前有效
+        const cv::Mat& Preprocess(const std::vector<cv::Mat>& srcImgs, std::vector<cv::Vec4d>& params);
+        // 结果写入 Output()；输出张量首次推理后绑定到固定缓冲，之后 ORT 直接写入
+        bool Inference(const cv::Mat& blob);
+        // FP32 推理结果 [batch, 4 + 类别数, 候选框数]
+        [[nodiscard]] const cv::Mat& Output() const { return _output; }
+        void Decode(size_t imgIndex, const cv::Vec4d& params, Candidates& candidates);
+        void NonMaxSuppression(const Candidates& candidates, std::vector<OutputDet>& output);
         static void LetterBox(const cv::Mat& image, cv::Mat& outImage, cv::Vec4d& params,
                                 const cv::Size& newShape = cv::Size(640, 640), bool autoShape = false,
                                 bool scaleFill=false, bool scaleUp=true, int stride= 32,const cv::Scalar& color = cv::Scalar(114,114,114));
         std::vector<std::string> _className;
+        [[nodiscard]] bool IsLoaded() const { return _OrtSession != nullptr; }
+        [[nodiscard]] cv::Size NetSize() const { return {_netWidth, _netHeight}; }
+        [[nodiscard]] bool IsDynamicInputSize() const { return _dynamicInputSize; }
+        [[nodiscard]] int BatchSize() const { return _batchSize; }
+        [[nodiscard]] bool IsHalfPrecision() const { return _inputNodeDataType == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16; }
 
     private:
         template <typename Templeate>   // 创建一个模板函数，用于计算向量的乘积
@@ -38,14 +81,20 @@ namespace ONNX {
             return std::accumulate(v.begin(), v.end(), 1, std::multiplies<Templeate>());
         }
         std::vector<cv::Scalar> GenerateColor();
-        int Preprocessing(const std::vector<cv::Mat>& SrcImgs, std::vector<cv::Mat>& OutSrcImgs, std::vector<cv::Vec4d>& params) const;
+        // 按 batch 大小准备 _blob，不足一个 batch 的部分补零
+        void PrepareBlob(int images);
+        // 信封处理后按 RGB、CHW、归一化写入 _blob 的第 index 张
+        void PreprocessImage(const cv::Mat& srcImg, int index, cv::Vec4d& params);
         static std::vector<std::string> ResolveYAML(const std::string& yamlPath);
 
-        const int _netWidth = NET_WIDTH;   //ONNX网络输入宽度
-        const int _netHeight = NET_HEIGHT;  //ONNX网络输入高度
+        int _netWidth = NET_WIDTH;   //ONNX网络输入宽度
+        int _netHeight = NET_HEIGHT;  //ONNX网络输入高度
 
         int _batchSize = 1; //if multi-batch,set this
+        int _intraOpThreads = 0;
+        std::vector<int> _intraOpCpus;
         bool _isDynamicShape = true;   //onnx 支持动态shape
+        bool _dynamicInputSize = false; // 输入宽高为动态，可在运行中更换
         float _classThreshold = CLASS_THERESHOLD;   // 置信度
         float _nmsThreshold= 0.45;  // nms阈值
         float _maskThreshold = 0.5; // mask阈值
@@ -64,6 +113,23 @@ namespace ONNX {
         std::vector<int64_t> _inputTensorShape;  // 输入张量形状
         std::vector<int64_t> _outputTensorShape;
         std::vector<cv::Scalar> _colorSet;
+        cv::Mat _halfBlob;     // FP16 模型的输入缓冲
+        cv::Mat _halfOutput;   // FP16 模型的输出缓冲
+
+        // 逐帧复用的缓冲
+        cv::Mat _letterbox;                 // 网络输入尺寸的 BGR 图像
+        cv::Rect _letterboxRoi;             // 上一次图像所占区域，区域不变时填充边不必重画
+        cv::Mat _blob;                      // NCHW FP32 输入
+        cv::Mat _output;                    // FP32 输出
+        std::vector<cv::Vec4d> _params;
+        Candidates _candidates;
+        std::vector<float> _bestScores;     // 解码时每个候选框的最大类别概率与类别
+        std::vector<int> _bestClasses;
+        std::vector<int> _order;            // NMS 按置信度排序的下标
+        Ort::Value _inputTensor{nullptr};   // 引用 _blob（FP16 为 _halfBlob）
+        const void* _boundInput = nullptr;
+        Ort::Value _outputTensor{nullptr};  // 引用 _output（FP16 为 _halfOutput）
+        int _boundBatch = 0;
     };
 }
 
@@ -0,0 +1,121 @@
+#include "DetectorPool.h"
+#include <algorithm>
+#include <utility>
+
+ONNX::DetectorPool::DetectorPool(const std::string& modelPath, const std::string& classesPath, const YOLOConfig& config,
+                                 size_t instances) {
+    instances = std::max<size_t>(instances, 1);
+    for (size_t i = 0; i < instances; i++) {
+        detectors.push_back(std::make_unique<YOLO>(modelPath, classesPath, config));
+        idle.push_back(instances - 1 - i);   // 从 0 号实例开始分配
+    }
+    net_size = detectors.front()->NetSize();
+}
+
+bool ONNX::DetectorPool::IsLoaded() const {
+    return std::all_of(detectors.begin(), detectors.end(), [](const auto& detector) { return detector->IsLoaded(); });
+}
+
+size_t ONNX::DetectorPool::addStream(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mtx);
+    streams.emplace_back();
+    streams.back().stats.name = name;
+    return streams.size() - 1;
+}
+
+void ONNX::DetectorPool::dispatchLocked() {
+    // 从 cursor 开始轮转查找等待的流，每分配一次 cursor 移到该流之后
+    const size_t n = streams.size();
+    while (!idle.empty()) {
+        size_t next = n;
+        for (size_t k = 0; k < n; k++) {
+            if (streams[(cursor + k) % n].waiting) {
+                next = (cursor + k) % n;
+                break;
+            }
+        }
+        if (next == n) break;
+        StreamSlot& slot = streams[next];
+        slot.waiting = false;
+        slot.granted = static_cast<int>(idle.back());
+        idle.pop_back();
+        cursor = (next + 1) % n;
+    }
+}
+
+ONNX::DetectorPool::Lease ONNX::DetectorPool::acquire(size_t stream) {
+    std::unique_lock<std::mutex> lock(mtx);
+    StreamSlot& slot = streams[stream];
+    slot.waiting = true;
+    slot.since = Clock::now();
+    dispatchLocked();
+    if (slot.granted < 0) {
+        granted_cv.wait(lock, [&slot] { return slot.granted >= 0; });
+    }
+    else {
+        // 其他等待的流也可能在这次分配中拿到了实例
+        granted_cv.notify_all();
+    }
+    const auto instance = static_cast<size_t>(slot.granted);
+    slot.granted = -1;
+    const Clock::time_point now = Clock::now();
+    const double wait = std::chrono::duration<double, std::milli>(now - slot.since).count();
+    slot.stats.waitMs += wait;
+    slot.stats.maxWaitMs = std::max(slot.stats.maxWaitMs, wait);
+    const cv::Size size = net_size;
+    lock.unlock();
+    // 实例已归本流独占，借出期间更换尺寸不会与推理并发
+    detectors[instance]->SetNetSize(size);
+    return {this, stream, instance, now};
+}
+
+void ONNX::DetectorPool::release(size_t stream, size_t instance, Clock::time_point granted) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        DetectorStreamStats& stats = streams[stream].stats;
+        stats.inferences++;
+        stats.busyMs += std::chrono::duration<double, std::milli>(Clock::now() - granted).count();
+        idle.push_back(instance);
+        dispatchLocked();
+    }
+    granted_cv.notify_all();
+}
+
+bool ONNX::DetectorPool::setNetSize(const cv::Size& size) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!detectors.front()->IsDynamicInputSize() || size.width <= 0 || size.height <= 0
+        || size.width % 32 != 0 || size.height % 32 != 0) {
+        return false;
+    }
+    net_size = size;
+    for (const size_t instance : idle) detectors[instance]->SetNetSize(size);
+    return true;
+}
+
+cv::Size ONNX::DetectorPool::netSize() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return net_size;
+}
+
+bool ONNX::DetectorPool::detect(size_t stream, const cv::Mat& scaledImg, const cv::Size& srcSize, std::vector<OutputDet>& output) {
+    Lease detector = acquire(stream);
+    return detector->OnnxDetect(scaledImg, srcSize, output);
+}
+
+std::vector<ONNX::DetectorStreamStats> ONNX::DetectorPool::stats() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    std::vector<DetectorStreamStats> result;
+    result.reserve(streams.size());
+    for (const auto& slot : streams) result.push_back(slot.stats);
+    return result;
+}
+
+ONNX::DetectorPool::Lease::Lease(DetectorPool* pool, size_t stream, size_t instance, Clock::time_point granted) :
+    pool(pool), stream(stream), instance(instance), granted(granted) {}
+
+ONNX::DetectorPool::Lease::Lease(Lease&& other) noexcept :
+    pool(std::exchange(other.pool, nullptr)), stream(other.stream), instance(other.instance), granted(other.granted) {}
+
+ONNX::DetectorPool::Lease::~Lease() {
+    if (pool != nullptr) pool->release(stream, instance, granted);
+}
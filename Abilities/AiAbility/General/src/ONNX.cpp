@@ -1,7 +1,12 @@
 #include "ONNX.h"
 #include <yaml-cpp/yaml.h>
+#include <cstdio>
+#include <cstring>
 
-ONNX::YOLO::YOLO(const std::string& model_path, const std::string& yaml_path):_OrtMemoryInfo(Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPUOutput)) {
+ONNX::YOLO::YOLO(const std::string& model_path, const std::string& yaml_path, const YOLOConfig& config):
+    _netWidth(config.netWidth), _netHeight(config.netHeight), _batchSize(config.batchSize),
+    _intraOpThreads(config.intraOpThreads), _intraOpCpus(config.intraOpCpus), _classThreshold(config.classThreshold), _nmsThreshold(config.nmsThreshold),
+    _OrtMemoryInfo(Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPUOutput)) {
     _className = ResolveYAML(yaml_path);
     ReadModel(model_path);
     _colorSet = GenerateColor();
@@ -42,7 +47,17 @@ bool ONNX::YOLO::ReadModel(const std::string &modelPath){
     try {
         std::vector<std::string> available_providers = Ort::GetAvailableProviders();
         //设置内部线程
-        // _OrtSessionOptions.SetIntraOpNumThreads(1);
+        if (_intraOpThreads > 0) _OrtSessionOptions.SetIntraOpNumThreads(_intraOpThreads);
+        // 线程池有 intraOpThreads - 1 个线程（发起推理的线程也参与计算），每个线程一项，以 ';' 分隔；
+        // ORT 的逻辑处理器编号从 1 开始
+        if (_intraOpThreads > 1 && !_intraOpCpus.empty()) {
+            std::string affinities;
+            for (int i = 1; i < _intraOpThreads; i++) {
+                if (!affinities.empty()) affinities += ';';
+                affinities += std::to_string(_intraOpCpus[(i - 1) % _intraOpCpus.size()] + 1);
+            }
+            _OrtSessionOptions.AddConfigEntry("session.intra_op_thread_affinities", affinities.c_str());
+        }
         // 开启图像优化
         _OrtSessionOptions.SetGraphOptimizationLevel(ORT_ENABLE_EXTENDED);
         _OrtSession = new Ort::Session(_OrtEnv, modelPath.c_str(), _OrtSessionOptions);
@@ -64,9 +79,15 @@ bool ONNX::YOLO::ReadModel(const std::string &modelPath){
         }
         if (_inputTensorShape[2] == -1 || _inputTensorShape[3] == -1) {
             _isDynamicShape = true;
+            _dynamicInputSize = true;
             _inputTensorShape[2] = _netHeight;
             _inputTensorShape[3] = _netWidth;
         }
+        else {
+            // 静态 shape 模型以模型的输入尺寸为准
+            _netHeight = static_cast<int>(_inputTensorShape[2]);
+            _netWidth = static_cast<int>(_inputTensorShape[3]);
+        }
         //init output
         _outputNodesNum = _OrtSession->GetOutputCount();
 
@@ -84,117 +105,242 @@ bool ONNX::YOLO::ReadModel(const std::string &modelPath){
     return true;
 }
 
-int ONNX::YOLO::Preprocessing(const std::vector<cv::Mat> &SrcImages, std::vector<cv::Mat> &OutSrcImages, std::vector<cv::Vec4d> &params) const{
-    OutSrcImages.clear();
-    auto input_size = cv::Size(_netWidth, _netHeight);
-    // 信封处理
-    for (size_t i=0; i<SrcImages.size(); ++i){
-        cv::Mat temp_img = SrcImages[i];
-        cv::Vec4d temp_param = {1,1,0,0};
-        if (temp_img.size() != input_size) {
-            cv::Mat borderImg;
-            LetterBox(temp_img, borderImg, temp_param, input_size, false, false, true, 32);
-            OutSrcImages.push_back(borderImg);
-            params.push_back(temp_param);
+void ONNX::YOLO::PrepareBlob(int images) {
+    // 不足一个 batch 时补零图
+    const int batch = std::max(_batchSize, images);
+    const int dims[4] = {batch, 3, _netHeight, _netWidth};
+    _blob.create(4, dims, CV_32F);
+    const size_t plane = static_cast<size_t>(3) * _netHeight * _netWidth;
+    if (batch > images) {
+        std::fill(_blob.ptr<float>() + images * plane, _blob.ptr<float>() + batch * plane, 0.f);
+    }
+}
+
+void ONNX::YOLO::PreprocessImage(const cv::Mat& srcImg, int index, cv::Vec4d& params) {
+    // 信封处理：等比例缩放到网络输入内，四周以 114 填充（与 LetterBox 的比例与取整一致）
+    const cv::Size scaled = LetterBoxSize(srcImg.size());
+    const float dw = static_cast<float>(_netWidth - scaled.width) / 2.0f;
+    const float dh = static_cast<float>(_netHeight - scaled.height) / 2.0f;
+    const int left = static_cast<int>(std::round(dw - 0.1f));
+    const int top = static_cast<int>(std::round(dh - 0.1f));
+    const cv::Rect roi(left, top, scaled.width, scaled.height);
+    if (_letterbox.rows != _netHeight || _letterbox.cols != _netWidth || roi != _letterboxRoi) {
+        _letterbox.create(_netHeight, _netWidth, CV_8UC3);
+        _letterbox.setTo(cv::Scalar(114, 114, 114));
+        _letterboxRoi = roi;
+    }
+    // 直接写入填充图的中间区域，不经过中间图像
+    cv::Mat inner = _letterbox(roi);
+    if (srcImg.size() == scaled) {
+        srcImg.copyTo(inner);
+    }
+    else {
+        cv::resize(srcImg, inner, scaled);
+    }
+    const float ratio = std::min(static_cast<float>(_netHeight) / static_cast<float>(srcImg.rows), static_cast<float>(_netWidth) / static_cast<float>(srcImg.cols));
+    params = {ratio, ratio, static_cast<double>(left), static_cast<double>(top)};
+
+    // [0~255] --> [0~1]; BGR -> RGB; HWC -> CHW
+    constexpr float scale = 1.0f / 255.0f;
+    float* r = _blob.ptr<float>(index, 0);
+    float* g = _blob.ptr<float>(index, 1);
+    float* b = _blob.ptr<float>(index, 2);
+    for (int y = 0; y < _netHeight; ++y) {
+        const uchar* row = _letterbox.ptr(y);
+        for (int x = 0; x < _netWidth; ++x) {
+            *b++ = static_cast<float>(row[0]) * scale;
+            *g++ = static_cast<float>(row[1]) * scale;
+            *r++ = static_cast<float>(row[2]) * scale;
+            row += 3;
+        }
+    }
+}
+
+const cv::Mat& ONNX::YOLO::Preprocess(const std::vector<cv::Mat> &srcImgs, std::vector<cv::Vec4d> &params) {
+    params.resize(srcImgs.size());
+    PrepareBlob(static_cast<int>(srcImgs.size()));
+    for (size_t i = 0; i < srcImgs.size(); ++i) {
+        PreprocessImage(srcImgs[i], static_cast<int>(i), params[i]);
+    }
+    return _blob;
+}
+
+bool ONNX::YOLO::Inference(const cv::Mat &blob) {
+    const cv::Mat* input = &blob;
+    if (IsHalfPrecision()) {
+        // FP16 模型：输入转换为半精度
+        blob.convertTo(_halfBlob, CV_16F);
+        input = &_halfBlob;
+    }
+    const int batch = blob.size[0];
+    try {
+        // 输入张量只引用缓冲，缓冲地址或 batch 变化时才重建
+        if (input->data != _boundInput || batch != _boundBatch) {
+            _inputTensorShape[0] = batch;
+            const size_t length = VectorProduct(_inputTensorShape);
+            _inputTensor = Ort::Value::CreateTensor(_OrtMemoryInfo, input->data, length * input->elemSize(),
+                                                    _inputTensorShape.data(), _inputTensorShape.size(), _inputNodeDataType);
+            _boundInput = input->data;
+            if (batch != _boundBatch) _outputTensor = Ort::Value(nullptr);
+            _boundBatch = batch;
+        }
+
+        if (_outputTensor) {
+            // 输出直接写入绑定的缓冲
+            _OrtSession->Run(Ort::RunOptions{nullptr}, _inputNodeNames.data(), &_inputTensor, 1,
+                             _outputNodeNames.data(), &_outputTensor, 1);
         }
         else {
-            OutSrcImages.push_back(temp_img);
-            params.push_back(temp_param);
+            // 首次推理（或 batch 变化）由 ORT 分配输出，得到输出形状后分配固定缓冲并绑定
+            std::vector<Ort::Value> output_tensors = _OrtSession->Run(Ort::RunOptions{nullptr}, _inputNodeNames.data(),
+                                                                      &_inputTensor, 1, _outputNodeNames.data(), 1);
+            const auto info = output_tensors[0].GetTensorTypeAndShapeInfo();
+            _outputTensorShape = info.GetShape(); // 一张图片输出的维度信息 [1, 84, 8400]
+            const int dims[3] = {static_cast<int>(_outputTensorShape[0]), static_cast<int>(_outputTensorShape[1]),
+                                 static_cast<int>(_outputTensorShape[2])};
+            _output.create(3, dims, CV_32F);
+            cv::Mat& target = info.GetElementType() == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16 ? _halfOutput : _output;
+            if (&target == &_halfOutput) _halfOutput.create(3, dims, CV_16F);
+            std::memcpy(target.data, output_tensors[0].GetTensorData<void>(), target.total() * target.elemSize());
+            _outputTensor = Ort::Value::CreateTensor(_OrtMemoryInfo, target.data, target.total() * target.elemSize(),
+                                                     _outputTensorShape.data(), _outputTensorShape.size(), info.GetElementType());
         }
     }
-    if (int lack_num = _batchSize - SrcImages.size(); lack_num > 0){
-        cv::Mat temp_img = cv::Mat::zeros(input_size, CV_8UC3);
-        cv::Vec4d temp_param = {1,1,0,0};
-        OutSrcImages.push_back(temp_img);
-        params.push_back(temp_param);
+    catch (const Ort::Exception& e) {
+        std::cerr << "Inference failed: " << e.what() << std::endl;
+        return false;
+    }
+    if (!_halfOutput.empty()) {
+        // FP16 输出转换为 FP32，后处理统一按 float 解码
+        _halfOutput.convertTo(_output, CV_32F);
     }
-    return 0;
+    return true;
 }
 
-bool ONNX::YOLO::OnnxBatchDetect(std::vector<cv::Mat> &SrcImages, std::vector<std::vector<OutputDet> > &output) {
-    std::vector<cv::Vec4d> params;
-    std::vector<cv::Mat> input_images;
-    cv::Size input_size(_netWidth, _netHeight);
+void ONNX::YOLO::Decode(size_t imgIndex, const cv::Vec4d &params, Candidates &candidates) {
+    // 输出为 [4 + 类别数, 候选框数]，按行遍历（每行连续）求每个候选框的最大类别概率，不做转置
+    const int channels = _output.size[1];
+    const int anchors = _output.size[2];
+    const int classes = std::min(static_cast<int>(_className.size()), channels - 4);
+    const float* data = _output.ptr<float>(static_cast<int>(imgIndex));
+    candidates.classIds.clear();
+    candidates.confidences.clear();
+    candidates.boxes.clear();
+    if (classes <= 0) return;
+    if (candidates.boxes.capacity() < static_cast<size_t>(anchors)) {
+        candidates.classIds.reserve(anchors);
+        candidates.confidences.reserve(anchors);
+        candidates.boxes.reserve(anchors);
+    }
+    _bestScores.assign(data + 4 * anchors, data + 5 * anchors);
+    _bestClasses.assign(anchors, 0);
+    for (int c = 1; c < classes; ++c) {
+        const float* scores = data + (4 + c) * anchors;
+        for (int a = 0; a < anchors; ++a) {
+            // 与 minMaxLoc 一致，并列时取类别编号较小的
+            if (scores[a] > _bestScores[a]) {
+                _bestScores[a] = scores[a];
+                _bestClasses[a] = c;
+            }
+        }
+    }
+    for (int a = 0; a < anchors; ++a) {
+        const float score = _bestScores[a];
+        // 预测框坐标映射到原图上
+        if (score >= _classThreshold) {
+            // rect [x,y,w,h]
+            const float x = static_cast<float>((data[a] - params[2]) / params[0]);
+            const float y = static_cast<float>((data[anchors + a] - params[3]) / params[1]);
+            const float w = static_cast<float>(data[2 * anchors + a] / params[0]);
+            const float h = static_cast<float>(data[3 * anchors + a] / params[1]);
+            const int left = std::max(static_cast<int>(x - 0.5f * w + 0.5f), 0);
+            const int top = std::max(static_cast<int>(y - 0.5f * h + 0.5f), 0);
+            candidates.classIds.push_back(_bestClasses[a]);
+            candidates.confidences.push_back(score);
+            candidates.boxes.emplace_back(left, top, static_cast<int>(w + 0.5f), static_cast<int>(h + 0.5f));
+        }
+    }
+}
 
-    Preprocessing(SrcImages, input_images, params);//preprocessing (信封处理)
-    // [0~255] --> [0~1]; BGR2RGB
-    cv::Mat blob = cv::dnn::blobFromImages(input_images, 1 / 255.0, input_size, cv::Scalar(0,0,0), true, false);
-    // 前向传播得到推理结果
-    int64_t input_tensor_length = VectorProduct(_inputTensorShape);// ?
-    std::vector<Ort::Value> input_tensors;
-    std::vector<Ort::Value> output_tensors;
-    input_tensors.push_back(Ort::Value::CreateTensor<float>(_OrtMemoryInfo, reinterpret_cast<float*>(blob.data),
-                                                            input_tensor_length, _inputTensorShape.data(),
-                                                            _inputTensorShape.size()));
-    output_tensors = _OrtSession->Run(Ort::RunOptions{ nullptr },
-        _inputNodeNames.data(),
-        input_tensors.data(),
-        _inputNodeNames.size(),
-        _outputNodeNames.data(),
-        _outputNodeNames.size()
-    );
-    //post-process
-    int net_width = _className.size() + 4;
-    auto* all_data = output_tensors[0].GetTensorMutableData<float>(); // 第一张图片的输出
-    _outputTensorShape = output_tensors[0].GetTensorTypeAndShapeInfo().GetShape(); // 一张图片输出的维度信息 [1, 84, 8400]
-    int64_t one_output_length = VectorProduct(_outputTensorShape) / _outputTensorShape[0]; // 一张图片输出所占内存长度 8400*84
-    for (int img_index = 0; img_index < SrcImages.size(); ++img_index){
-        cv::Mat output0 = cv::Mat(cv::Size(static_cast<int>(_outputTensorShape[2]), static_cast<int>(_outputTensorShape[1])), CV_32F, all_data).t(); // [1, 84 ,8400] -> [1, 8400, 84]
-        all_data += one_output_length; //指针指向下一个图片的地址
-        auto* pdata = reinterpret_cast<float*>(output0.data); // [x,y,w,h,class1,class2.....class80]
-        int rows = output0.rows; // 预测框的数量 8400
-        // 一张图片的预测框
-        std::vector<int> class_ids;
-        std::vector<float> confidences;
-        std::vector<cv::Rect> boxes;
-        for (int r=0; r<rows; ++r) {
-            cv::Mat scores(1, _className.size(), CV_32F, pdata + 4); // 80个类别的概率
-            // 得到最大类别概率、类别索引
-            cv::Point classIdPoint;
-            double max_class_scores; // 最大类别概率
-            minMaxLoc(scores, 0, &max_class_scores, 0, &classIdPoint);
-            max_class_scores = static_cast<float>(max_class_scores);
-            // 预测框坐标映射到原图上
-            if (max_class_scores >= _classThreshold){
-                // rect [x,y,w,h]
-                float x = (pdata[0] - params[img_index][2]) / params[img_index][0]; //x
-                float y = (pdata[1] - params[img_index][3]) / params[img_index][1]; //y
-                float w = pdata[2] / params[img_index][0]; //w
-                float h = pdata[3] / params[img_index][1]; //h
-                int left = MAX(int(x - 0.5 *w +0.5), 0);
-                int top = MAX(int(y - 0.5*h + 0.5), 0);
-                class_ids.push_back(classIdPoint.x);
-                confidences.push_back(max_class_scores);
-                boxes.push_back(cv::Rect(left, top, static_cast<int>(w + 0.5), static_cast<int>(h + 0.5)));
+void ONNX::YOLO::NonMaxSuppression(const Candidates &candidates, std::vector<OutputDet> &output) {
+    // 对一张图的预测框执行非极大值抑制（不区分类别），结果与 cv::dnn::NMSBoxes 相同：
+    // 按置信度从高到低，与已保留的框重叠超过阈值的丢弃
+    output.clear();
+    _order.clear();
+    for (size_t i = 0; i < candidates.confidences.size(); ++i) {
+        if (candidates.confidences[i] > _classThreshold) _order.push_back(static_cast<int>(i));
+    }
+    std::sort(_order.begin(), _order.end(), [&candidates](int a, int b) {
+        return candidates.confidences[a] > candidates.confidences[b] || (candidates.confidences[a] == candidates.confidences[b] && a < b);
+    });
+    for (int idx : _order) {
+        const cv::Rect& box = candidates.boxes[idx];
+        bool keep = true;
+        for (const auto& kept : output) {
+            const double inter = (box & kept.box).area();
+            const double overlap = inter / (static_cast<double>(box.area()) + kept.box.area() - inter);
+            if (overlap > _nmsThreshold) {
+                keep = false;
+                break;
             }
-            pdata += net_width; //下一个预测框
         }
-        // 对一张图的预测框执行非极大值抑制
-        std::vector<int> nms_result;
-        cv::dnn::NMSBoxes(boxes, confidences, _classThreshold, _nmsThreshold, nms_result);
-        // 对一张图片：依据非极大值抑制处理得到的索引，得到类别id、confidence、box，并置于结构体OutputDet的容器中
-        std::vector<OutputDet> temp_output;
-        for (size_t i=0; i<nms_result.size(); ++i){
-            int idx = nms_result[i];
-            OutputDet result;
-            result.id = class_ids[idx];
-            result.confidence = confidences[idx];
-            result.box = boxes[idx];
-            temp_output.push_back(result);
+        if (keep) {
+            output.push_back({candidates.classIds[idx], candidates.confidences[idx], box});
         }
-        output.push_back(temp_output); // 多张图片的输出；添加一张图片的输出置于此容器中
+    }
+}
+
+bool ONNX::YOLO::OnnxBatchDetect(std::vector<cv::Mat> &SrcImages, std::vector<std::vector<OutputDet> > &output) {
+    const cv::Mat& blob = Preprocess(SrcImages, _params);
+    if (!Inference(blob)) {
+        return false;
+    }
+    //post-process
+    // 每张图片的结果直接写入 output 中对应的容器，调用者复用 output 时容量在多次调用间保留
+    output.resize(SrcImages.size());
+    for (size_t img_index = 0; img_index < SrcImages.size(); ++img_index){
+        Decode(img_index, _params[img_index], _candidates);
+        NonMaxSuppression(_candidates, output[img_index]);
     }
     if (!output.empty())
         return true;
     return false;
 }
 bool ONNX::YOLO::OnnxDetect(const cv::Mat &srcImg, std::vector<OutputDet> &output){
-    std::vector<cv::Mat> input_data = {srcImg};
-    if(std::vector<std::vector<OutputDet>> temp_output; OnnxBatchDetect(input_data, temp_output)){
-        output = temp_output[0];
-        return true;
+    // 单张图片直接使用内部缓冲，不经过 batch 容器
+    _params.resize(1);
+    PrepareBlob(1);
+    PreprocessImage(srcImg, 0, _params[0]);
+    if (!Inference(_blob)) {
+        return false;
     }
-    return false;
+    Decode(0, _params[0], _candidates);
+    NonMaxSuppression(_candidates, output);
+    return true;
+}
+
+bool ONNX::YOLO::OnnxDetect(const cv::Mat &scaledImg, const cv::Size &srcSize, std::vector<OutputDet> &output) {
+    if (!OnnxDetect(scaledImg, output)) {
+        return false;
+    }
+    // 缩放图坐标 -> 原图坐标
+    const double sx = static_cast<double>(srcSize.width) / scaledImg.cols;
+    const double sy = static_cast<double>(srcSize.height) / scaledImg.rows;
+    for (auto& det : output) {
+        det.box = cv::Rect(static_cast<int>(det.box.x * sx + 0.5), static_cast<int>(det.box.y * sy + 0.5),
+                           static_cast<int>(det.box.width * sx + 0.5), static_cast<int>(det.box.height * sy + 0.5));
+    }
+    return true;
+}
+
+cv::Size ONNX::YOLO::LetterBoxSize(const cv::Size &srcSize, const cv::Size &netSize) {
+    // 与 LetterBox 的缩放比例计算保持一致
+    float r = std::min(static_cast<float>(netSize.height) / static_cast<float>(srcSize.height), static_cast<float>(netSize.width) / static_cast<float>(srcSize.width));
+    return {static_cast<int>(std::round(static_cast<float>(srcSize.width) * r)), static_cast<int>(std::round(static_cast<float>(srcSize.height) * r))};
+}
+
+void ONNX::YOLO::DrawResult(cv::Mat &img, const std::vector<OutputDet> &result) const {
+    DrawPred(img, result, _className, _colorSet);
 }
 
 void ONNX::YOLO::LetterBox(const cv::Mat& image, cv::Mat& outImage, cv::Vec4d& params, const cv::Size& newShape, bool autoShape, bool scaleFill, bool scaleUp, int stride, const cv::Scalar& color) {
@@ -249,13 +395,15 @@ void ONNX::YOLO::DrawPred(cv::Mat& img, const std::vector<OutputDet>& result, co
         top = result[i].box.y;
         // 框出目标
         rectangle(img, result[i].box,color[result[i].id], 3, cv::LINE_AA);
-        // 在目标框左上角标识目标类别以及概率
-        std::string label = classNames[result[i].id] + ":" + std::to_string(result[i].confidence);
+        // 在目标框左上角标识目标类别以及概率；标签字符串每个线程复用一份，不随每个目标分配
+        thread_local std::string label;
+        char confidence[16];
+        std::snprintf(confidence, sizeof(confidence), ":%f", result[i].confidence);
+        label.assign(classNames[result[i].id]).append(confidence);
         int baseLine;
         cv::Size labelSize = cv::getTextSize(label, cv::FONT_HERSHEY_SIMPLEX, 0.8, 1, &baseLine);
         top = std::max(top, labelSize.height);
         putText(img, label, cv::Point(left, top-10), cv::FONT_HERSHEY_SIMPLEX, 1, color[result[i].id], 2);
-        std::cout << "Class ID: " << result[i].id << ", Name: " << classNames[result[i].id] << ", Confidence: " << result[i].confidence << std::endl;
     }
 }
 
@@ -265,4 +413,21 @@ cv::Mat ONNX::YOLO::yoloDetect(cv::Mat& srcImg) {
         DrawPred(srcImg, output, _className, _colorSet);
     }
     return srcImg;
-}
\ No newline at end of file
+}
+
+bool ONNX::YOLO::SetNetSize(const cv::Size &size) {
+    if (size == NetSize()) return true;
+    if (!_dynamicInputSize || size.width <= 0 || size.height <= 0 || size.width % 32 != 0 || size.height % 32 != 0) {
+        return false;
+    }
+    _netWidth = size.width;
+    _netHeight = size.height;
+    _inputTensorShape[2] = _netHeight;
+    _inputTensorShape[3] = _netWidth;
+    // 候选框数随输入尺寸变化，输入输出张量都在下一次推理时按新尺寸重建
+    _boundInput = nullptr;
+    _boundBatch = 0;
+    _outputTensor = Ort::Value(nullptr);
+    _halfOutput.release();
+    return true;
+}
@@ -0,0 +1,124 @@
+#ifndef ALERT_H
+#define ALERT_H
+
+#include "ONNX.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <span>
+#include <vector>
+
+// 危险提示调度：把检测结果变成及时、不重复的提示。
+//   1) 按类别与框的重叠把检测关联成跟踪，估计每个目标的接近速度；
+//   2) 优先级 = 类别权重 × (接近程度与接近速度的加权和)，近处快速接近的车辆排在远处静止的长椅之前；
+//   3) 同一跟踪只在首次出现、危险等级升高或间隔足够久时再次提示；
+//   4) 每条提示带所属帧的采集时间，取出时超过延迟预算的直接丢弃——过时的提示比没有提示更危险
+namespace ALERT {
+    using Clock = std::chrono::steady_clock;
+
+    enum class Level {
+        INFO,
+        WARNING,
+        DANGER,
+    };
+
+    struct AlertConfig {
+        std::map<int, float> class_weights = defaultClassWeights();   // COCO 类别 -> 权重，0 表示不提示
+        float default_weight = 0.25f;       // 未列出的类别
+        float proximity_weight = 0.6f;
+        float approach_weight = 0.4f;
+        float max_range = 10.0f;            // 米，超过此距离接近程度为 0
+        float near_height_ratio = 0.6f;     // 没有距离时，框高占画面该比例视为贴近
+        float approach_full_scale = 2.0f;   // 米/秒；没有距离时为框高增长率（1/秒），达到此值时接近得分为 1
+        float warning_priority = 0.35f;     // 低于此优先级不提示
+        float danger_priority = 0.65f;
+        float iou_threshold = 0.3f;         // 同类框重叠超过此值视为同一目标
+        std::chrono::milliseconds track_timeout{800};      // 跟踪丢失多久后删除
+        std::chrono::milliseconds repeat_interval{4000};   // 同一目标同等级的最短重复间隔
+        std::chrono::milliseconds latency_budget{400};     // 采集到发出提示的最大延迟
+        size_t max_pending = 8;
+
+        static std::map<int, float> defaultClassWeights();
+    };
+
+    struct Alert {
+        uint32_t track = 0;
+        int classId = 0;
+        Level level = Level::INFO;
+        float priority = 0.f;
+        float distance = -1.f;      // 米，未知时为负
+        float approach = 0.f;       // 有距离时为接近速度（米/秒），否则为框高增长率（1/秒）
+        float bearing = 0.f;        // 目标中心在画面中的水平位置，-0.5（最左）~ 0.5（最右）
+        uint64_t sequence = 0;
+        Clock::time_point captureTime;
+        Clock::time_point issued;   // 从 next() 取出的时间
+    };
+
+    struct AlertStats {
+        uint64_t submitted = 0;     // 提交的检测数
+        uint64_t issued = 0;
+        uint64_t suppressed = 0;    // 同一目标重复而未提示
+        uint64_t deadline_dropped = 0;
+        uint64_t overflow_dropped = 0;  // 排队已满时被更高优先级挤掉
+        size_t tracks = 0;
+        // 最近 LATENCY_WINDOW 条提示的采集到发出延迟（毫秒）
+        double p50_ms = 0.0, p90_ms = 0.0, p99_ms = 0.0, max_ms = 0.0;
+    };
+
+    class AlertEngine {
+    public:
+        static constexpr size_t LATENCY_WINDOW = 1024;
+
+        explicit AlertEngine(const AlertConfig& config = {});
+        AlertEngine(const AlertEngine&) = delete;
+        AlertEngine& operator=(const AlertEngine&) = delete;
+
+        // 检测线程调用。detections 为 imageSize 坐标系下的检测框；distances 与 detections 一一对应（米，负值为未知），可为空
+        void submit(Clock::time_point captureTime, uint64_t sequence, std::span<const ONNX::OutputDet> detections,
+                    cv::Size imageSize, std::span<const float> distances = {});
+        // 提示线程调用：等待并取出优先级最高的提示；超时或 stop 后返回 false
+        bool next(Alert& alert, std::chrono::milliseconds timeout);
+        void stop();
+
+        [[nodiscard]] AlertStats stats() const;
+
+    private:
+        struct Track {
+            uint32_t id;
+            int classId;
+            cv::Rect2f box;                 // 归一化坐标
+            float distance;
+            float approach = 0.f;           // 平滑后的接近速度/增长率
+            Clock::time_point seen;         // 最近一次匹配的采集时间
+            Clock::time_point alerted{};    // 最近一次提示的采集时间
+            Level alerted_level = Level::INFO;
+            bool has_alerted = false;
+        };
+
+        [[nodiscard]] float classWeight(int classId) const;
+        [[nodiscard]] float proximity(const Track& track) const;
+        void update(Track& track, const cv::Rect2f& box, float distance, Clock::time_point captureTime) const;
+        void enqueue(const Alert& alert);
+
+        AlertConfig config;
+        uint32_t next_track = 1;
+        std::vector<Track> tracks;          // 只由检测线程访问
+        std::vector<uint8_t> matched;       // 复用的匹配标记
+        std::vector<Alert> fresh;           // 复用的本帧新提示
+
+        mutable std::mutex mtx;
+        std::condition_variable pending_cv;
+        std::vector<Alert> pending;         // 数量很少，取出时线性查找最大优先级
+        std::vector<uint32_t> lost;         // 提示被丢弃的跟踪，下次 submit 时允许它们重新提示
+        bool stopping = false;
+        AlertStats counters;
+        std::vector<double> latencies;      // 环形，LATENCY_WINDOW 条
+        size_t latency_next = 0;
+    };
+
+    const char* levelName(Level level);
+}
+
+#endif //ALERT_H
@@ -0,0 +1,255 @@
+#include "Alert.h"
+#include <algorithm>
+
+using namespace ALERT;
+
+std::map<int, float> AlertConfig::defaultClassWeights() {
+    // COCO 类别：行进中的车辆最危险，行人与动物次之，静止的障碍物最低
+    return {
+        {2, 1.0f},      // car
+        {3, 1.0f},      // motorcycle
+        {5, 1.0f},      // bus
+        {7, 1.0f},      // truck
+        {1, 0.9f},      // bicycle
+        {6, 0.8f},      // train
+        {0, 0.6f},      // person
+        {16, 0.6f},     // dog
+        {10, 0.5f},     // fire hydrant
+        {9, 0.4f},      // traffic light
+        {11, 0.4f},     // stop sign
+        {13, 0.35f},    // bench
+        {56, 0.35f},    // chair
+    };
+}
+
+const char* ALERT::levelName(Level level) {
+    switch (level) {
+        case Level::DANGER: return "DANGER";
+        case Level::WARNING: return "WARNING";
+        default: return "INFO";
+    }
+}
+
+namespace {
+    float iou(const cv::Rect2f& a, const cv::Rect2f& b) {
+        const float x1 = std::max(a.x, b.x), y1 = std::max(a.y, b.y);
+        const float x2 = std::min(a.x + a.width, b.x + b.width), y2 = std::min(a.y + a.height, b.y + b.height);
+        const float inter = std::max(0.f, x2 - x1) * std::max(0.f, y2 - y1);
+        const float uni = a.width * a.height + b.width * b.height - inter;
+        return uni > 0.f ? inter / uni : 0.f;
+    }
+
+    double percentile(const std::vector<double>& sorted, double p) {
+        if (sorted.empty()) return 0.0;
+        const size_t index = std::min(sorted.size() - 1, static_cast<size_t>(p / 100.0 * static_cast<double>(sorted.size())));
+        return sorted[index];
+    }
+}
+
+AlertEngine::AlertEngine(const AlertConfig& config) : config(config) {
+    latencies.reserve(LATENCY_WINDOW);
+    pending.reserve(config.max_pending);
+}
+
+float AlertEngine::classWeight(int classId) const {
+    const auto it = config.class_weights.find(classId);
+    return it != config.class_weights.end() ? it->second : config.default_weight;
+}
+
+float AlertEngine::proximity(const Track& track) const {
+    if (track.distance >= 0.f) {
+        return std::clamp(1.f - track.distance / config.max_range, 0.f, 1.f);
+    }
+    // 没有测距时以框高近似：目标越近框越高
+    return std::clamp(track.box.height / config.near_height_ratio, 0.f, 1.f);
+}
+
+void AlertEngine::update(Track& track, const cv::Rect2f& box, float distance, Clock::time_point captureTime) const {
+    const double dt = std::chrono::duration<double>(captureTime - track.seen).count();
+    if (dt > 1e-3) {
+        float rate;
+        if (distance >= 0.f && track.distance >= 0.f) {
+            rate = static_cast<float>((track.distance - distance) / dt);
+        }
+        else {
+            // 框高的相对增长率，其倒数近似为碰撞时间
+            rate = track.box.height > 0.f ? static_cast<float>((box.height / track.box.height - 1.f) / dt) : 0.f;
+        }
+        // 单帧检测框抖动较大，做一次指数平滑
+        track.approach = 0.5f * track.approach + 0.5f * rate;
+        track.seen = captureTime;
+    }
+    track.box = box;
+    track.distance = distance;
+}
+
+void AlertEngine::submit(Clock::time_point captureTime, uint64_t sequence, std::span<const ONNX::OutputDet> detections,
+                         cv::Size imageSize, std::span<const float> distances) {
+    {
+        // 上次排队后被丢弃的提示：对应目标不再受重复间隔限制
+        std::lock_guard<std::mutex> lock(mtx);
+        for (uint32_t id : lost) {
+            for (auto& track : tracks) {
+                if (track.id == id) track.has_alerted = false;
+            }
+        }
+        lost.clear();
+    }
+
+    std::erase_if(tracks, [&](const Track& track) { return captureTime - track.seen > config.track_timeout; });
+    matched.assign(tracks.size(), 0);
+
+    // 推理本身已超出预算时不再产生提示，只更新跟踪（计入 deadline_dropped）
+    const bool stale = Clock::now() - captureTime > config.latency_budget;
+    fresh.clear();
+    uint64_t suppressed = 0;
+    uint64_t late = 0;
+    const float width = static_cast<float>(std::max(imageSize.width, 1));
+    const float height = static_cast<float>(std::max(imageSize.height, 1));
+    for (size_t i = 0; i < detections.size(); i++) {
+        const ONNX::OutputDet& det = detections[i];
+        const float weight = classWeight(det.id);
+        if (weight <= 0.f) continue;
+        const cv::Rect2f box(det.box.x / width, det.box.y / height, det.box.width / width, det.box.height / height);
+        const float distance = i < distances.size() ? distances[i] : -1.f;
+
+        // 同类中重叠最大的未匹配跟踪
+        size_t best = tracks.size();
+        float best_iou = config.iou_threshold;
+        for (size_t t = 0; t < tracks.size(); t++) {
+            if (matched[t] || tracks[t].classId != det.id) continue;
+            if (const float overlap = iou(tracks[t].box, box); overlap >= best_iou) {
+                best_iou = overlap;
+                best = t;
+            }
+        }
+        if (best == tracks.size()) {
+            tracks.push_back({next_track++, det.id, box, distance, 0.f, captureTime});
+            matched.push_back(1);
+        }
+        else {
+            update(tracks[best], box, distance, captureTime);
+            matched[best] = 1;
+        }
+        Track& track = tracks[best];
+
+        const float approach = std::clamp(track.approach / config.approach_full_scale, 0.f, 1.f);
+        const float priority = weight * (config.proximity_weight * proximity(track) + config.approach_weight * approach);
+        if (priority < config.warning_priority) continue;
+        if (stale) {
+            late++;
+            continue;
+        }
+        const Level level = priority >= config.danger_priority ? Level::DANGER : Level::WARNING;
+        // 同一目标：等级没有升高且距上次提示不久则不重复
+        if (track.has_alerted && level <= track.alerted_level && captureTime - track.alerted < config.repeat_interval) {
+            suppressed++;
+            continue;
+        }
+        track.has_alerted = true;
+        track.alerted = captureTime;
+        track.alerted_level = level;
+
+        Alert alert;
+        alert.track = track.id;
+        alert.classId = det.id;
+        alert.level = level;
+        alert.priority = priority;
+        alert.distance = track.distance;
+        alert.approach = track.approach;
+        alert.bearing = box.x + box.width * 0.5f - 0.5f;
+        alert.sequence = sequence;
+        alert.captureTime = captureTime;
+        fresh.push_back(alert);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        counters.submitted += detections.size();
+        counters.suppressed += suppressed;
+        counters.tracks = tracks.size();
+        counters.deadline_dropped += late;
+        for (const auto& alert : fresh) enqueue(alert);
+    }
+    if (!fresh.empty()) pending_cv.notify_one();
+}
+
+void AlertEngine::enqueue(const Alert& alert) {
+    // 同一目标只保留最新一帧的提示
+    for (auto& queued : pending) {
+        if (queued.track == alert.track) {
+            queued = alert;
+            return;
+        }
+    }
+    if (pending.size() >= config.max_pending) {
+        // 挤掉优先级最低的一条
+        const auto lowest = std::min_element(pending.begin(), pending.end(),
+                                             [](const Alert& a, const Alert& b) { return a.priority < b.priority; });
+        counters.overflow_dropped++;
+        if (lowest->priority >= alert.priority) {
+            lost.push_back(alert.track);
+            return;
+        }
+        lost.push_back(lowest->track);
+        *lowest = alert;
+        return;
+    }
+    pending.push_back(alert);
+}
+
+bool AlertEngine::next(Alert& alert, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mtx);
+    const auto deadline = Clock::now() + timeout;
+    while (true) {
+        if (!pending_cv.wait_until(lock, deadline, [this] { return !pending.empty() || stopping; }) || stopping) {
+            return false;
+        }
+        const auto best = std::max_element(pending.begin(), pending.end(),
+                                           [](const Alert& a, const Alert& b) { return a.priority < b.priority; });
+        alert = *best;
+        pending.erase(best);
+
+        const Clock::time_point now = Clock::now();
+        if (now - alert.captureTime > config.latency_budget) {
+            counters.deadline_dropped++;
+            lost.push_back(alert.track);
+            continue;
+        }
+        alert.issued = now;
+        const double latency = std::chrono::duration<double, std::milli>(now - alert.captureTime).count();
+        if (latencies.size() < LATENCY_WINDOW) {
+            latencies.push_back(latency);
+        }
+        else {
+            latencies[latency_next] = latency;
+        }
+        latency_next = (latency_next + 1) % LATENCY_WINDOW;
+        counters.issued++;
+        return true;
+    }
+}
+
+void AlertEngine::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    pending_cv.notify_all();
+}
+
+AlertStats AlertEngine::stats() const {
+    std::vector<double> sorted;
+    AlertStats result;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        result = counters;
+        sorted = latencies;
+    }
+    std::sort(sorted.begin(), sorted.end());
+    result.p50_ms = percentile(sorted, 50.0);
+    result.p90_ms = percentile(sorted, 90.0);
+    result.p99_ms = percentile(sorted, 99.0);
+    result.max_ms = sorted.empty() ? 0.0 : sorted.back();
+    return result;
+}
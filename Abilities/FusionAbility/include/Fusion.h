@@ -0,0 +1,145 @@
+#ifndef FUSION_H
+#define FUSION_H
+
+#include "GNSS.h"
+#include "IMU.h"
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace FUSION {
+    using Clock = std::chrono::steady_clock;
+
+    // 某一时刻的融合结果。平面位置在以首个有效定位为原点的东-北-天（ENU）坐标系中
+    struct FusedState {
+        Clock::time_point timestamp;
+        double east = 0.0;          // 米
+        double north = 0.0;         // 米
+        double up = 0.0;            // 米，取自 GNSS 海拔
+        double yaw = 0.0;           // 航向，弧度，正北为 0、顺时针为正
+        double speed = 0.0;         // 沿航向的速度，米/秒
+        double yaw_rate = 0.0;      // 弧度/秒，顺时针为正
+        double latitude = 0.0;      // 十进制度
+        double longitude = 0.0;
+        double position_sigma = 0.0;    // 水平位置标准差（米）
+        double yaw_sigma = 0.0;         // 航向标准差（弧度）
+        bool position_valid = false;    // 已收到有效定位
+        bool heading_valid = false;     // 航向已由运动中的 GNSS 航迹向初始化
+    };
+
+    struct FusionConfig {
+        int rate = 100;                                     // 滤波器固定更新频率（Hz）
+        std::chrono::milliseconds history{2000};            // 保存供插值的状态时长
+        std::chrono::milliseconds max_extrapolation{100};   // 查询时刻晚于最新状态时允许外推的最大时长
+        double gyro_noise = 0.01;           // 陀螺角速度噪声（弧度/秒/√Hz）
+        double no_imu_yaw_noise = 0.5;      // 没有 IMU 时航向的随机游走（弧度/秒/√Hz）
+        double accel_noise = 1.0;           // 速度变化的过程噪声（米/秒²/√Hz）
+        double position_noise = 0.1;        // 运动模型误差（米/√秒）
+        double bias_walk = 1e-4;            // 陀螺零偏随机游走（弧度/秒/√秒）
+        double hdop_sigma = 2.5;            // GNSS 水平位置标准差 = HDOP × 该值（米）
+        double speed_sigma = 0.3;           // GNSS 速度标准差（米/秒）
+        double min_course_speed = 1.0;      // 低于该速度时 GNSS 航迹向不可靠，不参与更新（米/秒）
+    };
+
+    // 平面运动的扩展卡尔曼滤波：状态 [东, 北, 航向, 速度, 陀螺零偏]。
+    // 预测用陀螺绕竖直轴的角速度推航向、沿航向匀速推位置；
+    // GNSS 位置为线性观测，速度与航迹向观测航向（非线性角度，残差取最短弧）。不含线程，可单独测试
+    class Ekf {
+    public:
+        using Vec = cv::Matx<double, 5, 1>;
+        using Mat = cv::Matx<double, 5, 5>;
+        enum { EAST, NORTH, YAW, SPEED, BIAS };
+
+        explicit Ekf(const FusionConfig& config = {});
+
+        // 以首个定位初始化位置与速度，航向未知
+        void reset(double east, double north, double speed, double position_sigma);
+        // yaw_rate 为测得的竖直轴角速度（逆时针为正，未扣零偏）；has_imu 为 false 时航向仅随机游走
+        void predict(double dt, double yaw_rate, bool has_imu);
+        void updatePosition(double east, double north, double sigma);
+        // course 为航迹向（弧度，正北顺时针）；速度低于 min_course_speed 时只更新速度
+        void updateVelocity(double speed, double course);
+
+        [[nodiscard]] const Vec& state() const { return x; }
+        [[nodiscard]] const Mat& covariance() const { return P; }
+        [[nodiscard]] bool initialized() const { return has_position; }
+        [[nodiscard]] bool headingValid() const { return has_heading; }
+        // 扣除零偏后的航向角速度（顺时针为正）
+        [[nodiscard]] double yawRate(double measured) const { return -(measured - x(BIAS)); }
+
+    private:
+        template <int M>
+        void update(const cv::Matx<double, M, 1>& innovation, const cv::Matx<double, M, 5>& H, const cv::Matx<double, M, M>& R);
+
+        FusionConfig config;
+        Vec x;
+        Mat P;
+        bool has_position = false;
+        bool has_heading = false;
+    };
+
+    // 以固定频率运行 EKF：每拍取出新的 IMU 采样求平均角速度做预测，GNSS 有新历元时做更新，
+    // 结果带时间戳保存一段时间，任意线程可按相机帧的采集时间插值取状态。
+    // IMU、GNSS 都可缺省：只有 GNSS 时航向来自航迹向，只有 IMU 时仅有航向角速度
+    class FusionEngine {
+    public:
+        FusionEngine(IMU::ImuSource* imu, const GNSS::Location* gnss, const FusionConfig& config = {});
+        ~FusionEngine();
+        FusionEngine(const FusionEngine&) = delete;
+        FusionEngine& operator=(const FusionEngine&) = delete;
+
+        void start();
+        void stop();
+
+        bool latest(FusedState& state) const;
+        // 插值得到 t 时刻的状态；t 早于保存的历史或晚于最新状态超过 max_extrapolation 时返回 false
+        bool stateAt(Clock::time_point t, FusedState& state) const;
+
+        // 相对当前航向 bearing（弧度，右为正）、距离 range（米）处的点在 ENU 中的坐标
+        static cv::Point2d worldPoint(const FusedState& state, double bearing, double range);
+        // ENU -> 经纬度；尚未确定原点时返回 false
+        bool toGeodetic(const cv::Point2d& enu, double& latitude, double& longitude) const;
+
+        [[nodiscard]] uint64_t ticks() const { return tick_count.load(std::memory_order_relaxed); }
+        [[nodiscard]] uint64_t overruns() const { return overrun_count.load(std::memory_order_relaxed); }
+
+    private:
+        void run();
+        // 处理一拍：IMU 采样、GNSS 新历元、预测并记录状态
+        void step(Clock::time_point now, double dt);
+        void applyFix(const GNSS::NavState& nav);
+        FusedState snapshot(Clock::time_point now) const;
+
+        IMU::ImuSource* imu;
+        const GNSS::Location* gnss;
+        FusionConfig config;
+        Ekf ekf;
+
+        std::vector<IMU::ImuSample> samples;    // 复用的采样缓冲
+        cv::Vec3d up_axis{0.0, 0.0, 1.0};       // 由加速度低通估计的竖直方向（传感器坐标）
+        bool up_valid = false;
+        double yaw_rate_measured = 0.0;
+        bool has_imu = false;
+        uint64_t last_fix = 0;
+        double altitude = 0.0;
+
+        // ENU 原点
+        bool has_origin = false;
+        double origin_lat = 0.0, origin_lon = 0.0, origin_alt = 0.0;
+        double meters_per_deg_lat = 0.0, meters_per_deg_lon = 0.0;
+
+        mutable std::mutex history_mutex;
+        std::deque<FusedState> history;
+
+        std::atomic<bool> running{false};
+        std::atomic<uint64_t> tick_count{0};
+        std::atomic<uint64_t> overrun_count{0};
+        std::thread worker;
+    };
+}
+
+#endif //FUSION_H
@@ -0,0 +1,313 @@
+#include "Fusion.h"
+#include "Runtime.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace FUSION {
+
+namespace {
+    constexpr double EARTH_RADIUS = 6378137.0;
+    constexpr double DEG = M_PI / 180.0;
+    constexpr double GRAVITY = 9.80665;
+
+    double wrapAngle(double a) {
+        return std::remainder(a, 2.0 * M_PI);
+    }
+}
+
+// ---------------- Ekf ----------------
+
+Ekf::Ekf(const FusionConfig& config) : config(config), x(Vec::zeros()), P(Mat::eye()) {}
+
+void Ekf::reset(double east, double north, double speed, double position_sigma) {
+    x = Vec::zeros();
+    x(EAST) = east;
+    x(NORTH) = north;
+    x(SPEED) = speed;
+    P = Mat::zeros();
+    P(EAST, EAST) = P(NORTH, NORTH) = position_sigma * position_sigma;
+    P(YAW, YAW) = M_PI * M_PI;
+    P(SPEED, SPEED) = config.speed_sigma * config.speed_sigma;
+    P(BIAS, BIAS) = std::pow(0.5 * DEG, 2);     // 标定后的 MPU6050 零偏约在 ±0.5°/s 以内
+    has_position = true;
+    has_heading = false;
+}
+
+void Ekf::predict(double dt, double yaw_rate, bool has_imu) {
+    if (dt <= 0.0) return;
+    const double yaw = x(YAW);
+    const double speed = x(SPEED);
+    const double s = std::sin(yaw), c = std::cos(yaw);
+
+    Mat F = Mat::eye();
+    Mat Q = Mat::zeros();
+    if (has_heading) {
+        x(EAST) += speed * s * dt;
+        x(NORTH) += speed * c * dt;
+        F(EAST, YAW) = speed * c * dt;
+        F(EAST, SPEED) = s * dt;
+        F(NORTH, YAW) = -speed * s * dt;
+        F(NORTH, SPEED) = c * dt;
+        Q(EAST, EAST) = Q(NORTH, NORTH) = config.position_noise * config.position_noise * dt;
+    }
+    else {
+        // 航向未知时不沿航向推位置，把这段可能的位移计入位置不确定度
+        Q(EAST, EAST) = Q(NORTH, NORTH) = config.position_noise * config.position_noise * dt + speed * speed * dt * dt;
+    }
+    if (has_imu) {
+        x(YAW) = wrapAngle(yaw + yawRate(yaw_rate) * dt);
+        F(YAW, BIAS) = dt;
+        Q(YAW, YAW) = config.gyro_noise * config.gyro_noise * dt;
+    }
+    else {
+        Q(YAW, YAW) = config.no_imu_yaw_noise * config.no_imu_yaw_noise * dt;
+    }
+    Q(SPEED, SPEED) = config.accel_noise * config.accel_noise * dt;
+    Q(BIAS, BIAS) = config.bias_walk * config.bias_walk * dt;
+
+    P = F * P * F.t() + Q;
+}
+
+template <int M>
+void Ekf::update(const cv::Matx<double, M, 1>& innovation, const cv::Matx<double, M, 5>& H, const cv::Matx<double, M, M>& R) {
+    const cv::Matx<double, M, M> S = H * P * H.t() + R;
+    const cv::Matx<double, 5, M> K = P * H.t() * S.inv(cv::DECOMP_CHOLESKY);
+    x += K * innovation;
+    x(YAW) = wrapAngle(x(YAW));
+    // Joseph 形式，保持协方差对称正定
+    const Mat I_KH = Mat::eye() - K * H;
+    P = I_KH * P * I_KH.t() + K * R * K.t();
+}
+
+void Ekf::updatePosition(double east, double north, double sigma) {
+    cv::Matx<double, 2, 5> H = cv::Matx<double, 2, 5>::zeros();
+    H(0, EAST) = 1.0;
+    H(1, NORTH) = 1.0;
+    const cv::Matx<double, 2, 1> innovation(east - x(EAST), north - x(NORTH));
+    update<2>(innovation, H, cv::Matx<double, 2, 2>::eye() * (sigma * sigma));
+}
+
+void Ekf::updateVelocity(double speed, double course) {
+    const double speed_var = config.speed_sigma * config.speed_sigma;
+    if (speed < config.min_course_speed) {
+        cv::Matx<double, 1, 5> H = cv::Matx<double, 1, 5>::zeros();
+        H(0, SPEED) = 1.0;
+        update<1>(cv::Matx<double, 1, 1>(speed - x(SPEED)), H, cv::Matx<double, 1, 1>(speed_var));
+        return;
+    }
+
+    // 航迹向误差约为速度误差与速度之比
+    const double course_sigma = std::max(std::atan2(config.speed_sigma, speed), 2.0 * DEG);
+    if (!has_heading) {
+        // 首次得到可靠航迹向：直接初始化航向，避免从 ±π 的不确定度开始做角度更新
+        x(YAW) = wrapAngle(course);
+        for (int i = 0; i < 5; ++i) P(YAW, i) = P(i, YAW) = 0.0;
+        P(YAW, YAW) = course_sigma * course_sigma;
+        has_heading = true;
+    }
+    cv::Matx<double, 2, 5> H = cv::Matx<double, 2, 5>::zeros();
+    H(0, SPEED) = 1.0;
+    H(1, YAW) = 1.0;
+    const cv::Matx<double, 2, 1> innovation(speed - x(SPEED), wrapAngle(course - x(YAW)));
+    const cv::Matx<double, 2, 2> R(speed_var, 0.0, 0.0, course_sigma * course_sigma);
+    update<2>(innovation, H, R);
+}
+
+// ---------------- FusionEngine ----------------
+
+FusionEngine::FusionEngine(IMU::ImuSource* imu, const GNSS::Location* gnss, const FusionConfig& config)
+    : imu(imu), gnss(gnss), config(config), ekf(config) {
+    // 每拍最多取出的采样数约为 IMU 采样率 / 融合频率，留足余量
+    samples.reserve(256);
+}
+
+FusionEngine::~FusionEngine() {
+    stop();
+}
+
+void FusionEngine::start() {
+    if (running.exchange(true)) return;
+    worker = std::thread(&FusionEngine::run, this);
+}
+
+void FusionEngine::stop() {
+    running = false;
+    if (worker.joinable()) worker.join();
+}
+
+void FusionEngine::run() {
+    RT::ThreadScope scope("fusion");
+    const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / std::max(config.rate, 1)));
+    Clock::time_point last = Clock::now();
+    Clock::time_point next = last + period;
+    while (running.load(std::memory_order_relaxed)) {
+        std::this_thread::sleep_until(next);
+        const Clock::time_point now = Clock::now();
+        step(now, std::chrono::duration<double>(now - last).count());
+        last = now;
+        tick_count.fetch_add(1, std::memory_order_relaxed);
+
+        next += period;
+        if (Clock::now() > next) {
+            // 落后一整拍以上（调度延迟或 I2C 阻塞）：不补拍，从现在重新计时
+            overrun_count.fetch_add(1, std::memory_order_relaxed);
+            next = Clock::now() + period;
+        }
+    }
+}
+
+void FusionEngine::step(Clock::time_point now, double dt) {
+    if (imu) {
+        samples.clear();
+        const HAL::HardwareStatus status = imu->readSamples(samples, 0);
+        if (status == HAL::ERROR) {
+            has_imu = false;
+        }
+        else if (!samples.empty()) {
+            // 竖直轴取加速度的低通方向，传感器倾斜安装时仍能得到绕竖直轴的角速度
+            double sum = 0.0;
+            for (const IMU::ImuSample& sample : samples) {
+                const double norm = cv::norm(sample.accel);
+                if (norm > 0.5 * GRAVITY && norm < 1.5 * GRAVITY) {
+                    up_axis = up_valid ? cv::normalize(up_axis * 0.98 + sample.accel * (0.02 / norm)) : sample.accel / norm;
+                    up_valid = true;
+                }
+                sum += sample.gyro.dot(up_axis);
+            }
+            yaw_rate_measured = sum / static_cast<double>(samples.size());
+            has_imu = true;
+        }
+        // 本拍恰好没有新采样时沿用上一拍的角速度
+    }
+
+    ekf.predict(dt, yaw_rate_measured, has_imu);
+
+    if (gnss) {
+        const GNSS::NavState nav = gnss->latest();
+        if (nav.sequence != last_fix) {
+            last_fix = nav.sequence;
+            if (nav.valid) applyFix(nav);
+        }
+    }
+
+    const FusedState state = snapshot(now);
+    std::lock_guard<std::mutex> lock(history_mutex);
+    history.push_back(state);
+    while (!history.empty() && now - history.front().timestamp > config.history) {
+        history.pop_front();
+    }
+}
+
+void FusionEngine::applyFix(const GNSS::NavState& nav) {
+    const double sigma = std::max(nav.hdop * config.hdop_sigma, 1.0);
+    if (!has_origin) {
+        std::lock_guard<std::mutex> lock(history_mutex);
+        origin_lat = nav.latitude;
+        origin_lon = nav.longitude;
+        origin_alt = nav.altitude;
+        // 局部范围内用等距投影，几公里内误差远小于 GNSS 本身的误差
+        meters_per_deg_lat = EARTH_RADIUS * DEG;
+        meters_per_deg_lon = EARTH_RADIUS * DEG * std::cos(origin_lat * DEG);
+        has_origin = true;
+    }
+    const double east = (nav.longitude - origin_lon) * meters_per_deg_lon;
+    const double north = (nav.latitude - origin_lat) * meters_per_deg_lat;
+    if (!ekf.initialized()) {
+        ekf.reset(east, north, nav.speed, sigma);
+    }
+    else {
+        ekf.updatePosition(east, north, sigma);
+    }
+    ekf.updateVelocity(nav.speed, nav.course * DEG);
+    altitude = nav.altitude;
+}
+
+FusedState FusionEngine::snapshot(Clock::time_point now) const {
+    const Ekf::Vec& x = ekf.state();
+    const Ekf::Mat& P = ekf.covariance();
+    FusedState state;
+    state.timestamp = now;
+    state.east = x(Ekf::EAST);
+    state.north = x(Ekf::NORTH);
+    state.yaw = x(Ekf::YAW);
+    state.speed = x(Ekf::SPEED);
+    state.yaw_rate = has_imu ? ekf.yawRate(yaw_rate_measured) : 0.0;
+    state.position_valid = ekf.initialized();
+    state.heading_valid = ekf.headingValid();
+    state.position_sigma = std::sqrt(std::max(P(Ekf::EAST, Ekf::EAST), P(Ekf::NORTH, Ekf::NORTH)));
+    state.yaw_sigma = std::sqrt(P(Ekf::YAW, Ekf::YAW));
+    if (has_origin) {
+        state.up = altitude - origin_alt;
+        state.latitude = origin_lat + state.north / meters_per_deg_lat;
+        state.longitude = origin_lon + state.east / meters_per_deg_lon;
+    }
+    return state;
+}
+
+bool FusionEngine::latest(FusedState& state) const {
+    std::lock_guard<std::mutex> lock(history_mutex);
+    if (history.empty()) return false;
+    state = history.back();
+    return true;
+}
+
+bool FusionEngine::stateAt(Clock::time_point t, FusedState& state) const {
+    std::lock_guard<std::mutex> lock(history_mutex);
+    if (history.empty() || t < history.front().timestamp) return false;
+
+    const FusedState& newest = history.back();
+    if (t >= newest.timestamp) {
+        if (t - newest.timestamp > config.max_extrapolation) return false;
+        // 帧比最新一拍稍晚：按当前角速度与速度外推
+        const double dt = std::chrono::duration<double>(t - newest.timestamp).count();
+        state = newest;
+        state.timestamp = t;
+        state.yaw = wrapAngle(newest.yaw + newest.yaw_rate * dt);
+        if (newest.heading_valid && has_origin) {
+            const double mid = newest.yaw + 0.5 * newest.yaw_rate * dt;
+            state.east += newest.speed * std::sin(mid) * dt;
+            state.north += newest.speed * std::cos(mid) * dt;
+            state.latitude = origin_lat + state.north / meters_per_deg_lat;
+            state.longitude = origin_lon + state.east / meters_per_deg_lon;
+        }
+        return true;
+    }
+
+    // 第一个时间戳大于 t 的状态与其前一个之间线性插值，航向按最短弧插值
+    const auto after = std::upper_bound(history.begin(), history.end(), t,
+                                        [](Clock::time_point time, const FusedState& s) { return time < s.timestamp; });
+    const FusedState& b = *after;
+    const FusedState& a = *std::prev(after);
+    const double alpha = std::chrono::duration<double>(t - a.timestamp).count() /
+                         std::chrono::duration<double>(b.timestamp - a.timestamp).count();
+    const auto lerp = [alpha](double u, double v) { return u + (v - u) * alpha; };
+    state = b;      // 有效标志取较新的一拍
+    state.timestamp = t;
+    state.east = lerp(a.east, b.east);
+    state.north = lerp(a.north, b.north);
+    state.up = lerp(a.up, b.up);
+    state.speed = lerp(a.speed, b.speed);
+    state.yaw_rate = lerp(a.yaw_rate, b.yaw_rate);
+    state.yaw = wrapAngle(a.yaw + wrapAngle(b.yaw - a.yaw) * alpha);
+    state.latitude = lerp(a.latitude, b.latitude);
+    state.longitude = lerp(a.longitude, b.longitude);
+    state.position_sigma = lerp(a.position_sigma, b.position_sigma);
+    state.yaw_sigma = lerp(a.yaw_sigma, b.yaw_sigma);
+    return true;
+}
+
+cv::Point2d FusionEngine::worldPoint(const FusedState& state, double bearing, double range) {
+    const double direction = state.yaw + bearing;
+    return {state.east + range * std::sin(direction), state.north + range * std::cos(direction)};
+}
+
+bool FusionEngine::toGeodetic(const cv::Point2d& enu, double& latitude, double& longitude) const {
+    std::lock_guard<std::mutex> lock(history_mutex);
+    if (!has_origin) return false;
+    latitude = origin_lat + enu.y / meters_per_deg_lat;
+    longitude = origin_lon + enu.x / meters_per_deg_lon;
+    return true;
+}
+
+} // namespace FUSION
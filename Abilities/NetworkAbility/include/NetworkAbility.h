@@ -5,4 +5,87 @@
 #ifndef NETWORKABILITY_H
 #define NETWORKABILITY_H
 
+#include "HAL_Reactor.h"
+#include "HAL_UART.h"
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace NET {
+    enum class AtStatus {
+        OK,
+        ERROR,      // ERROR / +CME ERROR / +CMS ERROR
+        TIMEOUT,
+        CLOSED,     // 串口关闭或排队已满，命令未发出或未完成
+    };
+
+    struct AtResponse {
+        AtStatus status = AtStatus::OK;
+        std::vector<std::string> lines;     // 最终结果之前的应答行（不含回显）
+        std::string error;                  // ERROR 时的最终结果行
+    };
+
+    using AtCallback = std::function<void(const AtResponse& response)>;
+    // 非请求结果码（URC），如 RDY、+QIND、+CREG: 1
+    using UrcHandler = std::function<void(std::string_view line)>;
+
+    // AT 命令通道（EC200M 等 4G 模组的 AT 口），运行在 HAL::IO::Reactor 的事件循环中：
+    // 命令排队逐条发送，每条的应答期限由事件循环的时间轮计时，不占用单独的线程。
+    // 只支持以 OK/ERROR 结束的命令，不支持短信等需要 ">" 提示符的交互
+    class AtModem {
+    public:
+        static constexpr std::chrono::milliseconds DEFAULT_TIMEOUT{1000};
+        static constexpr size_t MAX_PENDING = 16;
+        // 命令超时后模组可能稍后才给出最终结果：先发一条 AT，丢弃其最终结果之前的所有行再继续发送队列。
+        // 模组关闭回显（ATE0）时无法区分迟到的结果与 AT 的结果，等满该期限再继续
+        static constexpr std::chrono::milliseconds SYNC_TIMEOUT{1000};
+
+        AtModem(HAL::IO::Reactor& reactor, HAL::UART::Uart& uart);
+
+        // 注册到事件循环；须在 reactorRun 之前或在事件循环线程中调用
+        HAL::HardwareStatus attach();
+        // 须在 attach 之前设置
+        void setUrcHandler(UrcHandler handler) { urc_handler = std::move(handler); }
+        // 任意线程调用：排队发送 command（不含 \r），完成、出错或超时后在事件循环线程中调用 callback
+        void command(std::string command, AtCallback callback, std::chrono::milliseconds timeout = DEFAULT_TIMEOUT);
+
+        [[nodiscard]] uint64_t completed() const { return completed_count; }
+        [[nodiscard]] uint64_t timeouts() const { return timeout_count; }
+    private:
+        struct Pending {
+            std::string command;
+            AtCallback callback;
+            std::chrono::milliseconds timeout;
+        };
+
+        void enqueue(Pending pending);
+        void sendNext();
+        void handleLine(std::string_view line);
+        void finish(AtStatus status);
+        void resync();
+        void endSync();
+        void handleClose();
+
+        HAL::IO::Reactor& reactor;
+        HAL::UART::Uart& uart;
+        UrcHandler urc_handler;
+        std::deque<Pending> queue;
+        bool busy = false;
+        bool closed = false;
+        bool syncing = false;       // 超时后等待 AT 的最终结果，期间不发送队列中的命令
+        bool sync_echoed = false;   // 已收到同步用 AT 的回显，其后的最终结果属于它
+        std::string prefix;         // 当前命令应答行的前缀，例如 AT+CSQ 对应 +CSQ
+        AtResponse response;
+        HAL::IO::TimerId timer = 0;
+        uint64_t completed_count = 0;
+        uint64_t timeout_count = 0;
+    public:
+        AtModem(const AtModem&) = delete;
+        AtModem& operator=(const AtModem&) = delete;
+    };
+}
+
 #endif //NETWORKABILITY_H
@@ -0,0 +1,248 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <variant>
+#include <vector>
+
+// 遥测上报：检测结果、危险提示与定位历元编码成紧凑的二进制批，按长度或时间凑满一批后由单独的线程
+// 经 UDP 或 TCP 发往后台。链路断开时批写入缓存目录（总量有上限，满时删除最旧的），恢复后按序补发。
+//
+// 批的格式（多字节整数为小端，varint 为 LEB128，有符号数先做 zigzag）：
+//   "EVT" 版本(1) | 设备编号 u32 | 会话 u32 | 批序号 varint | 事件… | CRC32 u32（覆盖之前的全部字节）
+// 每个事件以类型字节与时间增量开头：时间为 Unix 毫秒，与批内上一个事件之差（首个事件与 0 之差）；
+// 经纬度为 1e-7 度的整数，与批内上一个位置之差。TCP 时每批前加 u32 大端长度。
+// UDP 时后台对每个校验通过的批回复确认："EVA" 版本(1) | 会话 u32 | 批序号 varint；
+// 发出后 ACK_TIMEOUT 内没有确认或对端拒绝（ICMP 端口不可达）时视为链路断开，未确认的批写入缓存。
+// 确认丢失时同一批可能重复送达，后台按（设备, 会话, 批序号）去重
+namespace NET {
+    enum class Transport {
+        UDP,        // 每批一个数据报，只能发现本机无路由或对端拒绝（ICMP）等错误
+        TCP,
+    };
+
+    struct TelemetryConfig {
+        Transport transport = Transport::UDP;
+        std::string host;
+        uint16_t port = 0;
+        uint32_t device = 0;                                // 设备编号，后台据此区分终端
+        size_t batch_bytes = 1200;                          // 批的编码长度上限（UDP 时不超过一个 MTU），单个事件超过时单独成批
+        std::chrono::milliseconds batch_interval{2000};     // 批内首个事件最多等待多久
+        size_t queue_batches = 16;                          // 等待发送的批数，超出时丢弃最旧的
+        std::string spool_dir;                              // 链路断开时的缓存目录，空则直接丢弃
+        uint64_t spool_bytes = 16 * 1024 * 1024;
+        std::chrono::milliseconds retry_interval{5000};     // 断开后的重连间隔
+    };
+
+    enum EventType : uint8_t {
+        EVENT_DETECTION = 1,
+        EVENT_ALERT = 2,
+        EVENT_FIX = 3,
+    };
+
+    // 检测到的一个目标，框归一化到画面 [0,1]，按 1/4096 量化
+    struct TelemetryObject {
+        int classId = 0;
+        float confidence = 0.f;             // 按 1/255 量化
+        float x = 0.f, y = 0.f, width = 0.f, height = 0.f;
+        bool near = false;
+        double bearingDeg = -1.0;           // 绝对方位，按 0.1 度量化，无航向时为负
+    };
+
+    struct DetectionEvent {
+        uint64_t unixMs = 0;
+        uint16_t source = 0;                // 流水线编号
+        uint64_t sequence = 0;              // 帧序号
+        bool positioned = false;
+        double latitude = 0.0;
+        double longitude = 0.0;
+        std::vector<TelemetryObject> objects;
+    };
+
+    struct AlertEvent {
+        uint64_t unixMs = 0;
+        uint32_t track = 0;
+        int classId = 0;
+        uint8_t level = 0;                  // ALERT::Level
+        float distance = -1.f;              // 米，按厘米量化，未知时为负
+        float bearing = 0.f;                // 画面中的水平位置 -0.5~0.5，按 1/1000 量化
+    };
+
+    struct FixEvent {
+        uint64_t unixMs = 0;
+        double latitude = 0.0;
+        double longitude = 0.0;
+        double altitude = 0.0;              // 按分米量化
+        double speed = 0.0;                 // 米/秒，按厘米/秒量化
+        double course = 0.0;                // 度，按 0.01 度量化
+        double hdop = 0.0;                  // 按 0.1 量化
+        int quality = 0;
+        int satellites = 0;
+    };
+
+    using TelemetryEvent = std::variant<DetectionEvent, AlertEvent, FixEvent>;
+
+    struct TelemetryBatch {
+        uint32_t device = 0;
+        uint32_t session = 0;
+        uint64_t sequence = 0;
+        std::vector<TelemetryEvent> events;
+    };
+
+    // steady_clock 时刻（帧采集、历元接收）换算到 Unix 毫秒
+    uint64_t unixMs(std::chrono::steady_clock::time_point time);
+
+    // 逐个事件追加编码，不含线程与锁
+    class BatchEncoder {
+    public:
+        static constexpr uint8_t VERSION = 1;
+
+        BatchEncoder(uint32_t device, uint32_t session) : device(device), session(session) {}
+
+        // 开始新的一批，buffer 复用已有容量
+        void begin(std::vector<uint8_t> buffer, uint64_t sequence);
+        void add(const DetectionEvent& event);
+        void add(const AlertEvent& event);
+        void add(const FixEvent& event);
+        // 追加 CRC 并交出编码结果，之后须重新 begin
+        std::vector<uint8_t> finish();
+
+        [[nodiscard]] size_t size() const { return data.size(); }
+        [[nodiscard]] size_t count() const { return event_count; }
+        // 封批后的长度（含 CRC）
+        [[nodiscard]] size_t sealedSize() const;
+
+        // 编码状态的位置，追加事件后超出批长度时回到该位置，把事件移到下一批
+        struct Mark {
+            size_t size;
+            size_t count;
+            uint64_t last_ms;
+            int64_t last_lat, last_lon;
+            uint64_t last_sequence;
+        };
+        [[nodiscard]] Mark mark() const { return {data.size(), event_count, last_ms, last_lat, last_lon, last_sequence}; }
+        void rollback(const Mark& mark);
+
+    private:
+        void eventHeader(EventType type, uint64_t unixMs);
+        void position(double latitude, double longitude);
+        void varint(uint64_t value);
+        void zigzag(int64_t value);
+
+        uint32_t device;
+        uint32_t session;
+        std::vector<uint8_t> data;
+        size_t event_count = 0;
+        uint64_t last_ms = 0;
+        int64_t last_lat = 0;
+        int64_t last_lon = 0;
+        uint64_t last_sequence = 0;
+    };
+
+    // 校验并解码一批；格式或 CRC 错误时返回 false
+    bool decodeBatch(const uint8_t* data, size_t size, TelemetryBatch& batch);
+    // UDP 确认
+    std::vector<uint8_t> encodeAck(const TelemetryBatch& batch);
+    bool decodeAck(const uint8_t* data, size_t size, uint32_t& session, uint64_t& sequence);
+
+    struct TelemetryStats {
+        uint64_t events = 0;
+        uint64_t batches = 0;               // 封好的批
+        uint64_t sent = 0;                  // 发出的批（含补发）
+        uint64_t acked = 0;                 // UDP 时后台确认收到的批
+        uint64_t sent_bytes = 0;
+        uint64_t spooled = 0;               // 写入缓存目录的批
+        uint64_t resent = 0;                // 从缓存目录补发的批
+        uint64_t dropped = 0;               // 队列或缓存目录满、无缓存目录时丢弃的批
+        uint64_t pending_spool = 0;         // 缓存目录中尚未补发的批
+        uint64_t reconnects = 0;
+        bool connected = false;
+    };
+
+    // 事件由任意线程提交：只在锁内编码进当前批，不做任何 I/O。封批、连接、发送与缓存都在上报线程中完成
+    class TelemetryUplink {
+    public:
+        static constexpr std::chrono::milliseconds CONNECT_TIMEOUT{2000};
+        static constexpr size_t RESEND_PER_WAKE = 16;   // 每次唤醒最多补发的批数，避免恢复后占满上行
+        static constexpr std::chrono::milliseconds ACK_TIMEOUT{3000};   // UDP：最早的未确认批等待确认的期限
+        static constexpr std::chrono::milliseconds STOP_ACK_WAIT{500};  // UDP：停止时等待未确认批的时间
+
+        explicit TelemetryUplink(TelemetryConfig config);
+        ~TelemetryUplink();
+        TelemetryUplink(const TelemetryUplink&) = delete;
+        TelemetryUplink& operator=(const TelemetryUplink&) = delete;
+
+        // 载入上次运行遗留的缓存并启动上报线程
+        bool start();
+        // 封存当前批并尝试发出，发不出的写入缓存目录
+        void stop();
+
+        void submit(const DetectionEvent& event);
+        void submit(const AlertEvent& event);
+        void submit(const FixEvent& event);
+
+        [[nodiscard]] TelemetryStats stats() const;
+
+    private:
+        struct Spooled {
+            std::filesystem::path path;
+            uint64_t size;
+        };
+        // UDP 已发出、等待确认的批
+        struct InFlight {
+            uint32_t session;
+            uint64_t sequence;
+            std::vector<uint8_t> batch;
+            std::chrono::steady_clock::time_point sent;
+        };
+
+        template <typename Event>
+        void append(const Event& event);
+        // 须持锁
+        void seal();
+        void run();
+        // 连接并先补发缓存，再发送 batch；发不出时写入缓存目录
+        void deliver(std::vector<uint8_t> batch);
+        bool connect();
+        void disconnect();
+        bool send(const std::vector<uint8_t>& batch);
+        // 读取已到达的 UDP 确认，对端拒绝时断开链路
+        void readAcks();
+        // 断开链路，未确认的批按发出顺序写入缓存
+        void linkDown(const std::string& reason);
+        void resend(size_t limit);
+        void loadSpool();
+        void spool(const std::vector<uint8_t>& batch);
+        void recycle(std::vector<uint8_t> buffer);
+
+        TelemetryConfig config;
+        mutable std::mutex mtx;
+        std::condition_variable cv;
+        BatchEncoder encoder;
+        uint64_t next_sequence = 1;
+        std::chrono::steady_clock::time_point batch_started;
+        std::deque<std::vector<uint8_t>> ready;         // 已封好、等待发送的批
+        std::vector<std::vector<uint8_t>> spare;        // 发完的缓冲，供下一批复用
+        bool stopping = false;
+        std::thread worker;
+        TelemetryStats counters;
+
+        // 以下只在上报线程中访问
+        int fd = -1;
+        bool link_confirmed = false;    // TCP 连接成功或 UDP 收到确认后按 RESEND_PER_WAKE 补发，否则每次只试探一批
+        std::deque<InFlight> inflight;
+        std::chrono::steady_clock::time_point next_retry;
+        std::deque<Spooled> spooled;
+        uint64_t spool_total = 0;
+        uint64_t spool_index = 0;
+    };
+}
+
+#endif //TELEMETRY_H
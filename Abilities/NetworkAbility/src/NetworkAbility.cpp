@@ -1 +1,158 @@
 #include "NetworkAbility.h"
+#include <iostream>
+
+using namespace NET;
+
+namespace {
+    bool isError(std::string_view line) {
+        return line == "ERROR" || line.starts_with("+CME ERROR") || line.starts_with("+CMS ERROR");
+    }
+
+    // AT+CSQ -> +CSQ，AT+CPIN? -> +CPIN，AT+QICFG="..." -> +QICFG；基本命令（ATI 等）没有前缀
+    std::string responsePrefix(std::string_view command) {
+        if (!command.starts_with("AT+") && !command.starts_with("at+")) return {};
+        std::string_view name = command.substr(2);
+        name = name.substr(0, name.find_first_of("?=;"));
+        return std::string(name);
+    }
+}
+
+AtModem::AtModem(HAL::IO::Reactor& reactor, HAL::UART::Uart& uart) : reactor(reactor), uart(uart) {}
+
+HAL::HardwareStatus AtModem::attach() {
+    return reactor.reactorAddUart(uart, [this](HAL::UART::LineBatch lines) {
+        for (std::string_view line : lines) handleLine(line);
+    }, [this] { handleClose(); });
+}
+
+void AtModem::command(std::string command, AtCallback callback, std::chrono::milliseconds timeout) {
+    reactor.reactorPost([this, pending = Pending{std::move(command), std::move(callback), timeout}]() mutable {
+        enqueue(std::move(pending));
+    });
+}
+
+void AtModem::enqueue(Pending pending) {
+    if (closed || queue.size() >= MAX_PENDING) {
+        if (pending.callback) pending.callback(AtResponse{AtStatus::CLOSED, {}, {}});
+        return;
+    }
+    queue.push_back(std::move(pending));
+    if (!busy) sendNext();
+}
+
+void AtModem::sendNext() {
+    if (closed) return;
+    while (!busy && !syncing && !queue.empty()) {
+        const Pending& next = queue.front();
+        const std::string line = next.command + "\r";
+        if (uart.uartWrite(reinterpret_cast<const uint8_t*>(line.data()), line.size()) != HAL::OK) {
+            std::cerr << "Failed to send AT command: " << next.command << std::endl;
+            if (next.callback) next.callback(AtResponse{AtStatus::ERROR, {}, "write failed"});
+            queue.pop_front();
+            continue;
+        }
+        busy = true;
+        prefix = responsePrefix(next.command);
+        response = AtResponse{};
+        timer = reactor.reactorAddTimer(next.timeout, [this] {
+            timer = 0;
+            timeout_count++;
+            finish(AtStatus::TIMEOUT);
+        });
+    }
+}
+
+void AtModem::handleLine(std::string_view line) {
+    if (line.empty()) return;
+    if (syncing) {
+        if (line == "AT") {
+            sync_echoed = true;
+            return;
+        }
+        if (line == "OK" || isError(line)) {
+            // 回显之前的最终结果属于已超时的命令
+            if (sync_echoed) endSync();
+            return;
+        }
+        if (line.front() != '+') return;     // 已超时命令迟到的应答行
+    }
+    else if (busy) {
+        const std::string& command = queue.front().command;
+        if (line == command) return;    // 回显（ATE1）
+        if (line == "OK") {
+            finish(AtStatus::OK);
+            return;
+        }
+        if (isError(line)) {
+            response.error = std::string(line);
+            finish(AtStatus::ERROR);
+            return;
+        }
+        // 以 + 开头但不是本命令前缀的行是插入的 URC
+        if (line.front() != '+' || (!prefix.empty() && line.starts_with(prefix))) {
+            response.lines.emplace_back(line);
+            return;
+        }
+    }
+    else if (line == "OK" || isError(line)) {
+        return;     // 已超时命令迟到的最终结果
+    }
+    if (urc_handler) urc_handler(line);
+}
+
+void AtModem::finish(AtStatus status) {
+    if (!busy) return;
+    if (timer != 0) {
+        reactor.reactorCancelTimer(timer);
+        timer = 0;
+    }
+    Pending done = std::move(queue.front());
+    queue.pop_front();
+    busy = false;
+    response.status = status;
+    if (status != AtStatus::TIMEOUT) completed_count++;
+    if (done.callback) done.callback(response);
+    if (status == AtStatus::TIMEOUT) {
+        resync();
+    }
+    else {
+        sendNext();
+    }
+}
+
+void AtModem::resync() {
+    if (closed) return;
+    static constexpr std::string_view SYNC = "AT\r";
+    if (uart.uartWrite(reinterpret_cast<const uint8_t*>(SYNC.data()), SYNC.size()) != HAL::OK) {
+        sendNext();
+        return;
+    }
+    syncing = true;
+    sync_echoed = false;
+    timer = reactor.reactorAddTimer(SYNC_TIMEOUT, [this] {
+        timer = 0;
+        endSync();
+    });
+}
+
+void AtModem::endSync() {
+    if (!syncing) return;
+    if (timer != 0) {
+        reactor.reactorCancelTimer(timer);
+        timer = 0;
+    }
+    syncing = false;
+    sendNext();
+}
+
+void AtModem::handleClose() {
+    std::cerr << "AT modem UART closed." << std::endl;
+    closed = true;
+    if (syncing) endSync();
+    if (busy) finish(AtStatus::CLOSED);
+    while (!queue.empty()) {
+        Pending pending = std::move(queue.front());
+        queue.pop_front();
+        if (pending.callback) pending.callback(AtResponse{AtStatus::CLOSED, {}, {}});
+    }
+}
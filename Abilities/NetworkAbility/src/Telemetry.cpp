@@ -0,0 +1,705 @@
+#include "Telemetry.h"
+#include "Runtime.h"
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+using namespace NET;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+    constexpr uint8_t MAGIC[3] = {'E', 'V', 'T'};
+    constexpr uint8_t ACK_MAGIC[3] = {'E', 'V', 'A'};
+    constexpr size_t HEADER_MIN = sizeof(MAGIC) + 1 + 4 + 4 + 1;
+    constexpr size_t CRC_SIZE = 4;
+    constexpr double POSITION_SCALE = 1e7;      // 1e-7 度，约 1 厘米
+    constexpr double BOX_SCALE = 4096.0;
+    constexpr size_t SPARE_BUFFERS = 4;
+    const char* const SPOOL_SUFFIX = ".tlm";
+
+    constexpr std::array<uint32_t, 256> CRC_TABLE = [] {
+        std::array<uint32_t, 256> table{};
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+        return table;
+    }();
+
+    uint32_t crc32(const uint8_t* data, size_t size) {
+        uint32_t c = 0xFFFFFFFFu;
+        for (size_t i = 0; i < size; i++) c = CRC_TABLE[(c ^ data[i]) & 0xFF] ^ (c >> 8);
+        return c ^ 0xFFFFFFFFu;
+    }
+
+    void putU32(std::vector<uint8_t>& data, uint32_t value) {
+        for (int i = 0; i < 4; i++) data.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+
+    void putVarint(std::vector<uint8_t>& data, uint64_t value) {
+        while (value >= 0x80) {
+            data.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        data.push_back(static_cast<uint8_t>(value));
+    }
+
+    uint64_t quantize(double value, double scale, uint64_t max) {
+        const long long q = std::llround(value * scale);
+        return static_cast<uint64_t>(std::clamp<long long>(q, 0, static_cast<long long>(max)));
+    }
+
+    class Reader {
+    public:
+        Reader(const uint8_t* data, size_t size) : data(data), size(size) {}
+
+        uint8_t u8() {
+            if (pos >= size) return fail();
+            return data[pos++];
+        }
+
+        uint32_t u32() {
+            uint32_t value = 0;
+            for (int i = 0; i < 4; i++) value |= static_cast<uint32_t>(u8()) << (8 * i);
+            return value;
+        }
+
+        uint64_t varint() {
+            uint64_t value = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                const uint8_t byte = u8();
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) return value;
+            }
+            return fail();
+        }
+
+        int64_t zigzag() {
+            const uint64_t value = varint();
+            return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+        }
+
+        [[nodiscard]] bool more() const { return ok && pos < size; }
+        [[nodiscard]] bool good() const { return ok; }
+
+    private:
+        uint8_t fail() {
+            ok = false;
+            pos = size;
+            return 0;
+        }
+
+        const uint8_t* data;
+        size_t size;
+        size_t pos = 0;
+        bool ok = true;
+    };
+
+    // 只读批首的会话与批序号，不校验 CRC（用于已编码好的本机批）
+    bool batchId(const std::vector<uint8_t>& batch, uint32_t& session, uint64_t& sequence) {
+        if (batch.size() < HEADER_MIN || std::memcmp(batch.data(), MAGIC, sizeof(MAGIC)) != 0) return false;
+        Reader in(batch.data() + sizeof(MAGIC) + 1, batch.size() - sizeof(MAGIC) - 1);
+        in.u32();
+        session = in.u32();
+        sequence = in.varint();
+        return in.good();
+    }
+
+    std::string spoolName(uint64_t index) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llu%s", static_cast<unsigned long long>(index), SPOOL_SUFFIX);
+        return name;
+    }
+}
+
+uint64_t NET::unixMs(std::chrono::steady_clock::time_point time) {
+    using namespace std::chrono;
+    return static_cast<uint64_t>(duration_cast<milliseconds>((system_clock::now() - (steady_clock::now() - time))
+                                                             .time_since_epoch()).count());
+}
+
+void BatchEncoder::begin(std::vector<uint8_t> buffer, uint64_t sequence) {
+    data = std::move(buffer);
+    data.clear();
+    data.insert(data.end(), std::begin(MAGIC), std::end(MAGIC));
+    data.push_back(VERSION);
+    putU32(data, device);
+    putU32(data, session);
+    varint(sequence);
+    event_count = 0;
+    last_ms = 0;
+    last_lat = 0;
+    last_lon = 0;
+    last_sequence = 0;
+}
+
+void BatchEncoder::varint(uint64_t value) {
+    putVarint(data, value);
+}
+
+void BatchEncoder::zigzag(int64_t value) {
+    varint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+void BatchEncoder::eventHeader(EventType type, uint64_t unixMs) {
+    data.push_back(type);
+    zigzag(static_cast<int64_t>(unixMs - last_ms));
+    last_ms = unixMs;
+    event_count++;
+}
+
+void BatchEncoder::position(double latitude, double longitude) {
+    const int64_t lat = std::llround(latitude * POSITION_SCALE);
+    const int64_t lon = std::llround(longitude * POSITION_SCALE);
+    zigzag(lat - last_lat);
+    zigzag(lon - last_lon);
+    last_lat = lat;
+    last_lon = lon;
+}
+
+void BatchEncoder::add(const DetectionEvent& event) {
+    eventHeader(EVENT_DETECTION, event.unixMs);
+    varint(event.source);
+    // 同一批内帧序号相近，存与上一帧之差
+    zigzag(static_cast<int64_t>(event.sequence - last_sequence));
+    last_sequence = event.sequence;
+    data.push_back(event.positioned ? 1 : 0);
+    if (event.positioned) position(event.latitude, event.longitude);
+    varint(event.objects.size());
+    for (const auto& object : event.objects) {
+        varint(static_cast<uint64_t>(std::max(object.classId, 0)));
+        data.push_back(static_cast<uint8_t>(quantize(object.confidence, 255.0, 255)));
+        for (const float v : {object.x, object.y, object.width, object.height}) {
+            varint(quantize(v, BOX_SCALE, static_cast<uint64_t>(BOX_SCALE)));
+        }
+        const bool bearing = object.bearingDeg >= 0.0;
+        data.push_back(static_cast<uint8_t>((object.near ? 1 : 0) | (bearing ? 2 : 0)));
+        if (bearing) varint(quantize(object.bearingDeg, 10.0, 3600) % 3600);
+    }
+}
+
+void BatchEncoder::add(const AlertEvent& event) {
+    eventHeader(EVENT_ALERT, event.unixMs);
+    varint(event.track);
+    varint(static_cast<uint64_t>(std::max(event.classId, 0)));
+    data.push_back(event.level);
+    // 0 表示距离未知
+    varint(event.distance < 0.f ? 0 : quantize(event.distance, 100.0, UINT32_MAX) + 1);
+    zigzag(std::llround(event.bearing * 1000.0));
+}
+
+void BatchEncoder::add(const FixEvent& event) {
+    eventHeader(EVENT_FIX, event.unixMs);
+    position(event.latitude, event.longitude);
+    zigzag(std::llround(event.altitude * 10.0));
+    varint(quantize(event.speed, 100.0, UINT32_MAX));
+    varint(quantize(event.course, 100.0, 36000) % 36000);
+    varint(quantize(event.hdop, 10.0, UINT16_MAX));
+    data.push_back(static_cast<uint8_t>(std::clamp(event.quality, 0, 255)));
+    data.push_back(static_cast<uint8_t>(std::clamp(event.satellites, 0, 255)));
+}
+
+size_t BatchEncoder::sealedSize() const {
+    return data.size() + CRC_SIZE;
+}
+
+void BatchEncoder::rollback(const Mark& mark) {
+    data.resize(mark.size);
+    event_count = mark.count;
+    last_ms = mark.last_ms;
+    last_lat = mark.last_lat;
+    last_lon = mark.last_lon;
+    last_sequence = mark.last_sequence;
+}
+
+std::vector<uint8_t> BatchEncoder::finish() {
+    putU32(data, crc32(data.data(), data.size()));
+    return std::move(data);
+}
+
+bool NET::decodeBatch(const uint8_t* data, size_t size, TelemetryBatch& batch) {
+    if (size < HEADER_MIN + CRC_SIZE) return false;
+    const size_t body = size - CRC_SIZE;
+    Reader crc(data + body, CRC_SIZE);
+    if (crc.u32() != crc32(data, body)) return false;
+    if (std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0 || data[sizeof(MAGIC)] != BatchEncoder::VERSION) return false;
+
+    Reader in(data + sizeof(MAGIC) + 1, body - sizeof(MAGIC) - 1);
+    batch.device = in.u32();
+    batch.session = in.u32();
+    batch.sequence = in.varint();
+    batch.events.clear();
+    uint64_t ms = 0;
+    int64_t lat = 0, lon = 0;
+    uint64_t sequence = 0;
+    const auto position = [&](double& latitude, double& longitude) {
+        lat += in.zigzag();
+        lon += in.zigzag();
+        latitude = static_cast<double>(lat) / POSITION_SCALE;
+        longitude = static_cast<double>(lon) / POSITION_SCALE;
+    };
+    while (in.more()) {
+        const uint8_t type = in.u8();
+        ms += static_cast<uint64_t>(in.zigzag());
+        switch (type) {
+            case EVENT_DETECTION: {
+                DetectionEvent event;
+                event.unixMs = ms;
+                event.source = static_cast<uint16_t>(in.varint());
+                sequence += static_cast<uint64_t>(in.zigzag());
+                event.sequence = sequence;
+                event.positioned = in.u8() & 1;
+                if (event.positioned) position(event.latitude, event.longitude);
+                const uint64_t count = in.varint();
+                // 每个目标至少 7 字节，防止损坏的计数导致过量分配
+                if (count > body / 7) return false;
+                event.objects.resize(count);
+                for (auto& object : event.objects) {
+                    object.classId = static_cast<int>(in.varint());
+                    object.confidence = static_cast<float>(in.u8()) / 255.f;
+                    for (float* v : {&object.x, &object.y, &object.width, &object.height}) {
+                        *v = static_cast<float>(static_cast<double>(in.varint()) / BOX_SCALE);
+                    }
+                    const uint8_t flags = in.u8();
+                    object.near = flags & 1;
+                    if (flags & 2) object.bearingDeg = static_cast<double>(in.varint()) / 10.0;
+                }
+                batch.events.emplace_back(std::move(event));
+                break;
+            }
+            case EVENT_ALERT: {
+                AlertEvent event;
+                event.unixMs = ms;
+                event.track = static_cast<uint32_t>(in.varint());
+                event.classId = static_cast<int>(in.varint());
+                event.level = in.u8();
+                const uint64_t distance = in.varint();
+                event.distance = distance == 0 ? -1.f : static_cast<float>(distance - 1) / 100.f;
+                event.bearing = static_cast<float>(in.zigzag()) / 1000.f;
+                batch.events.emplace_back(event);
+                break;
+            }
+            case EVENT_FIX: {
+                FixEvent event;
+                event.unixMs = ms;
+                position(event.latitude, event.longitude);
+                event.altitude = static_cast<double>(in.zigzag()) / 10.0;
+                event.speed = static_cast<double>(in.varint()) / 100.0;
+                event.course = static_cast<double>(in.varint()) / 100.0;
+                event.hdop = static_cast<double>(in.varint()) / 10.0;
+                event.quality = in.u8();
+                event.satellites = in.u8();
+                batch.events.emplace_back(event);
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    return in.good();
+}
+
+std::vector<uint8_t> NET::encodeAck(const TelemetryBatch& batch) {
+    std::vector<uint8_t> data(std::begin(ACK_MAGIC), std::end(ACK_MAGIC));
+    data.push_back(BatchEncoder::VERSION);
+    putU32(data, batch.session);
+    putVarint(data, batch.sequence);
+    return data;
+}
+
+bool NET::decodeAck(const uint8_t* data, size_t size, uint32_t& session, uint64_t& sequence) {
+    if (size < sizeof(ACK_MAGIC) + 1 || std::memcmp(data, ACK_MAGIC, sizeof(ACK_MAGIC)) != 0
+        || data[sizeof(ACK_MAGIC)] != BatchEncoder::VERSION) return false;
+    Reader in(data + sizeof(ACK_MAGIC) + 1, size - sizeof(ACK_MAGIC) - 1);
+    session = in.u32();
+    sequence = in.varint();
+    return in.good() && !in.more();
+}
+
+TelemetryUplink::TelemetryUplink(TelemetryConfig config) :
+    config(std::move(config)), encoder(this->config.device, std::random_device{}()) {
+    std::vector<uint8_t> buffer;
+    buffer.reserve(this->config.batch_bytes + 256);
+    encoder.begin(std::move(buffer), next_sequence++);
+}
+
+TelemetryUplink::~TelemetryUplink() {
+    stop();
+}
+
+bool TelemetryUplink::start() {
+    if (!config.spool_dir.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(config.spool_dir, ec);
+        if (ec) {
+            std::cerr << "Failed to create telemetry spool " << config.spool_dir << ": " << ec.message() << std::endl;
+            return false;
+        }
+        loadSpool();
+    }
+    worker = std::thread(&TelemetryUplink::run, this);
+    return true;
+}
+
+void TelemetryUplink::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    cv.notify_all();
+    if (worker.joinable()) worker.join();
+}
+
+template <typename Event>
+void TelemetryUplink::append(const Event& event) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (stopping) return;
+    if (encoder.count() == 0) batch_started = Clock::now();
+    const BatchEncoder::Mark before = encoder.mark();
+    encoder.add(event);
+    if (encoder.sealedSize() > config.batch_bytes && encoder.count() > 1) {
+        // 加上该事件会超过批长度：先封存之前的事件，该事件作为下一批的第一个
+        encoder.rollback(before);
+        seal();
+        batch_started = Clock::now();
+        encoder.add(event);
+    }
+    counters.events++;
+    if (encoder.sealedSize() >= config.batch_bytes) {
+        seal();
+        cv.notify_one();
+    }
+    else if (encoder.count() == 1) {
+        // 上报线程据此设置封批期限
+        cv.notify_one();
+    }
+}
+
+void TelemetryUplink::submit(const DetectionEvent& event) { append(event); }
+void TelemetryUplink::submit(const AlertEvent& event) { append(event); }
+void TelemetryUplink::submit(const FixEvent& event) { append(event); }
+
+void TelemetryUplink::seal() {
+    if (encoder.count() == 0) return;
+    ready.push_back(encoder.finish());
+    counters.batches++;
+    std::vector<uint8_t> buffer;
+    if (!spare.empty()) {
+        buffer = std::move(spare.back());
+        spare.pop_back();
+    }
+    else {
+        buffer.reserve(config.batch_bytes + 256);
+    }
+    encoder.begin(std::move(buffer), next_sequence++);
+    // 上报线程卡在发送上时才会积压
+    while (ready.size() > config.queue_batches) {
+        ready.pop_front();
+        counters.dropped++;
+    }
+}
+
+void TelemetryUplink::recycle(std::vector<uint8_t> buffer) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (spare.size() < SPARE_BUFFERS) spare.push_back(std::move(buffer));
+}
+
+void TelemetryUplink::run() {
+    RT::ThreadScope scope("uplink");
+    std::deque<std::vector<uint8_t>> batches;
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+        // 有待补发的缓存时频繁醒来，逐步补发
+        const bool resending = fd >= 0 && !spooled.empty();
+        Clock::time_point wake = Clock::now() + (resending ? std::chrono::milliseconds(100) : config.retry_interval);
+        const bool pending = encoder.count() > 0;
+        if (pending) wake = std::min(wake, batch_started + config.batch_interval);
+        if (!inflight.empty()) wake = std::min(wake, inflight.front().sent + ACK_TIMEOUT);
+        cv.wait_until(lock, wake, [&] { return stopping || !ready.empty() || (!pending && encoder.count() > 0); });
+        if (encoder.count() > 0 && (stopping || Clock::now() >= batch_started + config.batch_interval)) {
+            seal();
+        }
+        batches.swap(ready);
+        const bool last = stopping;
+        lock.unlock();
+
+        for (auto& batch : batches) deliver(std::move(batch));
+        batches.clear();
+        readAcks();
+        if (!inflight.empty() && Clock::now() >= inflight.front().sent + ACK_TIMEOUT) {
+            linkDown("no ack for batch #" + std::to_string(inflight.front().sequence));
+        }
+        if (!spooled.empty() && (fd >= 0 || (Clock::now() >= next_retry && connect()))) {
+            // UDP 重连后先补发一批试探，收到确认后再加快
+            resend(link_confirmed ? RESEND_PER_WAKE : inflight.empty() ? 1 : 0);
+        }
+
+        lock.lock();
+        counters.connected = fd >= 0;
+        counters.pending_spool = spooled.size();
+        if (last) break;
+    }
+    lock.unlock();
+    // 停止前稍等已发出批的确认，仍未确认的写入缓存，下次启动时补发
+    const Clock::time_point until = Clock::now() + STOP_ACK_WAIT;
+    while (fd >= 0 && !inflight.empty()) {
+        const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(until - Clock::now());
+        if (remaining.count() <= 0) break;
+        pollfd pfd{fd, POLLIN, 0};
+        poll(&pfd, 1, static_cast<int>(remaining.count()));
+        readAcks();
+    }
+    for (const InFlight& unacked : inflight) spool(unacked.batch);
+    inflight.clear();
+    disconnect();
+    lock.lock();
+    counters.connected = false;
+    counters.pending_spool = spooled.size();
+}
+
+void TelemetryUplink::deliver(std::vector<uint8_t> batch) {
+    if (fd < 0 && Clock::now() >= next_retry) connect();
+    // 缓存未补发完时新批排在其后，后台按序收到
+    if (fd < 0 || !spooled.empty() || !send(batch)) {
+        spool(batch);
+    }
+    recycle(std::move(batch));
+}
+
+bool TelemetryUplink::connect() {
+    const bool tcp = config.transport == Transport::TCP;
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = tcp ? SOCK_STREAM : SOCK_DGRAM;
+    addrinfo* result = nullptr;
+    const std::string port = std::to_string(config.port);
+    if (getaddrinfo(config.host.c_str(), port.c_str(), &hints, &result) != 0) {
+        next_retry = Clock::now() + config.retry_interval;
+        return false;
+    }
+    for (addrinfo* ai = result; ai != nullptr && fd < 0; ai = ai->ai_next) {
+        const int s = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if (s < 0) continue;
+        bool ok;
+        if (tcp) {
+            // 带超时的非阻塞连接，之后恢复为阻塞并设置发送超时
+            const int flags = fcntl(s, F_GETFL, 0);
+            fcntl(s, F_SETFL, flags | O_NONBLOCK);
+            ok = ::connect(s, ai->ai_addr, ai->ai_addrlen) == 0;
+            if (!ok && errno == EINPROGRESS) {
+                pollfd pfd{s, POLLOUT, 0};
+                int error = 0;
+                socklen_t length = sizeof(error);
+                ok = poll(&pfd, 1, static_cast<int>(CONNECT_TIMEOUT.count())) == 1
+                     && getsockopt(s, SOL_SOCKET, SO_ERROR, &error, &length) == 0 && error == 0;
+            }
+            fcntl(s, F_SETFL, flags);
+            const timeval timeout{static_cast<time_t>(CONNECT_TIMEOUT.count() / 1000),
+                                  static_cast<suseconds_t>(CONNECT_TIMEOUT.count() % 1000 * 1000)};
+            setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        }
+        else {
+            // 连接后的 UDP 套接字能收到对端的 ICMP 拒绝，下一次发送时报错
+            ok = ::connect(s, ai->ai_addr, ai->ai_addrlen) == 0;
+        }
+        if (ok) {
+            fd = s;
+        }
+        else {
+            close(s);
+        }
+    }
+    freeaddrinfo(result);
+    if (fd < 0) {
+        next_retry = Clock::now() + config.retry_interval;
+        return false;
+    }
+    link_confirmed = tcp;
+    std::cout << "Telemetry link to " << config.host << ":" << config.port << " up." << std::endl;
+    std::lock_guard<std::mutex> lock(mtx);
+    counters.reconnects++;
+    return true;
+}
+
+void TelemetryUplink::disconnect() {
+    if (fd < 0) return;
+    close(fd);
+    fd = -1;
+    link_confirmed = false;
+}
+
+bool TelemetryUplink::send(const std::vector<uint8_t>& batch) {
+    std::string failure;
+    if (config.transport == Transport::TCP) {
+        const auto size = static_cast<uint32_t>(batch.size());
+        const uint8_t length[4] = {static_cast<uint8_t>(size >> 24), static_cast<uint8_t>(size >> 16),
+                                   static_cast<uint8_t>(size >> 8), static_cast<uint8_t>(size)};
+        for (const auto& [data, total] : {std::pair{length, sizeof(length)}, std::pair{batch.data(), batch.size()}}) {
+            size_t offset = 0;
+            while (failure.empty() && offset < total) {
+                const ssize_t n = ::send(fd, data + offset, total - offset, MSG_NOSIGNAL);
+                if (n < 0 && errno == EINTR) continue;
+                if (n > 0) {
+                    offset += static_cast<size_t>(n);
+                }
+                else {
+                    failure = n < 0 ? std::strerror(errno) : "connection closed";
+                }
+            }
+        }
+    }
+    else {
+        const ssize_t n = ::send(fd, batch.data(), batch.size(), MSG_NOSIGNAL);
+        if (n < 0) {
+            failure = std::strerror(errno);
+        }
+        else if (static_cast<size_t>(n) != batch.size()) {
+            // 数据报不会部分发送，出现时 errno 没有意义，只报告字节数
+            failure = "short send, " + std::to_string(n) + " of " + std::to_string(batch.size()) + " bytes";
+        }
+    }
+    if (!failure.empty()) {
+        linkDown(failure);
+        return false;
+    }
+    if (config.transport == Transport::UDP) {
+        InFlight sent{0, 0, batch, Clock::now()};
+        if (batchId(batch, sent.session, sent.sequence)) inflight.push_back(std::move(sent));
+    }
+    std::lock_guard<std::mutex> lock(mtx);
+    counters.sent++;
+    counters.sent_bytes += batch.size();
+    return true;
+}
+
+void TelemetryUplink::readAcks() {
+    uint8_t buffer[64];
+    while (fd >= 0 && config.transport == Transport::UDP) {
+        const ssize_t n = recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            // 连接后的 UDP 套接字收到 ICMP 端口不可达时报 ECONNREFUSED
+            if (errno != EAGAIN && errno != EWOULDBLOCK) linkDown(std::strerror(errno));
+            return;
+        }
+        uint32_t session;
+        uint64_t sequence;
+        if (!decodeAck(buffer, static_cast<size_t>(n), session, sequence)) continue;
+        const auto it = std::find_if(inflight.begin(), inflight.end(), [&](const InFlight& f) {
+            return f.session == session && f.sequence == sequence;
+        });
+        if (it == inflight.end()) continue;     // 重复的确认
+        inflight.erase(it);
+        link_confirmed = true;
+        std::lock_guard<std::mutex> lock(mtx);
+        counters.acked++;
+    }
+}
+
+void TelemetryUplink::linkDown(const std::string& reason) {
+    std::cerr << "Telemetry link to " << config.host << ":" << config.port << " down: " << reason << std::endl;
+    disconnect();
+    next_retry = Clock::now() + config.retry_interval;
+    for (const InFlight& unacked : inflight) spool(unacked.batch);
+    inflight.clear();
+}
+
+void TelemetryUplink::resend(size_t limit) {
+    std::vector<uint8_t> batch;
+    TelemetryBatch decoded;
+    for (size_t i = 0; i < limit && fd >= 0 && !spooled.empty(); i++) {
+        const Spooled& front = spooled.front();
+        std::ifstream file(front.path, std::ios::binary);
+        batch.resize(front.size);
+        const bool read = file && file.read(reinterpret_cast<char*>(batch.data()), static_cast<std::streamsize>(batch.size()));
+        file.close();
+        // 写到一半断电等原因损坏的文件直接丢弃
+        const bool valid = read && decodeBatch(batch.data(), batch.size(), decoded);
+        if (valid && !send(batch)) return;
+        std::error_code ec;
+        std::filesystem::remove(front.path, ec);
+        spool_total -= front.size;
+        spooled.pop_front();
+        std::lock_guard<std::mutex> lock(mtx);
+        (valid ? counters.resent : counters.dropped)++;
+    }
+}
+
+void TelemetryUplink::loadSpool() {
+    std::error_code ec;
+    std::vector<std::pair<uint64_t, Spooled>> found;
+    for (const auto& entry : std::filesystem::directory_iterator(config.spool_dir, ec)) {
+        const std::filesystem::path& path = entry.path();
+        if (path.extension() == ".tmp") {
+            std::filesystem::remove(path, ec);
+            continue;
+        }
+        const std::string stem = path.stem().string();
+        if (path.extension() != SPOOL_SUFFIX || stem.empty()
+            || !std::all_of(stem.begin(), stem.end(), [](char c) { return c >= '0' && c <= '9'; })) continue;
+        found.push_back({std::stoull(stem), {path, static_cast<uint64_t>(entry.file_size(ec))}});
+    }
+    std::sort(found.begin(), found.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (auto& [index, file] : found) {
+        spool_total += file.size;
+        spooled.push_back(std::move(file));
+        spool_index = index + 1;
+    }
+    if (!spooled.empty()) {
+        std::cout << "Telemetry spool: " << spooled.size() << " batches (" << spool_total << " bytes) from a previous run." << std::endl;
+    }
+    std::lock_guard<std::mutex> lock(mtx);
+    counters.pending_spool = spooled.size();
+}
+
+void TelemetryUplink::spool(const std::vector<uint8_t>& batch) {
+    if (config.spool_dir.empty() || batch.size() > config.spool_bytes) {
+        std::lock_guard<std::mutex> lock(mtx);
+        counters.dropped++;
+        return;
+    }
+    uint64_t evicted = 0;
+    std::error_code ec;
+    while (!spooled.empty() && spool_total + batch.size() > config.spool_bytes) {
+        std::filesystem::remove(spooled.front().path, ec);
+        spool_total -= spooled.front().size;
+        spooled.pop_front();
+        evicted++;
+    }
+    // 先写临时文件再改名，中途断电不会留下不完整的批
+    const std::filesystem::path path = std::filesystem::path(config.spool_dir) / spoolName(spool_index++);
+    std::filesystem::path temp = path;
+    temp += ".tmp";
+    std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(batch.data()), static_cast<std::streamsize>(batch.size()));
+    file.close();
+    const bool written = file.good();
+    if (written) std::filesystem::rename(temp, path, ec);
+    std::lock_guard<std::mutex> lock(mtx);
+    counters.dropped += evicted;
+    if (!written || ec) {
+        std::filesystem::remove(temp, ec);
+        counters.dropped++;
+        return;
+    }
+    spool_total += batch.size();
+    spooled.push_back({path, batch.size()});
+    counters.spooled++;
+}
+
+TelemetryStats TelemetryUplink::stats() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return counters;
+}
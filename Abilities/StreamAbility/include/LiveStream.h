@@ -2,7 +2,18 @@
 #define LIVESTREAM_H
 
 #include <string>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include <opencv2/opencv.hpp>
+#include "PacketQueue.h"
+#include "PacketSink.h"
+#include "Metadata.h"
+#include "RateControl.h"
 extern "C" {
 #include <libavformat/avformat.h>
 #include <libavcodec/avcodec.h>
@@ -12,22 +23,96 @@ extern "C" {
 }
 
 namespace LIVE {
+    using Clock = std::chrono::steady_clock;
+
+    struct AVFrameDeleter {
+        void operator()(AVFrame* frame) const { av_frame_free(&frame); }
+    };
+    // 引用计数的 AVFrame，多个编码器可共享同一份图像缓冲
+    using AVFramePtr = std::unique_ptr<AVFrame, AVFrameDeleter>;
+
+    // 推流运行状态，供监控与码率控制使用
+    struct StreamStats {
+        size_t queueDepth = 0;          // 待写出的包数
+        size_t queueCapacity = 0;
+        uint64_t framesPushed = 0;      // pushFrame 调用次数
+        uint64_t framesSkipped = 0;     // 编码线程来不及处理而被新帧覆盖的帧
+        uint64_t framesEncoded = 0;
+        uint64_t packetsWritten = 0;
+        uint64_t packetsDropped = 0;    // 队列满时按 GOP 丢弃的包
+        uint64_t gopsDropped = 0;
+        uint64_t bytesWritten = 0;
+        uint64_t writeErrors = 0;
+        double lastWriteMs = 0.0;       // 最近一次封装/网络写出耗时
+        double avgWriteMs = 0.0;        // 写出耗时的指数滑动平均
+        double maxWriteMs = 0.0;
+        uint64_t framesThrottled = 0;   // 为满足当前档位帧率而跳过的帧
+        uint64_t rateChanges = 0;       // 码率阶梯切换次数
+        uint64_t metadataSent = 0;      // 已写入码流的检测结果 SEI
+        uint64_t metadataDropped = 0;   // 积压过多被丢弃的检测结果
+        size_t rung = 0;                // 当前档位
+        int width = 0, height = 0, fps = 0;
+        int64_t bitrate = 0;
+        bool failed = false;            // 切换档位后编码器无法重建，编码线程已退出
+    };
+
     class Streamer {
     public:
         // 构造函数和析构函数
-        Streamer(const std::string& rtsp_url, int width, int height, int fps);
+        // format 为 FFmpeg 封装格式名，默认推 RTSP；基准测试可传 "null" 或 "mp4" 输出到空设备/文件
+        Streamer(const std::string& rtsp_url, int width, int height, int fps, const std::string& format = "rtsp",
+                 size_t queue_capacity = 120);
         ~Streamer();
+        Streamer(const Streamer&) = delete;
+        Streamer& operator=(const Streamer&) = delete;
+
+        // 设置码率（bit/s），需在 init 之前调用；启用码率控制时以阶梯档位为准
+        void setBitrate(int64_t bitrate);
+
+        // 启用拥塞自适应码率/分辨率控制，需在 init 之前调用；启用后以阶梯第一档为初始参数
+        void setRateControl(const RateControlConfig& config);
+
+        // 任意线程调用：限制码率阶梯的最高可用档，在下一个采样周期生效。未启用码率控制时无效
+        void limitRung(size_t top) { rung_limit.store(top, std::memory_order_relaxed); }
+
+        // 添加推流以外的输出（分段录像、事件缓存等），需在 init 之前调用。
+        // 编码只进行一次，同一份包同时送往推流与所有输出
+        void addSink(std::shared_ptr<PacketSink> sink);
 
-        // 初始化推流器
+        // 初始化推流器，成功后启动编码线程与封装线程
         bool init();
 
-        // 推送帧数据
-        void pushFrame(const cv::Mat& frame);
+        // 推送帧数据：只登记待编码帧并立即返回，转换与编码在编码线程、写出在封装线程完成。
+        // 编码线程忙时新帧覆盖未处理的旧帧，推流端网络阻塞不会反压到调用者。
+        // frame 在编码完成前不得被改写（采集每帧使用新的 cv::Mat 即可满足）。
+        void pushFrame(const cv::Mat& frame, Clock::time_point timestamp = Clock::now());
+        // 推送 frame 中的 roi 区域（任意尺寸），裁剪、缩放与 BGR->YUV420P 在一次 sws_scale 中完成
+        void pushFrame(const cv::Mat& frame, const cv::Rect& roi, Clock::time_point timestamp = Clock::now());
+        // 推送已转换好的 YUV420P 帧（联播时由上一级降采样链产生）。
+        // 尺寸与编码器一致时直接送编码器，不做任何拷贝；否则在编码线程中缩放。
+        // 调用者须先经 admitFrame 按帧率抽帧，这里不再抽帧
+        void pushFrame(AVFramePtr yuv, Clock::time_point timestamp);
+        // 按当前档位帧率决定是否送采集时刻为 timestamp 的帧，不送时计入 framesThrottled。
+        // 推送 cv::Mat 的 pushFrame 内部调用；联播在转换前调用，不需要的帧不做转换
+        bool admitFrame(Clock::time_point timestamp);
+
+        // 登记采集时刻为 timestamp 的画面的检测结果，在下一个编码帧中以 SEI 发出。
+        // SEI 中带有所描述画面的 pts，检测晚于编码完成时观看端仍可按 pts 对齐
+        void attachMetadata(Clock::time_point timestamp, uint32_t sequence, const std::vector<Detection>& detections);
+
+        // 同步执行的两个阶段：像素格式转换、编码并送入写出队列，便于基准测试单独计时
+        bool convertFrame(const cv::Mat& frame);
+        bool convertFrame(const cv::Mat& frame, const cv::Rect& roi);
+        void encodeFrame();
+
+        [[nodiscard]] StreamStats stats() const;
 
     private:
         // 私有成员变量
-        std::string rtsp_url;    // RTSP 地址
-        int width, height, fps;  // 视频参数
+        std::string rtsp_url;    // RTSP 地址（或输出文件路径）
+        std::string format;      // 封装格式
+        int width, height, fps;  // 视频参数（自适应模式下随档位变化，仅编码线程修改）
+        int64_t bitrate = 500 * 1000;
 
         SwsContext* sws_context;         // 像素格式转换上下文
         AVCodecContext* codec_context;   // 编码器上下文
@@ -35,6 +120,62 @@ namespace LIVE {
         AVFormatContext* output_context; // 输出上下文
         AVStream* video_stream;          // 视频流
 
+        // 编码线程的输入：只保留最新一帧
+        struct PendingFrame {
+            cv::Mat image;
+            cv::Rect roi;
+            AVFramePtr yuv;              // 非空时使用已转换的帧
+            Clock::time_point timestamp;
+        };
+        PendingFrame pending;
+        bool has_pending = false;
+        bool stopping = false;
+        std::mutex pending_mutex;
+        std::condition_variable pending_cv;
+
+        std::mutex encode_mutex;         // 保护 sws_context / codec_context / av_frame
+        PacketQueue packet_queue;
+        std::thread encode_thread, mux_thread;
+        bool header_written = false;
+        Clock::time_point start_time;
+        int64_t last_pts = -1;
+
+        std::vector<std::shared_ptr<PacketSink>> sinks;
+        StreamFormatPtr stream_format;   // 当前编码参数，随编码器重建更新
+        std::mutex format_mutex;
+        StreamFormatPtr mux_format;      // 编码器重建后待封装线程写入 video_stream 的参数
+        std::atomic<bool> format_changed{false};
+
+        std::mutex metadata_mutex;
+        // 前 metadata_count 条按 pts 递增，其后为空槽；槽位与其中的 detections 复用，稳定运行时不再分配
+        std::vector<FrameMetadata> pending_metadata;
+        size_t metadata_count = 0;
+        std::vector<uint8_t> sei_buffer;               // 仅编码线程使用
+
+        RateController rate_controller;
+        std::atomic<size_t> rung_limit{0};
+        Clock::time_point last_rate_sample;
+        Clock::time_point last_admitted;    // 上次按帧率放行的采集时间，受 pending_mutex 保护
+        bool force_keyframe = false;
+
+        mutable std::mutex stats_mutex;
+        StreamStats statistics;
+
+        bool admitLocked(Clock::time_point timestamp);
+        bool openEncoder();
+        void closeEncoder();
+        // previous 为切换前的档位，新档的编码器打不开时退回该档
+        void applyRung(size_t previous);
+        bool convertLocked(const cv::Mat& frame, const cv::Rect& roi);
+        bool scaleLocked(const uint8_t* const src_data[], const int src_linesize[], int src_width, int src_height,
+                         AVPixelFormat src_format);
+        void encodeLocked(AVFrame* frame);
+        int64_t ptsFor(Clock::time_point timestamp);
+        [[nodiscard]] int64_t timestampToPts(Clock::time_point timestamp) const;
+        void takeMetadata(int64_t pts);
+        void encodeLoop();
+        void muxLoop();
+        void stop();
         // 释放资源
         void releaseResources();
     };
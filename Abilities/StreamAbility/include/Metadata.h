@@ -0,0 +1,46 @@
+#ifndef METADATA_H
+#define METADATA_H
+
+#include <cstdint>
+#include <vector>
+#include <opencv2/opencv.hpp>
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+namespace LIVE {
+    // 单个检测结果。坐标归一化到检测所用图像的 [0,1]，与推流分辨率（随码率档位变化）无关
+    struct Detection {
+        int classId = 0;
+        float confidence = 0.f;
+        cv::Rect2f box;
+        float distance = -1.f;   // 米，未知时为负
+    };
+
+    // 一帧的检测结果，以 H.264 SEI（user data unregistered）随视频发送，
+    // 观看端按 pts 与画面对齐后自行绘制，设备端不必把框画进像素。
+    // SEI 中存放的是所描述画面相对所在包 pts 的偏移，与输出的时间轴无关：
+    // RTSP 重新映射时间戳、录像从第一个包归零后，按所在包的 pts 加上偏移仍能找到对应画面
+    struct FrameMetadata {
+        uint32_t sequence = 0;   // 采集帧序号
+        // 所描述画面的 pts。生成时为编码器时间基（90 kHz）；parseSei 解析出的已换算到所在流的时间基
+        int64_t pts = 0;
+        std::vector<Detection> detections;
+    };
+
+    // SEI 负载开头的 UUID，用于区分其他 user data
+    extern const uint8_t METADATA_UUID[16];
+
+    // 生成完整的 SEI NAL（Annex B 起始码 + 防竞争字节），追加到 nal 末尾
+    void buildSeiNal(const FrameMetadata& meta, std::vector<uint8_t>& nal);
+    // 把 nal 插入到 Annex B 包 pkt 的第一个 VCL NAL 之前，结果写入 out（时间戳等属性随之复制）。
+    // 其中的 pts 改写为相对 pkt->pts 的偏移，time_base 为 pkt 的时间基
+    bool insertSei(const AVPacket* pkt, AVRational time_base, const std::vector<uint8_t>& nal, AVPacket* out);
+    // 解析包中所有本程序写入的 SEI，追加到 out，返回解析出的条数。
+    // length_size 为 0 表示 Annex B（RTSP/裸流），否则为 AVCC 长度字段字节数（MP4）；
+    // packet_pts 与 time_base 为所在包的 pts 与所在流的时间基，解析出的 pts 与之在同一时间轴上
+    size_t parseSei(const uint8_t* data, size_t size, int length_size, int64_t packet_pts, AVRational time_base,
+                    std::vector<FrameMetadata>& out);
+}
+
+#endif //METADATA_H
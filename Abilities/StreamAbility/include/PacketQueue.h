@@ -0,0 +1,64 @@
+#ifndef PACKETQUEUE_H
+#define PACKETQUEUE_H
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+namespace LIVE {
+    // 编码器与封装/网络线程之间的有界包队列。
+    // 队列满时按整个 GOP 丢弃：优先丢掉最旧的完整 GOP；若队列里只有一个未完成的 GOP，
+    // 则全部丢弃并拒收后续包直到下一个关键帧，同时请求编码器尽快插入关键帧。
+    // 这样出队的包总能从关键帧开始解码。
+    // 队列槽位与空闲的 AVPacket 结构体都预先分配并循环使用，入队出队本身不再分配内存
+    // （包的负载仍由编码器按引用计数分配）。
+    class PacketQueue {
+    public:
+        explicit PacketQueue(size_t capacity);
+        ~PacketQueue();
+        PacketQueue(const PacketQueue&) = delete;
+        PacketQueue& operator=(const PacketQueue&) = delete;
+
+        // 取一个空的包用于接收编码输出，用完后入队或交还 recycle
+        AVPacket* acquire();
+        // 清除包的内容（释放负载的引用）并放回空闲包
+        void recycle(AVPacket* pkt);
+
+        // 入队并接管 pkt 的所有权；被丢弃时回收 pkt 并返回 false
+        bool push(AVPacket* pkt);
+        // 阻塞出队，调用者用完后交还 recycle；队列关闭且为空时返回 nullptr
+        AVPacket* pop();
+        // 关闭队列，唤醒等待的出队线程；已入队的包仍可取出
+        void close();
+
+        [[nodiscard]] size_t size() const;
+        [[nodiscard]] size_t capacity() const { return max_size; }
+        [[nodiscard]] uint64_t droppedPackets() const;
+        [[nodiscard]] uint64_t droppedGops() const;
+        // 取出并清除"需要关键帧"请求
+        bool takeKeyframeRequest();
+
+    private:
+        void dropFront(size_t n);
+        void recycleLocked(AVPacket* pkt);
+        [[nodiscard]] AVPacket* at(size_t index) const { return slots[(head + index) % max_size]; }
+
+        const size_t max_size;
+        std::vector<AVPacket*> slots;     // 环形，前 count 个从 head 开始
+        size_t head = 0;
+        size_t count = 0;
+        std::vector<AVPacket*> free_packets;
+        mutable std::mutex mtx;
+        std::condition_variable condition_v;
+        bool closed = false;
+        bool wait_keyframe = false;       // 丢弃后等待下一个关键帧
+        bool keyframe_requested = false;
+        uint64_t dropped_packets = 0;
+        uint64_t dropped_gops = 0;
+    };
+}
+
+#endif //PACKETQUEUE_H
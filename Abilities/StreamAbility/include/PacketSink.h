@@ -0,0 +1,36 @@
+#ifndef PACKETSINK_H
+#define PACKETSINK_H
+
+#include <memory>
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+namespace LIVE {
+    // 编码参数（分辨率、SPS/PPS 等）。编码器每次（重新）打开生成一份，之后的包共享同一份，
+    // 接收端比较指针即可发现参数变化
+    struct StreamFormat {
+        AVCodecParameters* codecpar = nullptr;
+        AVRational timeBase{1, 90000};    // 包时间戳的时间基
+
+        StreamFormat() : codecpar(avcodec_parameters_alloc()) {}
+        ~StreamFormat() { avcodec_parameters_free(&codecpar); }
+        StreamFormat(const StreamFormat&) = delete;
+        StreamFormat& operator=(const StreamFormat&) = delete;
+    };
+    using StreamFormatPtr = std::shared_ptr<const StreamFormat>;
+
+    // 编码输出的接收端：一次编码，分发给推流以外的多个去处（分段录像、事件缓存等）
+    class PacketSink {
+    public:
+        virtual ~PacketSink() = default;
+
+        // 编码线程中对每个输出包调用一次，实现不得阻塞。
+        // pkt 仍归调用者所有，需要保留时用 av_packet_clone（只增加引用计数，不拷贝数据）
+        virtual void write(const AVPacket* pkt, const StreamFormatPtr& format) = 0;
+        // 推流结束：写完缓存的数据并关闭文件
+        virtual void close() = 0;
+    };
+}
+
+#endif //PACKETSINK_H
@@ -0,0 +1,65 @@
+#ifndef RATECONTROL_H
+#define RATECONTROL_H
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace LIVE {
+    struct StreamStats;
+
+    // 码率阶梯中的一档
+    struct RateRung {
+        int width;
+        int height;
+        int fps;
+        int64_t bitrate;   // bit/s
+    };
+
+    struct RateControlConfig {
+        std::vector<RateRung> ladder;          // 从高到低排列，为空时不做自适应
+        std::chrono::milliseconds interval{500};  // 采样周期
+        double congestedWriteMs = 80.0;        // 平均写出耗时超过该值视为拥塞
+        double congestedQueueRatio = 0.5;      // 包队列占用超过容量的该比例视为拥塞
+        size_t congestedQueueGrowth = 8;       // 单个周期内包队列增长超过该值视为拥塞
+        int downAfter = 2;                     // 连续拥塞周期数达到后降一档
+        int upAfter = 10;                      // 连续健康周期数达到后升一档
+        int maxUpAfter = 120;                  // 升档后很快又拥塞时，升档等待按倍数退避的上限
+    };
+
+    // 拥塞自适应控制：根据封装写出耗时与包队列增长在码率阶梯上升降档。
+    // 降档快、升档慢，升档失败后加倍升档等待，避免在两档之间来回振荡。
+    class RateController {
+    public:
+        explicit RateController(const RateControlConfig& config, size_t start_rung = 0);
+
+        // 输入一次采样，返回采样后的档位
+        size_t update(const StreamStats& stats);
+        // 限制可用的最高档（下标越小档位越高），当前档高于它时立即降到该档；拥塞控制只在其下方升降
+        void setTopRung(size_t top);
+        // 编码器无法按该档打开（如硬件不支持的分辨率）：之后升降档都跳过它，当前档退回 fallback
+        void markUnusable(size_t index, size_t fallback);
+
+        [[nodiscard]] bool enabled() const { return !config.ladder.empty(); }
+        [[nodiscard]] size_t current() const { return rung; }
+        [[nodiscard]] const RateRung& currentRung() const { return config.ladder[rung]; }
+        [[nodiscard]] std::chrono::milliseconds interval() const { return config.interval; }
+
+    private:
+        // index 及其下方第一个可用的档，没有时返回 index
+        [[nodiscard]] size_t usableFrom(size_t index) const;
+
+        RateControlConfig config;
+        std::vector<bool> unusable;
+        size_t rung;
+        size_t top_rung = 0;
+        int congested_count = 0;
+        int healthy_count = 0;
+        int up_after;
+        int samples_since_up = -1;      // 上次升档后的周期数，-1 表示未升过档
+        size_t last_depth = 0;
+        uint64_t last_gops_dropped = 0;
+    };
+}
+
+#endif //RATECONTROL_H
@@ -0,0 +1,146 @@
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "PacketSink.h"
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+namespace LIVE {
+    // 录像缓存中的 AVPacket 结构体：用完放回空闲列表，稳定运行时不再逐包分配（负载只增加引用计数）。
+    // 空闲列表不设上限，其大小等于缓存中同时存在的包数的峰值
+    class PacketPool {
+    public:
+        PacketPool() = default;
+        ~PacketPool();
+        PacketPool(const PacketPool&) = delete;
+        PacketPool& operator=(const PacketPool&) = delete;
+
+        // 取一个空的包并引用 src 的负载，失败时返回 nullptr
+        AVPacket* ref(const AVPacket* src);
+        // 释放负载的引用并放回空闲列表，pkt 置空
+        void recycle(AVPacket*& pkt);
+
+    private:
+        std::mutex mtx;
+        std::vector<AVPacket*> free_packets;
+    };
+
+    // 把编码好的 H.264 包直接封装为 MP4（不重新编码）。
+    // 使用分片 MP4：断电或进程异常退出时已写入的部分仍可播放
+    class Mp4Writer {
+    public:
+        Mp4Writer();
+        ~Mp4Writer();
+        Mp4Writer(const Mp4Writer&) = delete;
+        Mp4Writer& operator=(const Mp4Writer&) = delete;
+
+        bool open(const std::string& path, const StreamFormatPtr& format);
+        // 时间戳从文件第一个包开始归零
+        bool write(const AVPacket* pkt);
+        void close();
+
+        [[nodiscard]] bool isOpen() const { return output_context != nullptr; }
+        [[nodiscard]] const StreamFormatPtr& format() const { return stream_format; }
+
+    private:
+        AVFormatContext* output_context = nullptr;
+        AVStream* video_stream = nullptr;
+        AVPacket* scratch;
+        StreamFormatPtr stream_format;
+        int64_t start_dts = AV_NOPTS_VALUE;
+    };
+
+    // 滚动分段录像：每段固定时长，从关键帧切分。
+    // 写盘在独立线程中进行，磁盘卡顿时队列满后丢包直到下一个关键帧，不会阻塞编码
+    class SegmentRecorder : public PacketSink {
+    public:
+        explicit SegmentRecorder(const std::filesystem::path& folder,
+                                 std::chrono::seconds segment_length = std::chrono::seconds(60),
+                                 size_t queue_capacity = 300);
+        ~SegmentRecorder() override;
+
+        // 创建目录并启动写盘线程
+        bool start();
+        void write(const AVPacket* pkt, const StreamFormatPtr& format) override;
+        void close() override;
+
+        [[nodiscard]] uint64_t droppedPackets() const;
+
+    private:
+        struct Item {
+            AVPacket* packet;
+            StreamFormatPtr format;
+        };
+
+        void writerLoop();
+
+        std::filesystem::path folder;
+        std::chrono::microseconds segment_length;
+        size_t capacity;
+
+        PacketPool packets;
+        std::deque<Item> queue;
+        mutable std::mutex mtx;
+        std::condition_variable condition_v;
+        bool closed = false;
+        bool wait_keyframe = true;      // 开始时与丢包后都从关键帧恢复
+        uint64_t dropped_packets = 0;
+        std::thread writer_thread;
+    };
+
+    // 事件前缓存：内存中保留最近 pre_event 秒的包（只增加引用计数），
+    // 事件触发时把缓存连同之后 post_event 秒的包写入一个文件
+    class EventRing : public PacketSink {
+    public:
+        explicit EventRing(const std::filesystem::path& folder,
+                           std::chrono::seconds pre_event = std::chrono::seconds(10),
+                           std::chrono::seconds post_event = std::chrono::seconds(5));
+        ~EventRing() override;
+
+        // 创建目录并启动写盘线程
+        bool start();
+        // 触发事件，可在任意线程调用；上一个事件的录制尚未结束时只延长其结束时间
+        void trigger(const std::string& tag);
+        void write(const AVPacket* pkt, const StreamFormatPtr& format) override;
+        void close() override;
+
+    private:
+        struct Item {
+            AVPacket* packet;
+            StreamFormatPtr format;
+        };
+        struct Event {
+            std::string path;
+            std::deque<Item> items;     // 待写入的包
+            int64_t endTime;            // 微秒，与包时间戳同一时间轴
+            bool complete = false;
+        };
+
+        static int64_t micros(const Item& item);
+        void trim();
+        void flushLoop();
+
+        std::filesystem::path folder;
+        int64_t pre_event, post_event;  // 微秒
+
+        PacketPool packets;
+        std::deque<Item> ring;
+        std::deque<Event> events;       // 队首正在写盘，队尾可能仍在录制
+        int64_t newest = 0;
+        std::mutex mtx;
+        std::condition_variable condition_v;
+        bool closed = false;
+        std::thread flush_thread;
+    };
+}
+
+#endif //RECORDER_H
@@ -0,0 +1,85 @@
+#ifndef SIMULCAST_H
+#define SIMULCAST_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "LiveStream.h"
+
+namespace LIVE {
+    // 联播中的一路输出
+    struct Rendition {
+        std::string url;        // 各路使用独立的 RTSP 路径
+        int width;
+        int height;
+        int fps;
+        int64_t bitrate;        // bit/s
+    };
+
+    struct RenditionStats {
+        std::string url;
+        StreamStats stats;
+    };
+
+    // 同一采集源同时输出多路分辨率/帧率不同的流，每路有自己的 Streamer（编码线程与封装线程）。
+    // 色彩转换只做一次：源图 BGR 区域先转换为最高一路的 YUV420P，之后每一路由上一路的 YUV 缩小得到，
+    // 转换结果以引用计数的 AVFrame 交给各路编码器，尺寸一致时不再拷贝
+    class Simulcast {
+    public:
+        // renditions 按分辨率从高到低排序后使用
+        explicit Simulcast(std::vector<Rendition> renditions, const std::string& format = "rtsp",
+                           size_t queue_capacity = 120);
+        ~Simulcast();
+        Simulcast(const Simulcast&) = delete;
+        Simulcast& operator=(const Simulcast&) = delete;
+
+        // 第 index 路推流器，可在 init 之前添加输出或启用码率控制
+        Streamer& rendition(size_t index) { return *streamers[index]; }
+        [[nodiscard]] size_t size() const { return streamers.size(); }
+
+        // 初始化各路推流器并启动转换线程
+        bool init();
+
+        // 登记待推送的帧并立即返回；转换线程忙时新帧覆盖旧帧
+        void pushFrame(const cv::Mat& frame, const cv::Rect& roi, Clock::time_point timestamp = Clock::now());
+        // 检测结果发给每一路
+        void attachMetadata(Clock::time_point timestamp, uint32_t sequence, const std::vector<Detection>& detections);
+
+        [[nodiscard]] std::vector<RenditionStats> stats() const;
+        // 转换线程来不及处理而被覆盖的帧
+        [[nodiscard]] uint64_t framesSkipped() const;
+        // 共享帧引用分配失败而没有送出的帧（按路累计）
+        [[nodiscard]] uint64_t framesDropped() const;
+
+    private:
+        void convertLoop();
+        void convert(const cv::Mat& image, const cv::Rect& roi, Clock::time_point timestamp);
+        // 第 index 路当前可写的帧；都还被编码线程引用时重新分配其中一帧的缓冲
+        AVFrame* writableFrame(size_t index);
+        void stop();
+
+        // 每路轮换的帧数：编码线程最多同时持有待编码与正在编码的两帧
+        static constexpr size_t FRAME_SLOTS = 3;
+
+        std::vector<Rendition> renditions;
+        std::vector<std::unique_ptr<Streamer>> streamers;
+        std::vector<SwsContext*> sws_contexts;          // [0]: BGR 区域 -> 第 0 路；[i]: 第 i-1 路 -> 第 i 路
+        std::vector<uint8_t> due, needed;               // 转换线程复用的本帧各路标记
+        std::vector<AVFramePtr> frames;                 // 第 i 路使用 [i * FRAME_SLOTS, (i + 1) * FRAME_SLOTS)
+        std::vector<size_t> next_slot;                  // 各路都不可写时下一个重新分配的帧
+
+        cv::Mat pending_image;
+        cv::Rect pending_roi;
+        Clock::time_point pending_timestamp;
+        bool has_pending = false;
+        bool stopping = false;
+        uint64_t frames_skipped = 0;
+        uint64_t frames_dropped = 0;
+        mutable std::mutex pending_mutex;
+        std::condition_variable pending_cv;
+        std::thread convert_thread;
+    };
+}
+
+#endif //SIMULCAST_H
@@ -1,13 +1,22 @@
 #include "LiveStream.h"
+#include "Runtime.h"
+#include <algorithm>
 #include <iostream>
+#include <iterator>
 #include <thread>
+#include <utility>
 
 namespace LIVE {
 
-Streamer::Streamer(const std::string& rtsp_url, int width, int height, int fps)
-    : rtsp_url(rtsp_url), width(width), height(height), fps(fps),
+static constexpr AVRational ENCODER_TIME_BASE = {1, 90000};  // 以采集时间戳生成 pts
+static constexpr size_t MAX_PENDING_METADATA = 32;
+
+Streamer::Streamer(const std::string& rtsp_url, int width, int height, int fps, const std::string& format,
+                   size_t queue_capacity)
+    : rtsp_url(rtsp_url), format(format), width(width), height(height), fps(fps),
       sws_context(nullptr), codec_context(nullptr), av_frame(nullptr),
-      output_context(nullptr) {}
+      output_context(nullptr), video_stream(nullptr), packet_queue(queue_capacity),
+      rate_controller(RateControlConfig()) {}
 
 Streamer::~Streamer() {
     releaseResources();
@@ -18,7 +27,7 @@ bool Streamer::init() {
     avformat_network_init();
 
     // 创建输出上下文
-    if (avformat_alloc_output_context2(&output_context, nullptr, "rtsp", rtsp_url.c_str()) < 0) {
+    if (avformat_alloc_output_context2(&output_context, nullptr, format.c_str(), rtsp_url.c_str()) < 0) {
         std::cerr << "无法创建输出上下文！" << std::endl;
         return false;
     }
@@ -31,6 +40,49 @@ bool Streamer::init() {
     }
 
     // 设置编码器
+    if (rate_controller.enabled()) {
+        // 自适应模式从阶梯第一档开始
+        const RateRung& rung = rate_controller.currentRung();
+        width = rung.width;
+        height = rung.height;
+        fps = rung.fps;
+        bitrate = rung.bitrate;
+    }
+    if (!openEncoder()) {
+        return false;
+    }
+
+    avcodec_parameters_from_context(video_stream->codecpar, codec_context);
+
+    if (!(output_context->oformat->flags & AVFMT_NOFILE)) {
+        if (avio_open(&output_context->pb, rtsp_url.c_str(), AVIO_FLAG_WRITE) < 0) {
+            std::cerr << "无法打开 RTSP 地址！" << std::endl;
+            return false;
+        }
+    }
+
+    if (avformat_write_header(output_context, nullptr) < 0) {
+        std::cerr << "无法写入头信息！" << std::endl;
+        return false;
+    }
+    header_written = true;
+
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        statistics.width = width;
+        statistics.height = height;
+        statistics.fps = fps;
+        statistics.bitrate = bitrate;
+    }
+
+    // 编码与写出各用一个线程，网络写出阻塞只会让包队列增长，不会阻塞调用者
+    start_time = Clock::now();
+    encode_thread = std::thread(&Streamer::encodeLoop, this);
+    mux_thread = std::thread(&Streamer::muxLoop, this);
+    return true;
+}
+
+bool Streamer::openEncoder() {
     const AVCodec* codec = avcodec_find_encoder(AV_CODEC_ID_H264);
     if (!codec) {
         std::cerr << "无法找到编码器！" << std::endl;
@@ -40,111 +92,464 @@ bool Streamer::init() {
     codec_context = avcodec_alloc_context3(codec);
     codec_context->width = width;
     codec_context->height = height;
-    codec_context->time_base = {1, fps};
+    codec_context->time_base = ENCODER_TIME_BASE;
     codec_context->framerate = {fps, 1};
     codec_context->pix_fmt = AV_PIX_FMT_YUV420P;
-    codec_context->bit_rate = 500 * 1000;
+    codec_context->bit_rate = bitrate;
     codec_context->gop_size = 25;
     codec_context->max_b_frames = 1;
-    codec_context->thread_count = std::thread::hardware_concurrency();
+    const int encoder_threads = RT::config().encoderThreads;
+    codec_context->thread_count = encoder_threads > 0 ? encoder_threads : static_cast<int>(std::thread::hardware_concurrency());
     codec_context->thread_type = FF_THREAD_SLICE;
 
-    if (output_context->oformat->flags & AVFMT_GLOBALHEADER) {
+    // MP4 录像需要 extradata 中的 SPS/PPS
+    if ((output_context->oformat->flags & AVFMT_GLOBALHEADER) || !sinks.empty()) {
         codec_context->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
     }
 
     av_opt_set(codec_context->priv_data, "preset", "fast", 0);
     av_opt_set(codec_context->priv_data, "tune", "zerolatency", 0);
     av_opt_set(codec_context->priv_data, "profile", "baseline", 0);
+    av_opt_set(codec_context->priv_data, "forced-idr", "1", 0);  // 丢 GOP 后请求的关键帧为 IDR
+    // 每个关键帧前都带 SPS/PPS：切换分辨率后、客户端中途加入时都能直接解码
+    av_opt_set(codec_context->priv_data, "x264-params", "repeat-headers=1", 0);
 
-    if (avcodec_open2(codec_context, codec, nullptr) < 0) {
-        std::cerr << "无法打开编码器！" << std::endl;
-        return false;
-    }
-
-    avcodec_parameters_from_context(video_stream->codecpar, codec_context);
-
-    if (!(output_context->oformat->flags & AVFMT_NOFILE)) {
-        if (avio_open(&output_context->pb, rtsp_url.c_str(), AVIO_FLAG_WRITE) < 0) {
-            std::cerr << "无法打开 RTSP 地址！" << std::endl;
-            return false;
-        }
+    // 编码器的内部线程在 avcodec_open2 中创建并继承当前线程的亲和性
+    bool opened;
+    {
+        RT::ScopedAffinity affinity(RT::config().encoderCpus);
+        opened = avcodec_open2(codec_context, codec, nullptr) >= 0;
     }
-
-    if (avformat_write_header(output_context, nullptr) < 0) {
-        std::cerr << "无法写入头信息！" << std::endl;
+    if (!opened) {
+        std::cerr << "无法打开编码器！" << std::endl;
+        avcodec_free_context(&codec_context);
         return false;
     }
 
-    // 初始化像素格式转换上下文
-    sws_context = sws_getContext(
-        width, height, AV_PIX_FMT_BGR24,
-        width, height, AV_PIX_FMT_YUV420P,
-        SWS_BILINEAR, nullptr, nullptr, nullptr
-    );
+    auto format = std::make_shared<StreamFormat>();
+    avcodec_parameters_from_context(format->codecpar, codec_context);
+    format->timeBase = codec_context->time_base;
+    stream_format = format;
 
+    // 像素格式转换上下文按输入区域尺寸在 convertFrame 中按需创建
     // 初始化帧
     av_frame = av_frame_alloc();
     av_frame->format = AV_PIX_FMT_YUV420P;
     av_frame->width = width;
     av_frame->height = height;
     av_image_alloc(av_frame->data, av_frame->linesize, width, height, AV_PIX_FMT_YUV420P, 32);
+    return true;
+}
 
+void Streamer::closeEncoder() {
+    if (av_frame) {
+        av_freep(&av_frame->data[0]);   // av_image_alloc 分配的图像缓冲
+        av_frame_free(&av_frame);
+    }
+    if (codec_context) avcodec_free_context(&codec_context);
+}
+
+void Streamer::addSink(std::shared_ptr<PacketSink> sink) {
+    sinks.push_back(std::move(sink));
+}
+
+void Streamer::setBitrate(int64_t bitrate) {
+    this->bitrate = bitrate;
+}
+
+void Streamer::setRateControl(const RateControlConfig& config) {
+    rate_controller = RateController(config);
+}
+
+void Streamer::applyRung(size_t previous) {
+    const RateRung& rung = rate_controller.currentRung();
+    if (rung.width != width || rung.height != height) {
+        // 分辨率变化需要重建编码器：先冲刷旧编码器，新编码器的第一帧即为 IDR
+        encodeLocked(nullptr);
+        closeEncoder();
+        const int old_width = width, old_height = height, old_fps = fps;
+        const int64_t old_bitrate = bitrate;
+        width = rung.width;
+        height = rung.height;
+        fps = rung.fps;
+        bitrate = rung.bitrate;
+        if (!openEncoder()) {
+            // 该档不可用：之后不再切换到它，按原参数重建编码器
+            std::cerr << "切换到 " << width << "x" << height << " 失败，恢复原分辨率" << std::endl;
+            rate_controller.markUnusable(rate_controller.current(), previous);
+            width = old_width;
+            height = old_height;
+            fps = old_fps;
+            bitrate = old_bitrate;
+            if (!openEncoder()) {
+                std::cerr << "无法恢复编码器，推流停止！" << std::endl;
+                std::lock_guard<std::mutex> lock(stats_mutex);
+                statistics.failed = true;
+                return;
+            }
+        }
+        force_keyframe = true;
+        {
+            std::lock_guard<std::mutex> lock(format_mutex);
+            mux_format = stream_format;
+        }
+        format_changed.store(true, std::memory_order_release);
+    }
+    else if (rung.bitrate != bitrate) {
+        // 码率可在线调整（libx264 在下一帧重新配置）
+        bitrate = rung.bitrate;
+        codec_context->bit_rate = bitrate;
+    }
+    fps = rate_controller.currentRung().fps;    // 切换失败时已退回原档
+
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    statistics.width = width;
+    statistics.height = height;
+    statistics.fps = fps;
+    statistics.bitrate = bitrate;
+    statistics.rung = rate_controller.current();
+    statistics.rateChanges++;
+}
+
+void Streamer::pushFrame(const cv::Mat& frame, Clock::time_point timestamp) {
+    pushFrame(frame, cv::Rect(0, 0, frame.cols, frame.rows), timestamp);
+}
+
+void Streamer::pushFrame(const cv::Mat& frame, const cv::Rect& roi, Clock::time_point timestamp) {
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        if (!admitLocked(timestamp)) return;
+        std::lock_guard<std::mutex> stats_lock(stats_mutex);
+        statistics.framesPushed++;
+        if (has_pending) {
+            statistics.framesSkipped++;   // 编码线程尚未取走上一帧，直接覆盖
+        }
+        pending.image = frame;
+        pending.roi = roi;
+        pending.yuv.reset();
+        pending.timestamp = timestamp;
+        has_pending = true;
+    }
+    pending_cv.notify_one();
+}
+
+void Streamer::pushFrame(AVFramePtr yuv, Clock::time_point timestamp) {
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        std::lock_guard<std::mutex> stats_lock(stats_mutex);
+        statistics.framesPushed++;
+        if (has_pending) {
+            statistics.framesSkipped++;
+        }
+        pending.image.release();
+        pending.yuv = std::move(yuv);
+        pending.timestamp = timestamp;
+        has_pending = true;
+    }
+    pending_cv.notify_one();
+}
+
+bool Streamer::admitFrame(Clock::time_point timestamp) {
+    std::lock_guard<std::mutex> lock(pending_mutex);
+    return admitLocked(timestamp);
+}
+
+bool Streamer::admitLocked(Clock::time_point timestamp) {
+    // 按当前档位帧率抽帧（留 10% 余量以适应采集抖动）
+    std::lock_guard<std::mutex> stats_lock(stats_mutex);
+    const auto frame_interval = std::chrono::microseconds(900000 / std::max(statistics.fps, 1));
+    if (statistics.fps > 0 && last_admitted != Clock::time_point{} && timestamp - last_admitted < frame_interval) {
+        statistics.framesThrottled++;
+        return false;
+    }
+    last_admitted = timestamp;
     return true;
 }
 
-void Streamer::pushFrame(const cv::Mat& frame) {
+bool Streamer::convertFrame(const cv::Mat& frame) {
+    return convertFrame(frame, cv::Rect(0, 0, frame.cols, frame.rows));
+}
+
+bool Streamer::convertFrame(const cv::Mat& frame, const cv::Rect& roi) {
+    std::lock_guard<std::mutex> lock(encode_mutex);
+    return convertLocked(frame, roi);
+}
+
+void Streamer::encodeFrame() {
+    std::lock_guard<std::mutex> lock(encode_mutex);
+    if (av_frame == nullptr) {
+        std::cout << "帧未初始化，无法推送！" << std::endl;
+        return;
+    }
+    av_frame->pts = ptsFor(Clock::now());
+    encodeLocked(av_frame);
+}
+
+void Streamer::attachMetadata(Clock::time_point timestamp, uint32_t sequence, const std::vector<Detection>& detections) {
+    const int64_t pts = timestampToPts(timestamp);
+
+    std::lock_guard<std::mutex> lock(metadata_mutex);
+    if (metadata_count >= MAX_PENDING_METADATA) {
+        // 最旧的一条移到末尾作为空槽复用
+        std::rotate(pending_metadata.begin(), pending_metadata.begin() + 1, pending_metadata.begin() + metadata_count);
+        metadata_count--;
+        std::lock_guard<std::mutex> stats_lock(stats_mutex);
+        statistics.metadataDropped++;
+    }
+    if (metadata_count == pending_metadata.size()) {
+        // 槽位最多 MAX_PENDING_METADATA 个，增长到上限后不再分配
+        pending_metadata.emplace_back();
+    }
+    // 槽位中的 detections 保留容量，目标数不超过以往最大值时只做拷贝
+    FrameMetadata& meta = pending_metadata[metadata_count++];
+    meta.sequence = sequence;
+    meta.pts = pts;
+    meta.detections.assign(detections.begin(), detections.end());
+    // 检测线程基本按采集顺序提交，偶尔乱序时交换到正确位置
+    for (size_t i = metadata_count - 1; i > 0 && pending_metadata[i - 1].pts > pending_metadata[i].pts; --i) {
+        std::swap(pending_metadata[i - 1], pending_metadata[i]);
+    }
+}
+
+void Streamer::takeMetadata(int64_t pts) {
+    // 取出 pts 不晚于当前编码帧的检测结果，拼成 SEI NAL；上一帧没能插入的保留下来一起发送
+    if (sei_buffer.size() > 64 * 1024) sei_buffer.clear();
+    size_t count = 0;
+    {
+        std::lock_guard<std::mutex> lock(metadata_mutex);
+        while (count < metadata_count && pending_metadata[count].pts <= pts) {
+            buildSeiNal(pending_metadata[count], sei_buffer);
+            count++;
+        }
+        // 已发出的槽位移到末尾复用
+        std::rotate(pending_metadata.begin(), pending_metadata.begin() + count, pending_metadata.begin() + metadata_count);
+        metadata_count -= count;
+    }
+    if (count > 0) {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        statistics.metadataSent += count;
+    }
+}
+
+StreamStats Streamer::stats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    StreamStats result = statistics;
+    result.queueDepth = packet_queue.size();
+    result.queueCapacity = packet_queue.capacity();
+    result.packetsDropped = packet_queue.droppedPackets();
+    result.gopsDropped = packet_queue.droppedGops();
+    return result;
+}
+
+bool Streamer::convertLocked(const cv::Mat& frame, const cv::Rect& roi) {
     if (frame.empty()) {
         std::cout << "空帧，无法推送！" << std::endl;
+        return false;
     } else if (frame.channels() == 1) {
         std::cout << "单通道图像，无法推送！" << std::endl;
+        return false;
     }
     else if (frame.type() != CV_8UC3) {
         std::cout << "图像格式不支持，无法推送！" << std::endl;
+        return false;
     }
-    else if (frame.size() != cv::Size(width, height)) {
-        std::cout << "图像尺寸不匹配，无法推送！" << std::endl;
+    else if (roi.empty() || (roi & cv::Rect(0, 0, frame.cols, frame.rows)) != roi) {
+        std::cout << "推流区域超出图像范围，无法推送！" << std::endl;
+        return false;
     }
-    else if (av_frame == nullptr) {
+
+    // 直接指向 roi 左上角，步长沿用整幅图像的行步长，无需中间 BGR 拷贝
+    const uint8_t* src_data[1] = { frame.ptr(roi.y) + roi.x * frame.elemSize() };
+    const int src_linesize[1] = { static_cast<int>(frame.step) };
+
+    // 裁剪 + 缩放 + 转换像素格式，结果直接写入编码帧
+    return scaleLocked(src_data, src_linesize, roi.width, roi.height, AV_PIX_FMT_BGR24);
+}
+
+bool Streamer::scaleLocked(const uint8_t* const src_data[], const int src_linesize[], int src_width, int src_height,
+                           AVPixelFormat src_format) {
+    if (av_frame == nullptr) {
         std::cout << "帧未初始化，无法推送！" << std::endl;
+        return false;
     }
-    else if (sws_context == nullptr) {
-        std::cout << "像素格式转换上下文未初始化，无法推送！" << std::endl;
+
+    // 输入尺寸或格式变化时重建上下文，不变时复用
+    sws_context = sws_getCachedContext(
+        sws_context,
+        src_width, src_height, src_format,
+        width, height, AV_PIX_FMT_YUV420P,
+        SWS_BILINEAR, nullptr, nullptr, nullptr
+    );
+    if (sws_context == nullptr) {
+        std::cout << "像素格式转换上下文初始化失败，无法推送！" << std::endl;
+        return false;
     }
-    else if (codec_context == nullptr) {
-        std::cout << "编码器上下文未初始化，无法推送！" << std::endl;
+
+    sws_scale(sws_context, src_data, src_linesize, 0, src_height, av_frame->data, av_frame->linesize);
+    return true;
+}
+
+int64_t Streamer::timestampToPts(Clock::time_point timestamp) const {
+    // 采集时间 -> 编码器时间基
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(timestamp - start_time).count();
+    return av_rescale_q(elapsed, {1, 1000000}, ENCODER_TIME_BASE);
+}
+
+int64_t Streamer::ptsFor(Clock::time_point timestamp) {
+    // 保证严格递增
+    int64_t pts = timestampToPts(timestamp);
+    if (pts <= last_pts) pts = last_pts + 1;
+    last_pts = pts;
+    return pts;
+}
+
+void Streamer::encodeLocked(AVFrame* frame) {
+    if (codec_context == nullptr) {
+        std::cerr << "编码器上下文未初始化，无法推送！" << std::endl;
+        return;
     }
-    else if (output_context == nullptr) {
-        std::cout << "输出上下文未初始化，无法推送！" << std::endl;
+
+    // 包队列丢弃过 GOP 或刚切换分辨率时立即插入关键帧，缩短画面中断时间
+    if (frame != nullptr) {
+        const bool keyframe = packet_queue.takeKeyframeRequest() || std::exchange(force_keyframe, false);
+        frame->pict_type = keyframe ? AV_PICTURE_TYPE_I : AV_PICTURE_TYPE_NONE;
+        takeMetadata(frame->pts);
+    }
+
+    // 编码，输出的包交给封装线程
+    if (avcodec_send_frame(codec_context, frame) == 0) {
+        // 包结构体取自包队列的空闲包，封装线程写出后交还
+        AVPacket* pkt = packet_queue.acquire();
+        while (avcodec_receive_packet(codec_context, pkt) == 0) {
+            // 检测结果 SEI 放进本帧输出的第一个包；零延迟编码下它就是当前帧
+            if (!sei_buffer.empty()) {
+                AVPacket* with_sei = packet_queue.acquire();
+                if (insertSei(pkt, codec_context->time_base, sei_buffer, with_sei)) {
+                    packet_queue.recycle(pkt);
+                    pkt = with_sei;
+                    sei_buffer.clear();
+                }
+                else {
+                    packet_queue.recycle(with_sei);
+                }
+            }
+            // 先分发给其他输出（编码器时间基），各输出只增加包的引用计数
+            for (const auto& sink : sinks) {
+                sink->write(pkt, stream_format);
+            }
+            // 编码器时间基 -> 输出流时间基
+            av_packet_rescale_ts(pkt, codec_context->time_base, video_stream->time_base);
+            pkt->stream_index = video_stream->index;
+            packet_queue.push(pkt);
+            pkt = packet_queue.acquire();
+        }
+        packet_queue.recycle(pkt);
+        if (frame != nullptr) {
+            std::lock_guard<std::mutex> lock(stats_mutex);
+            statistics.framesEncoded++;
+        }
     }
+}
 
-    uint8_t* src_data[1] = { frame.data };
-    int src_linesize[1] = { static_cast<int>(frame.step) };
+void Streamer::encodeLoop() {
+    RT::ThreadScope scope("encode");
+    while (true) {
+        PendingFrame job;
+        {
+            std::unique_lock<std::mutex> lock(pending_mutex);
+            pending_cv.wait(lock, [this] { return has_pending || stopping; });
+            if (stopping) break;
+            job = std::move(pending);
+            has_pending = false;
+        }
 
-    // 转换像素格式
-    sws_scale(sws_context, src_data, src_linesize, 0, height, av_frame->data, av_frame->linesize);
+        std::lock_guard<std::mutex> lock(encode_mutex);
+        // 按采样周期评估拥塞并在码率阶梯上升降档
+        if (rate_controller.enabled() && job.timestamp - last_rate_sample >= rate_controller.interval()) {
+            last_rate_sample = job.timestamp;
+            const size_t before = rate_controller.current();
+            rate_controller.setTopRung(rung_limit.load(std::memory_order_relaxed));
+            if (rate_controller.update(stats()) != before) {
+                applyRung(before);
+                if (codec_context == nullptr) break;    // 编码器无法重建，不再逐帧尝试
+            }
+        }
+        AVFrame* input = nullptr;
+        if (job.yuv && job.yuv->width == width && job.yuv->height == height && job.yuv->format == AV_PIX_FMT_YUV420P) {
+            input = job.yuv.get();   // 已是编码尺寸：直接编码共享的帧
+        }
+        else if (job.yuv) {
+            if (scaleLocked(job.yuv->data, job.yuv->linesize, job.yuv->width, job.yuv->height,
+                            static_cast<AVPixelFormat>(job.yuv->format))) {
+                input = av_frame;
+            }
+        }
+        else if (convertLocked(job.image, job.roi)) {
+            input = av_frame;
+        }
+        if (input != nullptr) {
+            input->pts = ptsFor(job.timestamp);
+            encodeLocked(input);
+        }
+    }
+}
 
-    // 编码并推流
-    AVPacket pkt = {0};
-    av_init_packet(&pkt);
-    pkt.data = nullptr;
-    pkt.size = 0;
+void Streamer::muxLoop() {
+    RT::ThreadScope scope("mux");
+    while (AVPacket* pkt = packet_queue.pop()) {
+        // 切换分辨率后同步输出流的参数；推流已发出的 SDP 不变，客户端依靠关键帧前重复的 SPS/PPS 切换
+        if (format_changed.exchange(false, std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(format_mutex);
+            avcodec_parameters_copy(video_stream->codecpar, mux_format->codecpar);
+        }
+        const int size = pkt->size;
+        const auto t0 = Clock::now();
+        const int ret = av_interleaved_write_frame(output_context, pkt);
+        const double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        packet_queue.recycle(pkt);
 
-    av_frame->pts++;
-    if (avcodec_send_frame(codec_context, av_frame) == 0) {
-        while (avcodec_receive_packet(codec_context, &pkt) == 0) {
-            av_interleaved_write_frame(output_context, &pkt);
-            av_packet_unref(&pkt);
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        if (ret < 0) {
+            if (statistics.writeErrors++ == 0) {
+                char err[AV_ERROR_MAX_STRING_SIZE] = {0};
+                av_strerror(ret, err, sizeof(err));
+                std::cerr << "推流写出失败: " << err << std::endl;
+            }
+            continue;
         }
+        statistics.packetsWritten++;
+        statistics.bytesWritten += size;
+        statistics.lastWriteMs = ms;
+        statistics.avgWriteMs = statistics.packetsWritten == 1 ? ms : 0.9 * statistics.avgWriteMs + 0.1 * ms;
+        statistics.maxWriteMs = std::max(statistics.maxWriteMs, ms);
+    }
+}
+
+void Streamer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        stopping = true;
+    }
+    pending_cv.notify_all();
+    if (encode_thread.joinable()) {
+        encode_thread.join();
+        // 冲刷编码器中缓存的帧
+        std::lock_guard<std::mutex> lock(encode_mutex);
+        if (codec_context) encodeLocked(nullptr);
+    }
+    packet_queue.close();
+    if (mux_thread.joinable()) mux_thread.join();
+    for (const auto& sink : sinks) {
+        sink->close();
     }
 }
 
 void Streamer::releaseResources() {
-    if (av_frame) av_frame_free(&av_frame);
+    stop();
+    closeEncoder();
     if (sws_context) sws_freeContext(sws_context);
-    if (codec_context) avcodec_free_context(&codec_context);
     if (output_context) {
-        av_write_trailer(output_context);
+        if (header_written) av_write_trailer(output_context);
         if (!(output_context->oformat->flags & AVFMT_NOFILE)) avio_closep(&output_context->pb);
         avformat_free_context(output_context);
     }
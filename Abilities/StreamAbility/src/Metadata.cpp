@@ -0,0 +1,287 @@
+#include "Metadata.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace LIVE {
+
+const uint8_t METADATA_UUID[16] = {
+    0x45, 0x63, 0x68, 0x6f, 0x56, 0x69, 0x73, 0x69,   // "EchoVisi"
+    0x6f, 0x6e, 0x2d, 0x64, 0x65, 0x74, 0x76, 0x31    // "on-detv1"
+};
+
+// 版本 1：版本、序号 u32、pts u64、条数；版本 2：版本、pts（PTS_SIZE 字节）、序号 u32、条数；
+// 版本 3 布局同版本 2，pts 字段为所描述画面相对所在包 pts 的偏移
+static constexpr uint8_t METADATA_VERSION = 3;
+static constexpr AVRational SEI_TIME_BASE = {1, 90000};
+static constexpr uint8_t NAL_SEI = 6;
+static constexpr uint8_t SEI_USER_DATA_UNREGISTERED = 5;
+static constexpr size_t PTS_SIZE = 9;
+static constexpr size_t HEADER_SIZE_V1 = 1 + 4 + 8 + 1;
+static constexpr size_t HEADER_SIZE = 1 + PTS_SIZE + 4 + 1;
+static constexpr size_t DETECTION_SIZE = 2 + 1 + 4 * 2 + 2;  // 类别、置信度、框、距离
+static constexpr uint16_t DISTANCE_UNKNOWN = 0xFFFF;
+
+static void putBE(std::vector<uint8_t>& out, uint64_t value, int bytes) {
+    for (int i = bytes - 1; i >= 0; --i) out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+}
+
+static uint64_t getBE(const uint8_t* p, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) value = (value << 8) | p[i];
+    return value;
+}
+
+// pts 按 7 位一组、高位置 1 存放（63 位补码）：每个字节都不小于 0x80，既不会触发防竞争字节，
+// 也不会改变其后字节的转义，插入包时可原位改写为偏移而不改变 NAL 长度
+static void putPts(uint8_t* out, int64_t pts) {
+    const uint64_t value = static_cast<uint64_t>(pts);
+    for (size_t i = 0; i < PTS_SIZE; ++i) {
+        out[i] = static_cast<uint8_t>(0x80 | ((value >> (7 * (PTS_SIZE - 1 - i))) & 0x7F));
+    }
+}
+
+static int64_t getPts(const uint8_t* p) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < PTS_SIZE; ++i) value = (value << 7) | (p[i] & 0x7F);
+    // 第 63 位为符号位
+    if (value & (uint64_t{1} << 62)) value |= uint64_t{1} << 63;
+    return static_cast<int64_t>(value);
+}
+
+static uint16_t quantize(float value, float scale) {
+    return static_cast<uint16_t>(std::lround(std::clamp(value, 0.f, 1.f) * scale));
+}
+
+// 负载中出现 00 00 0x（x<=3）时插入 0x03，避免被误认为起始码
+static void appendEscaped(std::vector<uint8_t>& nal, const std::vector<uint8_t>& rbsp) {
+    int zeros = 0;
+    for (uint8_t byte : rbsp) {
+        if (zeros == 2 && byte <= 3) {
+            nal.push_back(0x03);
+            zeros = 0;
+        }
+        nal.push_back(byte);
+        zeros = byte == 0 ? zeros + 1 : 0;
+    }
+}
+
+static std::vector<uint8_t> unescape(const uint8_t* data, size_t size) {
+    std::vector<uint8_t> rbsp;
+    rbsp.reserve(size);
+    int zeros = 0;
+    for (size_t i = 0; i < size; ++i) {
+        if (zeros == 2 && data[i] == 0x03) {
+            zeros = 0;
+            continue;
+        }
+        rbsp.push_back(data[i]);
+        zeros = data[i] == 0 ? zeros + 1 : 0;
+    }
+    return rbsp;
+}
+
+void buildSeiNal(const FrameMetadata& meta, std::vector<uint8_t>& nal) {
+    const size_t count = std::min<size_t>(meta.detections.size(), 255);
+
+    std::vector<uint8_t> payload(METADATA_UUID, METADATA_UUID + sizeof(METADATA_UUID));
+    payload.push_back(METADATA_VERSION);
+    payload.resize(payload.size() + PTS_SIZE);
+    putPts(payload.data() + payload.size() - PTS_SIZE, meta.pts);
+    putBE(payload, meta.sequence, 4);
+    payload.push_back(static_cast<uint8_t>(count));
+    for (size_t i = 0; i < count; ++i) {
+        const Detection& det = meta.detections[i];
+        putBE(payload, static_cast<uint16_t>(det.classId), 2);
+        payload.push_back(static_cast<uint8_t>(quantize(det.confidence, 255.f)));
+        putBE(payload, quantize(det.box.x, 65535.f), 2);
+        putBE(payload, quantize(det.box.y, 65535.f), 2);
+        putBE(payload, quantize(det.box.width, 65535.f), 2);
+        putBE(payload, quantize(det.box.height, 65535.f), 2);
+        const uint16_t cm = det.distance < 0 ? DISTANCE_UNKNOWN
+                          : static_cast<uint16_t>(std::min(det.distance * 100.f, 65534.f));
+        putBE(payload, cm, 2);
+    }
+
+    // sei_message：类型与长度按 0xFF 分段编码，最后是 rbsp 结束位
+    std::vector<uint8_t> rbsp;
+    rbsp.push_back(SEI_USER_DATA_UNREGISTERED);
+    size_t size = payload.size();
+    for (; size >= 255; size -= 255) rbsp.push_back(0xFF);
+    rbsp.push_back(static_cast<uint8_t>(size));
+    rbsp.insert(rbsp.end(), payload.begin(), payload.end());
+    rbsp.push_back(0x80);
+
+    const uint8_t start_code[] = {0x00, 0x00, 0x00, 0x01, NAL_SEI};
+    nal.insert(nal.end(), start_code, start_code + sizeof(start_code));
+    appendEscaped(nal, rbsp);
+}
+
+// UUID 不含零字节，在转义后的数据中原样出现；其后是版本字节与 pts，二者都不含防竞争字节
+template <typename Visit>
+static size_t forEachPts(const uint8_t* data, size_t size, Visit&& visit) {
+    constexpr size_t span = sizeof(METADATA_UUID) + 1 + PTS_SIZE;
+    size_t found = 0;
+    for (size_t i = 0; i + span <= size; ++i) {
+        if (data[i] != METADATA_UUID[0] || std::memcmp(data + i, METADATA_UUID, sizeof(METADATA_UUID)) != 0) continue;
+        if (data[i + sizeof(METADATA_UUID)] != METADATA_VERSION) continue;
+        visit(i + sizeof(METADATA_UUID) + 1);
+        found++;
+        i += span - 1;
+    }
+    return found;
+}
+
+bool insertSei(const AVPacket* pkt, AVRational time_base, const std::vector<uint8_t>& nal, AVPacket* out) {
+    if (pkt->pts == AV_NOPTS_VALUE) {
+        return false;
+    }
+    // 找第一个 VCL NAL（类型 1~5）的起始码，SEI 必须位于同一访问单元的图像数据之前
+    size_t pos = pkt->size;
+    for (int i = 0; i + 3 < pkt->size; ++i) {
+        if (pkt->data[i] == 0 && pkt->data[i + 1] == 0 && pkt->data[i + 2] == 1) {
+            const uint8_t type = pkt->data[i + 3] & 0x1F;
+            if (type >= 1 && type <= 5) {
+                pos = (i > 0 && pkt->data[i - 1] == 0) ? i - 1 : i;
+                break;
+            }
+            i += 2;
+        }
+    }
+    if (pos == static_cast<size_t>(pkt->size)) {
+        return false;
+    }
+
+    if (av_new_packet(out, pkt->size + static_cast<int>(nal.size())) < 0) {
+        return false;
+    }
+    av_packet_copy_props(out, pkt);
+    std::memcpy(out->data, pkt->data, pos);
+    std::memcpy(out->data + pos, nal.data(), nal.size());
+    std::memcpy(out->data + pos + nal.size(), pkt->data + pos, pkt->size - pos);
+    // buildSeiNal 写入的是编码器时间轴上的 pts，改为相对本包的偏移
+    uint8_t* sei = out->data + pos;
+    const int64_t host = av_rescale_q(pkt->pts, time_base, SEI_TIME_BASE);
+    forEachPts(sei, nal.size(), [&](size_t at) { putPts(sei + at, getPts(sei + at) - host); });
+    return true;
+}
+
+static bool parsePayload(const uint8_t* p, size_t size, int64_t packet_pts, AVRational time_base, FrameMetadata& meta) {
+    if (size < sizeof(METADATA_UUID) + HEADER_SIZE_V1 || std::memcmp(p, METADATA_UUID, sizeof(METADATA_UUID)) != 0) {
+        return false;
+    }
+    p += sizeof(METADATA_UUID);
+    size -= sizeof(METADATA_UUID);
+    size_t header = 0;
+    if (p[0] == METADATA_VERSION || p[0] == 2) {
+        if (size < HEADER_SIZE) return false;
+        const int64_t pts = getPts(p + 1);
+        if (p[0] == METADATA_VERSION) {
+            meta.pts = packet_pts == AV_NOPTS_VALUE ? AV_NOPTS_VALUE : packet_pts + av_rescale_q(pts, SEI_TIME_BASE, time_base);
+        }
+        else {
+            // 版本 2 的录像：pts 随文件时间戳归零，为 90 kHz 的绝对值
+            meta.pts = av_rescale_q(pts, SEI_TIME_BASE, time_base);
+        }
+        meta.sequence = static_cast<uint32_t>(getBE(p + 1 + PTS_SIZE, 4));
+        header = HEADER_SIZE;
+    }
+    else if (p[0] == 1) {
+        // 旧录像：pts 为推流时间轴上的绝对值，与录像文件中的时间戳不一致
+        meta.sequence = static_cast<uint32_t>(getBE(p + 1, 4));
+        meta.pts = av_rescale_q(static_cast<int64_t>(getBE(p + 5, 8)), SEI_TIME_BASE, time_base);
+        header = HEADER_SIZE_V1;
+    }
+    else {
+        return false;
+    }
+    const size_t count = p[header - 1];
+    p += header;
+    size -= header;
+    if (size < count * DETECTION_SIZE) {
+        return false;
+    }
+
+    meta.detections.resize(count);
+    for (Detection& det : meta.detections) {
+        det.classId = static_cast<int>(getBE(p, 2));
+        det.confidence = p[2] / 255.f;
+        det.box = cv::Rect2f(getBE(p + 3, 2) / 65535.f, getBE(p + 5, 2) / 65535.f,
+                             getBE(p + 7, 2) / 65535.f, getBE(p + 9, 2) / 65535.f);
+        const auto cm = static_cast<uint16_t>(getBE(p + 11, 2));
+        det.distance = cm == DISTANCE_UNKNOWN ? -1.f : cm / 100.f;
+        p += DETECTION_SIZE;
+    }
+    return true;
+}
+
+// 解析一个 SEI NAL（不含起始码/长度字段）中的所有消息
+static size_t parseSeiNal(const uint8_t* data, size_t size, int64_t packet_pts, AVRational time_base,
+                          std::vector<FrameMetadata>& out) {
+    const std::vector<uint8_t> rbsp = unescape(data + 1, size - 1);
+    size_t found = 0;
+    size_t i = 0;
+    while (i < rbsp.size() && !(rbsp[i] == 0x80 && i + 1 == rbsp.size())) {   // 最后的 0x80 为 rbsp 结束位
+        size_t type = 0, length = 0;
+        while (i < rbsp.size() && rbsp[i] == 0xFF) type += rbsp[i++];
+        if (i >= rbsp.size()) break;
+        type += rbsp[i++];
+        while (i < rbsp.size() && rbsp[i] == 0xFF) length += rbsp[i++];
+        if (i >= rbsp.size()) break;
+        length += rbsp[i++];
+        if (i + length > rbsp.size()) break;
+
+        FrameMetadata meta;
+        if (type == SEI_USER_DATA_UNREGISTERED && parsePayload(rbsp.data() + i, length, packet_pts, time_base, meta)) {
+            out.push_back(std::move(meta));
+            found++;
+        }
+        i += length;
+    }
+    return found;
+}
+
+size_t parseSei(const uint8_t* data, size_t size, int length_size, int64_t packet_pts, AVRational time_base,
+                std::vector<FrameMetadata>& out) {
+    size_t found = 0;
+    auto visit = [&](const uint8_t* nal, size_t nal_size) {
+        if (nal_size > 1 && (nal[0] & 0x1F) == NAL_SEI) {
+            found += parseSeiNal(nal, nal_size, packet_pts, time_base, out);
+        }
+    };
+
+    if (length_size > 0) {
+        // AVCC：每个 NAL 前是大端长度
+        size_t i = 0;
+        while (i + length_size <= size) {
+            const size_t nal_size = getBE(data + i, length_size);
+            i += length_size;
+            if (i + nal_size > size) break;
+            visit(data + i, nal_size);
+            i += nal_size;
+        }
+        return found;
+    }
+
+    // Annex B：按起始码切分
+    size_t begin = 0;
+    bool in_nal = false;
+    for (size_t i = 0; i + 2 < size; ++i) {
+        if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1) {
+            if (in_nal) {
+                size_t end = i;
+                while (end > begin && data[end - 1] == 0) end--;   // 4 字节起始码的前导零
+                visit(data + begin, end - begin);
+            }
+            begin = i + 3;
+            in_nal = true;
+            i += 2;
+        }
+    }
+    if (in_nal && begin < size) {
+        visit(data + begin, size - begin);
+    }
+    return found;
+}
+
+} // namespace LIVE
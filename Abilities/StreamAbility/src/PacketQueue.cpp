@@ -0,0 +1,143 @@
+#include "PacketQueue.h"
+#include <algorithm>
+#include <utility>
+
+namespace LIVE {
+
+static bool isKeyframe(const AVPacket* pkt) {
+    return pkt->flags & AV_PKT_FLAG_KEY;
+}
+
+PacketQueue::PacketQueue(size_t capacity) : max_size(std::max<size_t>(capacity, 1)), slots(max_size, nullptr) {
+    // 队列中的包加上编码线程与封装线程各自手里的几个
+    free_packets.reserve(max_size + 8);
+}
+
+PacketQueue::~PacketQueue() {
+    for (size_t i = 0; i < count; ++i) {
+        AVPacket* pkt = at(i);
+        av_packet_free(&pkt);
+    }
+    for (AVPacket* pkt : free_packets) av_packet_free(&pkt);
+}
+
+AVPacket* PacketQueue::acquire() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!free_packets.empty()) {
+            AVPacket* pkt = free_packets.back();
+            free_packets.pop_back();
+            return pkt;
+        }
+    }
+    return av_packet_alloc();
+}
+
+void PacketQueue::recycle(AVPacket* pkt) {
+    if (pkt == nullptr) return;
+    av_packet_unref(pkt);
+    std::lock_guard<std::mutex> lock(mtx);
+    recycleLocked(pkt);
+}
+
+void PacketQueue::recycleLocked(AVPacket* pkt) {
+    av_packet_unref(pkt);
+    if (free_packets.size() < free_packets.capacity()) {
+        free_packets.push_back(pkt);
+    }
+    else {
+        av_packet_free(&pkt);
+    }
+}
+
+bool PacketQueue::push(AVPacket* pkt) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (wait_keyframe) {
+            if (!isKeyframe(pkt)) {
+                dropped_packets++;
+                recycleLocked(pkt);
+                return false;
+            }
+            wait_keyframe = false;
+        }
+
+        if (count >= max_size) {
+            size_t next_key = 1;
+            while (next_key < count && !isKeyframe(at(next_key))) ++next_key;
+            dropped_gops++;
+            if (next_key < count) {
+                // 丢弃最旧的 GOP，队列仍从关键帧开始
+                dropFront(next_key);
+            }
+            else {
+                // 只有一个未完成的 GOP：整体丢弃，等待新的关键帧
+                dropFront(count);
+                if (!isKeyframe(pkt)) {
+                    wait_keyframe = true;
+                    keyframe_requested = true;
+                    dropped_packets++;
+                    recycleLocked(pkt);
+                    return false;
+                }
+            }
+        }
+        slots[(head + count) % max_size] = pkt;
+        count++;
+    }
+    condition_v.notify_one();
+    return true;
+}
+
+AVPacket* PacketQueue::pop() {
+    std::unique_lock<std::mutex> lock(mtx);
+    condition_v.wait(lock, [this] { return count > 0 || closed; });
+    if (count == 0) {
+        return nullptr;
+    }
+    AVPacket* pkt = slots[head];
+    slots[head] = nullptr;
+    head = (head + 1) % max_size;
+    count--;
+    return pkt;
+}
+
+void PacketQueue::close() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        closed = true;
+    }
+    condition_v.notify_all();
+}
+
+size_t PacketQueue::size() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return count;
+}
+
+uint64_t PacketQueue::droppedPackets() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return dropped_packets;
+}
+
+uint64_t PacketQueue::droppedGops() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return dropped_gops;
+}
+
+bool PacketQueue::takeKeyframeRequest() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return std::exchange(keyframe_requested, false);
+}
+
+void PacketQueue::dropFront(size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        recycleLocked(slots[head]);
+        slots[head] = nullptr;
+        head = (head + 1) % max_size;
+    }
+    count -= n;
+    dropped_packets += n;
+}
+
+} // namespace LIVE
@@ -0,0 +1,89 @@
+#include "RateControl.h"
+#include "LiveStream.h"
+#include <algorithm>
+
+namespace LIVE {
+
+RateController::RateController(const RateControlConfig& config, size_t start_rung)
+    : config(config), unusable(config.ladder.size(), false),
+      rung(config.ladder.empty() ? 0 : std::min(start_rung, config.ladder.size() - 1)),
+      up_after(std::max(1, config.upAfter)) {}
+
+size_t RateController::update(const StreamStats& stats) {
+    if (!enabled()) return rung;
+
+    const bool slow_write = stats.avgWriteMs > config.congestedWriteMs;
+    const bool queue_full = stats.queueCapacity > 0 &&
+        static_cast<double>(stats.queueDepth) > config.congestedQueueRatio * static_cast<double>(stats.queueCapacity);
+    const bool queue_growing = stats.queueDepth > last_depth + config.congestedQueueGrowth;
+    const bool dropped = stats.gopsDropped > last_gops_dropped;
+    last_depth = stats.queueDepth;
+    last_gops_dropped = stats.gopsDropped;
+
+    if (samples_since_up >= 0) samples_since_up++;
+
+    if (slow_write || queue_full || queue_growing || dropped) {
+        healthy_count = 0;
+        // 丢过 GOP 说明已经积压，立即降档
+        if (++congested_count >= config.downAfter || dropped) {
+            congested_count = 0;
+            // 升档后不久又拥塞：说明上一档带宽不够，加倍升档等待
+            if (samples_since_up >= 0 && samples_since_up < 2 * up_after) {
+                up_after = std::min(up_after * 2, std::max(config.maxUpAfter, 1));
+            }
+            samples_since_up = -1;
+            for (size_t next = rung + 1; next < config.ladder.size(); next++) {
+                if (!unusable[next]) {
+                    rung = next;
+                    break;
+                }
+            }
+        }
+    }
+    else {
+        congested_count = 0;
+        // 升档后稳定运行足够久，升档等待逐步恢复
+        if (samples_since_up == 2 * up_after) {
+            up_after = std::max(std::max(1, config.upAfter), up_after / 2);
+        }
+        if (++healthy_count >= up_after) {
+            for (size_t next = rung; next > top_rung;) {
+                if (!unusable[--next]) {
+                    healthy_count = 0;
+                    samples_since_up = 0;
+                    rung = next;
+                    break;
+                }
+            }
+        }
+    }
+    return rung;
+}
+
+void RateController::setTopRung(size_t top) {
+    if (!enabled()) return;
+    top_rung = std::min(top, config.ladder.size() - 1);
+    if (rung < top_rung) {
+        rung = usableFrom(top_rung);
+        congested_count = 0;
+        healthy_count = 0;
+    }
+}
+
+void RateController::markUnusable(size_t index, size_t fallback) {
+    if (index >= unusable.size()) return;
+    unusable[index] = true;
+    rung = std::min(fallback, config.ladder.size() - 1);
+    congested_count = 0;
+    healthy_count = 0;
+    samples_since_up = -1;
+}
+
+size_t RateController::usableFrom(size_t index) const {
+    for (size_t i = index; i < unusable.size(); i++) {
+        if (!unusable[i]) return i;
+    }
+    return index;
+}
+
+} // namespace LIVE
@@ -0,0 +1,394 @@
+#include "Recorder.h"
+#include "Runtime.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <iostream>
+
+namespace LIVE {
+
+static bool isKeyframe(const AVPacket* pkt) {
+    return pkt->flags & AV_PKT_FLAG_KEY;
+}
+
+static int64_t packetTime(const AVPacket* pkt) {
+    return pkt->dts != AV_NOPTS_VALUE ? pkt->dts : pkt->pts;
+}
+
+// 以本地时间命名文件，精确到毫秒，如 20250305_142530_042
+static std::string fileTimestamp() {
+    const auto now = std::chrono::system_clock::now();
+    const std::time_t seconds = std::chrono::system_clock::to_time_t(now);
+    const auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000;
+    std::tm local{};
+    localtime_r(&seconds, &local);
+    char buf[32];
+    const size_t length = std::strftime(buf, sizeof(buf), "%Y%m%d_%H%M%S", &local);
+    std::snprintf(buf + length, sizeof(buf) - length, "_%03d", static_cast<int>(millis));
+    return buf;
+}
+
+// 授时校正使时钟回拨时名字可能重复，已有的文件不覆盖，在名字后加序号
+static std::string freshPath(const std::filesystem::path& folder, const std::string& stem) {
+    std::filesystem::path path = folder / (stem + ".mp4");
+    std::error_code ec;
+    for (int i = 1; std::filesystem::exists(path, ec); i++) {
+        path = folder / (stem + "_" + std::to_string(i) + ".mp4");
+    }
+    return path.string();
+}
+
+static bool makeFolder(const std::filesystem::path& folder) {
+    std::error_code ec;
+    std::filesystem::create_directories(folder, ec);
+    if (ec) {
+        std::cerr << "无法创建录像目录 " << folder.string() << ": " << ec.message() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// ---------------- PacketPool ----------------
+
+PacketPool::~PacketPool() {
+    for (AVPacket* pkt : free_packets) av_packet_free(&pkt);
+}
+
+AVPacket* PacketPool::ref(const AVPacket* src) {
+    AVPacket* pkt = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!free_packets.empty()) {
+            pkt = free_packets.back();
+            free_packets.pop_back();
+        }
+    }
+    if (pkt == nullptr && (pkt = av_packet_alloc()) == nullptr) return nullptr;
+    if (av_packet_ref(pkt, src) < 0) {
+        recycle(pkt);
+        return nullptr;
+    }
+    return pkt;
+}
+
+void PacketPool::recycle(AVPacket*& pkt) {
+    if (pkt == nullptr) return;
+    av_packet_unref(pkt);
+    std::lock_guard<std::mutex> lock(mtx);
+    free_packets.push_back(pkt);
+    pkt = nullptr;
+}
+
+// ---------------- Mp4Writer ----------------
+
+Mp4Writer::Mp4Writer() : scratch(av_packet_alloc()) {}
+
+Mp4Writer::~Mp4Writer() {
+    close();
+    av_packet_free(&scratch);
+}
+
+bool Mp4Writer::open(const std::string& path, const StreamFormatPtr& format) {
+    close();
+    if (avformat_alloc_output_context2(&output_context, nullptr, "mp4", path.c_str()) < 0) {
+        std::cerr << "无法创建录像输出上下文！" << std::endl;
+        return false;
+    }
+    video_stream = avformat_new_stream(output_context, nullptr);
+    if (!video_stream || avcodec_parameters_copy(video_stream->codecpar, format->codecpar) < 0) {
+        std::cerr << "无法创建录像视频流！" << std::endl;
+        avformat_free_context(output_context);
+        output_context = nullptr;
+        return false;
+    }
+    video_stream->codecpar->codec_tag = 0;
+    video_stream->time_base = format->timeBase;
+
+    if (avio_open(&output_context->pb, path.c_str(), AVIO_FLAG_WRITE) < 0) {
+        std::cerr << "无法打开录像文件 " << path << std::endl;
+        avformat_free_context(output_context);
+        output_context = nullptr;
+        return false;
+    }
+
+    // 每个关键帧写出一个分片，moov 放在文件头且不依赖文件尾
+    AVDictionary* options = nullptr;
+    av_dict_set(&options, "movflags", "frag_keyframe+empty_moov+default_base_moof", 0);
+    const int ret = avformat_write_header(output_context, &options);
+    av_dict_free(&options);
+    if (ret < 0) {
+        std::cerr << "无法写入录像头信息！" << std::endl;
+        avio_closep(&output_context->pb);
+        avformat_free_context(output_context);
+        output_context = nullptr;
+        return false;
+    }
+
+    stream_format = format;
+    start_dts = AV_NOPTS_VALUE;
+    return true;
+}
+
+bool Mp4Writer::write(const AVPacket* pkt) {
+    if (!isOpen() || av_packet_ref(scratch, pkt) < 0) {
+        return false;
+    }
+    if (start_dts == AV_NOPTS_VALUE) {
+        start_dts = packetTime(pkt);
+    }
+    if (scratch->pts != AV_NOPTS_VALUE) scratch->pts -= start_dts;
+    if (scratch->dts != AV_NOPTS_VALUE) scratch->dts -= start_dts;
+    av_packet_rescale_ts(scratch, stream_format->timeBase, video_stream->time_base);
+    scratch->stream_index = video_stream->index;
+    // av_interleaved_write_frame 接管 scratch 中的引用并将其清空
+    return av_interleaved_write_frame(output_context, scratch) >= 0;
+}
+
+void Mp4Writer::close() {
+    if (!output_context) return;
+    av_write_trailer(output_context);
+    avio_closep(&output_context->pb);
+    avformat_free_context(output_context);
+    output_context = nullptr;
+    video_stream = nullptr;
+    stream_format.reset();
+}
+
+// ---------------- SegmentRecorder ----------------
+
+SegmentRecorder::SegmentRecorder(const std::filesystem::path& folder, std::chrono::seconds segment_length, size_t queue_capacity)
+    : folder(folder), segment_length(segment_length), capacity(std::max<size_t>(queue_capacity, 1)) {}
+
+SegmentRecorder::~SegmentRecorder() {
+    close();
+}
+
+bool SegmentRecorder::start() {
+    if (!makeFolder(folder)) return false;
+    writer_thread = std::thread(&SegmentRecorder::writerLoop, this);
+    return true;
+}
+
+void SegmentRecorder::write(const AVPacket* pkt, const StreamFormatPtr& format) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (closed) return;
+        if (wait_keyframe) {
+            if (!isKeyframe(pkt)) {
+                dropped_packets++;
+                return;
+            }
+            wait_keyframe = false;
+        }
+        if (queue.size() >= capacity) {
+            // 写盘跟不上：丢弃当前包并等待下一个关键帧，保证录像可解码
+            dropped_packets++;
+            wait_keyframe = true;
+            return;
+        }
+        AVPacket* copy = packets.ref(pkt);
+        if (copy == nullptr) {
+            dropped_packets++;
+            wait_keyframe = true;
+            return;
+        }
+        queue.push_back({copy, format});
+    }
+    condition_v.notify_one();
+}
+
+void SegmentRecorder::close() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        closed = true;
+    }
+    condition_v.notify_all();
+    if (writer_thread.joinable()) writer_thread.join();
+    for (Item& item : queue) packets.recycle(item.packet);
+    queue.clear();
+}
+
+uint64_t SegmentRecorder::droppedPackets() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return dropped_packets;
+}
+
+void SegmentRecorder::writerLoop() {
+    RT::ThreadScope scope("storage");
+    Mp4Writer writer;
+    int64_t segment_start = 0;
+    while (true) {
+        Item item;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            condition_v.wait(lock, [this] { return !queue.empty() || closed; });
+            if (queue.empty()) break;   // 关闭前写完已入队的包
+            item = queue.front();
+            queue.pop_front();
+        }
+
+        const int64_t now = av_rescale_q(packetTime(item.packet), item.format->timeBase, {1, 1000000});
+        // 到达分段时长或编码参数变化（切换分辨率）时，在关键帧处开始新的一段
+        const bool new_segment = !writer.isOpen() || writer.format() != item.format ||
+                                 now - segment_start >= segment_length.count();
+        if (new_segment && isKeyframe(item.packet)) {
+            const std::string path = freshPath(folder, "segment_" + fileTimestamp());
+            if (writer.open(path, item.format)) {
+                segment_start = now;
+                std::cout << "Recording segment: " << path << std::endl;
+            }
+        }
+        if (writer.isOpen() && writer.format() == item.format) {
+            writer.write(item.packet);
+        }
+        packets.recycle(item.packet);
+    }
+    writer.close();
+}
+
+// ---------------- EventRing ----------------
+
+EventRing::EventRing(const std::filesystem::path& folder, std::chrono::seconds pre_event, std::chrono::seconds post_event)
+    : folder(folder),
+      pre_event(std::chrono::duration_cast<std::chrono::microseconds>(pre_event).count()),
+      post_event(std::chrono::duration_cast<std::chrono::microseconds>(post_event).count()) {}
+
+EventRing::~EventRing() {
+    close();
+}
+
+bool EventRing::start() {
+    if (!makeFolder(folder)) return false;
+    flush_thread = std::thread(&EventRing::flushLoop, this);
+    return true;
+}
+
+int64_t EventRing::micros(const Item& item) {
+    return av_rescale_q(packetTime(item.packet), item.format->timeBase, {1, 1000000});
+}
+
+void EventRing::trigger(const std::string& tag) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (closed) return;
+        if (!events.empty() && !events.back().complete) {
+            events.back().endTime = newest + post_event;
+            return;
+        }
+        Event event;
+        event.path = freshPath(folder, "event_" + fileTimestamp() + "_" + tag);
+        event.endTime = newest + post_event;
+        // 缓存的包只增加引用计数，环形缓存本身保持不变
+        for (const Item& item : ring) {
+            if (AVPacket* copy = packets.ref(item.packet)) event.items.push_back({copy, item.format});
+        }
+        events.push_back(std::move(event));
+    }
+    condition_v.notify_one();
+}
+
+void EventRing::write(const AVPacket* pkt, const StreamFormatPtr& format) {
+    bool notify = false;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (closed) return;
+        Item item{packets.ref(pkt), format};
+        if (item.packet == nullptr) return;
+        newest = micros(item);
+
+        if (!events.empty() && !events.back().complete) {
+            Event& event = events.back();
+            if (AVPacket* copy = packets.ref(pkt)) event.items.push_back({copy, format});
+            event.complete = newest >= event.endTime;
+            notify = true;
+        }
+
+        ring.push_back(item);
+        trim();
+    }
+    if (notify) condition_v.notify_one();
+}
+
+void EventRing::trim() {
+    // 缓存总是从关键帧开始
+    while (!ring.empty() && !isKeyframe(ring.front().packet)) {
+        packets.recycle(ring.front().packet);
+        ring.pop_front();
+    }
+    // 下一个关键帧已早于窗口起点时，整个最旧的 GOP 都可以丢弃
+    while (true) {
+        auto next_key = std::find_if(ring.begin() + (ring.empty() ? 0 : 1), ring.end(),
+                                     [](const Item& item) { return isKeyframe(item.packet); });
+        if (next_key == ring.end() || micros(*next_key) > newest - pre_event) break;
+        for (auto it = ring.begin(); it != next_key; ++it) packets.recycle(it->packet);
+        ring.erase(ring.begin(), next_key);
+    }
+}
+
+void EventRing::close() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        closed = true;
+        // 正在录制的事件以已有的包结束
+        if (!events.empty()) events.back().complete = true;
+    }
+    condition_v.notify_all();
+    if (flush_thread.joinable()) flush_thread.join();
+    for (Item& item : ring) packets.recycle(item.packet);
+    ring.clear();
+    for (Event& event : events) {
+        for (Item& item : event.items) packets.recycle(item.packet);
+    }
+    events.clear();
+}
+
+void EventRing::flushLoop() {
+    RT::ThreadScope scope("storage");
+    Mp4Writer writer;
+    int part = 0;
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+        condition_v.wait(lock, [this] {
+            return closed || (!events.empty() && (!events.front().items.empty() || events.front().complete));
+        });
+        if (events.empty()) {
+            if (closed) break;
+            continue;
+        }
+
+        // 取出已到达的包后解锁写盘，编码线程可以继续追加
+        std::deque<Item> batch;
+        batch.swap(events.front().items);
+        const bool done = events.front().complete;
+        const std::string path = events.front().path;
+        lock.unlock();
+
+        for (Item& item : batch) {
+            // 事件期间切换了分辨率：从新参数的关键帧开始写入下一个文件
+            if (!writer.isOpen() || writer.format() != item.format) {
+                if (isKeyframe(item.packet)) {
+                    const std::string part_path = part == 0 ? path : path.substr(0, path.size() - 4) + "_" + std::to_string(part) + ".mp4";
+                    if (writer.open(part_path, item.format)) {
+                        part++;
+                    }
+                }
+            }
+            if (writer.isOpen() && writer.format() == item.format) {
+                writer.write(item.packet);
+            }
+            packets.recycle(item.packet);
+        }
+        if (done) {
+            if (writer.isOpen()) std::cout << "Event clip saved into: " << path << std::endl;
+            writer.close();
+            part = 0;
+        }
+
+        lock.lock();
+        if (done) events.pop_front();
+    }
+}
+
+} // namespace LIVE
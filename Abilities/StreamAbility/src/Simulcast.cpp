@@ -0,0 +1,204 @@
+#include "Simulcast.h"
+#include "Runtime.h"
+#include <algorithm>
+#include <iostream>
+
+namespace LIVE {
+
+Simulcast::Simulcast(std::vector<Rendition> renditions, const std::string& format, size_t queue_capacity)
+    : renditions(std::move(renditions)) {
+    // 降采样链要求逐级变小
+    std::stable_sort(this->renditions.begin(), this->renditions.end(), [](const Rendition& a, const Rendition& b) {
+        return a.width * a.height > b.width * b.height;
+    });
+    for (const Rendition& r : this->renditions) {
+        streamers.push_back(std::make_unique<Streamer>(r.url, r.width, r.height, r.fps, format, queue_capacity));
+        streamers.back()->setBitrate(r.bitrate);
+    }
+    sws_contexts.assign(this->renditions.size(), nullptr);
+    frames.resize(this->renditions.size() * FRAME_SLOTS);
+    next_slot.assign(this->renditions.size(), 0);
+}
+
+Simulcast::~Simulcast() {
+    stop();
+    for (SwsContext* ctx : sws_contexts) {
+        if (ctx) sws_freeContext(ctx);
+    }
+}
+
+bool Simulcast::init() {
+    for (size_t i = 0; i < streamers.size(); ++i) {
+        if (!streamers[i]->init()) {
+            std::cerr << "联播第 " << i << " 路初始化失败: " << renditions[i].url << std::endl;
+            return false;
+        }
+    }
+    convert_thread = std::thread(&Simulcast::convertLoop, this);
+    return true;
+}
+
+void Simulcast::pushFrame(const cv::Mat& frame, const cv::Rect& roi, Clock::time_point timestamp) {
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        if (has_pending) frames_skipped++;
+        pending_image = frame;
+        pending_roi = roi;
+        pending_timestamp = timestamp;
+        has_pending = true;
+    }
+    pending_cv.notify_one();
+}
+
+void Simulcast::attachMetadata(Clock::time_point timestamp, uint32_t sequence, const std::vector<Detection>& detections) {
+    for (const auto& streamer : streamers) {
+        streamer->attachMetadata(timestamp, sequence, detections);
+    }
+}
+
+std::vector<RenditionStats> Simulcast::stats() const {
+    std::vector<RenditionStats> result;
+    for (size_t i = 0; i < streamers.size(); ++i) {
+        result.push_back({renditions[i].url, streamers[i]->stats()});
+    }
+    return result;
+}
+
+uint64_t Simulcast::framesSkipped() const {
+    std::lock_guard<std::mutex> lock(pending_mutex);
+    return frames_skipped;
+}
+
+uint64_t Simulcast::framesDropped() const {
+    std::lock_guard<std::mutex> lock(pending_mutex);
+    return frames_dropped;
+}
+
+void Simulcast::convertLoop() {
+    RT::ThreadScope scope("convert");
+    while (true) {
+        cv::Mat image;
+        cv::Rect roi;
+        Clock::time_point timestamp;
+        {
+            std::unique_lock<std::mutex> lock(pending_mutex);
+            pending_cv.wait(lock, [this] { return has_pending || stopping; });
+            if (stopping) break;
+            image = std::move(pending_image);
+            roi = pending_roi;
+            timestamp = pending_timestamp;
+            has_pending = false;
+        }
+        convert(image, roi, timestamp);
+    }
+}
+
+void Simulcast::convert(const cv::Mat& image, const cv::Rect& roi, Clock::time_point timestamp) {
+    if (image.empty() || image.type() != CV_8UC3 || roi.empty() || (roi & cv::Rect(0, 0, image.cols, image.rows)) != roi) {
+        std::cout << "联播输入帧无效，跳过！" << std::endl;
+        return;
+    }
+
+    // 由各路推流器按当前档位帧率决定本帧送给哪些路；
+    // 低一级由高一级派生，某一路不送但更低的路需要时仍要转换
+    const size_t n = renditions.size();
+    due.assign(n, 0);
+    needed.assign(n, 0);
+    for (size_t i = 0; i < n; ++i) {
+        due[i] = streamers[i]->admitFrame(timestamp);
+    }
+    bool any = false;
+    for (size_t i = n; i-- > 0;) {
+        any = any || due[i];
+        needed[i] = any;
+    }
+
+    const AVFrame* previous = nullptr;
+    for (size_t i = 0; i < n && needed[i]; ++i) {
+        const Rendition& r = renditions[i];
+        const AVFrame* yuv;
+        if (previous && previous->width == r.width && previous->height == r.height) {
+            // 与上一级同尺寸（仅帧率/码率不同）：共享同一份缓冲
+            yuv = previous;
+        }
+        else {
+            AVFrame* target = writableFrame(i);
+            if (target == nullptr) {
+                std::cerr << "联播帧缓冲分配失败！" << std::endl;
+                return;
+            }
+            if (i == 0) {
+                // 裁剪 + 缩放 + BGR->YUV420P，一次完成
+                sws_contexts[i] = sws_getCachedContext(sws_contexts[i], roi.width, roi.height, AV_PIX_FMT_BGR24,
+                                                       r.width, r.height, AV_PIX_FMT_YUV420P,
+                                                       SWS_BILINEAR, nullptr, nullptr, nullptr);
+                if (sws_contexts[i] == nullptr) {
+                    std::cerr << "联播像素格式转换上下文初始化失败！" << std::endl;
+                    return;
+                }
+                const uint8_t* src_data[1] = { image.ptr(roi.y) + roi.x * image.elemSize() };
+                const int src_linesize[1] = { static_cast<int>(image.step) };
+                sws_scale(sws_contexts[i], src_data, src_linesize, 0, roi.height, target->data, target->linesize);
+            }
+            else {
+                // YUV 平面直接缩小，不再经过 BGR
+                sws_contexts[i] = sws_getCachedContext(sws_contexts[i], previous->width, previous->height, AV_PIX_FMT_YUV420P,
+                                                       r.width, r.height, AV_PIX_FMT_YUV420P,
+                                                       SWS_AREA, nullptr, nullptr, nullptr);
+                if (sws_contexts[i] == nullptr) {
+                    std::cerr << "联播降采样上下文初始化失败！" << std::endl;
+                    return;
+                }
+                sws_scale(sws_contexts[i], previous->data, previous->linesize, 0, previous->height, target->data, target->linesize);
+            }
+            yuv = target;
+        }
+
+        if (due[i]) {
+            // 编码线程只增加缓冲的引用计数，编码完成后该帧重新可写
+            AVFramePtr shared(av_frame_clone(yuv));
+            if (shared) {
+                streamers[i]->pushFrame(std::move(shared), timestamp);
+            }
+            else {
+                std::lock_guard<std::mutex> lock(pending_mutex);
+                frames_dropped++;
+            }
+        }
+        previous = yuv;
+    }
+}
+
+AVFrame* Simulcast::writableFrame(size_t index) {
+    for (size_t k = 0; k < FRAME_SLOTS; ++k) {
+        AVFrame* frame = frames[index * FRAME_SLOTS + k].get();
+        if (frame && av_frame_is_writable(frame)) return frame;
+    }
+    // 首次使用或各帧都还在编码线程手里：另分配缓冲，旧缓冲在编码线程释放引用时回收
+    AVFramePtr& slot = frames[index * FRAME_SLOTS + next_slot[index]];
+    next_slot[index] = (next_slot[index] + 1) % FRAME_SLOTS;
+    if (slot) {
+        av_frame_unref(slot.get());
+    }
+    else {
+        slot.reset(av_frame_alloc());
+        if (!slot) return nullptr;
+    }
+    slot->format = AV_PIX_FMT_YUV420P;
+    slot->width = renditions[index].width;
+    slot->height = renditions[index].height;
+    if (av_frame_get_buffer(slot.get(), 32) < 0) return nullptr;
+    return slot.get();
+}
+
+void Simulcast::stop() {
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        stopping = true;
+    }
+    pending_cv.notify_all();
+    if (convert_thread.joinable()) convert_thread.join();
+    // 各路 Streamer 析构时停止各自的编码与封装线程
+}
+
+} // namespace LIVE
@@ -0,0 +1,53 @@
+#ifndef OVERLAY_H
+#define OVERLAY_H
+
+#include "ONNX.h"
+#include <string>
+#include <vector>
+
+// 检测结果叠加：只为请求叠加的输出（显示窗口）创建与绘制，无显示时完全不参与。
+// 类别名与置信度数字在构造时渲染成单通道字形遮罩（图集），逐帧只做矩形填充与按遮罩着色，
+// 不再对每个目标调用 getTextSize / putText
+namespace OVERLAY {
+    class LabelAtlas {
+    public:
+        LabelAtlas(const std::vector<std::string>& classNames, double fontScale);
+
+        // 所有遮罩同高，非零像素为字形
+        [[nodiscard]] const cv::Mat& name(int classId) const;
+        [[nodiscard]] const cv::Mat& digit(int value) const { return digits[value]; }
+        [[nodiscard]] const cv::Mat& percent() const { return percent_sign; }
+        [[nodiscard]] int height() const { return line_height; }
+
+    private:
+        [[nodiscard]] cv::Mat render(const std::string& text) const;
+
+        double font_scale;
+        int line_height = 0;
+        int baseline = 0;
+        std::vector<cv::Mat> names;
+        cv::Mat unknown;                    // 类别编号越界时
+        cv::Mat digits[10];
+        cv::Mat percent_sign;
+    };
+
+    class Compositor {
+    public:
+        Compositor(const std::vector<std::string>& classNames, double fontScale);
+
+        // detections 为 canvas 坐标：画框，并在框的左上角贴出 "类别 置信度%" 标签
+        void render(cv::Mat& canvas, const std::vector<ONNX::OutputDet>& detections) const;
+        [[nodiscard]] const cv::Scalar& color(int classId) const;
+
+    private:
+        // mask 贴到 at 处，超出画布的部分不画
+        static void blit(cv::Mat& canvas, const cv::Mat& mask, cv::Point at, const cv::Scalar& color);
+
+        LabelAtlas atlas;
+        int padding;
+        std::vector<cv::Scalar> colors;     // 各类别的框与标签底色，按编号确定，每次运行相同
+        std::vector<cv::Scalar> text_colors;
+    };
+}
+
+#endif //OVERLAY_H
@@ -0,0 +1,115 @@
+#include "Overlay.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    constexpr int FONT = cv::FONT_HERSHEY_SIMPLEX;
+    constexpr int LABEL_GAP = 4;        // 类别名与置信度之间的像素
+    constexpr int BOX_THICKNESS = 2;
+
+    // 色相按黄金分割角递增，相邻编号的类别颜色差异大
+    cv::Scalar classColor(size_t index) {
+        const double hue = std::fmod(static_cast<double>(index) * 0.618033988749895, 1.0) * 6.0;
+        const double s = 0.75, v = 0.95;
+        const auto sector = static_cast<int>(hue);
+        const double f = hue - sector;
+        const double p = v * (1 - s), q = v * (1 - s * f), t = v * (1 - s * (1 - f));
+        double r, g, b;
+        switch (sector) {
+            case 0: r = v; g = t; b = p; break;
+            case 1: r = q; g = v; b = p; break;
+            case 2: r = p; g = v; b = t; break;
+            case 3: r = p; g = q; b = v; break;
+            case 4: r = t; g = p; b = v; break;
+            default: r = v; g = p; b = q; break;
+        }
+        return {b * 255, g * 255, r * 255};
+    }
+}
+
+OVERLAY::LabelAtlas::LabelAtlas(const std::vector<std::string>& classNames, double fontScale) : font_scale(fontScale) {
+    // 按含上下伸部的字符确定统一行高，各遮罩可直接并排拼接
+    const cv::Size extent = cv::getTextSize("Agjy%0", FONT, font_scale, 1, &baseline);
+    line_height = extent.height + baseline;
+    names.reserve(classNames.size());
+    for (const auto& className : classNames) {
+        names.push_back(render(className));
+    }
+    unknown = render("?");
+    for (int i = 0; i < 10; i++) {
+        digits[i] = render(std::string(1, static_cast<char>('0' + i)));
+    }
+    percent_sign = render("%");
+}
+
+const cv::Mat& OVERLAY::LabelAtlas::name(int classId) const {
+    return classId >= 0 && classId < static_cast<int>(names.size()) ? names[classId] : unknown;
+}
+
+cv::Mat OVERLAY::LabelAtlas::render(const std::string& text) const {
+    int unused;
+    const cv::Size size = cv::getTextSize(text, FONT, font_scale, 1, &unused);
+    cv::Mat mask = cv::Mat::zeros(line_height, std::max(size.width, 1), CV_8UC1);
+    // 不抗锯齿：遮罩只区分有无字形
+    cv::putText(mask, text, cv::Point(0, line_height - baseline), FONT, font_scale, cv::Scalar(255), 1, cv::LINE_8);
+    return mask;
+}
+
+OVERLAY::Compositor::Compositor(const std::vector<std::string>& classNames, double fontScale) :
+    atlas(classNames, fontScale), padding(std::max(2, static_cast<int>(std::lround(fontScale * 4)))) {
+    const size_t count = std::max<size_t>(classNames.size(), 1);
+    for (size_t i = 0; i < count; i++) {
+        colors.push_back(classColor(i));
+        // 浅色底用黑字，深色底用白字
+        const cv::Scalar& c = colors.back();
+        const double luma = 0.114 * c[0] + 0.587 * c[1] + 0.299 * c[2];
+        text_colors.push_back(luma > 140 ? cv::Scalar(0, 0, 0) : cv::Scalar(255, 255, 255));
+    }
+}
+
+const cv::Scalar& OVERLAY::Compositor::color(int classId) const {
+    return colors[static_cast<size_t>(std::max(classId, 0)) % colors.size()];
+}
+
+void OVERLAY::Compositor::blit(cv::Mat& canvas, const cv::Mat& mask, cv::Point at, const cv::Scalar& color) {
+    const cv::Rect target(at, mask.size());
+    const cv::Rect visible = target & cv::Rect(0, 0, canvas.cols, canvas.rows);
+    if (visible.empty()) return;
+    canvas(visible).setTo(color, mask(cv::Rect(visible.x - at.x, visible.y - at.y, visible.width, visible.height)));
+}
+
+void OVERLAY::Compositor::render(cv::Mat& canvas, const std::vector<ONNX::OutputDet>& detections) const {
+    for (const auto& det : detections) {
+        const cv::Scalar& background = color(det.id);
+        const cv::Scalar& foreground = text_colors[static_cast<size_t>(std::max(det.id, 0)) % text_colors.size()];
+        cv::rectangle(canvas, det.box, background, BOX_THICKNESS);
+
+        const int percent = std::clamp(static_cast<int>(std::lround(det.confidence * 100.f)), 0, 100);
+        int digitCount = 0;
+        int value[3];
+        for (int rest = percent; digitCount == 0 || rest > 0; rest /= 10) {
+            value[digitCount++] = rest % 10;
+        }
+        const cv::Mat& name = atlas.name(det.id);
+        int width = 2 * padding + name.cols + LABEL_GAP + atlas.percent().cols;
+        for (int i = 0; i < digitCount; i++) width += atlas.digit(value[i]).cols;
+        const int height = atlas.height() + 2 * padding;
+        if (width > canvas.cols || height > canvas.rows) continue;
+
+        // 标签放在框上方，贴近画面顶部时放进框内
+        const int x = std::clamp(det.box.x, 0, canvas.cols - width);
+        int y = det.box.y - height;
+        if (y < 0) y = std::clamp(det.box.y, 0, canvas.rows - height);
+        canvas(cv::Rect(x, y, width, height)).setTo(background);
+
+        cv::Point at(x + padding, y + padding);
+        blit(canvas, name, at, foreground);
+        at.x += name.cols + LABEL_GAP;
+        for (int i = digitCount - 1; i >= 0; i--) {
+            const cv::Mat& digit = atlas.digit(value[i]);
+            blit(canvas, digit, at, foreground);
+            at.x += digit.cols;
+        }
+        blit(canvas, atlas.percent(), at, foreground);
+    }
+}
@@ -0,0 +1,87 @@
+#include "DetectionLog.h"
+#include <cstdio>
+#include <iostream>
+
+PIPE::DetectionLog::DetectionLog(std::string path, std::vector<std::string> classNames) :
+    path(std::move(path)), class_names(std::move(classNames)) {}
+
+PIPE::DetectionLog::~DetectionLog() {
+    close();
+}
+
+bool PIPE::DetectionLog::open() {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (path == "-") {
+        out = &std::cout;
+        return true;
+    }
+    file.open(path, std::ios::out | std::ios::app);
+    if (!file) {
+        std::cerr << "Failed to open detection log: " << path << std::endl;
+        return false;
+    }
+    out = &file;
+    return true;
+}
+
+void PIPE::DetectionLog::appendEscaped(std::string_view text) {
+    for (const char c : text) {
+        if (c == '"' || c == '\\') line += '\\';
+        if (static_cast<unsigned char>(c) < 0x20) continue;
+        line += c;
+    }
+}
+
+void PIPE::DetectionLog::write(const DetectionRecord& record) {
+    using namespace std::chrono;
+    // 采集时刻换算到系统时间，供没有 steady_clock 基准的程序对齐
+    const auto unixMs = duration_cast<milliseconds>((system_clock::now() - (steady_clock::now() - record.captureTime))
+                                                    .time_since_epoch()).count();
+    char number[64];
+    std::lock_guard<std::mutex> lock(mtx);
+    if (out == nullptr) return;
+    line.assign("{\"source\":\"");
+    appendEscaped(record.source);
+    std::snprintf(number, sizeof(number), "\",\"seq\":%llu,\"t\":%.3f,\"unix_ms\":%lld",
+                  static_cast<unsigned long long>(record.sequence),
+                  duration<double>(record.captureTime.time_since_epoch()).count(), static_cast<long long>(unixMs));
+    line += number;
+    if (record.positioned) {
+        std::snprintf(number, sizeof(number), ",\"lat\":%.7f,\"lon\":%.7f", record.latitude, record.longitude);
+        line += number;
+    }
+    line += ",\"objects\":[";
+    for (size_t i = 0; i < record.objects.size(); i++) {
+        const DetectedObject& object = record.objects[i];
+        line += i == 0 ? "{\"class\":\"" : ",{\"class\":\"";
+        if (object.classId >= 0 && object.classId < static_cast<int>(class_names.size())) {
+            appendEscaped(class_names[object.classId]);
+        }
+        std::snprintf(number, sizeof(number), "\",\"id\":%d,\"conf\":%.3f,", object.classId, object.confidence);
+        line += number;
+        std::snprintf(number, sizeof(number), "\"box\":[%.4f,%.4f,%.4f,%.4f]",
+                      object.box.x, object.box.y, object.box.width, object.box.height);
+        line += number;
+        if (object.near) line += ",\"near\":true";
+        if (object.bearingDeg >= 0.0) {
+            std::snprintf(number, sizeof(number), ",\"bearing\":%.1f", object.bearingDeg);
+            line += number;
+        }
+        line += '}';
+    }
+    line += "]}\n";
+    out->write(line.data(), static_cast<std::streamsize>(line.size()));
+    count++;
+}
+
+void PIPE::DetectionLog::close() {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (out != nullptr) out->flush();
+    out = nullptr;
+    if (file.is_open()) file.close();
+}
+
+uint64_t PIPE::DetectionLog::written() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return count;
+}
@@ -1,186 +1,541 @@
 #include "EchoVision.h"
-#include "DualLensCamera.h"
+#include "Snapshot.h"
 #include "HAL_UART.h"
-
-#include <condition_variable>
+#include "Runtime.h"
+#include "Config.h"
+#include "Pipeline.h"
+#include "DetectorPool.h"
 #include "GNSS.h"
-#include "ONNX.h"
-#include "LiveStream.h"
+#include "MPU6050.h"
+#include "ImuLog.h"
+#include "Record.h"
+#include "Replay.h"
+#include "Fusion.h"
+#include "Alert.h"
+#include "NetworkAbility.h"
+#include "Telemetry.h"
+#include "Governor.h"
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <iomanip>
+#include <map>
 #include <thread>
-#include <queue>
-#include <mutex>
 
-std::queue<cv::Mat> frameQueue;
-std::mutex queueMutex;
-std::condition_variable queueCV;
-bool stopThreads = false;
+// 拍照服务，显示窗口中按 s 对当前帧拍照
+std::unique_ptr<SnapshotService> snapshots;
+// 危险提示：检测线程提交，提示线程按优先级取出
+std::unique_ptr<ALERT::AlertEngine> alerts;
+// 启动时从 YAML 读取的流水线配置，之后只读
+CONFIG::PipelineConfig pipelineConfig;
 
 #define VISUAL
 
-#define CONFIDENCE_THRESHOLD 0.35
-#define IOU_THRESHOLD 0.45
-
-std::string COCO_YAML_PATH = "./coco8.yaml";
-std::string YOLO_MODEL_PATH = "./yolo11n_dynamic.onnx";
-
 HAL::UART::Config config;
 HAL::UART::Uart uart;
+// 所有串口（定位模块、4G 模组）共用一个事件循环线程
+HAL::IO::Reactor reactor;
+HAL::UART::Uart modemUart;
+std::unique_ptr<NET::AtModem> modem;
+// 检测结果、提示与定位的遥测上报，未配置时为空
+std::unique_ptr<NET::TelemetryUplink> telemetry;
+// 最新导航状态可由任意线程无锁读取（gnss.latest()），用于给检测事件标注位置
+GNSS::Location gnss;
+// 六轴 + GNSS 融合，按帧采集时间取位姿
+std::unique_ptr<IMU::ImuSource> imu;
+std::unique_ptr<FUSION::FusionEngine> fusion;
+// 会话记录与回放，二者同时只启用一个
+std::shared_ptr<RECORD::LogWriter> sessionLog;
+std::shared_ptr<RECORD::LogReplay> sessionReplay;
+
+namespace REC {
+    // 须在相机、串口与六轴初始化之前调用
+    static void RecordInit() {
+        const CONFIG::SessionConfig& session = pipelineConfig.session;
+        if (!session.replay.empty()) {
+            auto replay = std::make_shared<RECORD::LogReplay>(session.replay, session.replay_speed);
+            if (!replay->open()) {
+                std::cerr << "Failed to open replay log: " << session.replay << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            sessionReplay = std::move(replay);
+        }
+        else if (!session.record.empty()) {
+            auto writer = std::make_shared<RECORD::LogWriter>(session.record);
+            if (writer->open()) {
+                sessionLog = std::move(writer);
+            }
+            else {
+                std::cerr << "Failed to open session log, recording disabled." << std::endl;
+            }
+        }
+    }
+
+    static void RecordDeinit() {
+        if (sessionReplay) {
+            sessionReplay->stop();
+        }
+        if (sessionLog) {
+            sessionLog->close();
+            std::cout << "Session log: " << sessionLog->written() << " records, " << sessionLog->bytes() << " bytes, "
+                      << sessionLog->dropped() << " dropped." << std::endl;
+        }
+    }
+}
 
 namespace HW {
-    static void HardwareInit() {
-        config.device = "/dev/ttyUSB0";
-        config.baudRate = 115200;
+    static void GnssInit() {
+        // 回放时定位数据来自伪终端，串口读取与解析流程不变
+        config.device = sessionReplay ? sessionReplay->uartDevice(0) : pipelineConfig.devices.gnss;
+        config.baudRate = pipelineConfig.devices.gnss_baud;
         config.parity = 'N';
         config.dataBits = 8;
         config.stopBits = 1;
 
         uart.uartInit(config);
         if (const HAL::HardwareStatus status = uart.uartGetStatus(); status != HAL::HardwareStatus::OK) {
-            std::cerr << "UART initialization failed." << std::endl;
-            exit(EXIT_FAILURE);
+            // 没有定位模块时视觉功能照常运行，只是没有位置信息
+            std::cerr << "UART initialization failed, running without GNSS." << std::endl;
+            return;
+        }
+        if (sessionLog) {
+            gnss.setLineTap([](std::string_view line) {
+                sessionLog->writeLine(RECORD::Clock::now(), line);
+            });
         }
+        gnss.attach(reactor, uart);
     }
 
-    static void HardwareService() {
-        GNSS::Location gnss;
-        gnss.locationService(uart);
+    // 定时查询信号质量，定时器在事件循环线程中重新设置
+    static void ModemPoll() {
+        modem->command("AT+CSQ", [](const NET::AtResponse& response) {
+            if (response.status == NET::AtStatus::OK && !response.lines.empty()) {
+                std::cout << "Modem signal: " << response.lines.front() << std::endl;
+            }
+            else if (response.status == NET::AtStatus::CLOSED) {
+                return;
+            }
+            reactor.reactorAddTimer(std::chrono::seconds(pipelineConfig.devices.modem_poll_seconds), ModemPoll);
+        });
     }
-}
 
-#ifdef __VISUAL
-namespace VS {
-    ONNX::YOLO yolo(YOLO_MODEL_PATH, COCO_YAML_PATH);
-    static void displayVideo(const cv::Mat& frame) {
-        // 分割帧为左右两部分
-        cv::Mat leftFrame = frame(cv::Rect(0, 0, CAM_WIDTH / 2, CAM_HEIGHT));
-        cv::Mat rightFrame = frame(cv::Rect(CAM_WIDTH / 2, 0, CAM_WIDTH / 2, CAM_HEIGHT));
-
-        cv::Mat leftAfterDetect = yolo.yoloDetect(leftFrame);
-        // 水平连接左右两部分
-        cv::Mat mergeFrame;
-        hconcat(leftAfterDetect, rightFrame, mergeFrame);
-
-        cv::resize(mergeFrame, mergeFrame, cv::Size(), 0.67, 0.67);
-        // 显示结果
-        imshow("Dual Lens Camera", mergeFrame);
-        cv::waitKey(1); // 等待1毫秒以更新窗口
+    static void ModemInit() {
+        if (pipelineConfig.devices.modem.empty()) return;
+        HAL::UART::Config modemConfig = config;
+        modemConfig.device = pipelineConfig.devices.modem;
+        if (modemUart.uartInit(modemConfig) != HAL::OK) {
+            std::cerr << "Modem UART initialization failed." << std::endl;
+            return;
+        }
+        modem = std::make_unique<NET::AtModem>(reactor, modemUart);
+        modem->setUrcHandler([](std::string_view line) {
+            std::cout << "Modem: " << line << std::endl;
+        });
+        if (modem->attach() != HAL::OK) {
+            modem.reset();
+            return;
+        }
+        modem->command("ATE0", nullptr);
+        ModemPoll();
     }
-}
-#endif
 
-namespace Camera {
-    static DualLensCamera CameraServiceInit() {
-        DualLensCamera cam(CAM_ID, CAM_WIDTH, CAM_HEIGHT, CAM_FPS);
+    static void TelemetryInit() {
+        const CONFIG::TelemetrySettings& settings = pipelineConfig.telemetry;
+        if (settings.host.empty()) return;
+        NET::TelemetryConfig config;
+        config.transport = settings.transport == "tcp" ? NET::Transport::TCP : NET::Transport::UDP;
+        config.host = settings.host;
+        config.port = static_cast<uint16_t>(settings.port);
+        config.device = static_cast<uint32_t>(settings.device_id);
+        config.batch_bytes = static_cast<size_t>(settings.batch_bytes);
+        config.batch_interval = std::chrono::milliseconds(settings.batch_ms);
+        config.spool_dir = settings.spool_dir;
+        config.spool_bytes = static_cast<uint64_t>(settings.spool_mb) * 1024 * 1024;
+        config.retry_interval = std::chrono::milliseconds(settings.retry_ms);
+        auto uplink = std::make_unique<NET::TelemetryUplink>(config);
+        if (uplink->start()) {
+            telemetry = std::move(uplink);
+        }
+        else {
+            std::cerr << "Telemetry disabled." << std::endl;
+        }
+    }
 
-        if (!cam.isTrueCamera(CAM_WIDTH, CAM_HEIGHT)) {
-            std::cerr << "Camera initialization failed: Invalid camera settings." << std::endl;
-            exit(EXIT_FAILURE);
+    // 主循环中定时调用：取出新的定位历元（历史环形缓冲的唯一消费者），按 fix_interval_ms 抽稀后上报
+    static void TelemetryFixes() {
+        static std::chrono::steady_clock::time_point lastFix;
+        if (!telemetry) return;
+        const auto interval = std::chrono::milliseconds(pipelineConfig.telemetry.fix_interval_ms);
+        GNSS::NavState nav;
+        while (gnss.history().pop(nav)) {
+            if (!nav.valid || nav.received - lastFix < interval) continue;
+            lastFix = nav.received;
+            NET::FixEvent fix;
+            fix.unixMs = NET::unixMs(nav.received);
+            fix.latitude = nav.latitude;
+            fix.longitude = nav.longitude;
+            fix.altitude = nav.altitude;
+            fix.speed = nav.speed;
+            fix.course = nav.course;
+            fix.hdop = nav.hdop;
+            fix.quality = nav.quality;
+            fix.satellites = nav.satellites;
+            telemetry->submit(fix);
         }
-        return cam;
     }
 
-    static int cameraService(const cv::Mat& frame) {
-        DualLensCamera::makeShotFolder(PICTURE_DIR);
-        DualLensCamera::makeShotFolder(VIDEO_DIR);
-        VS::displayVideo(frame);
-        return EXIT_SUCCESS;
+    // 返回 false 表示没有可用的串口设备，不必启动事件循环
+    static bool HardwareInit() {
+        if (reactor.reactorInit() != HAL::OK) {
+            return false;
+        }
+        GnssInit();
+        ModemInit();
+        return reactor.reactorFdCount() > 0;
+    }
+
+    static void HardwareService() {
+        RT::ThreadScope scope("io");
+        reactor.reactorRun();
     }
-}
 
-namespace Stream {
-    static cv::Mat CutFrame(const cv::Mat &frame) {
-        cv::Mat right_frame = frame(cv::Rect(CAM_WIDTH / 2, 0, CAM_WIDTH / 2, CAM_HEIGHT));
-        cv::Mat resized_right;
-        cv::resize(right_frame, resized_right, cv::Size(1280, 720));
-        return resized_right;    // 返回大小为1280x720的右侧图像
+    // 没有 MPU6050 时融合仅用 GNSS
+    static void ImuInit() {
+        if (sessionReplay) {
+            imu = std::make_unique<IMU::LogImuSource>(sessionReplay, IMU::Mpu6050Config{}.sampleRate);
+        }
+        else if (pipelineConfig.session.imu_replay.empty()) {
+            auto mpu = std::make_unique<IMU::MPU6050>();
+            if (mpu->init(IMU::Mpu6050Config{}) == HAL::OK) {
+                imu = std::move(mpu);
+            }
+            else {
+                std::cerr << "MPU6050 initialization failed, fusing GNSS only." << std::endl;
+            }
+        }
+        else {
+            auto replay = std::make_unique<IMU::ImuReplay>(IMU::ReplayConfig{pipelineConfig.session.imu_replay});
+            if (replay->open()) {
+                imu = std::move(replay);
+            }
+        }
+        if (imu && sessionLog) {
+            imu = std::make_unique<IMU::RecordingImuSource>(std::move(imu), sessionLog);
+        }
+        fusion = std::make_unique<FUSION::FusionEngine>(imu.get(), &gnss);
+        fusion->start();
     }
+}
 
-    static LIVE::Streamer StreamServiceInit(const std::string& rtsp_url, int width, int height, int fps) {
-        LIVE::Streamer streamer(rtsp_url, width, height, fps);
-        if (!streamer.init()) {
-            std::cerr << "Failed to initialize streamer." << std::endl;
+#ifdef __VISUAL
+namespace VS {
+    // 所有流水线共享的检测器池
+    std::unique_ptr<ONNX::DetectorPool> detectors;
+
+    static void DetectorInit() {
+        const CONFIG::DetectorConfig& detector = pipelineConfig.detector;
+        ONNX::YOLOConfig config;
+        config.netWidth = detector.input_width;
+        config.netHeight = detector.input_height;
+        config.classThreshold = detector.confidence;
+        config.nmsThreshold = detector.nms_iou;
+        config.intraOpThreads = pipelineConfig.threads.ortThreads;
+        config.intraOpCpus = pipelineConfig.threads.ortCpus;
+        detectors = std::make_unique<ONNX::DetectorPool>(detector.model, detector.classes, config,
+                                                         static_cast<size_t>(detector.instances));
+        if (!detectors->IsLoaded()) {
+            std::cerr << "Failed to load detection model: " << detector.model << std::endl;
             exit(EXIT_FAILURE);
         }
-        return streamer;
     }
 
-    static int StreamService(LIVE::Streamer& streamer , const cv::Mat &frame) {
-        cv::Mat frame1 = CutFrame(frame);
-        streamer.pushFrame(frame1);
-        return EXIT_SUCCESS;
+    // 提示输出：目前打印到终端，语音与震动接入后替换这里
+    static void announce(const ALERT::Alert& alert) {
+        const char* direction = alert.bearing < -1.0f / 6 ? "左侧" : alert.bearing > 1.0f / 6 ? "右侧" : "正前方";
+        const std::vector<std::string>& names = detectors->classNames();
+        const std::string& name = alert.classId >= 0 && alert.classId < static_cast<int>(names.size())
+                                  ? names[alert.classId] : std::to_string(alert.classId);
+        std::cout << "[" << ALERT::levelName(alert.level) << "] " << direction << " " << name;
+        if (alert.distance >= 0.f) std::cout << " " << std::setprecision(2) << alert.distance << "m" << std::setprecision(6);
+        std::cout << std::endl;
     }
 }
+#endif
 
-
-static void captureFrames(DualLensCamera &cam) {
-    while (!stopThreads) {
-        cv::Mat frame;
-        if (!cam.readFrame(frame)) {
-            std::cerr << "Failed to read frame from camera." << std::endl;
-            break;
+namespace PIPE {
+    // 各流水线的节点共用的执行器
+    std::unique_ptr<FLOW::Executor> executor;
+    // 结构化检测结果，未配置时为空
+    std::unique_ptr<DetectionLog> detectionLog;
+    // 温度与期限调节，未启用时为空；只在主循环中轮询
+    std::unique_ptr<GOV::Governor> governor;
+
+    static void DetectionLogInit() {
+        const std::string& path = pipelineConfig.storage.detection_log;
+        if (path.empty()) return;
+        auto log = std::make_unique<DetectionLog>(path, VS::detectors->classNames());
+        if (log->open()) {
+            detectionLog = std::move(log);
         }
-
-        // 将帧加入共享队列
-        {
-            std::lock_guard<std::mutex> lock(queueMutex);
-            frameQueue.push(frame);
+        else {
+            std::cerr << "Detection log disabled." << std::endl;
         }
-        queueCV.notify_all();
     }
-}
 
-static void displayFrames() {
-    while (!stopThreads) {
-        cv::Mat frame;
+    static void GovernorInit() {
+        const CONFIG::GovernorSettings& settings = pipelineConfig.governor;
+        if (!settings.enabled) return;
+        GOV::GovernorConfig config;
+        config.thermal_path = settings.thermal_path;
+        config.interval = std::chrono::milliseconds(settings.interval_ms);
+        config.hot_c = settings.hot_c;
+        config.cool_c = settings.cool_c;
+        config.critical_c = settings.critical_c;
+        config.miss_ratio = settings.miss_ratio;
+        config.deadlines_ms = settings.deadlines_ms;
+        config.down_after = settings.down_after;
+        config.up_after = settings.up_after;
+        config.settle = settings.settle;
+        config.ladder = settings.ladder;
+        config.state_file = settings.state_file;
+        governor = std::make_unique<GOV::Governor>(std::move(config));
+    }
 
-        // 从队列中取出帧用于显示
-        {
-            std::unique_lock<std::mutex> lock(queueMutex);
-            queueCV.wait(lock, [] { return !frameQueue.empty() || stopThreads; });
+    // 网络输入尺寸对所有流水线共用的检测器池生效，其余参数逐条流水线设置
+    static void ApplyOperatingPoint(const std::vector<std::unique_ptr<Pipeline>>& pipelines) {
+        static bool resizeWarned = false;
+        const GOV::OperatingPoint& point = governor->point();
+        const CONFIG::DetectorConfig& detector = pipelineConfig.detector;
+        const cv::Size netSize = point.input_width > 0 ? cv::Size(point.input_width, point.input_height)
+                                                       : cv::Size(detector.input_width, detector.input_height);
+        if (netSize != VS::detectors->netSize() && !VS::detectors->setNetSize(netSize) && !resizeWarned) {
+            resizeWarned = true;
+            std::cerr << "Governor: model input size is fixed, keeping " << detector.input_width << "x" << detector.input_height << "." << std::endl;
+        }
+        for (const auto& pipeline : pipelines) {
+            pipeline->setOperatingPoint(point);
+        }
+    }
 
-            if (stopThreads && frameQueue.empty()) break;
+    // 采集节点等待相机、检测节点等待推理时都占着执行器线程，
+    // 自动确定时保证每条流水线的这两个节点同时阻塞后仍有线程处理推流与显示
+    static size_t ExecutorWorkers(size_t pipelines) {
+        if (pipelineConfig.threads.flowWorkers > 0) return static_cast<size_t>(pipelineConfig.threads.flowWorkers);
+        return std::max<size_t>(std::thread::hardware_concurrency(), 2 * pipelines + 1);
+    }
 
-            frame = frameQueue.front();
-            frameQueue.pop();
+    // 每个输入源一条流水线。回放源按日志路径共用回放器（与 session.replay 相同的即会话回放器），
+    // 回放器在所有流水线初始化之后统一启动
+    static std::vector<std::unique_ptr<Pipeline>> PipelinesInit(std::vector<std::shared_ptr<RECORD::LogReplay>>& replays) {
+        const std::vector<CONFIG::SourceConfig> sources = CONFIG::resolveSources(pipelineConfig);
+        executor = std::make_unique<FLOW::Executor>(ExecutorWorkers(sources.size()));
+        SharedServices shared;
+        shared.config = &pipelineConfig;
+        shared.executor = executor.get();
+        shared.detectors = VS::detectors.get();
+        shared.alerts = alerts.get();
+        shared.fusion = fusion.get();
+        shared.snapshots = snapshots.get();
+        shared.detectionLog = detectionLog.get();
+        shared.telemetry = telemetry.get();
+        shared.governor = governor.get();
+        shared.sessionLog = sessionLog;
+
+        std::map<std::string, std::shared_ptr<RECORD::LogReplay>> opened;
+        if (sessionReplay) {
+            opened[pipelineConfig.session.replay] = sessionReplay;
+            replays.push_back(sessionReplay);
+        }
+        std::vector<std::unique_ptr<Pipeline>> pipelines;
+        for (size_t i = 0; i < sources.size(); i++) {
+            const CONFIG::SourceConfig& source = sources[i];
+            std::shared_ptr<RECORD::LogReplay> replay;
+            if (!source.replay.empty()) {
+                auto& entry = opened[source.replay];
+                if (!entry) {
+                    entry = std::make_shared<RECORD::LogReplay>(source.replay, pipelineConfig.session.replay_speed);
+                    if (!entry->open()) {
+                        std::cerr << "Failed to open replay log: " << source.replay << std::endl;
+                        exit(EXIT_FAILURE);
+                    }
+                    replays.push_back(entry);
+                }
+                replay = entry;
+            }
+            auto pipeline = std::make_unique<Pipeline>(source, static_cast<uint16_t>(i), shared);
+            if (!pipeline->init(replay)) {
+                exit(EXIT_FAILURE);
+            }
+            pipelines.push_back(std::move(pipeline));
         }
+        return pipelines;
+    }
 
-        // 显示帧
-        Camera::cameraService(frame);
+    // nodes 为 true 时附带各节点的执行时间与各边的丢弃数（退出时）
+    static void report(const std::vector<std::unique_ptr<Pipeline>>& pipelines, bool nodes = false) {
+        std::cout << std::fixed << std::setprecision(1);
+        for (const auto& pipeline : pipelines) {
+            const PipelineStats stats = pipeline->stats();
+            std::cout << "Pipeline " << stats.name << ": captured " << stats.captured << " (" << stats.captureFps << " fps), detected "
+                      << stats.detected << " (" << stats.detectFps << " fps), dropped " << stats.dropped << "; latency p50 "
+                      << stats.p50Ms << "ms p90 " << stats.p90Ms << "ms p99 " << stats.p99Ms << "ms max " << stats.maxMs << "ms" << std::endl;
+            if (!nodes) continue;
+            const FLOW::GraphStats graph = pipeline->graphStats();
+            for (const auto& node : graph.nodes) {
+                std::cout << "  node " << node.name << ": " << node.items << " items, " << node.activations << " activations, "
+                          << node.busyMs << "ms busy" << std::endl;
+            }
+            for (const auto& edge : graph.edges) {
+                std::cout << "  edge " << edge.name << " (" << edge.capacity << "): " << edge.pushed << " pushed, "
+                          << edge.dropped << " dropped" << std::endl;
+            }
+        }
+        if (nodes && executor) {
+            const FLOW::ExecutorStats stats = executor->stats();
+            std::cout << "Executor: " << stats.workers << " workers, " << stats.executed << " tasks, " << stats.stolen << " stolen" << std::endl;
+        }
+        for (const auto& stream : VS::detectors->stats()) {
+            const double avg = stream.inferences ? stream.busyMs / static_cast<double>(stream.inferences) : 0.0;
+            const double wait = stream.inferences ? stream.waitMs / static_cast<double>(stream.inferences) : 0.0;
+            std::cout << "Detector " << stream.name << ": " << stream.inferences << " inferences, " << avg << "ms each, wait avg "
+                      << wait << "ms max " << stream.maxWaitMs << "ms" << std::endl;
+        }
+        std::cout.unsetf(std::ios::floatfield);
+        std::cout << std::setprecision(6);
     }
 }
 
-static void streamFrames(LIVE::Streamer& streamer) {
-    while (!stopThreads) {
-        cv::Mat frame;
-
-        // 从队列中取出帧用于传输
-        {
-            std::unique_lock<std::mutex> lock(queueMutex);
-            queueCV.wait(lock, [] { return !frameQueue.empty() || stopThreads; });
-
-            if (stopThreads && frameQueue.empty()) break;
-
-            frame = frameQueue.front();
-            frameQueue.pop();
+static void alertFrames(const std::atomic<bool>& running) {
+    RT::ThreadScope scope("alert");
+    ALERT::Alert alert;
+    while (running.load(std::memory_order_relaxed)) {
+        // 定时醒来检查停止标志
+        if (alerts->next(alert, std::chrono::milliseconds(200))) {
+            VS::announce(alert);
+            if (telemetry) {
+                telemetry->submit(NET::AlertEvent{NET::unixMs(alert.captureTime), alert.track, alert.classId,
+                                                  static_cast<uint8_t>(alert.level), alert.distance, alert.bearing});
+            }
         }
-
-        // 传输视频帧
-        Stream::StreamService(streamer, frame);
     }
 }
 
+// 先填入平台默认值，再由配置文件覆盖；默认路径的文件不存在时全部使用默认值
+static bool ConfigInit(int argc, char** argv) {
+    pipelineConfig.camera.device = CAM_ID;
+    const std::string path = argc > 1 ? argv[1] : DEFAULT_CONFIG_PATH;
+    if (argc <= 1 && !std::filesystem::exists(path)) {
+        std::cout << "No config file, using built-in defaults." << std::endl;
+        return CONFIG::validate(pipelineConfig);
+    }
+    if (!CONFIG::load(path, pipelineConfig)) {
+        return false;
+    }
+    std::cout << "Config " << path << ": camera " << pipelineConfig.camera.width << "x" << pipelineConfig.camera.height
+              << "@" << pipelineConfig.camera.fps << ", detector " << pipelineConfig.detector.input_width << "x"
+              << pipelineConfig.detector.input_height << ", " << pipelineConfig.stream.renditions.size() << " renditions"
+              << (CONFIG::headless(pipelineConfig) ? ", headless" : "") << std::endl;
+    return true;
+}
 
-static void IoTMainTaskEntry() {
-    auto cam = Camera::CameraServiceInit();
-    auto streamer = Stream::StreamServiceInit("rtsp://127.0.0.1:8554/camera_test", 1280, 720, 30);
-    // 创建捕获线程、显示线程和传输线程
-    std::thread captureThread(captureFrames, std::ref(cam));
-    std::thread displayThread(displayFrames);
-    std::thread streamThread(streamFrames, std::ref(streamer));
-
-    captureThread.join();
-    displayThread.join();
-    streamThread.join();
+static int IoTMainTaskEntry(int argc, char** argv) {
+    if (!ConfigInit(argc, argv)) {
+        std::cerr << "Invalid configuration, exiting." << std::endl;
+        return EXIT_FAILURE;
+    }
+    // 须在创建任何线程（包括推流器与录像的内部线程）之前设置
+    RT::configure(pipelineConfig.threads);
+    ALERT::AlertConfig alertConfig;
+    alertConfig.latency_budget = std::chrono::milliseconds(pipelineConfig.alert.latency_budget_ms);
+    alertConfig.repeat_interval = std::chrono::milliseconds(pipelineConfig.alert.repeat_interval_ms);
+    alertConfig.max_pending = pipelineConfig.queues.alert_pending;
+    alerts = std::make_unique<ALERT::AlertEngine>(alertConfig);
+    VS::DetectorInit();
+    REC::RecordInit();
+    snapshots = std::make_unique<SnapshotService>(pipelineConfig.storage.picture_dir, 2, 90, pipelineConfig.queues.snapshot_pending);
+    PIPE::DetectionLogInit();
+    HW::TelemetryInit();
+    PIPE::GovernorInit();
+    // 串口事件循环只在有设备时启动
+    std::thread ioThread;
+    if (HW::HardwareInit()) {
+        ioThread = std::thread(HW::HardwareService);
+    }
+    HW::ImuInit();
+    std::vector<std::shared_ptr<RECORD::LogReplay>> replays;
+    std::vector<std::unique_ptr<PIPE::Pipeline>> pipelines = PIPE::PipelinesInit(replays);
+    for (const auto& replay : replays) {
+        replay->start();
+    }
+    // 各流水线的节点在执行器上运行，提示线程共用
+    for (const auto& pipeline : pipelines) {
+        if (!pipeline->start()) {
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (PIPE::governor) PIPE::ApplyOperatingPoint(pipelines);
+    std::atomic<bool> alertRunning{true};
+    std::thread alertThread(alertFrames, std::cref(alertRunning));
+
+    // 所有流水线的相机断开或回放结束后退出，期间定时报告各路帧率与延迟
+    auto lastReport = PIPE::Clock::now();
+    while (!std::all_of(pipelines.begin(), pipelines.end(), [](const auto& pipeline) { return pipeline->finished(); })) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        HW::TelemetryFixes();
+        if (PIPE::governor && PIPE::governor->poll()) {
+            const GOV::GovernorState state = PIPE::governor->state();
+            std::cout << "Governor: level " << state.level << " '" << state.name << "' (" << state.reason;
+            if (!std::isnan(state.temperature_c)) std::cout << ", " << std::setprecision(3) << state.temperature_c << "C" << std::setprecision(6);
+            if (!state.worst_stage.empty()) std::cout << ", " << state.worst_stage << " misses " << static_cast<int>(state.worst_miss_ratio * 100) << "%";
+            std::cout << ")" << std::endl;
+            PIPE::ApplyOperatingPoint(pipelines);
+        }
+        if (PIPE::Clock::now() - lastReport >= std::chrono::seconds(STATS_REPORT_SECONDS)) {
+            lastReport = PIPE::Clock::now();
+            PIPE::report(pipelines);
+        }
+    }
+    for (const auto& pipeline : pipelines) {
+        pipeline->join();
+    }
+    PIPE::executor->stop();
+    alertRunning.store(false, std::memory_order_relaxed);
+    alerts->stop();
+    alertThread.join();
+    fusion->stop();
+    if (ioThread.joinable()) {
+        reactor.reactorStop();
+        ioThread.join();
+    }
+    for (const auto& replay : replays) {
+        if (replay != sessionReplay) replay->stop();
+    }
+    REC::RecordDeinit();
+    if (PIPE::detectionLog) {
+        PIPE::detectionLog->close();
+        std::cout << "Detection log: " << PIPE::detectionLog->written() << " frames." << std::endl;
+    }
+    if (telemetry) {
+        // 封存最后一批，发不出的留在缓存目录，下次启动时补发
+        telemetry->stop();
+        const NET::TelemetryStats stats = telemetry->stats();
+        std::cout << "Telemetry: " << stats.events << " events in " << stats.batches << " batches, " << stats.sent << " sent ("
+                  << stats.sent_bytes << " bytes, " << stats.resent << " from spool), " << stats.spooled << " spooled, "
+                  << stats.dropped << " dropped, " << stats.pending_spool << " left in spool." << std::endl;
+    }
+    PIPE::report(pipelines, true);
+    if (PIPE::governor) {
+        const GOV::GovernorState state = PIPE::governor->state();
+        std::cout << "Governor: ended at level " << state.level << " '" << state.name << "', " << state.steps_down << " steps down, "
+                  << state.steps_up << " steps up." << std::endl;
+    }
+    const ALERT::AlertStats alertStats = alerts->stats();
+    std::cout << "Alerts: " << alertStats.issued << " issued, " << alertStats.suppressed << " suppressed, "
+              << alertStats.deadline_dropped << " late, " << alertStats.overflow_dropped << " overflowed; latency p50 "
+              << alertStats.p50_ms << "ms p90 " << alertStats.p90_ms << "ms p99 " << alertStats.p99_ms << "ms max "
+              << alertStats.max_ms << "ms" << std::endl;
+    RT::report(std::cout);
+    return EXIT_SUCCESS;
 }
 
 APP_SERVICE_INIT(IoTMainTaskEntry);
\ No newline at end of file
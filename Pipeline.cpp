@@ -0,0 +1,349 @@
+#include "Pipeline.h"
+#include "Alert.h"
+#include "Fusion.h"
+#include "Overlay.h"
+#include "Record.h"
+#include "Recorder.h"
+#include "Replay.h"
+#include "Simulcast.h"
+#include "Snapshot.h"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+
+PIPE::Pipeline::Pipeline(const CONFIG::SourceConfig& source, uint16_t index, const SharedServices& shared) :
+    source(source), index(index), shared(shared), pool(2 * shared.config->queues.frame_depth + 4),
+    latencies(LATENCY_WINDOW, 0.0), graph(*shared.executor, source.name) {
+    // 单路时保持原来的窗口名
+    window = shared.config->sources.empty() ? "Dual Lens Camera" : "Dual Lens Camera - " + source.name;
+}
+
+// 析构时 Compositor 为完整类型
+PIPE::Pipeline::~Pipeline() {
+    stop();
+    join();
+}
+
+bool PIPE::Pipeline::init(std::shared_ptr<RECORD::LogReplay> replay) {
+    const CONFIG::CameraConfig& config = shared.config->camera;
+    camera = replay ? std::make_unique<DualLensCamera>(std::move(replay), static_cast<uint16_t>(source.channel))
+                    : std::make_unique<DualLensCamera>(source.device, config.width, config.height, config.fps);
+    if (!camera->isTrueCamera(config.width, config.height)) {
+        std::cerr << "Pipeline " << source.name << ": invalid camera settings." << std::endl;
+        return false;
+    }
+    detector_stream = shared.detectors->addStream(source.name);
+    if (shared.governor) {
+        detect_stage = shared.governor->stage("detect");
+        latency_stage = shared.governor->stage("latency");
+    }
+    if (!initStream()) return false;
+    buildGraph();
+    return true;
+}
+
+void PIPE::Pipeline::buildGraph() {
+    const size_t depth = shared.config->queues.frame_depth;
+    detect_edge = &graph.edge<FRAME::FramePtr>("frames->detect", depth, FLOW::DropPolicy::DROP_OLDEST);
+    stream_edge = &graph.edge<FRAME::FramePtr>("frames->stream", depth, FLOW::DropPolicy::DROP_OLDEST);
+    // 同一帧（及其金字塔）由检测与推流共享
+    graph.source<FRAME::FramePtr>("capture", [this](FRAME::FramePtr& frame) { return capture(frame); })
+         .to(*detect_edge)
+         .to(*stream_edge);
+    auto& detectNode = graph.stage<FRAME::FramePtr, Detected>("detect", *detect_edge, [this](FRAME::FramePtr& frame, Detected& result) {
+        return detect(frame, result);
+    });
+    graph.sink<FRAME::FramePtr>("stream", *stream_edge, [this](FRAME::FramePtr& frame) { stream(frame); });
+    // 无显示时不建显示节点，也不生成显示层、不创建合成器
+    if (source.display) {
+        if (shared.config->display.overlay) {
+            compositor = std::make_unique<OVERLAY::Compositor>(shared.detectors->classNames(), shared.config->display.label_scale);
+        }
+        // 显示跟不上时只显示最新的结果；节点不会并发执行，highgui 调用不会重叠
+        display_edge = &graph.edge<Detected>("detect->display", 1, FLOW::DropPolicy::DROP_OLDEST);
+        detectNode.to(*display_edge);
+        graph.sink<Detected>("display", *display_edge, [this](Detected& result) { display(result); });
+    }
+    if (shared.detectionLog || shared.telemetry) {
+        // 写盘慢时丢弃新结果，不阻塞检测
+        log_edge = &graph.edge<Detected>("detect->detections", 16, FLOW::DropPolicy::DROP_NEWEST);
+        detectNode.to(*log_edge);
+        graph.sink<Detected>("detections", *log_edge, [this](Detected& result) { logDetections(result); });
+    }
+}
+
+// 联播：高清一路供网络良好的远程协助，低分辨率低帧率一路作为 4G 信号差时的后备
+bool PIPE::Pipeline::initStream() {
+    const CONFIG::PipelineConfig& config = *shared.config;
+    const CONFIG::StreamConfig& stream = config.stream;
+    std::vector<LIVE::Rendition> renditions;
+    for (const auto& r : stream.renditions) {
+        renditions.push_back({stream.url + source.stream_path + r.path, r.width, r.height, r.fps, r.bitrate});
+    }
+    simulcast = std::make_unique<LIVE::Simulcast>(std::move(renditions), "rtsp", config.queues.stream_packets);
+    LIVE::Streamer& hd = simulcast->rendition(0);
+    // EC200M 4G 上行实测约 0.3~1 Mbit/s 且波动较大：拥塞时先降码率与帧率，再降分辨率
+    LIVE::RateControlConfig rc;
+    for (const auto& rung : stream.rate_ladder) {
+        rc.ladder.push_back({rung.width, rung.height, rung.fps, rung.bitrate});
+    }
+    hd.setRateControl(rc);
+
+    // 录像直接复用高清一路的 H.264 包，不再单独编码；多路时各自写入以流水线名命名的子目录
+    const CONFIG::StorageConfig& storage = config.storage;
+    std::filesystem::path video_dir = storage.video_dir;
+    std::filesystem::path event_dir = storage.event_dir;
+    if (!config.sources.empty()) {
+        video_dir /= source.name;
+        event_dir /= source.name;
+    }
+    auto segments = std::make_shared<LIVE::SegmentRecorder>(video_dir, std::chrono::seconds(storage.segment_seconds),
+                                                            config.queues.recorder_packets);
+    event_ring = std::make_shared<LIVE::EventRing>(event_dir, std::chrono::seconds(storage.pre_event_seconds),
+                                                   std::chrono::seconds(storage.post_event_seconds));
+    if (!segments->start() || !event_ring->start()) {
+        std::cerr << "Pipeline " << source.name << ": failed to initialize recorder." << std::endl;
+        return false;
+    }
+    hd.addSink(segments);
+    hd.addSink(event_ring);
+
+    if (!simulcast->init()) {
+        std::cerr << "Pipeline " << source.name << ": failed to initialize streamer." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool PIPE::Pipeline::start() {
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        started = Clock::now();
+    }
+    return graph.start();
+}
+
+void PIPE::Pipeline::stop() {
+    graph.stop();
+}
+
+void PIPE::Pipeline::setOperatingPoint(const GOV::OperatingPoint& point) {
+    detect_interval_ms.store(point.detect_interval_ms, std::memory_order_relaxed);
+    const int fps = shared.config->camera.fps;
+    const int divisor = point.capture_fps > 0 && point.capture_fps < fps
+                            ? static_cast<int>(std::lround(static_cast<double>(fps) / point.capture_fps)) : 1;
+    capture_divisor.store(std::max(1, divisor), std::memory_order_relaxed);
+    if (simulcast) simulcast->rendition(0).limitRung(static_cast<size_t>(point.stream_rung));
+}
+
+void PIPE::Pipeline::join() {
+    graph.wait();
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    if (stopped <= started) stopped = Clock::now();
+    if (!pool_reported) {
+        pool_reported = true;
+        std::cout << "Pipeline " << source.name << " frame pool: " << pool.size() << " frames, " << pool.misses() << " allocated" << std::endl;
+    }
+}
+
+bool PIPE::Pipeline::capture(FRAME::FramePtr& frame) {
+    // 抽帧：其余帧只从相机取出，不解码也不进入流水线
+    const int divisor = capture_divisor.load(std::memory_order_relaxed);
+    bool ok = true;
+    while (ok && divisor > 1 && read_count++ % static_cast<uint64_t>(divisor) != 0) {
+        ok = camera->skipFrame();
+    }
+    frame = pool.acquire();
+    if (!ok || !camera->readFrame(frame->image)) {
+        // 相机断开或回放结束，检测与推流处理完剩余帧后结束
+        std::cerr << "Pipeline " << source.name << ": failed to read frame from camera." << std::endl;
+        frame.reset();
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        stopped = Clock::now();
+        return false;
+    }
+    frame->reset(sequence++);
+    if (shared.sessionLog) {
+        shared.sessionLog->writeFrame(frame->captureTime, frame->image, index);
+    }
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    captured++;
+    return true;
+}
+
+void PIPE::Pipeline::stream(FRAME::FramePtr& frame) {
+    // 右镜头区域直接交给联播：转换一次后逐级缩小分给各路；
+    // 转换、编码与网络写出都在联播/推流器自己的线程中进行，这里不会被阻塞
+    simulcast->pushFrame(frame->image, frame->rightRoi(), frame->captureTime);
+}
+
+cv::Size PIPE::Pipeline::displaySize(const cv::Rect& full) const {
+    const double scale = shared.config->detector.display_scale;
+    return {static_cast<int>(full.width * scale + 0.5), static_cast<int>(full.height * scale + 0.5)};
+}
+
+bool PIPE::Pipeline::isNear(const ONNX::OutputDet& det, const cv::Rect& left) const {
+    // 检测框越高说明目标越近
+    return det.box.height > shared.config->detector.near_obstacle_ratio * left.height;
+}
+
+bool PIPE::Pipeline::detect(FRAME::FramePtr& frame, Detected& result) {
+    // 推理间隔内的帧不检测，仍照常推流
+    const int interval = detect_interval_ms.load(std::memory_order_relaxed);
+    if (interval > 0 && frame->captureTime - last_inference < std::chrono::milliseconds(interval)) return false;
+    last_inference = frame->captureTime;
+
+    const cv::Rect left = frame->leftRoi();
+    if (source.display) {
+        // 先取显示层，左镜头的网络输入层可由它派生，不必再从原图缩放
+        const cv::Rect full = frame->fullRoi();
+        frame->pyramid.level(full, displaySize(full));
+    }
+
+    output.clear();
+    detections.clear();
+    const cv::Mat& netInput = frame->pyramid.level(left, shared.detectors->LetterBoxSize(left.size()));
+    // 只在推理期间占用检测器实例，金字塔缩放与后续处理不占用
+    const Clock::time_point inferStart = Clock::now();
+    const bool ok = shared.detectors->detect(detector_stream, netInput, left.size(), output);
+    if (shared.governor) {
+        shared.governor->record(detect_stage, std::chrono::duration<double, std::milli>(Clock::now() - inferStart).count());
+    }
+    if (ok) {
+        if (source.alerts && shared.alerts) {
+            shared.alerts->submit(frame->captureTime, frame->sequence, output, left.size());
+        }
+        bool near = false;
+        for (const auto& det : output) {
+            detections.push_back({det.id, det.confidence,
+                                  cv::Rect2f(static_cast<float>(det.box.x) / left.width, static_cast<float>(det.box.y) / left.height,
+                                             static_cast<float>(det.box.width) / left.width, static_cast<float>(det.box.height) / left.height)});
+            near = near || isNear(det, left);
+        }
+        if (near && event_ring) {
+            event_ring->trigger("obstacle");
+        }
+    }
+    const double latency = std::chrono::duration<double, std::milli>(Clock::now() - frame->captureTime).count();
+    if (shared.governor) shared.governor->record(latency_stage, latency);
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        detected++;
+        latencies[latency_next] = latency;
+        latency_next = (latency_next + 1) % LATENCY_WINDOW;
+    }
+    // 检测结果不画进推流画面，以 SEI 随视频发送，由观看端绘制
+    simulcast->attachMetadata(frame->captureTime, static_cast<uint32_t>(frame->sequence), detections);
+
+    // 没有下游节点时不复制结果
+    if (display_edge == nullptr && log_edge == nullptr) return false;
+    // 交换而不复制：result 由图回收时保留容量，两个缓冲轮流使用
+    result.frame = frame;
+    std::swap(result.output, output);
+    return true;
+}
+
+void PIPE::Pipeline::display(Detected& result) {
+    // 金字塔层只读，绘制前拷贝到复用的画布；显示层已由检测节点生成
+    const cv::Rect full = result.frame->fullRoi();
+    const cv::Size size = displaySize(full);
+    result.frame->pyramid.level(full, size).copyTo(canvas);
+    if (compositor) {
+        // 左镜头原图坐标 -> 显示层坐标（左镜头在拼接画面的左侧，原点相同）
+        const double sx = static_cast<double>(size.width) / full.width;
+        const double sy = static_cast<double>(size.height) / full.height;
+        overlay.clear();
+        for (const auto& det : result.output) {
+            overlay.push_back({det.id, det.confidence,
+                               cv::Rect(static_cast<int>(det.box.x * sx), static_cast<int>(det.box.y * sy),
+                                        static_cast<int>(det.box.width * sx), static_cast<int>(det.box.height * sy))});
+        }
+        compositor->render(canvas, overlay);
+    }
+    // 显示结果
+    cv::imshow(window, canvas);
+    const int key = cv::waitKey(1); // 等待1毫秒以更新窗口
+    if (key == 's' && shared.snapshots) {
+        // 对正在显示的这一帧拍照，编码与写盘都在拍照服务的线程中进行
+        shared.snapshots->request(result.frame->image);
+    }
+}
+
+// 用帧采集时刻的融合位姿给目标定方位：目标方位 = 航向 + 目标在画面中的水平偏角
+void PIPE::Pipeline::logDetections(Detected& result) {
+    if (result.output.empty()) return;
+    const cv::Rect left = result.frame->leftRoi();
+    FUSION::FusedState pose;
+    const bool posed = shared.fusion && shared.fusion->stateAt(result.frame->captureTime, pose);
+    record.source = source.name;
+    record.sequence = result.frame->sequence;
+    record.captureTime = result.frame->captureTime;
+    record.positioned = posed && pose.position_valid;
+    record.latitude = pose.latitude;
+    record.longitude = pose.longitude;
+    record.objects.clear();
+    const double halfFov = std::tan(shared.config->camera.hfov_deg * M_PI / 360.0);
+    for (const auto& det : result.output) {
+        DetectedObject object;
+        object.classId = det.id;
+        object.confidence = det.confidence;
+        object.box = cv::Rect2f(static_cast<float>(det.box.x) / left.width, static_cast<float>(det.box.y) / left.height,
+                                static_cast<float>(det.box.width) / left.width, static_cast<float>(det.box.height) / left.height);
+        object.near = isNear(det, left);
+        if (posed && pose.heading_valid) {
+            const double center = (det.box.x + det.box.width * 0.5) / left.width - 0.5;
+            const double bearing = std::atan(2.0 * center * halfFov);
+            object.bearingDeg = std::fmod((pose.yaw + bearing) * 180.0 / M_PI + 360.0, 360.0);
+        }
+        record.objects.push_back(object);
+    }
+    if (shared.detectionLog) shared.detectionLog->write(record);
+    if (shared.telemetry) {
+        NET::DetectionEvent& event = telemetry_event;
+        event.unixMs = NET::unixMs(record.captureTime);
+        event.source = index;
+        event.sequence = record.sequence;
+        event.positioned = record.positioned;
+        event.latitude = record.latitude;
+        event.longitude = record.longitude;
+        event.objects.clear();
+        for (const auto& object : record.objects) {
+            event.objects.push_back({object.classId, object.confidence, object.box.x, object.box.y, object.box.width,
+                                     object.box.height, object.near, object.bearingDeg});
+        }
+        shared.telemetry->submit(event);
+    }
+}
+
+PIPE::PipelineStats PIPE::Pipeline::stats() const {
+    PipelineStats result;
+    result.name = source.name;
+    std::vector<double> recent;
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        result.captured = captured;
+        result.detected = detected;
+        const Clock::time_point end = stopped > started ? stopped : Clock::now();
+        const double seconds = std::chrono::duration<double>(end - started).count();
+        if (seconds > 0.0) {
+            result.captureFps = static_cast<double>(captured) / seconds;
+            result.detectFps = static_cast<double>(detected) / seconds;
+        }
+        recent.assign(latencies.begin(), latencies.begin() + static_cast<long>(std::min<uint64_t>(detected, LATENCY_WINDOW)));
+    }
+    if (detect_edge == nullptr) return result;
+    result.dropped = detect_edge->stats().dropped + stream_edge->stats().dropped;
+    if (display_edge != nullptr) result.dropped += display_edge->stats().dropped;
+    if (!recent.empty()) {
+        std::sort(recent.begin(), recent.end());
+        auto at = [&recent](double p) {
+            return recent[std::min(recent.size() - 1, static_cast<size_t>(p * static_cast<double>(recent.size())))];
+        };
+        result.p50Ms = at(0.50);
+        result.p90Ms = at(0.90);
+        result.p99Ms = at(0.99);
+        result.maxMs = recent.back();
+    }
+    return result;
+}
@@ -0,0 +1,90 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace BENCH {
+    // 进程内全局的内存分配计数。glibc 下由 Benchmark.cpp 中接管的 malloc 系列函数维护，
+    // 包括 C 库与第三方库（OpenCV、ORT、FFmpeg）的分配；其他平台只统计 operator new
+    uint64_t allocationCount();
+    uint64_t allocationBytes();
+    // 当前线程的分配次数，不受其他线程（ORT 线程池、编码线程等）干扰
+    uint64_t threadAllocationCount();
+
+    enum class AllocationPolicy {
+        REPORT,     // 只统计
+        ZERO,       // 预热之后调用线程每次操作都不得分配内存，否则该项失败，进程以非零退出码结束
+        ZERO_PROCESS,   // 同 ZERO，但统计整个进程：操作由其他线程完成（如执行器上的数据流图）时使用
+    };
+
+    struct Options {
+        int warmup = 20;                 // 预热次数，不计入统计
+        int iterations = 200;            // 计时次数
+        std::string jsonPath;            // 结果输出文件，为空时输出到 stdout
+        std::vector<std::string> inputs; // 位置参数（模型、图片、日志等存储输入）
+    };
+
+    struct Result {
+        std::string name;
+        uint64_t ops = 0;
+        double seconds = 0.0;
+        double opsPerSec = 0.0;
+        double p50Us = 0.0, p90Us = 0.0, p99Us = 0.0, maxUs = 0.0;
+        double allocsPerOp = 0.0;
+        double bytesPerOp = 0.0;
+        double threadAllocsPerOp = 0.0;     // 调用线程自身的分配
+        bool enforced = false;              // 按 AllocationPolicy::ZERO 或 ZERO_PROCESS 检查
+        bool passed = true;
+    };
+
+    // 解析 --warmup N --iterations N --json PATH，其余参数作为输入
+    Options parseArgs(int argc, char** argv);
+
+    class Runner {
+    public:
+        explicit Runner(const Options& options);
+
+        // 对 op 预热后逐次计时，op 每调用一次记为一次操作。
+        // ZERO 用于稳定运行时应当不分配内存的热路径：预热阶段允许分配（缓冲按需增长），计时阶段不允许
+        template <typename Op>
+        const Result& run(const std::string& name, Op&& op, AllocationPolicy policy = AllocationPolicy::REPORT) {
+            for (int i = 0; i < _options.warmup; ++i) op();
+
+            std::vector<double> latencies;
+            latencies.reserve(_options.iterations);
+            const uint64_t allocs = allocationCount();
+            const uint64_t bytes = allocationBytes();
+            const uint64_t threadAllocs = threadAllocationCount();
+            const auto begin = std::chrono::steady_clock::now();
+            for (int i = 0; i < _options.iterations; ++i) {
+                const auto t0 = std::chrono::steady_clock::now();
+                op();
+                const auto t1 = std::chrono::steady_clock::now();
+                latencies.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+            }
+            const auto end = std::chrono::steady_clock::now();
+            // latencies 已预留容量，计时循环内不会引入额外分配
+            return record(name, latencies, std::chrono::duration<double>(end - begin).count(),
+                          allocationCount() - allocs, allocationBytes() - bytes,
+                          threadAllocationCount() - threadAllocs, policy);
+        }
+
+        // 以 JSON 数组输出全部结果
+        void report() const;
+        // 有按 ZERO 检查而分配了内存的项
+        [[nodiscard]] bool failed() const;
+
+    private:
+        const Result& record(const std::string& name, std::vector<double>& latencies, double seconds,
+                             uint64_t allocs, uint64_t bytes, uint64_t threadAllocs, AllocationPolicy policy);
+
+        Options _options;
+        std::vector<Result> _results;
+    };
+}
+
+#endif //BENCHMARK_H
@@ -0,0 +1,147 @@
+// FLOW 数据流图基准测试：按流水线的形状建图，在执行器上运行各节点
+//   capture ─┬─> detect ─┬─> display
+//            │           └─> detections
+//            └─> stream
+// 每次操作由采集节点送出一帧，检测节点产生与流水线相同类型的结果（帧 + 检测框），等三个终点节点都处理完后返回。
+// 帧、检测结果与各边槽位中的缓冲稳定运行后都应复用：计时阶段整个进程（含执行器线程）不得分配内存
+// 用法: bench_flow [--warmup N] [--iterations N] [--json out.json]
+#include "Benchmark.h"
+#include "Executor.h"
+#include "Frame.h"
+#include "Graph.h"
+#include "ONNX.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+namespace {
+    constexpr int WIDTH = 1280;
+    constexpr int HEIGHT = 480;
+    constexpr size_t FRAME_DEPTH = 2;
+    constexpr size_t LOG_DEPTH = 16;
+    constexpr size_t MAX_DETECTIONS = 16;
+
+    // 与 Pipeline 中检测节点的输出相同
+    struct Detected {
+        FRAME::FramePtr frame;
+        std::vector<ONNX::OutputDet> output;
+
+        void reset() {
+            frame.reset();
+            output.clear();
+        }
+    };
+
+    // 采集节点等待 step 放行一帧（与等待相机相同，占着一个执行器线程），终点节点处理完后计数
+    class Driver {
+    public:
+        // 放行一帧并等待三个终点节点都处理完
+        void step() {
+            std::unique_lock<std::mutex> lock(mtx);
+            permits++;
+            const uint64_t target = consumed + SINKS;
+            cv.notify_all();
+            cv.wait(lock, [&] { return consumed >= target; });
+        }
+
+        bool acquire() {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [&] { return permits > 0 || closing; });
+            if (permits == 0) return false;
+            permits--;
+            return true;
+        }
+
+        void consumedOne() {
+            std::lock_guard<std::mutex> lock(mtx);
+            consumed++;
+            cv.notify_all();
+        }
+
+        void close() {
+            std::lock_guard<std::mutex> lock(mtx);
+            closing = true;
+            cv.notify_all();
+        }
+
+    private:
+        static constexpr uint64_t SINKS = 3;
+
+        std::mutex mtx;
+        std::condition_variable cv;
+        uint64_t permits = 0;
+        uint64_t consumed = 0;
+        bool closing = false;
+    };
+}
+
+int main(int argc, char** argv) {
+    BENCH::Options options = BENCH::parseArgs(argc, argv);
+    BENCH::Runner runner(options);
+
+    FLOW::Executor executor(4);
+    FLOW::Graph graph(executor, "bench");
+    Driver driver;
+    FRAME::FramePool pool(2 * FRAME_DEPTH + 4);
+    {
+        // 终点节点在计数之后才归还帧，下一帧开始时上一帧可能仍被引用：预先建好足够的帧，计时阶段不必再创建
+        std::vector<FRAME::FramePtr> held;
+        for (size_t i = 0; i < 2 * FRAME_DEPTH + 4; i++) {
+            held.push_back(pool.acquire());
+            held.back()->image.create(HEIGHT, WIDTH, CV_8UC3);
+        }
+    }
+    uint64_t sequence = 0;
+    size_t detections = MAX_DETECTIONS;
+    std::vector<ONNX::OutputDet> output;
+    std::atomic<uint64_t> checksum{0};      // 三个终点节点可能同时执行
+
+    auto& detectEdge = graph.edge<FRAME::FramePtr>("frames->detect", FRAME_DEPTH, FLOW::DropPolicy::DROP_OLDEST);
+    auto& streamEdge = graph.edge<FRAME::FramePtr>("frames->stream", FRAME_DEPTH, FLOW::DropPolicy::DROP_OLDEST);
+    auto& displayEdge = graph.edge<Detected>("detect->display", 1, FLOW::DropPolicy::DROP_OLDEST);
+    auto& logEdge = graph.edge<Detected>("detect->detections", LOG_DEPTH, FLOW::DropPolicy::DROP_NEWEST);
+    graph.source<FRAME::FramePtr>("capture", [&](FRAME::FramePtr& frame) {
+        if (!driver.acquire()) return false;
+        frame = pool.acquire();
+        frame->image.create(HEIGHT, WIDTH, CV_8UC3);
+        frame->reset(sequence++);
+        return true;
+    }).to(detectEdge).to(streamEdge);
+    // 检测框数量逐帧变化，与 Pipeline::detect 一样交换而不复制结果
+    graph.stage<FRAME::FramePtr, Detected>("detect", detectEdge, [&](FRAME::FramePtr& frame, Detected& result) {
+        output.clear();
+        for (size_t i = 0; i < detections; i++) {
+            output.push_back({static_cast<int>(i), 0.5f, cv::Rect(static_cast<int>(i) * 8, 0, 32, 64)});
+        }
+        result.frame = frame;
+        std::swap(result.output, output);
+        return true;
+    }).to(displayEdge).to(logEdge);
+    graph.sink<FRAME::FramePtr>("stream", streamEdge, [&](FRAME::FramePtr& frame) {
+        checksum.fetch_add(frame->sequence, std::memory_order_relaxed);
+        driver.consumedOne();
+    });
+    graph.sink<Detected>("display", displayEdge, [&](Detected& result) {
+        checksum.fetch_add(result.output.size(), std::memory_order_relaxed);
+        driver.consumedOne();
+    });
+    graph.sink<Detected>("detections", logEdge, [&](Detected& result) {
+        checksum.fetch_add(result.output.size(), std::memory_order_relaxed);
+        driver.consumedOne();
+    });
+    if (!graph.start()) return EXIT_FAILURE;
+
+    // 先以最多的检测框数走满各边的槽位，之后所有轮转的缓冲都已有足够容量
+    for (size_t i = 0; i < 2 * (LOG_DEPTH + FRAME_DEPTH); i++) driver.step();
+    runner.run("flow/frame", [&] {
+        detections = static_cast<size_t>(sequence % (MAX_DETECTIONS + 1));
+        driver.step();
+    }, BENCH::AllocationPolicy::ZERO_PROCESS);
+
+    driver.close();
+    graph.wait();
+    executor.stop();
+    std::cerr << "checksum " << checksum.load() << std::endl;
+    runner.report();
+    return runner.failed() ? EXIT_FAILURE : EXIT_SUCCESS;
+}
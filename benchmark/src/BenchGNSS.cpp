@@ -0,0 +1,118 @@
+// HAL::UART 行分帧 + GNSS::NmeaParser 解析基准测试
+// 用法: bench_gnss [--warmup N] [--iterations N] [--json out.json] [nmea.log]
+//   串口由伪终端代替：写线程向主端回放 NMEA 日志，Uart 从从端按行读取
+#include "Benchmark.h"
+#include "GNSS.h"
+#include "HAL_UART.h"
+#include <fstream>
+#include <thread>
+
+static const std::vector<std::string> SAMPLE_NMEA = {
+    "$GNGGA,023634.00,3443.85620,N,11339.47258,E,1,12,0.80,112.4,M,-15.2,M,,*68",
+    "$GNRMC,023634.00,A,3443.85620,N,11339.47258,E,0.215,87.50,190326,,,A*4F",
+    "$GNGGA,023635.00,3443.85631,N,11339.47266,E,1,12,0.80,112.6,M,-15.2,M,,*66",
+    "$GNRMC,023635.00,A,3443.85631,N,11339.47266,E,0.187,88.10,190326,,,A*40",
+    "$GNGSA,A,3,05,13,15,18,24,,,,,,,,1.45,0.80,1.21,1*07",
+    "$GPGSV,3,1,11,05,62,310,45,13,40,052,42,15,28,221,38,18,55,096,44,1*61",
+    "$BDGSV,2,1,07,06,45,120,40,09,33,200,37,16,70,300,43,21,12,040,,1*7E",
+    "$GNVTG,87.50,T,,M,0.215,N,0.398,K,A*1D",
+};
+
+static std::vector<std::string> LoadLines(const std::string& path) {
+    std::vector<std::string> lines;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!line.empty()) lines.push_back(line);
+    }
+    return lines;
+}
+
+int main(int argc, char** argv) {
+    BENCH::Options options = BENCH::parseArgs(argc, argv);
+    std::vector<std::string> lines = options.inputs.empty() ? SAMPLE_NMEA : LoadLines(options.inputs.front());
+    if (lines.empty()) {
+        std::cerr << "No NMEA sentences to replay." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    BENCH::Runner runner(options);
+    size_t next = 0;
+
+    GNSS::NmeaParser parser;
+    GNSS::Sentence sentence;
+
+    // 纯解析：输入已在内存中
+    runner.run("gnss/parse", [&] {
+        parser.parse(lines[next], sentence);
+        next = (next + 1) % lines.size();
+    });
+
+    // 解析 + 历元合并 + 发布；历史缓冲无人消费，满后只计入丢弃
+    GNSS::Location gnss;
+    runner.run("gnss/handle_line", [&] {
+        gnss.handleLine(lines[next]);
+        next = (next + 1) % lines.size();
+    });
+    // 视觉线程读取最新导航状态的代价
+    volatile double sink = 0.0;
+    runner.run("gnss/latest", [&] {
+        const GNSS::NavState state = gnss.latest();
+        sink = state.latitude;
+    });
+
+    // 伪终端代替真实串口
+    HAL::UART::PseudoTerminal pty;
+    if (pty.ptyInit() != HAL::OK) {
+        std::cerr << "Failed to create pseudo-terminal." << std::endl;
+        return EXIT_FAILURE;
+    }
+    HAL::UART::Config config;
+    config.device = pty.ptyDevice();
+    config.baudRate = 115200;
+    config.parity = 'N';
+    config.dataBits = 8;
+    config.stopBits = 1;
+    HAL::UART::Uart uart;
+    if (uart.uartInit(config) != HAL::OK) {
+        std::cerr << "Failed to open " << config.device << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // 写线程恰好写入读端需要的行数，读完即结束
+    const int total = 3 * (options.warmup + options.iterations);
+    std::thread writer([&] {
+        for (int i = 0; i < total; ++i) {
+            const std::string sentence = lines[i % lines.size()] + "\r\n";
+            if (pty.ptyWrite(sentence) != HAL::OK) return;
+        }
+    });
+
+    // 拷贝为 std::string 的旧接口，对比直接返回缓冲视图的接口
+    runner.run("uart/readline", [&] {
+        std::string line = uart.uartReadLine();
+    });
+    runner.run("uart/readline_view", [&] {
+        std::string_view line;
+        uart.uartReadLine(line, -1);
+    });
+    runner.run("uart/readline+parse", [&] {
+        std::string_view line;
+        if (uart.uartReadLine(line, -1) == HAL::OK) {
+            parser.parse(line, sentence);
+        }
+    });
+
+    writer.join();
+    pty.ptyClose();
+    // 日志中有不被接受的句子时提示，便于区分解析失败与正常的快速路径
+    if (parser.count(GNSS::ParseResult::BadChecksum) + parser.count(GNSS::ParseResult::Malformed) +
+        parser.count(GNSS::ParseResult::Unsupported) > 0) {
+        std::cerr << "Rejected " << parser.count(GNSS::ParseResult::BadChecksum) << " bad-checksum, "
+                  << parser.count(GNSS::ParseResult::Malformed) << " malformed, "
+                  << parser.count(GNSS::ParseResult::Unsupported) << " unsupported sentences." << std::endl;
+    }
+    runner.report();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,190 @@
+#include "Benchmark.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <new>
+
+namespace {
+    std::atomic<uint64_t> g_allocCount{0};
+    std::atomic<uint64_t> g_allocBytes{0};
+    // 只含常量初始化，可执行文件中直接按偏移访问，malloc 内使用不会引起递归
+    thread_local uint64_t t_allocCount = 0;
+
+    inline void countAlloc(std::size_t size) {
+        g_allocCount.fetch_add(1, std::memory_order_relaxed);
+        g_allocBytes.fetch_add(size, std::memory_order_relaxed);
+        t_allocCount++;
+    }
+
+    // 最近邻秩百分位
+    double percentile(const std::vector<double>& sorted, double p) {
+        if (sorted.empty()) return 0.0;
+        auto rank = static_cast<size_t>(p / 100.0 * static_cast<double>(sorted.size()) + 0.5);
+        rank = std::clamp<size_t>(rank, 1, sorted.size());
+        return sorted[rank - 1];
+    }
+}
+
+#ifdef __GLIBC__
+// 接管 malloc 系列函数，转发给 glibc 的内部实现；operator new 与各第三方库的分配都经过这里
+extern "C" {
+    void* __libc_malloc(std::size_t size);
+    void __libc_free(void* p);
+    void* __libc_calloc(std::size_t n, std::size_t size);
+    void* __libc_realloc(void* p, std::size_t size);
+    void* __libc_memalign(std::size_t alignment, std::size_t size);
+
+    void* malloc(std::size_t size) {
+        countAlloc(size);
+        return __libc_malloc(size);
+    }
+    void free(void* p) {
+        __libc_free(p);
+    }
+    void* calloc(std::size_t n, std::size_t size) {
+        countAlloc(n * size);
+        return __libc_calloc(n, size);
+    }
+    void* realloc(void* p, std::size_t size) {
+        countAlloc(size);
+        return __libc_realloc(p, size);
+    }
+    void* memalign(std::size_t alignment, std::size_t size) {
+        countAlloc(size);
+        return __libc_memalign(alignment, size);
+    }
+    void* aligned_alloc(std::size_t alignment, std::size_t size) {
+        countAlloc(size);
+        return __libc_memalign(alignment, size);
+    }
+    int posix_memalign(void** p, std::size_t alignment, std::size_t size) {
+        countAlloc(size);
+        void* r = __libc_memalign(alignment, size);
+        if (r == nullptr) return ENOMEM;
+        *p = r;
+        return 0;
+    }
+}
+#else
+namespace {
+    void* countedAlloc(std::size_t size) {
+        countAlloc(size);
+        if (size == 0) size = 1;
+        if (void* p = std::malloc(size)) return p;
+        throw std::bad_alloc();
+    }
+
+    void* countedAlignedAlloc(std::size_t size, std::align_val_t align) {
+        countAlloc(size);
+        const auto alignment = static_cast<std::size_t>(align);
+        // aligned_alloc 要求 size 为 alignment 的整数倍
+        size = (std::max<std::size_t>(size, 1) + alignment - 1) / alignment * alignment;
+        if (void* p = std::aligned_alloc(alignment, size)) return p;
+        throw std::bad_alloc();
+    }
+}
+
+// 替换全局 operator new/delete，统计每次操作的堆分配次数与字节数
+void* operator new(std::size_t size) { return countedAlloc(size); }
+void* operator new[](std::size_t size) { return countedAlloc(size); }
+void* operator new(std::size_t size, std::align_val_t align) { return countedAlignedAlloc(size, align); }
+void* operator new[](std::size_t size, std::align_val_t align) { return countedAlignedAlloc(size, align); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+#endif
+
+uint64_t BENCH::allocationCount() {
+    return g_allocCount.load(std::memory_order_relaxed);
+}
+
+uint64_t BENCH::allocationBytes() {
+    return g_allocBytes.load(std::memory_order_relaxed);
+}
+
+uint64_t BENCH::threadAllocationCount() {
+    return t_allocCount;
+}
+
+BENCH::Options BENCH::parseArgs(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--warmup" && i + 1 < argc) {
+            options.warmup = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            options.iterations = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--json" && i + 1 < argc) {
+            options.jsonPath = argv[++i];
+        } else {
+            options.inputs.push_back(arg);
+        }
+    }
+    return options;
+}
+
+BENCH::Runner::Runner(const Options& options) : _options(options) {}
+
+const BENCH::Result& BENCH::Runner::record(const std::string& name, std::vector<double>& latencies, double seconds,
+                                           uint64_t allocs, uint64_t bytes, uint64_t threadAllocs,
+                                           AllocationPolicy policy) {
+    std::sort(latencies.begin(), latencies.end());
+    Result result;
+    result.name = name;
+    result.ops = latencies.size();
+    result.seconds = seconds;
+    result.opsPerSec = seconds > 0.0 ? static_cast<double>(result.ops) / seconds : 0.0;
+    result.p50Us = percentile(latencies, 50.0);
+    result.p90Us = percentile(latencies, 90.0);
+    result.p99Us = percentile(latencies, 99.0);
+    result.maxUs = latencies.empty() ? 0.0 : latencies.back();
+    result.allocsPerOp = result.ops ? static_cast<double>(allocs) / static_cast<double>(result.ops) : 0.0;
+    result.bytesPerOp = result.ops ? static_cast<double>(bytes) / static_cast<double>(result.ops) : 0.0;
+    result.threadAllocsPerOp = result.ops ? static_cast<double>(threadAllocs) / static_cast<double>(result.ops) : 0.0;
+    result.enforced = policy != AllocationPolicy::REPORT;
+    const uint64_t counted = policy == AllocationPolicy::ZERO_PROCESS ? allocs : threadAllocs;
+    result.passed = !result.enforced || counted == 0;
+    _results.push_back(result);
+    std::cerr << name << ": " << result.opsPerSec << " ops/s, p50 " << result.p50Us << " us" << std::endl;
+    if (!result.passed) {
+        std::cerr << name << ": " << counted << " allocations in steady state (expected none)" << std::endl;
+    }
+    return _results.back();
+}
+
+void BENCH::Runner::report() const {
+    std::ofstream file;
+    if (!_options.jsonPath.empty()) {
+        file.open(_options.jsonPath);
+        if (!file) {
+            std::cerr << "Failed to open " << _options.jsonPath << ", writing to stdout." << std::endl;
+        }
+    }
+    std::ostream& out = file.is_open() ? static_cast<std::ostream&>(file) : std::cout;
+
+    out << std::fixed << std::setprecision(3) << "[\n";
+    for (size_t i = 0; i < _results.size(); ++i) {
+        const Result& r = _results[i];
+        out << "  {\"name\": \"" << r.name << "\", \"ops\": " << r.ops
+            << ", \"seconds\": " << r.seconds << ", \"ops_per_sec\": " << r.opsPerSec
+            << ", \"latency_us\": {\"p50\": " << r.p50Us << ", \"p90\": " << r.p90Us
+            << ", \"p99\": " << r.p99Us << ", \"max\": " << r.maxUs << "}"
+            << ", \"allocs_per_op\": " << r.allocsPerOp << ", \"bytes_per_op\": " << r.bytesPerOp
+            << ", \"thread_allocs_per_op\": " << r.threadAllocsPerOp
+            << ", \"zero_alloc\": " << (r.enforced ? (r.passed ? "\"pass\"" : "\"fail\"") : "null") << "}"
+            << (i + 1 < _results.size() ? ",\n" : "\n");
+    }
+    out << "]" << std::endl;
+}
+
+bool BENCH::Runner::failed() const {
+    return std::any_of(_results.begin(), _results.end(), [](const Result& r) { return !r.passed; });
+}
@@ -0,0 +1,524 @@
+// 串口、I/O 事件循环、AT 模组与遥测上报的回归检查，不需要任何硬件或后台：
+//   - HAL::UART::Uart：伪终端代替串口，检查分行、跨次读入的半行、超时、超长行与设备关闭
+//   - HAL::IO::Reactor + NET::AtModem：伪终端另一端模拟 4G 模组，检查 OK、+CME ERROR、超时与迟到的结果、
+//     URC 分流、定时器取消、设备关闭，以及空闲时事件循环不被唤醒；GNSS 经同一事件循环按行送达
+//   - NET::TelemetryUplink：本机回环上的 UDP/TCP 接收端逐批解码，检查链路断开时写入缓存、恢复后按序补发，
+//     UDP 对端拒绝或不确认时也写入缓存
+// 每项输出 PASS/FAIL，有失败时以非零退出码结束，可直接用于 CI
+// 用法: check_io
+#include "GNSS.h"
+#include "HAL_Reactor.h"
+#include "HAL_UART.h"
+#include "NetworkAbility.h"
+#include "Telemetry.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <cmath>
+#include <filesystem>
+#include <future>
+#include <thread>
+#include <variant>
+
+namespace {
+    using namespace std::chrono_literals;
+
+    int failures = 0;
+
+    void check(bool ok, const std::string& what) {
+        std::cout << (ok ? "PASS " : "FAIL ") << what << std::endl;
+        if (!ok) failures++;
+    }
+
+    bool openPty(HAL::UART::PseudoTerminal& pty, HAL::UART::Uart& uart) {
+        if (pty.ptyInit() != HAL::OK) return false;
+        HAL::UART::Config config;
+        config.device = pty.ptyDevice();
+        config.baudRate = 115200;
+        config.parity = 'N';
+        config.dataBits = 8;
+        config.stopBits = 1;
+        return uart.uartInit(config) == HAL::OK;
+    }
+
+    // ---------------- Uart ----------------
+
+    void checkUart() {
+        HAL::UART::PseudoTerminal pty;
+        HAL::UART::Uart uart;
+        if (!openPty(pty, uart)) {
+            check(false, "uart: open pseudo-terminal");
+            return;
+        }
+        std::string_view line;
+        check(uart.uartReadLine(line, 50) == HAL::TIMEOUT, "uart: read times out without data");
+
+        // 半行在下一次写入后拼接完整，\r\n 与 \n 都作为行尾
+        pty.ptyWrite("$GNGGA,1");
+        check(uart.uartReadLine(line, 50) == HAL::TIMEOUT, "uart: partial line is not delivered");
+        pty.ptyWrite("23*00\r\nsecond\nthird\r\n");
+        check(uart.uartReadLine(line, 1000) == HAL::OK && line == "$GNGGA,123*00", "uart: partial line joined across reads");
+        check(uart.uartReadLine(line, 1000) == HAL::OK && line == "second", "uart: \\n line ending");
+        check(uart.uartReadLine(line, 1000) == HAL::OK && line == "third", "uart: \\r\\n line ending");
+
+        // 一次读入的多行一批交给回调
+        pty.ptyWrite("a\r\nb\r\nc\r\n");
+        std::this_thread::sleep_for(20ms);
+        std::vector<std::string> batch;
+        uart.uartReadLines([&](HAL::UART::LineBatch lines) {
+            for (std::string_view l : lines) batch.emplace_back(l);
+        }, 1000);
+        check(batch == std::vector<std::string>{"a", "b", "c"}, "uart: lines delivered as one batch");
+
+        // 超过缓冲的行丢弃到下一个换行符，之后的行不受影响
+        const uint64_t overflows = uart.uartOverflows();
+        pty.ptyWrite(std::string(HAL::UART::LINE_BUFFER_SIZE + 100, 'x') + "\r\nafter\r\n");
+        HAL::HardwareStatus status;
+        while ((status = uart.uartReadLine(line, 1000)) == HAL::OK && line != "after") {}
+        check(status == HAL::OK && uart.uartOverflows() == overflows + 1, "uart: overlong line dropped and counted");
+
+        pty.ptyClose();
+        check(uart.uartReadLine(line, 1000) == HAL::ERROR, "uart: closed device reports error");
+    }
+
+    // ---------------- Reactor + AtModem ----------------
+
+    // 模拟 4G 模组的 AT 口：按 \r 切分命令，回显后按命令应答
+    class ModemSimulator {
+    public:
+        explicit ModemSimulator(HAL::UART::PseudoTerminal& pty) : pty(pty), worker(&ModemSimulator::run, this) {}
+        ~ModemSimulator() { stop(); }
+
+        void stop() {
+            running.store(false);
+            if (worker.joinable()) worker.join();
+        }
+
+    private:
+        void reply(const std::string& command) {
+            pty.ptyWrite(command + "\r\n");     // 回显
+            if (command == "AT") {
+                pty.ptyWrite("OK\r\n");
+            }
+            else if (command == "AT+CSQ") {
+                // 应答中间插入一条 URC
+                pty.ptyWrite("+CSQ: 20,99\r\n+QIND: \"csq\",20\r\n\r\nOK\r\n");
+            }
+            else if (command == "AT+CPIN?") {
+                pty.ptyWrite("+CME ERROR: 10\r\n");
+            }
+            else if (command == "AT+SLOW") {
+                // 超过命令期限后才给出最终结果
+                std::this_thread::sleep_for(300ms);
+                pty.ptyWrite("OK\r\n");
+            }
+            // AT+HANG 不应答
+        }
+
+        void run() {
+            std::string pending;
+            while (running.load()) {
+                pollfd pfd{pty.ptyGetFd(), POLLIN, 0};
+                if (poll(&pfd, 1, 20) <= 0) continue;
+                char buffer[256];
+                const ssize_t n = pty.ptyRead(reinterpret_cast<uint8_t*>(buffer), sizeof(buffer));
+                if (n <= 0) continue;
+                pending.append(buffer, static_cast<size_t>(n));
+                size_t end;
+                while ((end = pending.find('\r')) != std::string::npos) {
+                    const std::string command = pending.substr(0, end);
+                    pending.erase(0, end + 1);
+                    reply(command);
+                }
+            }
+        }
+
+        HAL::UART::PseudoTerminal& pty;
+        std::atomic<bool> running{true};
+        std::thread worker;
+    };
+
+    NET::AtResponse runCommand(NET::AtModem& modem, const std::string& command, std::chrono::milliseconds timeout) {
+        auto done = std::make_shared<std::promise<NET::AtResponse>>();
+        std::future<NET::AtResponse> result = done->get_future();
+        modem.command(command, [done](const NET::AtResponse& response) { done->set_value(response); }, timeout);
+        if (result.wait_for(5s) != std::future_status::ready) return {NET::AtStatus::CLOSED, {}, "no callback"};
+        return result.get();
+    }
+
+    // 在事件循环线程中执行并等待完成
+    template <typename F>
+    auto onLoop(HAL::IO::Reactor& reactor, F&& f) {
+        std::packaged_task<decltype(f())()> task(std::forward<F>(f));
+        auto result = task.get_future();
+        reactor.reactorPost([&task] { task(); });
+        result.wait();
+        return result.get();
+    }
+
+    void checkReactor() {
+        HAL::IO::Reactor reactor;
+        HAL::UART::PseudoTerminal modemPty, gnssPty;
+        HAL::UART::Uart modemUart, gnssUart;
+        if (reactor.reactorInit() != HAL::OK || !openPty(modemPty, modemUart) || !openPty(gnssPty, gnssUart)) {
+            check(false, "reactor: init and open pseudo-terminals");
+            return;
+        }
+        NET::AtModem modem(reactor, modemUart);
+        std::mutex urc_mutex;
+        std::vector<std::string> urcs;
+        modem.setUrcHandler([&](std::string_view line) {
+            std::lock_guard<std::mutex> lock(urc_mutex);
+            urcs.emplace_back(line);
+        });
+        GNSS::Location gnss;
+        check(modem.attach() == HAL::OK && gnss.attach(reactor, gnssUart) == HAL::OK, "reactor: attach modem and GNSS");
+        ModemSimulator simulator(modemPty);
+        std::thread loop([&] { reactor.reactorRun(); });
+
+        NET::AtResponse response = runCommand(modem, "AT", 1000ms);
+        check(response.status == NET::AtStatus::OK && response.lines.empty(), "modem: AT -> OK, echo skipped");
+        response = runCommand(modem, "AT+CSQ", 1000ms);
+        check(response.status == NET::AtStatus::OK && response.lines == std::vector<std::string>{"+CSQ: 20,99"},
+              "modem: AT+CSQ response lines");
+        {
+            std::lock_guard<std::mutex> lock(urc_mutex);
+            check(urcs == std::vector<std::string>{"+QIND: \"csq\",20"}, "modem: interleaved URC routed to handler");
+        }
+        response = runCommand(modem, "AT+CPIN?", 1000ms);
+        check(response.status == NET::AtStatus::ERROR && response.error == "+CME ERROR: 10", "modem: +CME ERROR");
+        response = runCommand(modem, "AT+SLOW", 100ms);
+        check(response.status == NET::AtStatus::TIMEOUT && modem.timeouts() == 1, "modem: deadline on the timer wheel");
+        // 迟到的 OK 既不算作下一条命令的结果，也不当作 URC
+        std::this_thread::sleep_for(400ms);
+        const uint64_t completed = modem.completed();
+        response = runCommand(modem, "AT", 1000ms);
+        check(response.status == NET::AtStatus::OK && modem.completed() == completed + 1, "modem: late final result dropped");
+        {
+            std::lock_guard<std::mutex> lock(urc_mutex);
+            check(urcs.size() == 1, "modem: late final result not reported as URC");
+        }
+        // 排在超时命令之后的命令：迟到的 OK 不能成为它的结果
+        {
+            auto slow = std::make_shared<std::promise<NET::AtResponse>>();
+            std::future<NET::AtResponse> slowResult = slow->get_future();
+            modem.command("AT+SLOW", [slow](const NET::AtResponse& r) { slow->set_value(r); }, 100ms);
+            response = runCommand(modem, "AT+CPIN?", 1000ms);
+            check(slowResult.wait_for(1s) == std::future_status::ready && slowResult.get().status == NET::AtStatus::TIMEOUT &&
+                  response.status == NET::AtStatus::ERROR && response.error == "+CME ERROR: 10",
+                  "modem: queued command after a timeout gets its own result");
+            response = runCommand(modem, "AT+CSQ", 1000ms);
+            check(response.status == NET::AtStatus::OK && response.lines == std::vector<std::string>{"+CSQ: 20,99"},
+                  "modem: results stay aligned after a timeout");
+        }
+
+        // 取消后不触发，重复取消返回 false
+        std::atomic<bool> fired{false};
+        const bool cancelled = onLoop(reactor, [&] {
+            const HAL::IO::TimerId id = reactor.reactorAddTimer(50ms, [&] { fired.store(true); });
+            return reactor.reactorCancelTimer(id) && !reactor.reactorCancelTimer(id);
+        });
+        std::this_thread::sleep_for(150ms);
+        check(cancelled && !fired.load(), "reactor: cancelled timer does not fire");
+
+        // 只有一个较远的定时器时，事件循环睡到它到期，其间不被唤醒
+        onLoop(reactor, [&] { return reactor.reactorAddTimer(3000ms, [] {}); });
+        std::this_thread::sleep_for(50ms);
+        const uint64_t wakeups = reactor.reactorWakeups();
+        std::this_thread::sleep_for(500ms);
+        check(reactor.reactorWakeups() == wakeups, "reactor: no wakeups while idle with a pending timer");
+
+        // GNSS 经同一事件循环按行读取；下一历元的句子到达时发布上一历元
+        gnssPty.ptyWrite("$GNGGA,023634.00,3443.85620,N,11339.47258,E,1,12,0.80,112.4,M,-15.2,M,,*68\r\n"
+                         "$GNRMC,023634.00,A,3443.85620,N,11339.47258,E,0.215,87.50,190326,,,A*4F\r\n"
+                         "$GNGGA,023635.00,3443.85631,N,11339.47266,E,1,12,0.80,112.6,M,-15.2,M,,*66\r\n");
+        GNSS::NavState state;
+        for (int i = 0; i < 100 && (state = gnss.latest()).sequence == 0; i++) std::this_thread::sleep_for(10ms);
+        check(state.sequence >= 1 && std::abs(state.latitude - (34 + 43.85620 / 60)) < 1e-6, "reactor: GNSS lines delivered");
+
+        // 设备关闭：未完成与之后的命令都以 CLOSED 结束，串口从事件循环注销
+        auto hung = std::make_shared<std::promise<NET::AtResponse>>();
+        std::future<NET::AtResponse> hungResult = hung->get_future();
+        modem.command("AT+HANG", [hung](const NET::AtResponse& r) { hung->set_value(r); }, 5000ms);
+        std::this_thread::sleep_for(100ms);
+        simulator.stop();
+        modemPty.ptyClose();
+        check(hungResult.wait_for(2s) == std::future_status::ready && hungResult.get().status == NET::AtStatus::CLOSED,
+              "modem: pending command closed with the device");
+        check(runCommand(modem, "AT", 1000ms).status == NET::AtStatus::CLOSED, "modem: commands after close fail fast");
+        check(onLoop(reactor, [&] { return reactor.reactorFdCount(); }) == 1, "reactor: closed UART unregistered");
+
+        reactor.reactorStop();
+        loop.join();
+    }
+
+    // ---------------- TelemetryUplink ----------------
+
+    int bindLoopback(int type, uint16_t& port) {
+        const int fd = socket(AF_INET, type, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+        socklen_t length = sizeof(addr);
+        if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+            getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &length) != 0 || (type == SOCK_STREAM && listen(fd, 1) != 0)) {
+            if (fd >= 0) close(fd);
+            return -1;
+        }
+        port = ntohs(addr.sin_port);
+        timeval timeout{2, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        return fd;
+    }
+
+    bool readAll(int fd, uint8_t* data, size_t size) {
+        for (size_t offset = 0; offset < size;) {
+            const ssize_t n = recv(fd, data + offset, size - offset, 0);
+            if (n <= 0) return false;
+            offset += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    // 接受一个连接，按长度前缀读出全部批，直到对端关闭
+    std::vector<NET::TelemetryBatch> receiveTcp(int listener) {
+        std::vector<NET::TelemetryBatch> batches;
+        const int client = accept(listener, nullptr, nullptr);
+        if (client < 0) return batches;
+        timeval timeout{5, 0};
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        uint8_t length[4];
+        std::vector<uint8_t> buffer;
+        while (readAll(client, length, sizeof(length))) {
+            buffer.resize((uint32_t{length[0]} << 24) | (uint32_t{length[1]} << 16) | (uint32_t{length[2]} << 8) | length[3]);
+            NET::TelemetryBatch batch;
+            if (!readAll(client, buffer.data(), buffer.size()) || !NET::decodeBatch(buffer.data(), buffer.size(), batch)) break;
+            batches.push_back(std::move(batch));
+        }
+        close(client);
+        return batches;
+    }
+
+    // 逐个接收 UDP 批，ack 时回复确认，直到 2 秒内没有新批
+    std::vector<NET::TelemetryBatch> receiveUdp(int receiver, bool ack) {
+        std::vector<NET::TelemetryBatch> batches;
+        uint8_t buffer[65536];
+        while (true) {
+            sockaddr_in peer{};
+            socklen_t peer_size = sizeof(peer);
+            const ssize_t n = recvfrom(receiver, buffer, sizeof(buffer), 0, reinterpret_cast<sockaddr*>(&peer), &peer_size);
+            if (n <= 0) break;
+            NET::TelemetryBatch batch;
+            if (!NET::decodeBatch(buffer, static_cast<size_t>(n), batch)) continue;
+            if (ack) {
+                const std::vector<uint8_t> reply = NET::encodeAck(batch);
+                sendto(receiver, reply.data(), reply.size(), 0, reinterpret_cast<sockaddr*>(&peer), peer_size);
+            }
+            batches.push_back(std::move(batch));
+        }
+        return batches;
+    }
+
+    NET::DetectionEvent sampleDetection(uint64_t sequence) {
+        NET::DetectionEvent event;
+        event.unixMs = 1760000000000 + sequence * 33;
+        event.source = 1;
+        event.sequence = sequence;
+        event.positioned = true;
+        event.latitude = 34.7309367;
+        event.longitude = 113.6578763;
+        event.objects.push_back({0, 0.8f, 0.25f, 0.5f, 0.125f, 0.25f, true, 87.5});
+        event.objects.push_back({2, 0.4f, 0.5f, 0.5f, 0.25f, 0.125f, false, -1.0});
+        return event;
+    }
+
+    void checkTelemetryUdp() {
+        uint16_t port = 0;
+        const int receiver = bindLoopback(SOCK_DGRAM, port);
+        if (receiver < 0) {
+            check(false, "telemetry: bind UDP receiver");
+            return;
+        }
+        NET::TelemetryConfig config;
+        config.transport = NET::Transport::UDP;
+        config.host = "127.0.0.1";
+        config.port = port;
+        config.device = 7;
+        config.batch_interval = 100ms;
+        NET::TelemetryUplink uplink(config);
+        uplink.start();
+        uplink.submit(sampleDetection(42));
+        uplink.submit(NET::AlertEvent{1760000000100, 9, 2, 2, 3.25f, -0.2f});
+        uplink.submit(NET::FixEvent{1760000000200, 34.7309367, 113.6578763, 112.4, 0.11, 87.5, 0.8, 1, 12});
+
+        uint8_t buffer[65536];
+        sockaddr_in peer{};
+        socklen_t peer_size = sizeof(peer);
+        const ssize_t n = recvfrom(receiver, buffer, sizeof(buffer), 0, reinterpret_cast<sockaddr*>(&peer), &peer_size);
+        NET::TelemetryBatch batch;
+        const bool decoded = n > 0 && NET::decodeBatch(buffer, static_cast<size_t>(n), batch);
+        if (decoded) {
+            const std::vector<uint8_t> ack = NET::encodeAck(batch);
+            sendto(receiver, ack.data(), ack.size(), 0, reinterpret_cast<sockaddr*>(&peer), peer_size);
+        }
+        check(decoded && batch.device == 7 && batch.sequence == 1 && batch.events.size() == 3, "telemetry: UDP batch sealed by time and decoded");
+        if (decoded && batch.events.size() == 3) {
+            const auto* detection = std::get_if<NET::DetectionEvent>(&batch.events[0]);
+            check(detection && detection->sequence == 42 && detection->objects.size() == 2 &&
+                  std::abs(detection->latitude - 34.7309367) < 1e-7 && std::abs(detection->objects[0].bearingDeg - 87.5) < 0.1 &&
+                  detection->objects[1].bearingDeg < 0.0 && detection->objects[0].near, "telemetry: detection round trip");
+            const auto* alert = std::get_if<NET::AlertEvent>(&batch.events[1]);
+            check(alert && alert->track == 9 && alert->unixMs == 1760000000100 && std::abs(alert->distance - 3.25f) < 0.01f,
+                  "telemetry: alert round trip");
+            const auto* fix = std::get_if<NET::FixEvent>(&batch.events[2]);
+            check(fix && fix->satellites == 12 && std::abs(fix->altitude - 112.4) < 0.1, "telemetry: fix round trip");
+        }
+        // CRC 覆盖全部字节
+        buffer[n / 2] ^= 0x01;
+        check(!NET::decodeBatch(buffer, static_cast<size_t>(std::max<ssize_t>(n, 0)), batch), "telemetry: corrupted batch rejected");
+        uplink.stop();
+        const NET::TelemetryStats stats = uplink.stats();
+        check(stats.sent == 1 && stats.acked == 1 && stats.dropped == 0, "telemetry: UDP batch acknowledged");
+        close(receiver);
+    }
+
+    void checkTelemetryUdpSpool() {
+        // 先占一个端口再释放，之后发往该端口的数据报被拒绝
+        uint16_t port = 0;
+        close(bindLoopback(SOCK_DGRAM, port));
+        const std::filesystem::path spool = std::filesystem::temp_directory_path() / ("check_io_udp_spool_" + std::to_string(getpid()));
+        std::filesystem::remove_all(spool);
+
+        NET::TelemetryConfig config;
+        config.transport = NET::Transport::UDP;
+        config.host = "127.0.0.1";
+        config.port = port;
+        config.batch_bytes = 1;          // 每个事件一批
+        config.spool_dir = spool.string();
+        config.retry_interval = 200ms;
+        {
+            NET::TelemetryUplink refused(config);
+            refused.start();
+            refused.submit(sampleDetection(1));
+            std::this_thread::sleep_for(400ms);
+            refused.stop();
+            // 重连后试探补发的同一批再次被拒绝，仍留在缓存里
+            const NET::TelemetryStats stats = refused.stats();
+            check(stats.sent >= 1 && stats.spooled >= 1 && stats.acked == 0 && stats.pending_spool == 1,
+                  "telemetry: UDP batch spooled when the port refuses it");
+        }
+
+        const int receiver = bindLoopback(SOCK_DGRAM, port);
+        if (receiver < 0) {
+            check(false, "telemetry: bind UDP receiver on port " + std::to_string(port));
+            return;
+        }
+        {
+            // 对端收下但不确认：停止时未确认的批写入缓存
+            std::future<std::vector<NET::TelemetryBatch>> received = std::async(std::launch::async, receiveUdp, receiver, false);
+            NET::TelemetryUplink silent(config);
+            silent.start();
+            std::this_thread::sleep_for(300ms);
+            silent.submit(sampleDetection(2));
+            std::this_thread::sleep_for(100ms);
+            silent.stop();
+            const NET::TelemetryStats stats = silent.stats();
+            check(stats.acked == 0 && stats.spooled == 2 && stats.pending_spool == 2, "telemetry: unacknowledged UDP batches spooled at stop");
+            received.get();
+        }
+        {
+            // 对端确认后补发缓存，新批排在其后
+            std::future<std::vector<NET::TelemetryBatch>> received = std::async(std::launch::async, receiveUdp, receiver, true);
+            NET::TelemetryUplink online(config);
+            online.start();
+            std::this_thread::sleep_for(800ms);
+            online.submit(sampleDetection(3));
+            std::this_thread::sleep_for(100ms);
+            online.stop();
+            const NET::TelemetryStats stats = online.stats();
+            check(stats.resent == 2 && stats.acked == 3 && stats.pending_spool == 0, "telemetry: UDP spool resent once acknowledged");
+            std::vector<uint64_t> frames;
+            for (const auto& batch : received.get()) {
+                for (const auto& event : batch.events) {
+                    if (const auto* detection = std::get_if<NET::DetectionEvent>(&event)) frames.push_back(detection->sequence);
+                }
+            }
+            check(frames == std::vector<uint64_t>{1, 2, 3}, "telemetry: UDP receiver gets spooled batches in order, then new ones");
+        }
+        check(std::filesystem::is_empty(spool), "telemetry: UDP spool emptied");
+        close(receiver);
+        std::filesystem::remove_all(spool);
+    }
+
+    void checkTelemetrySpool() {
+        // 先占一个端口再释放，之后连接被拒绝
+        uint16_t port = 0;
+        const int probe = bindLoopback(SOCK_STREAM, port);
+        close(probe);
+        const std::filesystem::path spool = std::filesystem::temp_directory_path() / ("check_io_spool_" + std::to_string(getpid()));
+        std::filesystem::remove_all(spool);
+
+        NET::TelemetryConfig config;
+        config.transport = NET::Transport::TCP;
+        config.host = "127.0.0.1";
+        config.port = port;
+        config.batch_bytes = 1;          // 每个事件一批
+        config.spool_dir = spool.string();
+        config.retry_interval = 200ms;
+        {
+            NET::TelemetryUplink offline(config);
+            offline.start();
+            for (uint64_t i = 1; i <= 3; i++) offline.submit(sampleDetection(i));
+            offline.stop();
+            const NET::TelemetryStats stats = offline.stats();
+            check(stats.batches == 3 && stats.spooled == 3 && stats.sent == 0, "telemetry: batches spooled while the link is down");
+        }
+
+        const int listener = bindLoopback(SOCK_STREAM, port);
+        if (listener < 0) {
+            check(false, "telemetry: listen on TCP port " + std::to_string(port));
+            return;
+        }
+        std::future<std::vector<NET::TelemetryBatch>> received = std::async(std::launch::async, receiveTcp, listener);
+        {
+            // 重启后载入缓存，连接恢复后先按序补发，新批排在其后
+            NET::TelemetryUplink online(config);
+            online.start();
+            std::this_thread::sleep_for(600ms);
+            online.submit(sampleDetection(4));
+            std::this_thread::sleep_for(100ms);
+            online.stop();
+            const NET::TelemetryStats stats = online.stats();
+            check(stats.resent == 3 && stats.pending_spool == 0, "telemetry: spool resent after reconnect");
+        }
+        const std::vector<NET::TelemetryBatch> batches = received.get();
+        std::vector<uint64_t> frames;
+        for (const auto& batch : batches) {
+            for (const auto& event : batch.events) {
+                if (const auto* detection = std::get_if<NET::DetectionEvent>(&event)) frames.push_back(detection->sequence);
+            }
+        }
+        check(frames == std::vector<uint64_t>{1, 2, 3, 4}, "telemetry: TCP receiver gets spooled batches in order, then new ones");
+        check(std::filesystem::is_empty(spool), "telemetry: spool emptied");
+        close(listener);
+        std::filesystem::remove_all(spool);
+    }
+}
+
+int main() {
+    checkUart();
+    checkReactor();
+    checkTelemetryUdp();
+    checkTelemetryUdpSpool();
+    checkTelemetrySpool();
+    if (failures > 0) {
+        std::cerr << failures << " checks failed." << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cerr << "All checks passed." << std::endl;
+    return EXIT_SUCCESS;
+}
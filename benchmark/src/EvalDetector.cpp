@@ -0,0 +1,351 @@
+// ONNX::YOLO 精度-延迟评估：在 YOLO 格式的标注数据集上计算 mAP@0.5、mAP@0.5:0.95 与单张图片延迟，
+// 并行扫描多组配置（输入尺寸、置信度/IoU 阈值、batch、模型精度），输出一张速度/精度对比表。
+// 用法: eval_detector <sweep.yaml> [--csv out.csv]
+#include "ONNX.h"
+#include <yaml-cpp/yaml.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace EVAL {
+    struct GroundTruth {
+        int id;
+        cv::Rect2d box;
+    };
+
+    struct Sample {
+        std::string path;
+        cv::Mat image;
+        std::vector<GroundTruth> labels;
+    };
+
+    struct Job {
+        std::string model;
+        std::string precision;
+        ONNX::YOLOConfig config;
+    };
+
+    struct Report {
+        Job job;
+        bool ok = false;
+        std::string error;
+        double map50 = 0.0;
+        double map5095 = 0.0;
+        double p50Ms = 0.0, p95Ms = 0.0, meanMs = 0.0;
+    };
+
+    // 单张图片的检测结果
+    struct Prediction {
+        size_t image;
+        ONNX::OutputDet det;
+    };
+
+    // 数据集 yaml 中的相对路径相对于 yaml 所在目录解析
+    static fs::path ResolvePath(const fs::path& base, const std::string& value) {
+        fs::path p(value);
+        return p.is_absolute() ? p : (base / p).lexically_normal();
+    }
+
+    // images/xxx -> labels/xxx（YOLO 数据集约定）
+    static fs::path LabelPathFor(const fs::path& image) {
+        std::string path = image.string();
+        const std::string key = "/images/";
+        if (size_t pos = path.rfind(key); pos != std::string::npos) {
+            path.replace(pos, key.size(), "/labels/");
+        }
+        return fs::path(path).replace_extension(".txt");
+    }
+
+    static std::vector<Sample> LoadDataset(const std::string& yamlPath, const std::string& split) {
+        YAML::Node data = YAML::LoadFile(yamlPath);
+        if (!data[split]) {
+            throw std::runtime_error("Dataset yaml has no '" + split + "' split");
+        }
+        const fs::path yamlDir = fs::absolute(yamlPath).parent_path();
+        const fs::path root = ResolvePath(yamlDir, data["path"] ? data["path"].as<std::string>() : ".");
+        const fs::path imageDir = ResolvePath(root, data[split].as<std::string>());
+
+        std::vector<fs::path> images;
+        for (const auto& entry : fs::directory_iterator(imageDir)) {
+            std::string ext = entry.path().extension().string();
+            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+            if (ext == ".jpg" || ext == ".jpeg" || ext == ".png" || ext == ".bmp") {
+                images.push_back(entry.path());
+            }
+        }
+        std::sort(images.begin(), images.end());
+
+        std::vector<Sample> samples;
+        for (const auto& path : images) {
+            Sample sample;
+            sample.path = path.string();
+            sample.image = cv::imread(sample.path);
+            if (sample.image.empty()) {
+                std::cerr << "Skip unreadable image: " << sample.path << std::endl;
+                continue;
+            }
+            // 每行: class cx cy w h（归一化坐标）
+            std::ifstream label(LabelPathFor(path));
+            int id;
+            double cx, cy, w, h;
+            while (label >> id >> cx >> cy >> w >> h) {
+                const double iw = sample.image.cols, ih = sample.image.rows;
+                sample.labels.push_back({id, cv::Rect2d((cx - w / 2) * iw, (cy - h / 2) * ih, w * iw, h * ih)});
+            }
+            samples.push_back(std::move(sample));
+        }
+        if (samples.empty()) {
+            throw std::runtime_error("No images found in " + imageDir.string());
+        }
+        return samples;
+    }
+
+    static double IoU(const cv::Rect2d& a, const cv::Rect2d& b) {
+        const double inter = (a & b).area();
+        const double uni = a.area() + b.area() - inter;
+        return uni > 0.0 ? inter / uni : 0.0;
+    }
+
+    // COCO 式 101 点插值 AP
+    static double AveragePrecision(std::vector<std::pair<float, bool>>& hits, size_t gtCount) {
+        if (gtCount == 0) return 0.0;
+        std::sort(hits.begin(), hits.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+        std::vector<double> precision, recall;
+        size_t tp = 0, fp = 0;
+        for (const auto& hit : hits) {
+            hit.second ? ++tp : ++fp;
+            precision.push_back(static_cast<double>(tp) / static_cast<double>(tp + fp));
+            recall.push_back(static_cast<double>(tp) / static_cast<double>(gtCount));
+        }
+        // 精度包络：从后向前取最大值
+        for (size_t i = precision.size(); i-- > 1;) {
+            precision[i - 1] = std::max(precision[i - 1], precision[i]);
+        }
+        double ap = 0.0;
+        for (int i = 0; i <= 100; ++i) {
+            const double r = i / 100.0;
+            auto it = std::lower_bound(recall.begin(), recall.end(), r);
+            if (it != recall.end()) ap += precision[it - recall.begin()];
+        }
+        return ap / 101.0;
+    }
+
+    // 在给定 IoU 阈值下计算各类别 AP 的平均值（只统计有标注的类别）
+    static double MeanAP(const std::vector<Sample>& samples, const std::vector<Prediction>& predictions, double iouThreshold) {
+        std::map<int, size_t> gtCount;
+        for (const auto& sample : samples) {
+            for (const auto& gt : sample.labels) gtCount[gt.id]++;
+        }
+        std::map<int, std::vector<std::pair<float, bool>>> hits;
+        std::vector<std::vector<bool>> matched(samples.size());
+        for (size_t i = 0; i < samples.size(); ++i) matched[i].assign(samples[i].labels.size(), false);
+
+        // 按置信度从高到低贪心匹配
+        std::vector<const Prediction*> order;
+        for (const auto& p : predictions) order.push_back(&p);
+        std::sort(order.begin(), order.end(), [](const Prediction* a, const Prediction* b) {
+            return a->det.confidence > b->det.confidence;
+        });
+        for (const Prediction* p : order) {
+            const auto& labels = samples[p->image].labels;
+            double best = iouThreshold;
+            int bestIndex = -1;
+            for (size_t g = 0; g < labels.size(); ++g) {
+                if (labels[g].id != p->det.id || matched[p->image][g]) continue;
+                double iou = IoU(cv::Rect2d(p->det.box), labels[g].box);
+                if (iou >= best) {
+                    best = iou;
+                    bestIndex = static_cast<int>(g);
+                }
+            }
+            if (bestIndex >= 0) matched[p->image][bestIndex] = true;
+            hits[p->det.id].emplace_back(p->det.confidence, bestIndex >= 0);
+        }
+
+        double sum = 0.0;
+        for (const auto& [id, count] : gtCount) {
+            sum += AveragePrecision(hits[id], count);
+        }
+        return gtCount.empty() ? 0.0 : sum / static_cast<double>(gtCount.size());
+    }
+
+    static Report RunJob(const Job& job, const std::vector<Sample>& samples, const std::string& namesYaml) {
+        Report report;
+        report.job = job;
+        try {
+            ONNX::YOLO yolo(job.model, namesYaml, job.config);
+            if (!yolo.IsLoaded()) {
+                throw std::runtime_error("failed to load model");
+            }
+            std::vector<Prediction> predictions;
+            std::vector<double> latencies;
+            const size_t batch = std::max(1, job.config.batchSize);
+            std::vector<cv::Mat> images;
+            std::vector<std::vector<ONNX::OutputDet>> output;   // 各批复用
+            for (size_t begin = 0; begin < samples.size(); begin += batch) {
+                const size_t end = std::min(samples.size(), begin + batch);
+                images.clear();
+                for (size_t i = begin; i < end; ++i) images.push_back(samples[i].image);
+
+                const auto t0 = std::chrono::steady_clock::now();
+                const bool ok = yolo.OnnxBatchDetect(images, output);
+                const auto t1 = std::chrono::steady_clock::now();
+                // 推理失败时 output 可能为空或不足一批，整个任务记为失败，不用残缺结果计算 mAP
+                if (!ok || output.size() != images.size()) {
+                    throw std::runtime_error("inference failed on images " + std::to_string(begin) + "~" + std::to_string(end - 1) +
+                                             " (" + std::to_string(output.size()) + "/" + std::to_string(images.size()) + " results)");
+                }
+                // 按 batch 均摊为单张图片延迟
+                const double ms = std::chrono::duration<double, std::milli>(t1 - t0).count() / static_cast<double>(images.size());
+                for (size_t i = begin; i < end; ++i) {
+                    latencies.push_back(ms);
+                    for (const auto& det : output[i - begin]) predictions.push_back({i, det});
+                }
+            }
+
+            report.map50 = MeanAP(samples, predictions, 0.5);
+            for (int i = 0; i < 10; ++i) {
+                report.map5095 += MeanAP(samples, predictions, 0.5 + 0.05 * i);
+            }
+            report.map5095 /= 10.0;
+
+            std::sort(latencies.begin(), latencies.end());
+            report.p50Ms = latencies[latencies.size() / 2];
+            report.p95Ms = latencies[std::min(latencies.size() - 1, latencies.size() * 95 / 100)];
+            for (double ms : latencies) report.meanMs += ms;
+            report.meanMs /= static_cast<double>(latencies.size());
+            report.ok = true;
+        }
+        catch (const std::exception& e) {
+            report.error = e.what();
+        }
+        return report;
+    }
+
+    // sweep 中每个字段为标量或列表，展开为笛卡尔积
+    template <typename T>
+    static std::vector<T> ListOf(const YAML::Node& node, const T& fallback) {
+        if (!node) return {fallback};
+        if (!node.IsSequence()) return {node.as<T>()};
+        std::vector<T> values;
+        for (const auto& item : node) values.push_back(item.as<T>());
+        return values;
+    }
+
+    static std::vector<Job> ExpandSweep(const YAML::Node& sweep) {
+        if (!sweep["models"] || !sweep["models"].IsMap()) {
+            throw std::runtime_error("sweep.models must map precision names to model paths");
+        }
+        const ONNX::YOLOConfig defaults;
+        std::vector<Job> jobs;
+        for (const auto& model : sweep["models"]) {
+            for (int input : ListOf<int>(sweep["input"], defaults.netWidth)) {
+                for (float conf : ListOf<float>(sweep["conf"], defaults.classThreshold)) {
+                    for (float iou : ListOf<float>(sweep["iou"], defaults.nmsThreshold)) {
+                        for (int batch : ListOf<int>(sweep["batch"], defaults.batchSize)) {
+                            Job job;
+                            job.precision = model.first.as<std::string>();
+                            job.model = model.second.as<std::string>();
+                            job.config.netWidth = input;
+                            job.config.netHeight = input;
+                            job.config.classThreshold = conf;
+                            job.config.nmsThreshold = iou;
+                            job.config.batchSize = batch;
+                            jobs.push_back(job);
+                        }
+                    }
+                }
+            }
+        }
+        return jobs;
+    }
+
+    static void PrintTable(std::ostream& out, const std::vector<Report>& reports) {
+        out << "| precision | input | conf | iou | batch | mAP@0.5 | mAP@0.5:0.95 | p50 ms | p95 ms | img/s | model |\n";
+        out << "|---|---|---|---|---|---|---|---|---|---|---|\n";
+        out << std::fixed;
+        for (const auto& r : reports) {
+            out << "| " << r.job.precision << " | " << r.job.config.netWidth
+                << " | " << std::setprecision(2) << r.job.config.classThreshold
+                << " | " << r.job.config.nmsThreshold << " | " << r.job.config.batchSize << " | ";
+            if (!r.ok) {
+                out << "error: " << r.error << " | | | | | " << r.job.model << " |\n";
+                continue;
+            }
+            out << std::setprecision(4) << r.map50 << " | " << r.map5095 << " | "
+                << std::setprecision(2) << r.p50Ms << " | " << r.p95Ms << " | "
+                << (r.meanMs > 0.0 ? 1000.0 / r.meanMs : 0.0) << " | " << r.job.model << " |\n";
+        }
+    }
+
+    static void WriteCsv(const std::string& path, const std::vector<Report>& reports) {
+        std::ofstream out(path);
+        out << "precision,input,conf,iou,batch,map50,map50_95,p50_ms,p95_ms,mean_ms,model,error\n";
+        for (const auto& r : reports) {
+            out << r.job.precision << ',' << r.job.config.netWidth << ',' << r.job.config.classThreshold << ','
+                << r.job.config.nmsThreshold << ',' << r.job.config.batchSize << ',' << r.map50 << ',' << r.map5095 << ','
+                << r.p50Ms << ',' << r.p95Ms << ',' << r.meanMs << ',' << r.job.model << ',' << r.error << '\n';
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string sweepPath, csvPath;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--csv" && i + 1 < argc) csvPath = argv[++i];
+        else sweepPath = arg;
+    }
+    if (sweepPath.empty()) {
+        std::cerr << "Usage: " << argv[0] << " <sweep.yaml> [--csv PATH]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try {
+        YAML::Node sweep = YAML::LoadFile(sweepPath);
+        const std::string dataset = sweep["dataset"] ? sweep["dataset"].as<std::string>() : "./coco8.yaml";
+        const std::string split = sweep["split"] ? sweep["split"].as<std::string>() : "val";
+        const std::vector<EVAL::Sample> samples = EVAL::LoadDataset(dataset, split);
+        const std::vector<EVAL::Job> jobs = EVAL::ExpandSweep(sweep);
+
+        // 并行度：配置间并行，核数均分给每个会话的算子内线程
+        const int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        int workers = sweep["workers"] ? sweep["workers"].as<int>() : 0;
+        if (workers <= 0) workers = cores;
+        workers = std::min<int>(workers, static_cast<int>(jobs.size()));
+        const int intraOpThreads = std::max(1, cores / std::max(1, workers));
+        std::cerr << samples.size() << " images, " << jobs.size() << " configurations, "
+                  << workers << " workers x " << intraOpThreads << " threads" << std::endl;
+
+        std::vector<EVAL::Report> reports(jobs.size());
+        std::atomic<size_t> next{0};
+        std::vector<std::thread> pool;
+        for (int w = 0; w < workers; ++w) {
+            pool.emplace_back([&] {
+                for (size_t i = next++; i < jobs.size(); i = next++) {
+                    EVAL::Job job = jobs[i];
+                    job.config.intraOpThreads = intraOpThreads;
+                    reports[i] = EVAL::RunJob(job, samples, dataset);
+                    std::cerr << "done " << i + 1 << "/" << jobs.size() << std::endl;
+                }
+            });
+        }
+        for (auto& t : pool) t.join();
+
+        // workers > 1 时各配置互相争用 CPU，延迟仅用于相对比较；需要绝对延迟时设 workers: 1
+        EVAL::PrintTable(std::cout, reports);
+        if (!csvPath.empty()) EVAL::WriteCsv(csvPath, reports);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Evaluation failed: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,199 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include "Governor.h"
+#include "Runtime.h"
+#include <map>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 运行时流水线配置：相机模式、网络输入尺寸、各阈值、推流各路与队列深度等从 YAML 文件读取，
+// 同一个程序可在不同性能的板卡上以各自合适的速度/画质运行，不必为每种组合重新编译。
+// 各字段的默认值即此前的编译期常量，文件中未出现的项保持默认；示例见仓库根目录的 echovision.yaml
+namespace CONFIG {
+    struct CameraConfig {
+        int device = 0;                     // 相机编号，EchoVision 先填入平台默认值
+        int width = 3840;                   // 左右两个镜头拼接后的宽度
+        int height = 1080;
+        int fps = 30;
+        double hfov_deg = 90.0;             // 单个镜头的水平视场角
+    };
+
+    struct DetectorConfig {
+        std::string model = "./yolo11n_dynamic.onnx";
+        std::string classes = "./coco8.yaml";
+        int input_width = 320;              // 网络输入尺寸，须为 32 的倍数
+        int input_height = 320;
+        float confidence = 0.35f;
+        float nms_iou = 0.45f;
+        float near_obstacle_ratio = 0.4f;   // 检测框高度超过画面高度的该比例视为近距离障碍物
+        double display_scale = 0.67;        // 显示窗口相对原图的比例
+        int instances = 1;                  // 各流水线共享的模型实例数（每个实例一个 ORT 会话）
+    };
+
+    struct RenditionConfig {
+        std::string path;                   // 接在 StreamConfig::url 之后的 RTSP 路径
+        int width = 0;
+        int height = 0;
+        int fps = 0;
+        int64_t bitrate = 0;                // bit/s
+    };
+
+    struct RungConfig {
+        int width = 0;
+        int height = 0;
+        int fps = 0;
+        int64_t bitrate = 0;
+    };
+
+    struct StreamConfig {
+        std::string url = "rtsp://127.0.0.1:8554";
+        // 联播各路，按分辨率从高到低；第一路同时供录像使用
+        std::vector<RenditionConfig> renditions = {
+            {"/camera_hd", 1280, 720, 30, 800 * 1000},
+            {"/camera_sd",  640, 360, 10, 120 * 1000},
+        };
+        // 第一路的码率阶梯，为空时不做自适应
+        std::vector<RungConfig> rate_ladder = {
+            {1280, 720, 30, 800 * 1000},
+            {1280, 720, 20, 500 * 1000},
+            { 960, 540, 15, 350 * 1000},
+            { 640, 360, 15, 200 * 1000},
+            { 640, 360, 10, 120 * 1000},
+        };
+    };
+
+    struct QueueConfig {
+        size_t frame_depth = 2;             // 每个消费者队列最多缓存的帧数
+        size_t stream_packets = 120;        // 每路推流的包队列容量
+        size_t recorder_packets = 300;      // 分段录像的写盘队列容量
+        size_t alert_pending = 8;           // 等待发出的提示数
+        size_t snapshot_pending = 8;
+    };
+
+    // 目录总是以 / 结尾，配置中省略时载入时补上
+    struct StorageConfig {
+        std::string picture_dir = "./SaveImage/";
+        std::string video_dir = "./SaveVideo/";         // 滚动分段录像
+        std::string event_dir = "./SaveVideo/Event/";   // 事件前后录像
+        int segment_seconds = 60;
+        int pre_event_seconds = 10;
+        int post_event_seconds = 5;
+        std::string detection_log;                      // 检测结果（JSON Lines），"-" 为标准输出，空则不写
+    };
+
+    enum class DisplayMode {
+        AUTO,                               // 有图形环境（DISPLAY / WAYLAND_DISPLAY）时显示
+        WINDOW,
+        HEADLESS,                           // 不创建窗口，不做任何显示相关的缩放与绘制
+    };
+
+    struct DisplayConfig {
+        DisplayMode mode = DisplayMode::AUTO;
+        bool overlay = true;                // 窗口中叠加检测框与标签
+        double label_scale = 0.6;           // 标签字号
+    };
+
+    struct SessionConfig {
+        std::string record;                 // 非空时把相机帧、串口行与六轴采样记录到该会话日志
+        std::string replay;                 // 非空时从会话日志回放，代替相机、定位模块与 MPU6050
+        double replay_speed = 1.0;          // 回放倍速，<= 0 为尽快回放
+        std::string imu_replay;             // 非空时从该日志回放六轴数据，代替 MPU6050
+    };
+
+    // 一条 采集 -> 检测 -> 推流 流水线的输入源。相机模式、检测参数与推流各路对所有源相同
+    struct SourceConfig {
+        std::string name;                   // 用于统计、线程名与录像子目录，只含字母、数字、'-'、'_'
+        int device = -1;                    // 相机编号，-1 为 camera.device
+        std::string replay;                 // 非空时从该会话日志回放代替相机；与 session.replay 相同时共用同一个回放器
+        int channel = 0;                    // 回放日志中的相机通道
+        std::string stream_path;            // 插在 stream.url 与各路 path 之间（如 /front），各源不能相同
+        bool display = false;               // 显示窗口，至多一个源
+        bool alerts = false;                // 检测结果送危险提示，至多一个源
+    };
+
+    struct DeviceConfig {
+        std::string gnss = "/dev/ttyUSB0";
+        int gnss_baud = 115200;
+        std::string modem;                  // EC200M 的 AT 口（通常为 /dev/ttyUSB2），空则不启用
+        int modem_poll_seconds = 30;        // 查询信号质量的间隔
+    };
+
+    struct AlertTiming {
+        int latency_budget_ms = 400;        // 采集到发出提示的最大延迟
+        int repeat_interval_ms = 4000;      // 同一目标同等级的最短重复间隔
+    };
+
+    // 遥测上报，host 为空时不启用
+    struct TelemetrySettings {
+        std::string host;
+        int port = 9750;
+        std::string transport = "udp";      // udp 或 tcp
+        int device_id = 0;                  // 设备编号，后台据此区分终端
+        int batch_bytes = 1200;             // 批的编码长度达到该值即发送
+        int batch_ms = 2000;                // 批内首个事件最多等待多久
+        int fix_interval_ms = 1000;         // 定位历元的上报间隔，0 为每个历元都上报
+        std::string spool_dir = "./Telemetry/";         // 链路断开时的缓存目录，空则丢弃
+        int spool_mb = 16;
+        int retry_ms = 5000;                // 断开后的重连间隔
+    };
+
+    // 温度与期限调节，见 GOV::Governor。deadlines 的阶段：detect（一次推理，含等待检测器实例）、
+    // latency（采集到检测完成）
+    struct GovernorSettings {
+        bool enabled = true;
+        std::string thermal_path = "/sys/class/thermal/thermal_zone0/temp";
+        int interval_ms = 1000;
+        double hot_c = 75.0;
+        double cool_c = 65.0;
+        double critical_c = 82.0;
+        double miss_ratio = 0.2;
+        std::map<std::string, double, std::less<>> deadlines_ms = {{"detect", 120.0}, {"latency", 300.0}};
+        int down_after = 2;
+        int up_after = 10;
+        int settle = 15;
+        std::string state_file = "./governor.json";
+        // 默认工作点按 stream.rate_ladder 的默认五档设置，超出阶梯的档位按最后一档
+        std::vector<GOV::OperatingPoint> ladder = {
+            {"full",      0,   0,   0, 0,  0},
+            {"paced",   100,   0,   0, 1,  0},
+            {"reduced", 100, 256, 256, 2, 15},
+            {"minimal", 200, 224, 224, 4, 10},
+        };
+    };
+
+    // 四核板卡上的默认线程放置
+    RT::RuntimeConfig defaultPlacement();
+
+    struct PipelineConfig {
+        CameraConfig camera;
+        DetectorConfig detector;
+        StreamConfig stream;
+        QueueConfig queues;
+        StorageConfig storage;
+        DisplayConfig display;
+        SessionConfig session;
+        DeviceConfig devices;
+        AlertTiming alert;
+        TelemetrySettings telemetry;
+        GovernorSettings governor;
+        RT::RuntimeConfig threads = defaultPlacement();
+        std::vector<SourceConfig> sources;  // 为空时只有一条流水线，见 resolveSources
+    };
+
+    // display.mode 为 AUTO 时按环境变量判断
+    bool headless(const PipelineConfig& config);
+
+    // 实际运行的各条流水线：sources 为空时为单个源 "main"（camera.device 或 session.replay，显示与提示都开启），
+    // 否则为 sources 中的各项，device 为 -1 的填入 camera.device。无显示时所有源的 display 均关闭
+    std::vector<SourceConfig> resolveSources(const PipelineConfig& config);
+
+    // 读取 path 并覆盖 config 中出现的项，再整体校验。未知的键、类型错误与取值越界逐条打印到 std::cerr，
+    // 有任何错误时返回 false（config 可能已被部分修改）
+    bool load(const std::string& path, PipelineConfig& config);
+    // 只做取值校验，load 最后也会调用
+    bool validate(const PipelineConfig& config);
+}
+
+#endif //CONFIG_H
@@ -0,0 +1,643 @@
+#include "Config.h"
+#include <yaml-cpp/yaml.h>
+#include <sched.h>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string_view>
+
+using namespace CONFIG;
+
+RT::RuntimeConfig CONFIG::defaultPlacement() {
+    // 核 0 给串口、提示与融合（实时调度，大部分时间在等待），核 2 为 ORT 线程池，
+    // 流水线各节点由执行器线程在核 0、1、3 上执行，编码器线程在核 0、3，写盘与遥测上报线程降低优先级
+    RT::RuntimeConfig config;
+    config.threads["io"] = {{0}, RT::SchedPolicy::FIFO, 40};
+    config.threads["alert"] = {{0}, RT::SchedPolicy::FIFO, 45};
+    config.threads["fusion"] = {{0}, RT::SchedPolicy::FIFO, 30};
+    config.threads["flow"] = {{0, 1, 3}};
+    config.threads["convert"] = {{3}};
+    config.threads["encode"] = {{3}};
+    config.threads["mux"] = {{0, 3}};
+    config.threads["storage"] = {{3}, RT::SchedPolicy::OTHER, 0, 10};
+    config.threads["snapshot"] = {{3}, RT::SchedPolicy::OTHER, 0, 10};
+    config.threads["record"] = {{3}, RT::SchedPolicy::OTHER, 0, 10};
+    config.threads["replay"] = {{0}};
+    config.threads["uplink"] = {{3}, RT::SchedPolicy::OTHER, 0, 10};
+    config.ortThreads = 2;
+    config.ortCpus = {2};
+    config.encoderThreads = 2;
+    config.encoderCpus = {0, 3};
+    return config;
+}
+
+namespace {
+    // 与 Runtime.h 中列出的角色一致，拼错的角色名不会匹配任何线程，按错误处理
+    constexpr std::array<std::string_view, 12> ROLES = {
+        "flow", "io", "encode", "mux", "convert",
+        "fusion", "alert", "storage", "snapshot", "record", "replay", "uplink",
+    };
+    constexpr std::array<int, 8> BAUD_RATES = {9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600};
+
+    class Parser {
+    public:
+        explicit Parser(std::vector<std::string>& errors) : errors(errors) {}
+
+        // 节点存在且为映射时返回 true；不在 keys 中的键记为错误，避免拼错的配置项被静默忽略
+        bool section(const YAML::Node& node, const std::string& path, std::initializer_list<std::string_view> keys) {
+            if (!node) return false;
+            if (!node.IsMap()) {
+                errors.push_back(path + ": expected a map");
+                return false;
+            }
+            for (const auto& item : node) {
+                const std::string key = item.first.as<std::string>();
+                if (std::find(keys.begin(), keys.end(), key) == keys.end()) {
+                    errors.push_back(path + "." + key + ": unknown key");
+                }
+            }
+            return true;
+        }
+
+        template <typename T>
+        void read(const YAML::Node& node, const std::string& path, const char* key, T& value) {
+            const YAML::Node item = node[key];
+            if (!item) return;
+            try {
+                value = item.as<T>();
+            }
+            catch (const YAML::Exception&) {
+                errors.push_back(path + "." + key + ": invalid value '" + YAML::Dump(item) + "'");
+            }
+        }
+
+        void readMode(const YAML::Node& node, const std::string& path, int& width, int& height, int& fps, int64_t& bitrate) {
+            read(node, path, "width", width);
+            read(node, path, "height", height);
+            read(node, path, "fps", fps);
+            read(node, path, "bitrate", bitrate);
+        }
+
+        void camera(const YAML::Node& node, CameraConfig& config) {
+            if (!section(node, "camera", {"device", "width", "height", "fps", "hfov_deg"})) return;
+            read(node, "camera", "device", config.device);
+            read(node, "camera", "width", config.width);
+            read(node, "camera", "height", config.height);
+            read(node, "camera", "fps", config.fps);
+            read(node, "camera", "hfov_deg", config.hfov_deg);
+        }
+
+        void detector(const YAML::Node& node, DetectorConfig& config) {
+            if (!section(node, "detector", {"model", "classes", "input_width", "input_height", "confidence", "nms_iou",
+                                            "near_obstacle_ratio", "display_scale", "instances"})) return;
+            read(node, "detector", "model", config.model);
+            read(node, "detector", "classes", config.classes);
+            read(node, "detector", "input_width", config.input_width);
+            // 只给出宽度时按正方形输入
+            if (node["input_width"] && !node["input_height"]) config.input_height = config.input_width;
+            read(node, "detector", "input_height", config.input_height);
+            read(node, "detector", "confidence", config.confidence);
+            read(node, "detector", "nms_iou", config.nms_iou);
+            read(node, "detector", "near_obstacle_ratio", config.near_obstacle_ratio);
+            read(node, "detector", "display_scale", config.display_scale);
+            read(node, "detector", "instances", config.instances);
+        }
+
+        void sources(const YAML::Node& node, std::vector<SourceConfig>& config) {
+            if (!node) return;
+            if (!node.IsSequence()) {
+                errors.push_back("sources: expected a list");
+                return;
+            }
+            config.clear();
+            for (size_t i = 0; i < node.size(); i++) {
+                const std::string path = "sources[" + std::to_string(i) + "]";
+                SourceConfig source;
+                if (!section(node[i], path, {"name", "device", "replay", "channel", "stream_path", "display", "alerts"})) continue;
+                read(node[i], path, "name", source.name);
+                read(node[i], path, "device", source.device);
+                read(node[i], path, "replay", source.replay);
+                read(node[i], path, "channel", source.channel);
+                read(node[i], path, "stream_path", source.stream_path);
+                read(node[i], path, "display", source.display);
+                read(node[i], path, "alerts", source.alerts);
+                config.push_back(source);
+            }
+        }
+
+        void stream(const YAML::Node& node, StreamConfig& config) {
+            if (!section(node, "stream", {"url", "renditions", "rate_ladder"})) return;
+            read(node, "stream", "url", config.url);
+            if (const YAML::Node list = node["renditions"]; list) {
+                if (!list.IsSequence()) {
+                    errors.push_back("stream.renditions: expected a list");
+                }
+                else {
+                    config.renditions.clear();
+                    for (size_t i = 0; i < list.size(); i++) {
+                        const std::string path = "stream.renditions[" + std::to_string(i) + "]";
+                        RenditionConfig rendition;
+                        if (!section(list[i], path, {"path", "width", "height", "fps", "bitrate"})) continue;
+                        read(list[i], path, "path", rendition.path);
+                        readMode(list[i], path, rendition.width, rendition.height, rendition.fps, rendition.bitrate);
+                        config.renditions.push_back(rendition);
+                    }
+                }
+            }
+            if (const YAML::Node list = node["rate_ladder"]; list) {
+                // 写成空列表即关闭自适应
+                if (!list.IsSequence()) {
+                    errors.push_back("stream.rate_ladder: expected a list");
+                }
+                else {
+                    config.rate_ladder.clear();
+                    for (size_t i = 0; i < list.size(); i++) {
+                        const std::string path = "stream.rate_ladder[" + std::to_string(i) + "]";
+                        RungConfig rung;
+                        if (!section(list[i], path, {"width", "height", "fps", "bitrate"})) continue;
+                        readMode(list[i], path, rung.width, rung.height, rung.fps, rung.bitrate);
+                        config.rate_ladder.push_back(rung);
+                    }
+                }
+            }
+        }
+
+        void queues(const YAML::Node& node, QueueConfig& config) {
+            if (!section(node, "queues", {"frame_depth", "stream_packets", "recorder_packets", "alert_pending",
+                                          "snapshot_pending"})) return;
+            read(node, "queues", "frame_depth", config.frame_depth);
+            read(node, "queues", "stream_packets", config.stream_packets);
+            read(node, "queues", "recorder_packets", config.recorder_packets);
+            read(node, "queues", "alert_pending", config.alert_pending);
+            read(node, "queues", "snapshot_pending", config.snapshot_pending);
+        }
+
+        void storage(const YAML::Node& node, StorageConfig& config) {
+            if (!section(node, "storage", {"picture_dir", "video_dir", "event_dir", "segment_seconds",
+                                           "pre_event_seconds", "post_event_seconds", "detection_log"})) return;
+            read(node, "storage", "picture_dir", config.picture_dir);
+            read(node, "storage", "video_dir", config.video_dir);
+            read(node, "storage", "event_dir", config.event_dir);
+            read(node, "storage", "segment_seconds", config.segment_seconds);
+            read(node, "storage", "pre_event_seconds", config.pre_event_seconds);
+            read(node, "storage", "post_event_seconds", config.post_event_seconds);
+            read(node, "storage", "detection_log", config.detection_log);
+            // 拍照等处按 目录 + 文件名 拼接路径：没有以 / 结尾的目录在载入时补上
+            for (std::string* dir : {&config.picture_dir, &config.video_dir, &config.event_dir}) {
+                if (!dir->empty() && dir->back() != '/') dir->push_back('/');
+            }
+        }
+
+        void display(const YAML::Node& node, DisplayConfig& config) {
+            if (!section(node, "display", {"mode", "overlay", "label_scale"})) return;
+            std::string mode;
+            read(node, "display", "mode", mode);
+            if (mode == "auto") {
+                config.mode = DisplayMode::AUTO;
+            }
+            else if (mode == "window") {
+                config.mode = DisplayMode::WINDOW;
+            }
+            else if (mode == "headless") {
+                config.mode = DisplayMode::HEADLESS;
+            }
+            else if (!mode.empty()) {
+                errors.push_back("display.mode: expected 'auto', 'window' or 'headless'");
+            }
+            read(node, "display", "overlay", config.overlay);
+            read(node, "display", "label_scale", config.label_scale);
+        }
+
+        void session(const YAML::Node& node, SessionConfig& config) {
+            if (!section(node, "session", {"record", "replay", "replay_speed", "imu_replay"})) return;
+            read(node, "session", "record", config.record);
+            read(node, "session", "replay", config.replay);
+            read(node, "session", "replay_speed", config.replay_speed);
+            read(node, "session", "imu_replay", config.imu_replay);
+        }
+
+        void devices(const YAML::Node& node, DeviceConfig& config) {
+            if (!section(node, "devices", {"gnss", "gnss_baud", "modem", "modem_poll_seconds"})) return;
+            read(node, "devices", "gnss", config.gnss);
+            read(node, "devices", "gnss_baud", config.gnss_baud);
+            read(node, "devices", "modem", config.modem);
+            read(node, "devices", "modem_poll_seconds", config.modem_poll_seconds);
+        }
+
+        void alert(const YAML::Node& node, AlertTiming& config) {
+            if (!section(node, "alert", {"latency_budget_ms", "repeat_interval_ms"})) return;
+            read(node, "alert", "latency_budget_ms", config.latency_budget_ms);
+            read(node, "alert", "repeat_interval_ms", config.repeat_interval_ms);
+        }
+
+        void telemetry(const YAML::Node& node, TelemetrySettings& config) {
+            if (!section(node, "telemetry", {"host", "port", "transport", "device_id", "batch_bytes", "batch_ms",
+                                             "fix_interval_ms", "spool_dir", "spool_mb", "retry_ms"})) return;
+            read(node, "telemetry", "host", config.host);
+            read(node, "telemetry", "port", config.port);
+            read(node, "telemetry", "transport", config.transport);
+            read(node, "telemetry", "device_id", config.device_id);
+            read(node, "telemetry", "batch_bytes", config.batch_bytes);
+            read(node, "telemetry", "batch_ms", config.batch_ms);
+            read(node, "telemetry", "fix_interval_ms", config.fix_interval_ms);
+            read(node, "telemetry", "spool_dir", config.spool_dir);
+            read(node, "telemetry", "spool_mb", config.spool_mb);
+            read(node, "telemetry", "retry_ms", config.retry_ms);
+        }
+
+        void governor(const YAML::Node& node, GovernorSettings& config) {
+            if (!section(node, "governor", {"enabled", "thermal_path", "interval_ms", "hot_c", "cool_c", "critical_c",
+                                            "miss_ratio", "deadlines_ms", "down_after", "up_after", "settle", "state_file",
+                                            "ladder"})) return;
+            read(node, "governor", "enabled", config.enabled);
+            read(node, "governor", "thermal_path", config.thermal_path);
+            read(node, "governor", "interval_ms", config.interval_ms);
+            read(node, "governor", "hot_c", config.hot_c);
+            read(node, "governor", "cool_c", config.cool_c);
+            read(node, "governor", "critical_c", config.critical_c);
+            read(node, "governor", "miss_ratio", config.miss_ratio);
+            read(node, "governor", "down_after", config.down_after);
+            read(node, "governor", "up_after", config.up_after);
+            read(node, "governor", "settle", config.settle);
+            read(node, "governor", "state_file", config.state_file);
+            if (const YAML::Node deadlines = node["deadlines_ms"]; deadlines) {
+                // 给出时整体替换默认期限，写成空映射即只按温度调节
+                if (!deadlines.IsMap()) {
+                    errors.push_back("governor.deadlines_ms: expected a map");
+                }
+                else {
+                    config.deadlines_ms.clear();
+                    for (const auto& item : deadlines) {
+                        const std::string stage = item.first.as<std::string>();
+                        double budget = 0.0;
+                        read(deadlines, "governor.deadlines_ms", stage.c_str(), budget);
+                        config.deadlines_ms[stage] = budget;
+                    }
+                }
+            }
+            if (const YAML::Node list = node["ladder"]; list) {
+                if (!list.IsSequence()) {
+                    errors.push_back("governor.ladder: expected a list");
+                    return;
+                }
+                config.ladder.clear();
+                for (size_t i = 0; i < list.size(); i++) {
+                    const std::string path = "governor.ladder[" + std::to_string(i) + "]";
+                    GOV::OperatingPoint point;
+                    if (!section(list[i], path, {"name", "detect_interval_ms", "input_width", "input_height", "stream_rung",
+                                                 "capture_fps"})) continue;
+                    read(list[i], path, "name", point.name);
+                    read(list[i], path, "detect_interval_ms", point.detect_interval_ms);
+                    read(list[i], path, "input_width", point.input_width);
+                    // 只给出宽度时按正方形输入
+                    if (list[i]["input_width"] && !list[i]["input_height"]) point.input_height = point.input_width;
+                    read(list[i], path, "input_height", point.input_height);
+                    read(list[i], path, "stream_rung", point.stream_rung);
+                    read(list[i], path, "capture_fps", point.capture_fps);
+                    config.ladder.push_back(point);
+                }
+            }
+        }
+
+        void threads(const YAML::Node& node, RT::RuntimeConfig& config) {
+            if (!section(node, "threads", {"placement", "flow_workers", "ort_threads", "ort_cpus", "encoder_threads",
+                                           "encoder_cpus", "roles"})) return;
+            // 执行器线程数与放置无关
+            read(node, "threads", "flow_workers", config.flowWorkers);
+            bool placement = true;
+            read(node, "threads", "placement", placement);
+            if (!placement) {
+                // 全部交给系统调度
+                const int workers = config.flowWorkers;
+                config = {};
+                config.flowWorkers = workers;
+                return;
+            }
+            read(node, "threads", "ort_threads", config.ortThreads);
+            read(node, "threads", "ort_cpus", config.ortCpus);
+            read(node, "threads", "encoder_threads", config.encoderThreads);
+            read(node, "threads", "encoder_cpus", config.encoderCpus);
+
+            const YAML::Node roles = node["roles"];
+            if (!roles) return;
+            if (!roles.IsMap()) {
+                errors.push_back("threads.roles: expected a map");
+                return;
+            }
+            // 给出 roles 时整体替换默认放置，未列出的角色不做设置
+            config.threads.clear();
+            for (const auto& item : roles) {
+                const std::string role = item.first.as<std::string>();
+                const std::string path = "threads.roles." + role;
+                // "角色:源名" 只作用于该条流水线的线程
+                const std::string_view base = std::string_view(role).substr(0, role.find(':'));
+                if (std::find(ROLES.begin(), ROLES.end(), base) == ROLES.end()) {
+                    errors.push_back(path + ": unknown role");
+                    continue;
+                }
+                if (!section(item.second, path, {"cpus", "policy", "priority", "nice"})) continue;
+                RT::ThreadConfig thread;
+                read(item.second, path, "cpus", thread.cpus);
+                std::string policy = "other";
+                read(item.second, path, "policy", policy);
+                if (policy == "fifo") {
+                    thread.policy = RT::SchedPolicy::FIFO;
+                }
+                else if (policy != "other") {
+                    errors.push_back(path + ".policy: expected 'fifo' or 'other'");
+                }
+                read(item.second, path, "priority", thread.priority);
+                read(item.second, path, "nice", thread.nice);
+                config.threads[role] = thread;
+            }
+        }
+
+    private:
+        std::vector<std::string>& errors;
+    };
+
+    class Checker {
+    public:
+        explicit Checker(std::vector<std::string>& errors) : errors(errors) {}
+
+        void require(bool ok, const std::string& message) {
+            if (!ok) errors.push_back(message);
+        }
+
+        void file(const std::string& path, const std::string& key) {
+            std::error_code ec;
+            require(std::filesystem::is_regular_file(path, ec), key + ": file not found: " + path);
+        }
+
+        void cpus(const std::vector<int>& list, const std::string& key) {
+            for (int cpu : list) {
+                require(cpu >= 0 && cpu < CPU_SETSIZE, key + ": invalid CPU " + std::to_string(cpu));
+            }
+        }
+
+    private:
+        std::vector<std::string>& errors;
+    };
+
+    bool report(const std::vector<std::string>& errors, const std::string& source) {
+        for (const auto& error : errors) {
+            std::cerr << source << ": " << error << std::endl;
+        }
+        return errors.empty();
+    }
+}
+
+bool CONFIG::validate(const PipelineConfig& config) {
+    std::vector<std::string> errors;
+    Checker check(errors);
+
+    const CameraConfig& camera = config.camera;
+    check.require(camera.device >= 0, "camera.device must be >= 0");
+    // 左右两个镜头各占一半宽度
+    check.require(camera.width > 0 && camera.width % 2 == 0, "camera.width must be a positive even number");
+    check.require(camera.height > 0, "camera.height must be positive");
+    check.require(camera.fps > 0 && camera.fps <= 240, "camera.fps must be in 1~240");
+    check.require(camera.hfov_deg > 0.0 && camera.hfov_deg < 180.0, "camera.hfov_deg must be in (0, 180)");
+    const int lensWidth = camera.width / 2;
+
+    const DetectorConfig& detector = config.detector;
+    check.file(detector.model, "detector.model");
+    check.file(detector.classes, "detector.classes");
+    for (const auto& [key, size] : {std::pair{"detector.input_width", detector.input_width},
+                                    std::pair{"detector.input_height", detector.input_height}}) {
+        // 模型的最大下采样倍数为 32
+        check.require(size >= 32 && size <= 1280 && size % 32 == 0, std::string(key) + " must be a multiple of 32 in 32~1280");
+    }
+    check.require(detector.confidence > 0.f && detector.confidence < 1.f, "detector.confidence must be in (0, 1)");
+    check.require(detector.nms_iou > 0.f && detector.nms_iou <= 1.f, "detector.nms_iou must be in (0, 1]");
+    check.require(detector.near_obstacle_ratio > 0.f && detector.near_obstacle_ratio <= 1.f,
+                  "detector.near_obstacle_ratio must be in (0, 1]");
+    check.require(detector.display_scale > 0.0 && detector.display_scale <= 1.0, "detector.display_scale must be in (0, 1]");
+    check.require(detector.instances >= 1 && detector.instances <= 16, "detector.instances must be in 1~16");
+
+    const StreamConfig& stream = config.stream;
+    check.require(!stream.url.empty(), "stream.url must not be empty");
+    check.require(!stream.renditions.empty(), "stream.renditions must list at least one rendition");
+    for (size_t i = 0; i < stream.renditions.size(); i++) {
+        const RenditionConfig& r = stream.renditions[i];
+        const std::string key = "stream.renditions[" + std::to_string(i) + "]";
+        check.require(r.path.starts_with('/'), key + ".path must start with '/'");
+        // YUV420P 要求宽高为偶数；推流画面取自右镜头，不放大
+        check.require(r.width > 0 && r.height > 0 && r.width % 2 == 0 && r.height % 2 == 0,
+                      key + ": width and height must be positive even numbers");
+        check.require(r.width <= lensWidth && r.height <= camera.height,
+                      key + ": " + std::to_string(r.width) + "x" + std::to_string(r.height) + " exceeds the lens image "
+                      + std::to_string(lensWidth) + "x" + std::to_string(camera.height));
+        check.require(r.fps > 0 && r.fps <= camera.fps, key + ".fps must be in 1~camera.fps");
+        check.require(r.bitrate > 0, key + ".bitrate must be positive");
+        // 录像与码率阶梯都挂在第一路上
+        if (i > 0) {
+            const RenditionConfig& prev = stream.renditions[i - 1];
+            check.require(r.width * r.height <= prev.width * prev.height,
+                          key + ": renditions must be ordered from highest to lowest resolution");
+        }
+    }
+    if (!stream.renditions.empty()) {
+        const RenditionConfig& top = stream.renditions.front();
+        for (size_t i = 0; i < stream.rate_ladder.size(); i++) {
+            const RungConfig& rung = stream.rate_ladder[i];
+            const std::string key = "stream.rate_ladder[" + std::to_string(i) + "]";
+            check.require(rung.width > 0 && rung.height > 0 && rung.width % 2 == 0 && rung.height % 2 == 0,
+                          key + ": width and height must be positive even numbers");
+            check.require(rung.width <= top.width && rung.height <= top.height && rung.fps > 0 && rung.fps <= top.fps,
+                          key + " must not exceed the first rendition");
+            check.require(rung.bitrate > 0, key + ".bitrate must be positive");
+            if (i > 0) {
+                check.require(rung.bitrate <= stream.rate_ladder[i - 1].bitrate, key + ": ladder must be ordered from high to low bitrate");
+            }
+        }
+    }
+
+    const QueueConfig& queues = config.queues;
+    check.require(queues.frame_depth >= 1, "queues.frame_depth must be >= 1");
+    check.require(queues.stream_packets >= 1, "queues.stream_packets must be >= 1");
+    check.require(queues.recorder_packets >= 1, "queues.recorder_packets must be >= 1");
+    check.require(queues.alert_pending >= 1, "queues.alert_pending must be >= 1");
+    check.require(queues.snapshot_pending >= 1, "queues.snapshot_pending must be >= 1");
+
+    const StorageConfig& storage = config.storage;
+    check.require(!storage.picture_dir.empty() && !storage.video_dir.empty() && !storage.event_dir.empty(),
+                  "storage directories must not be empty");
+    check.require(storage.segment_seconds > 0, "storage.segment_seconds must be positive");
+    check.require(storage.pre_event_seconds >= 0 && storage.post_event_seconds >= 0, "storage event seconds must be >= 0");
+
+    check.require(config.display.label_scale > 0.0 && config.display.label_scale <= 4.0, "display.label_scale must be in (0, 4]");
+
+    const SessionConfig& session = config.session;
+    check.require(session.record.empty() || session.replay.empty(), "session.record and session.replay are mutually exclusive");
+    if (!session.replay.empty()) check.file(session.replay, "session.replay");
+    if (!session.imu_replay.empty()) check.file(session.imu_replay, "session.imu_replay");
+
+    int displays = 0;
+    int alerting = 0;
+    for (size_t i = 0; i < config.sources.size(); i++) {
+        const SourceConfig& source = config.sources[i];
+        const std::string key = "sources[" + std::to_string(i) + "]";
+        const bool plain = !source.name.empty() && std::all_of(source.name.begin(), source.name.end(), [](char c) {
+            return std::isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '_';
+        });
+        check.require(plain, key + ".name must be non-empty and contain only letters, digits, '-' and '_'");
+        check.require(source.device >= -1, key + ".device must be >= 0 (or -1 for camera.device)");
+        check.require(source.channel >= 0 && source.channel <= UINT16_MAX, key + ".channel must be in 0~65535");
+        if (!source.replay.empty()) check.file(source.replay, key + ".replay");
+        check.require(source.replay.empty() || source.replay == session.replay || session.record.empty(),
+                      key + ".replay cannot be combined with session.record");
+        check.require(source.stream_path.empty() || source.stream_path.starts_with('/'), key + ".stream_path must start with '/'");
+        for (size_t j = 0; j < i; j++) {
+            check.require(config.sources[j].name != source.name, key + ": duplicate name '" + source.name + "'");
+            check.require(config.sources[j].stream_path != source.stream_path, key + ": duplicate stream_path '" + source.stream_path + "'");
+        }
+        displays += source.display;
+        alerting += source.alerts;
+    }
+    check.require(displays <= 1, "sources: at most one source may set display");
+    check.require(alerting <= 1, "sources: at most one source may set alerts");
+
+    const DeviceConfig& devices = config.devices;
+    check.require(std::find(BAUD_RATES.begin(), BAUD_RATES.end(), devices.gnss_baud) != BAUD_RATES.end(),
+                  "devices.gnss_baud " + std::to_string(devices.gnss_baud) + " is not a standard baud rate");
+    check.require(devices.modem_poll_seconds > 0, "devices.modem_poll_seconds must be positive");
+
+    check.require(config.alert.latency_budget_ms > 0, "alert.latency_budget_ms must be positive");
+    check.require(config.alert.repeat_interval_ms >= 0, "alert.repeat_interval_ms must be >= 0");
+
+    const TelemetrySettings& telemetry = config.telemetry;
+    if (!telemetry.host.empty()) {
+        const bool udp = telemetry.transport == "udp";
+        check.require(udp || telemetry.transport == "tcp", "telemetry.transport must be 'udp' or 'tcp'");
+        check.require(telemetry.port > 0 && telemetry.port <= UINT16_MAX, "telemetry.port must be in 1~65535");
+        check.require(telemetry.device_id >= 0, "telemetry.device_id must be >= 0");
+        // 一批即一个 UDP 数据报
+        const int maxBatch = udp ? 65000 : 1024 * 1024;
+        check.require(telemetry.batch_bytes >= 64 && telemetry.batch_bytes <= maxBatch,
+                      "telemetry.batch_bytes must be in 64~" + std::to_string(maxBatch));
+        check.require(telemetry.batch_ms > 0, "telemetry.batch_ms must be positive");
+        check.require(telemetry.fix_interval_ms >= 0, "telemetry.fix_interval_ms must be >= 0");
+        check.require(telemetry.spool_mb >= 0 && telemetry.spool_mb <= 4096, "telemetry.spool_mb must be in 0~4096");
+        check.require(telemetry.retry_ms > 0, "telemetry.retry_ms must be positive");
+    }
+
+    const GovernorSettings& governor = config.governor;
+    if (governor.enabled) {
+        check.require(!governor.thermal_path.empty(), "governor.thermal_path must not be empty");
+        check.require(governor.interval_ms >= 100, "governor.interval_ms must be >= 100");
+        check.require(governor.cool_c < governor.hot_c && governor.hot_c <= governor.critical_c,
+                      "governor: expected cool_c < hot_c <= critical_c");
+        check.require(governor.miss_ratio > 0.0 && governor.miss_ratio < 1.0, "governor.miss_ratio must be in (0, 1)");
+        for (const auto& [stage, budget] : governor.deadlines_ms) {
+            check.require(stage == "detect" || stage == "latency", "governor.deadlines_ms." + stage + ": unknown stage");
+            check.require(budget > 0.0, "governor.deadlines_ms." + stage + " must be positive");
+        }
+        check.require(governor.down_after >= 1 && governor.up_after >= 1 && governor.settle >= 0,
+                      "governor: down_after and up_after must be >= 1, settle >= 0");
+        check.require(!governor.ladder.empty(), "governor.ladder must list at least one operating point");
+        for (size_t i = 0; i < governor.ladder.size(); i++) {
+            const GOV::OperatingPoint& point = governor.ladder[i];
+            const std::string key = "governor.ladder[" + std::to_string(i) + "]";
+            const bool plain = !point.name.empty() && std::all_of(point.name.begin(), point.name.end(), [](char c) {
+                return std::isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '_';
+            });
+            check.require(plain, key + ".name must be non-empty and contain only letters, digits, '-' and '_'");
+            check.require(point.detect_interval_ms >= 0, key + ".detect_interval_ms must be >= 0");
+            // 0 为 detector.input_width/height
+            for (const auto& [name, size] : {std::pair{".input_width", point.input_width}, std::pair{".input_height", point.input_height}}) {
+                check.require(size == 0 || (size >= 32 && size <= 1280 && size % 32 == 0),
+                              key + name + " must be 0 or a multiple of 32 in 32~1280");
+            }
+            check.require((point.input_width == 0) == (point.input_height == 0), key + ": input_width and input_height must both be set");
+            check.require(point.stream_rung >= 0, key + ".stream_rung must be >= 0");
+            check.require(point.capture_fps >= 0 && point.capture_fps <= camera.fps, key + ".capture_fps must be in 0~camera.fps");
+        }
+    }
+
+    const RT::RuntimeConfig& threads = config.threads;
+    check.require(threads.ortThreads >= 0 && threads.encoderThreads >= 0, "threads: thread counts must be >= 0");
+    check.require(threads.flowWorkers >= 0 && threads.flowWorkers <= 64, "threads.flow_workers must be in 0~64");
+    check.cpus(threads.ortCpus, "threads.ort_cpus");
+    check.cpus(threads.encoderCpus, "threads.encoder_cpus");
+    for (const auto& [role, thread] : threads.threads) {
+        const std::string key = "threads.roles." + role;
+        check.cpus(thread.cpus, key + ".cpus");
+        if (thread.policy == RT::SchedPolicy::FIFO) {
+            check.require(thread.priority >= 1 && thread.priority <= 99, key + ".priority must be in 1~99 for fifo");
+        }
+        check.require(thread.nice >= -20 && thread.nice <= 19, key + ".nice must be in -20~19");
+    }
+
+    return report(errors, "Config");
+}
+
+bool CONFIG::load(const std::string& path, PipelineConfig& config) {
+    YAML::Node root;
+    try {
+        root = YAML::LoadFile(path);
+    }
+    catch (const YAML::Exception& e) {
+        std::cerr << "Failed to read config " << path << ": " << e.what() << std::endl;
+        return false;
+    }
+
+    std::vector<std::string> errors;
+    Parser parser(errors);
+    // 空文件等同于全部使用默认值
+    if (root && !root.IsNull()) {
+        if (parser.section(root, path, {"camera", "detector", "stream", "queues", "storage", "display", "session",
+                                        "devices", "alert", "telemetry", "governor", "threads", "sources"})) {
+            parser.camera(root["camera"], config.camera);
+            parser.detector(root["detector"], config.detector);
+            parser.stream(root["stream"], config.stream);
+            parser.queues(root["queues"], config.queues);
+            parser.storage(root["storage"], config.storage);
+            parser.display(root["display"], config.display);
+            parser.session(root["session"], config.session);
+            parser.devices(root["devices"], config.devices);
+            parser.alert(root["alert"], config.alert);
+            parser.telemetry(root["telemetry"], config.telemetry);
+            parser.governor(root["governor"], config.governor);
+            parser.threads(root["threads"], config.threads);
+            parser.sources(root["sources"], config.sources);
+        }
+    }
+    // 解析出错时仍做取值校验，一次报告所有问题
+    const bool parsed = report(errors, path);
+    return validate(config) && parsed;
+}
+
+bool CONFIG::headless(const PipelineConfig& config) {
+    switch (config.display.mode) {
+        case DisplayMode::WINDOW:
+            return false;
+        case DisplayMode::HEADLESS:
+            return true;
+        default:
+            return std::getenv("DISPLAY") == nullptr && std::getenv("WAYLAND_DISPLAY") == nullptr;
+    }
+}
+
+std::vector<SourceConfig> CONFIG::resolveSources(const PipelineConfig& config) {
+    std::vector<SourceConfig> sources = config.sources;
+    if (sources.empty()) {
+        SourceConfig source;
+        source.name = "main";
+        source.device = config.camera.device;
+        source.replay = config.session.replay;
+        source.display = true;
+        source.alerts = true;
+        sources.push_back(source);
+    }
+    const bool noDisplay = headless(config);
+    for (auto& source : sources) {
+        if (source.device < 0) source.device = config.camera.device;
+        if (noDisplay) source.display = false;
+    }
+    return sources;
+}
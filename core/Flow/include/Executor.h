@@ -0,0 +1,75 @@
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace FLOW {
+    // 可提交给执行器的任务。任务对象由提交者持有，执行器只保存指针，提交不分配内存
+    class Task {
+    public:
+        virtual ~Task() = default;
+        virtual void run() = 0;
+    };
+
+    struct ExecutorStats {
+        size_t workers = 0;
+        uint64_t executed = 0;
+        uint64_t stolen = 0;            // 从其他工作线程队列中取得的任务
+    };
+
+    // 工作窃取线程池：每个工作线程一条双端队列，自己从尾部取（刚提交的下游任务，数据还在缓存中），
+    // 空闲时从其他线程队列的头部窃取；都没有任务时休眠。
+    // 工作线程以角色 flow 登记（线程名 flow:序号），配置中可用 "flow" 或 "flow:序号" 放置
+    class Executor {
+    public:
+        // workers 为 0 时取 CPU 核数
+        explicit Executor(size_t workers = 0);
+        ~Executor();
+        Executor(const Executor&) = delete;
+        Executor& operator=(const Executor&) = delete;
+
+        // 工作线程内提交的进入本线程队列，外部提交的轮流分给各工作线程。
+        // yield 为 true 时放在队列头部：本线程先执行其他任务，空闲线程可先把它窃取走
+        void submit(Task* task, bool yield = false);
+        // 等待正在执行的任务结束后退出各线程，队列中未执行的任务丢弃
+        void stop();
+
+        [[nodiscard]] size_t size() const { return workers.size(); }
+        [[nodiscard]] ExecutorStats stats() const;
+
+    private:
+        // 环形双端队列，满时扩容（只在启动阶段发生）
+        struct Worker {
+            std::mutex mtx;
+            std::vector<Task*> ring;
+            size_t head = 0;
+            size_t count = 0;
+            std::thread thread;
+
+            void push(Task* task, bool front);
+            Task* popBack();
+            Task* popFront();
+        };
+
+        void workerLoop(size_t index);
+        Task* steal(size_t thief);
+
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::mutex idle_mutex;
+        std::condition_variable idle_cv;
+        std::atomic<int64_t> pending{0};        // 已提交尚未取走的任务数
+        std::atomic<bool> stopping{false};
+        std::atomic<size_t> next_worker{0};
+        std::atomic<uint64_t> executed{0};
+        std::atomic<uint64_t> stolen{0};
+    };
+}
+
+#endif //EXECUTOR_H
@@ -0,0 +1,335 @@
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include "BoundedQueue.h"
+#include "Executor.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// 数据流图：处理阶段声明为节点，节点之间以有类型、有界的边相连，节点作为任务在共享的执行器上运行，
+// 增加一个阶段不需要增加线程。
+//   - 每条边一个生产者、一个消费者；源节点与中间节点可向多条边扇出
+//   - 节点只在有输入（源节点：未结束）且所有 BLOCK 边都有空位时被调度，同一节点不会并发执行，处理顺序与到达顺序一致
+//   - 结束：源节点返回 false 或图停止后关闭输出边，下游处理完剩余数据后依次结束
+//   - 数据项在节点与边的槽位之间复制或交换，处理后经 SYNC::recycle 释放引用、保留缓冲，
+//     带缓冲的数据类型提供 reset()（释放帧等引用并 clear 容器）即可在稳定运行时不分配内存
+namespace FLOW {
+    using Clock = std::chrono::steady_clock;
+
+    enum class DropPolicy {
+        BLOCK,          // 满时暂停生产者（背压），不丢数据
+        DROP_OLDEST,    // 满时覆盖最旧的，消费者总是处理最新数据
+        DROP_NEWEST,    // 满时丢弃新到的
+    };
+
+    class Graph;
+    class Node;
+
+    struct EdgeStats {
+        std::string name;
+        size_t capacity = 0;
+        uint64_t pushed = 0;
+        uint64_t dropped = 0;
+    };
+
+    struct NodeStats {
+        std::string name;
+        uint64_t items = 0;             // 处理（源节点：产生）的数据项
+        uint64_t activations = 0;       // 被调度执行的次数
+        double busyMs = 0.0;
+    };
+
+    // 边中与类型无关的部分：关闭状态、两端节点与统计
+    class EdgeBase {
+    public:
+        EdgeBase(std::string name, size_t capacity, DropPolicy policy);
+        virtual ~EdgeBase() = default;
+        EdgeBase(const EdgeBase&) = delete;
+        EdgeBase& operator=(const EdgeBase&) = delete;
+
+        [[nodiscard]] const std::string& name() const { return edge_name; }
+        [[nodiscard]] DropPolicy policy() const { return drop_policy; }
+        [[nodiscard]] bool hasRoom() const;
+        [[nodiscard]] bool hasItems() const;
+        // 已关闭且取空，消费者可以结束
+        [[nodiscard]] bool drained() const;
+        [[nodiscard]] EdgeStats stats() const;
+
+    protected:
+        friend class Node;
+        friend class Graph;
+
+        // 在持有 mtx 时调用
+        [[nodiscard]] virtual size_t sizeLocked() const = 0;
+        // 入队后通知消费者，出队后通知等待空位的生产者
+        void pushed();
+        void popped();
+        void close();
+
+        const std::string edge_name;
+        const size_t capacity;
+        const DropPolicy drop_policy;
+        mutable std::mutex mtx;
+        bool closed = false;
+        uint64_t pushed_count = 0;
+        uint64_t dropped_count = 0;
+        Node* producer = nullptr;
+        Node* consumer = nullptr;
+    };
+
+    template <typename T>
+    class Edge final : public EdgeBase {
+    public:
+        Edge(std::string name, size_t capacity, DropPolicy policy) : EdgeBase(std::move(name), capacity, policy), queue(capacity) {}
+
+        // 返回 false 表示数据被丢弃（DROP_NEWEST 满，或 BLOCK 满时由图外调用）或覆盖了最旧的一项
+        bool push(const T& value) {
+            bool kept = true;
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (closed) return false;
+                if (queue.size() == queue.capacity() && drop_policy != DropPolicy::DROP_OLDEST) {
+                    dropped_count++;
+                    return false;
+                }
+                kept = queue.push(value);
+                pushed_count++;
+                if (!kept) dropped_count++;
+            }
+            pushed();
+            return kept;
+        }
+
+        bool pop(T& value) {
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (!queue.pop(value)) return false;
+            }
+            popped();
+            return true;
+        }
+
+    private:
+        [[nodiscard]] size_t sizeLocked() const override { return queue.size(); }
+
+        SYNC::BoundedQueue<T> queue;
+    };
+
+    // 节点调度与结束的公共部分；具体的处理由 Source / Stage / Sink 实现
+    class Node : public Task {
+    public:
+        Node(Graph& graph, std::string name);
+        [[nodiscard]] const std::string& name() const { return node_name; }
+        [[nodiscard]] bool done() const { return finished.load(std::memory_order_acquire); }
+        [[nodiscard]] NodeStats stats() const;
+
+        void run() final;
+        // 可执行时提交给执行器；已提交或正在执行时什么也不做，执行结束前会再检查一次
+        void schedule(bool yield = false);
+
+    protected:
+        // 处理一项数据，没有可处理的数据时返回 false
+        virtual bool step() = 0;
+        [[nodiscard]] virtual bool isSource() const { return false; }
+
+        void attachInput(EdgeBase& edge);
+        void attachOutput(EdgeBase& edge);
+
+        Graph& graph;
+
+    private:
+        friend class Graph;
+
+        [[nodiscard]] bool outputsHaveRoom() const;
+        [[nodiscard]] bool runnable() const;
+        void finish();
+
+        // 每次调度最多处理的数据项，之后让出线程给其他节点
+        static constexpr int BATCH = 4;
+        // 调度状态：空闲；已提交或正在执行；执行期间又收到了通知
+        static constexpr int IDLE = 0;
+        static constexpr int SCHEDULED = 1;
+        static constexpr int NOTIFIED = 2;
+
+        const std::string node_name;
+        EdgeBase* input = nullptr;
+        std::vector<EdgeBase*> outputs;
+        std::atomic<int> state{IDLE};
+        std::atomic<bool> finished{false};
+        // 只在节点自身执行时写入
+        uint64_t item_count = 0;
+        uint64_t activation_count = 0;
+        double busy_ms = 0.0;
+        mutable std::mutex stats_mutex;
+    };
+
+    // 源节点：每次调用 produce 产生一项，返回 false 表示数据源结束。
+    // produce 可以阻塞（如等待相机），执行器线程数应留出余量
+    template <typename Out>
+    class Source final : public Node {
+    public:
+        using Produce = std::function<bool(Out&)>;
+
+        Source(Graph& graph, std::string name, Produce produce) : Node(graph, std::move(name)), produce(std::move(produce)) {}
+
+        Source& to(Edge<Out>& edge) {
+            attachOutput(edge);
+            targets.push_back(&edge);
+            return *this;
+        }
+
+    private:
+        bool step() override {
+            if (!produce(item)) return false;
+            for (Edge<Out>* edge : targets) edge->push(item);
+            // 不持有已送出的数据，下游释放后即可回收
+            SYNC::recycle(item);
+            return true;
+        }
+        [[nodiscard]] bool isSource() const override { return true; }
+
+        Produce produce;
+        std::vector<Edge<Out>*> targets;
+        Out item{};
+    };
+
+    // 中间节点：process 返回 true 时把 out 发往所有输出边
+    template <typename In, typename Out>
+    class Stage final : public Node {
+    public:
+        using Process = std::function<bool(In&, Out&)>;
+
+        Stage(Graph& graph, std::string name, Edge<In>& input, Process process) :
+            Node(graph, std::move(name)), source(input), process(std::move(process)) {
+            attachInput(input);
+        }
+
+        Stage& to(Edge<Out>& edge) {
+            attachOutput(edge);
+            targets.push_back(&edge);
+            return *this;
+        }
+
+    private:
+        bool step() override {
+            if (!source.pop(item)) return false;
+            if (process(item, result)) {
+                for (Edge<Out>* edge : targets) edge->push(result);
+            }
+            SYNC::recycle(item);
+            SYNC::recycle(result);
+            return true;
+        }
+
+        Edge<In>& source;
+        Process process;
+        std::vector<Edge<Out>*> targets;
+        In item{};
+        Out result{};
+    };
+
+    // 终点节点
+    template <typename In>
+    class Sink final : public Node {
+    public:
+        using Consume = std::function<void(In&)>;
+
+        Sink(Graph& graph, std::string name, Edge<In>& input, Consume consume) :
+            Node(graph, std::move(name)), source(input), consume(std::move(consume)) {
+            attachInput(input);
+        }
+
+    private:
+        bool step() override {
+            if (!source.pop(item)) return false;
+            consume(item);
+            SYNC::recycle(item);
+            return true;
+        }
+
+        Edge<In>& source;
+        Consume consume;
+        In item{};
+    };
+
+    struct GraphStats {
+        std::string name;
+        std::vector<NodeStats> nodes;
+        std::vector<EdgeStats> edges;
+    };
+
+    // 图拥有其节点与边，须在 start 之前建好；多个图可共用一个执行器
+    class Graph {
+    public:
+        Graph(Executor& executor, std::string name);
+        ~Graph();
+        Graph(const Graph&) = delete;
+        Graph& operator=(const Graph&) = delete;
+
+        template <typename T>
+        Edge<T>& edge(std::string name, size_t capacity, DropPolicy policy) {
+            auto owned = std::make_unique<Edge<T>>(std::move(name), capacity, policy);
+            Edge<T>& ref = *owned;
+            edges.push_back(std::move(owned));
+            return ref;
+        }
+
+        template <typename Out>
+        Source<Out>& source(std::string name, typename Source<Out>::Produce produce) {
+            return add(std::make_unique<Source<Out>>(*this, std::move(name), std::move(produce)));
+        }
+
+        template <typename In, typename Out>
+        Stage<In, Out>& stage(std::string name, Edge<In>& input, typename Stage<In, Out>::Process process) {
+            return add(std::make_unique<Stage<In, Out>>(*this, std::move(name), input, std::move(process)));
+        }
+
+        template <typename In>
+        Sink<In>& sink(std::string name, Edge<In>& input, typename Sink<In>::Consume consume) {
+            return add(std::make_unique<Sink<In>>(*this, std::move(name), input, std::move(consume)));
+        }
+
+        // 检查每条边两端都已连接后调度源节点，失败时返回 false
+        bool start();
+        // 源节点不再产生数据，其余节点处理完已有数据后结束
+        void stop();
+        // 等待所有节点结束
+        void wait();
+        [[nodiscard]] bool finished() const;
+        [[nodiscard]] bool stopping() const { return stop_requested.load(std::memory_order_relaxed); }
+        [[nodiscard]] Executor& executor() const { return pool; }
+        [[nodiscard]] GraphStats stats() const;
+
+    private:
+        friend class Node;
+
+        template <typename N>
+        N& add(std::unique_ptr<N> node) {
+            N& ref = *node;
+            nodes.push_back(std::move(node));
+            return ref;
+        }
+        void nodeFinished();
+
+        Executor& pool;
+        const std::string graph_name;
+        std::vector<std::unique_ptr<EdgeBase>> edges;
+        std::vector<std::unique_ptr<Node>> nodes;
+        std::atomic<bool> stop_requested{false};
+        std::vector<std::string> wiring_errors;      // 建图时发现的连接错误，start 时报告
+        bool started = false;
+        mutable std::mutex done_mutex;
+        std::condition_variable done_cv;
+        size_t running = 0;
+    };
+}
+
+#endif //GRAPH_H
@@ -0,0 +1,133 @@
+#include "Executor.h"
+#include "Runtime.h"
+#include <algorithm>
+#include <string>
+
+namespace {
+    // 当前线程所属的执行器与序号，用于把工作线程内的提交放进本线程队列
+    thread_local const FLOW::Executor* current_executor = nullptr;
+    thread_local size_t current_worker = 0;
+
+    constexpr size_t INITIAL_RING = 16;
+}
+
+void FLOW::Executor::Worker::push(Task* task, bool front) {
+    if (count == ring.size()) {
+        // 按顺序搬到新数组的开头
+        std::vector<Task*> grown(std::max(INITIAL_RING, ring.size() * 2));
+        for (size_t i = 0; i < count; i++) grown[i] = ring[(head + i) % ring.size()];
+        ring.swap(grown);
+        head = 0;
+    }
+    if (front) {
+        head = (head + ring.size() - 1) % ring.size();
+        ring[head] = task;
+    }
+    else {
+        ring[(head + count) % ring.size()] = task;
+    }
+    count++;
+}
+
+FLOW::Task* FLOW::Executor::Worker::popBack() {
+    if (count == 0) return nullptr;
+    count--;
+    return ring[(head + count) % ring.size()];
+}
+
+FLOW::Task* FLOW::Executor::Worker::popFront() {
+    if (count == 0) return nullptr;
+    Task* task = ring[head];
+    head = (head + 1) % ring.size();
+    count--;
+    return task;
+}
+
+FLOW::Executor::Executor(size_t count) {
+    if (count == 0) count = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t i = 0; i < count; i++) {
+        workers.push_back(std::make_unique<Worker>());
+        workers.back()->ring.resize(INITIAL_RING);
+    }
+    // 所有队列建好后再启动线程，窃取时不会访问到未构造的队列
+    for (size_t i = 0; i < count; i++) {
+        workers[i]->thread = std::thread(&Executor::workerLoop, this, i);
+    }
+}
+
+FLOW::Executor::~Executor() {
+    stop();
+}
+
+void FLOW::Executor::submit(Task* task, bool yield) {
+    const size_t index = current_executor == this ? current_worker
+                                                  : next_worker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+    // 先计数再入队：被唤醒的线程可能暂时找不到任务，但不会漏掉
+    pending.fetch_add(1, std::memory_order_acq_rel);
+    {
+        std::lock_guard<std::mutex> lock(workers[index]->mtx);
+        workers[index]->push(task, yield);
+    }
+    {
+        // 与休眠线程检查 pending 互斥，避免在其检查之后、休眠之前通知而丢失唤醒
+        std::lock_guard<std::mutex> lock(idle_mutex);
+    }
+    idle_cv.notify_one();
+}
+
+void FLOW::Executor::stop() {
+    {
+        std::lock_guard<std::mutex> lock(idle_mutex);
+        stopping.store(true, std::memory_order_relaxed);
+    }
+    idle_cv.notify_all();
+    for (auto& worker : workers) {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+}
+
+FLOW::Task* FLOW::Executor::steal(size_t thief) {
+    for (size_t k = 1; k < workers.size(); k++) {
+        Worker& victim = *workers[(thief + k) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mtx);
+        if (Task* task = victim.popFront()) return task;
+    }
+    return nullptr;
+}
+
+void FLOW::Executor::workerLoop(size_t index) {
+    RT::ThreadScope scope("flow", std::to_string(index));
+    current_executor = this;
+    current_worker = index;
+    Worker& self = *workers[index];
+    while (true) {
+        Task* task;
+        {
+            std::lock_guard<std::mutex> lock(self.mtx);
+            task = self.popBack();
+        }
+        if (task == nullptr && (task = steal(index)) != nullptr) {
+            stolen.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (task != nullptr) {
+            pending.fetch_sub(1, std::memory_order_acq_rel);
+            task->run();
+            executed.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(idle_mutex);
+        idle_cv.wait(lock, [this] {
+            return stopping.load(std::memory_order_relaxed) || pending.load(std::memory_order_acquire) > 0;
+        });
+        if (stopping.load(std::memory_order_relaxed)) break;
+    }
+    current_executor = nullptr;
+}
+
+FLOW::ExecutorStats FLOW::Executor::stats() const {
+    ExecutorStats result;
+    result.workers = workers.size();
+    result.executed = executed.load(std::memory_order_relaxed);
+    result.stolen = stolen.load(std::memory_order_relaxed);
+    return result;
+}
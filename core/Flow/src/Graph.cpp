@@ -0,0 +1,213 @@
+#include "Graph.h"
+#include <algorithm>
+#include <iostream>
+
+FLOW::EdgeBase::EdgeBase(std::string name, size_t capacity, DropPolicy policy) :
+    edge_name(std::move(name)), capacity(std::max<size_t>(capacity, 1)), drop_policy(policy) {}
+
+bool FLOW::EdgeBase::hasRoom() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return sizeLocked() < capacity;
+}
+
+bool FLOW::EdgeBase::hasItems() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return sizeLocked() > 0;
+}
+
+bool FLOW::EdgeBase::drained() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return closed && sizeLocked() == 0;
+}
+
+FLOW::EdgeStats FLOW::EdgeBase::stats() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return {edge_name, capacity, pushed_count, dropped_count};
+}
+
+void FLOW::EdgeBase::pushed() {
+    if (consumer != nullptr) consumer->schedule();
+}
+
+void FLOW::EdgeBase::popped() {
+    // 只有 BLOCK 边会让生产者等待空位
+    if (drop_policy == DropPolicy::BLOCK && producer != nullptr) producer->schedule();
+}
+
+void FLOW::EdgeBase::close() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        closed = true;
+    }
+    if (consumer != nullptr) consumer->schedule();
+}
+
+FLOW::Node::Node(Graph& graph, std::string name) : graph(graph), node_name(std::move(name)) {}
+
+void FLOW::Node::attachInput(EdgeBase& edge) {
+    if (edge.consumer != nullptr) {
+        graph.wiring_errors.push_back("edge " + edge.name() + " has more than one consumer");
+        return;
+    }
+    edge.consumer = this;
+    input = &edge;
+}
+
+void FLOW::Node::attachOutput(EdgeBase& edge) {
+    if (edge.producer != nullptr) {
+        graph.wiring_errors.push_back("edge " + edge.name() + " has more than one producer");
+        return;
+    }
+    edge.producer = this;
+    outputs.push_back(&edge);
+}
+
+bool FLOW::Node::outputsHaveRoom() const {
+    return std::all_of(outputs.begin(), outputs.end(), [](const EdgeBase* edge) {
+        return edge->policy() != DropPolicy::BLOCK || edge->hasRoom();
+    });
+}
+
+bool FLOW::Node::runnable() const {
+    if (!outputsHaveRoom()) return false;
+    // 输入关闭后也要调度一次，以便结束并关闭下游
+    return isSource() || input->hasItems() || input->drained();
+}
+
+void FLOW::Node::schedule(bool yield) {
+    if (finished.load(std::memory_order_acquire)) return;
+    int current = state.load();
+    while (true) {
+        if (current == IDLE) {
+            if (state.compare_exchange_weak(current, SCHEDULED)) {
+                graph.pool.submit(this, yield);
+                return;
+            }
+        }
+        else if (current == SCHEDULED) {
+            // 正在执行：留下标记，由执行者在让出前再检查一次
+            if (state.compare_exchange_weak(current, NOTIFIED)) return;
+        }
+        else {
+            return;
+        }
+    }
+}
+
+void FLOW::Node::run() {
+    const Clock::time_point begin = Clock::now();
+    int processed = 0;
+    bool end = false;
+    while (processed < BATCH && outputsHaveRoom()) {
+        if (isSource() && graph.stopping()) {
+            end = true;
+            break;
+        }
+        if (step()) {
+            processed++;
+            continue;
+        }
+        // 源节点结束，或输入已关闭且取空
+        end = isSource() || input->drained();
+        break;
+    }
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        activation_count++;
+        item_count += processed;
+        busy_ms += std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+    }
+    if (end) {
+        // 状态保持为已调度，之后不会再被调度
+        finish();
+        return;
+    }
+    while (true) {
+        state.store(SCHEDULED);
+        if (runnable()) {
+            // 源节点排在本线程其他任务之后，刚送出的数据先由下游处理
+            graph.pool.submit(this, isSource());
+            return;
+        }
+        // 让出执行权是最后一次访问本节点：之后其他线程可能调度并结束它，图也可能随之析构。
+        // 失败说明检查期间收到了通知，重新检查
+        int expected = SCHEDULED;
+        if (state.compare_exchange_strong(expected, IDLE)) return;
+    }
+}
+
+void FLOW::Node::finish() {
+    finished.store(true, std::memory_order_release);
+    for (EdgeBase* edge : outputs) edge->close();
+    // 之后图可能随时析构，不能再访问本节点
+    graph.nodeFinished();
+}
+
+FLOW::NodeStats FLOW::Node::stats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    return {node_name, item_count, activation_count, busy_ms};
+}
+
+FLOW::Graph::Graph(Executor& executor, std::string name) : pool(executor), graph_name(std::move(name)) {}
+
+FLOW::Graph::~Graph() {
+    stop();
+    wait();
+}
+
+bool FLOW::Graph::start() {
+    for (const auto& edge : edges) {
+        if (edge->producer == nullptr) wiring_errors.push_back("edge " + edge->name() + " has no producer");
+        if (edge->consumer == nullptr) wiring_errors.push_back("edge " + edge->name() + " has no consumer");
+    }
+    if (!wiring_errors.empty()) {
+        for (const auto& error : wiring_errors) {
+            std::cerr << "Graph " << graph_name << ": " << error << std::endl;
+        }
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(done_mutex);
+        running = nodes.size();
+        started = true;
+    }
+    for (const auto& node : nodes) {
+        if (node->isSource()) node->schedule();
+    }
+    return true;
+}
+
+void FLOW::Graph::stop() {
+    stop_requested.store(true, std::memory_order_relaxed);
+    // 等待空位的源节点不在队列中，调度一次让它看到停止标志
+    std::lock_guard<std::mutex> lock(done_mutex);
+    if (!started) return;
+    for (const auto& node : nodes) {
+        if (node->isSource()) node->schedule();
+    }
+}
+
+void FLOW::Graph::wait() {
+    std::unique_lock<std::mutex> lock(done_mutex);
+    done_cv.wait(lock, [this] { return running == 0; });
+}
+
+bool FLOW::Graph::finished() const {
+    std::lock_guard<std::mutex> lock(done_mutex);
+    return started && running == 0;
+}
+
+void FLOW::Graph::nodeFinished() {
+    // 持锁通知：等待者醒来后可能立即析构图
+    std::lock_guard<std::mutex> lock(done_mutex);
+    running--;
+    done_cv.notify_all();
+}
+
+FLOW::GraphStats FLOW::Graph::stats() const {
+    GraphStats result;
+    result.name = graph_name;
+    for (const auto& node : nodes) result.nodes.push_back(node->stats());
+    for (const auto& edge : edges) result.edges.push_back(edge->stats());
+    return result;
+}
@@ -0,0 +1,102 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace FRAME {
+    using Clock = std::chrono::steady_clock;
+
+    // 每帧惰性构建的多尺度图像金字塔：
+    // 任意 (roi, size) 层只计算一次并被所有消费者复用，
+    // 新层从已计算的、覆盖该 roi 的最近较精细层缩放得到，而不是每次从原图缩放。
+    // 帧被复用时各层保留自己的缓冲，层的组合不变时稳定运行中不再分配内存。
+    class Pyramid {
+    public:
+        explicit Pyramid(const cv::Mat& base);
+        Pyramid(const Pyramid&) = delete;
+        Pyramid& operator=(const Pyramid&) = delete;
+
+        // 换成新的基图，清除各层的计算结果但保留缓冲；调用时不得有其他线程访问
+        void reset(const cv::Mat& base);
+        // 放开对基图的所有引用（基图本身与直接取视图的层）
+        void release();
+
+        // roi 为原图坐标系下的区域，size 为目标尺寸；返回的图像只读，生命周期与金字塔相同
+        const cv::Mat& level(const cv::Rect& roi, const cv::Size& size);
+        // 整幅图像按 size 缩放
+        const cv::Mat& level(const cv::Size& size);
+
+        [[nodiscard]] const cv::Mat& base() const { return _base; }
+        [[nodiscard]] size_t levelCount();
+
+    private:
+        struct Level {
+            Level(const cv::Rect& roi, const cv::Size& size) : roi(roi), size(size) {}
+            cv::Rect roi;          // 原图坐标
+            cv::Size size;         // 缩放后尺寸
+            cv::Mat image;
+            bool view = false;     // image 是基图或其他层的视图，不拥有缓冲
+            std::mutex build_mutex;
+            std::atomic<bool> ready{false};
+            [[nodiscard]] double scaleX() const { return static_cast<double>(size.width) / roi.width; }
+            [[nodiscard]] double scaleY() const { return static_cast<double>(size.height) / roi.height; }
+        };
+
+        void build(Level& level);
+
+        cv::Mat _base;
+        std::mutex _mutex;
+        std::list<Level> _levels;  // list 保证元素地址稳定
+    };
+
+    // 一次采集得到的帧：原始图像、采集时间戳与共享金字塔
+    struct Frame {
+        Frame(uint64_t sequence, const cv::Mat& image);
+        Frame(const Frame&) = delete;
+        Frame& operator=(const Frame&) = delete;
+
+        // 新图像已读入 image 后调用：更新序号与采集时间，金字塔改用新图像
+        void reset(uint64_t sequence);
+
+        // 双目相机左右镜头各占一半宽度
+        [[nodiscard]] cv::Rect fullRoi() const { return {0, 0, image.cols, image.rows}; }
+        [[nodiscard]] cv::Rect leftRoi() const { return {0, 0, image.cols / 2, image.rows}; }
+        [[nodiscard]] cv::Rect rightRoi() const { return {image.cols / 2, 0, image.cols / 2, image.rows}; }
+
+        uint64_t sequence;
+        Clock::time_point captureTime;
+        cv::Mat image;
+        Pyramid pyramid;
+    };
+    using FramePtr = std::shared_ptr<Frame>;
+
+    // 帧对象池，只由采集线程使用。所有消费者释放后帧连同图像缓冲与金字塔各层回到池中，
+    // 相机直接读入复用的缓冲，稳定运行时采集不再分配内存。
+    // 图像仍被其他模块持有（联播转换、拍照、会话记录的队列中的 cv::Mat）的帧不会被复用，
+    // 池按需增长，大小稳定在同时在用的帧数
+    class FramePool {
+    public:
+        explicit FramePool(size_t reserve = 8);
+        FramePool(const FramePool&) = delete;
+        FramePool& operator=(const FramePool&) = delete;
+
+        // 取一个空闲帧，调用者读入图像后调用 Frame::reset
+        FramePtr acquire();
+
+        [[nodiscard]] size_t size() const { return frames.size(); }
+        // 没有空闲帧而新建的次数（含启动时的预热）
+        [[nodiscard]] uint64_t misses() const { return created; }
+
+    private:
+        std::vector<FramePtr> frames;
+        uint64_t created = 0;
+    };
+}
+
+#endif //FRAME_H
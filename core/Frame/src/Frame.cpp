@@ -0,0 +1,138 @@
+#include "Frame.h"
+#include <cmath>
+
+FRAME::Pyramid::Pyramid(const cv::Mat& base) : _base(base) {}
+
+void FRAME::Pyramid::reset(const cv::Mat& base) {
+    release();
+    _base = base;
+}
+
+void FRAME::Pyramid::release() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _base.release();
+    for (auto& l : _levels) {
+        // 自有缓冲的层保留，下次同尺寸 resize 直接写入
+        if (l.view) {
+            l.image.release();
+            l.view = false;
+        }
+        l.ready.store(false, std::memory_order_relaxed);
+    }
+}
+
+const cv::Mat& FRAME::Pyramid::level(const cv::Size& size) {
+    return level(cv::Rect(0, 0, _base.cols, _base.rows), size);
+}
+
+const cv::Mat& FRAME::Pyramid::level(const cv::Rect& roi, const cv::Size& size) {
+    Level* entry = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& l : _levels) {
+            if (l.roi == roi && l.size == size) {
+                entry = &l;
+                break;
+            }
+        }
+        if (entry == nullptr) {
+            entry = &_levels.emplace_back(roi, size);
+        }
+    }
+    // 同一层并发请求时只有一个线程计算，其余线程等待结果
+    if (!entry->ready.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(entry->build_mutex);
+        if (!entry->ready.load(std::memory_order_relaxed)) build(*entry);
+    }
+    return entry->image;
+}
+
+size_t FRAME::Pyramid::levelCount() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _levels.size();
+}
+
+void FRAME::Pyramid::build(Level& level) {
+    // 原图尺寸的层直接取视图，不拷贝
+    if (level.roi.size() == level.size) {
+        level.image = _base(level.roi);
+        level.view = true;
+        level.ready.store(true, std::memory_order_release);
+        return;
+    }
+
+    // 在已完成的层中找覆盖 roi 且两个方向分辨率都不低于目标的最粗层
+    const double needX = level.scaleX();
+    const double needY = level.scaleY();
+    const Level* source = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (const auto& l : _levels) {
+            if (&l == &level || !l.ready.load(std::memory_order_acquire)) continue;
+            if ((l.roi & level.roi) != level.roi) continue;
+            if (l.scaleX() < needX || l.scaleY() < needY) continue;
+            if (source == nullptr || l.scaleX() * l.scaleY() < source->scaleX() * source->scaleY()) {
+                source = &l;
+            }
+        }
+    }
+
+    cv::Mat src;
+    if (source == nullptr) {
+        src = _base(level.roi);
+    }
+    else {
+        // roi 映射到源层坐标，取整后裁剪到源层范围内
+        const double sx = source->scaleX(), sy = source->scaleY();
+        cv::Rect crop(static_cast<int>(std::lround((level.roi.x - source->roi.x) * sx)),
+                      static_cast<int>(std::lround((level.roi.y - source->roi.y) * sy)),
+                      static_cast<int>(std::lround(level.roi.width * sx)),
+                      static_cast<int>(std::lround(level.roi.height * sy)));
+        crop &= cv::Rect(0, 0, source->image.cols, source->image.rows);
+        src = source->image(crop);
+    }
+
+    if (src.size() == level.size) {
+        level.image = src;
+        level.view = true;
+    }
+    else {
+        if (level.view) {
+            // 上一帧这一层是视图，不能写入别人的缓冲
+            level.image.release();
+            level.view = false;
+        }
+        // 缩小一半以上时用 INTER_AREA 抗混叠，其余与原先一致用双线性
+        const bool shrinkHalf = level.size.width * 2 <= src.cols && level.size.height * 2 <= src.rows;
+        cv::resize(src, level.image, level.size, 0, 0, shrinkHalf ? cv::INTER_AREA : cv::INTER_LINEAR);
+    }
+    level.ready.store(true, std::memory_order_release);
+}
+
+FRAME::Frame::Frame(uint64_t sequence, const cv::Mat& image) :
+    sequence(sequence), captureTime(Clock::now()), image(image), pyramid(image) {}
+
+void FRAME::Frame::reset(uint64_t sequence) {
+    this->sequence = sequence;
+    captureTime = Clock::now();
+    pyramid.reset(image);
+}
+
+FRAME::FramePool::FramePool(size_t reserve) {
+    frames.reserve(reserve);
+}
+
+FRAME::FramePtr FRAME::FramePool::acquire() {
+    for (const auto& frame : frames) {
+        // 只有池本身持有时才空闲；其他线程释放引用时的写入在此之后可见
+        if (frame.use_count() != 1) continue;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        frame->pyramid.release();
+        // 图像缓冲仍被其他模块引用，写入新图像会改写它们正在使用的数据
+        if (frame->image.u != nullptr && CV_XADD(&frame->image.u->refcount, 0) > 1) continue;
+        return frame;
+    }
+    created++;
+    frames.push_back(std::make_shared<Frame>(0, cv::Mat()));
+    return frames.back();
+}
@@ -0,0 +1,102 @@
+#ifndef GOVERNOR_H
+#define GOVERNOR_H
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 性能调节：被动散热的板卡持续推理与编码会触发降频，帧耗时成倍增加。按 SoC 温度与各阶段的期限
+// 超时比例，在一组由高到低的工作点之间切换（推理间隔、网络输入尺寸、推流档位、采集帧率）。
+// 降档快、升档慢：温度在 cool_c 与 hot_c 之间时保持当前档；升档后很快又降档时加倍升档等待，避免振荡
+namespace GOV {
+    using Clock = std::chrono::steady_clock;
+
+    // 一个工作点，0 表示使用配置中的原值
+    struct OperatingPoint {
+        std::string name;
+        int detect_interval_ms = 0;         // 两次推理的最小间隔，0 为每帧都推理
+        int input_width = 0;                // 网络输入尺寸，须为 32 的倍数且模型输入为动态尺寸
+        int input_height = 0;
+        int stream_rung = 0;                // 推流码率阶梯允许的最高档（下标），拥塞控制只在其下方升降
+        int capture_fps = 0;                // 解码的帧率，其余帧只取出不解码；0 为相机帧率
+    };
+
+    struct GovernorConfig {
+        std::string thermal_path = "/sys/class/thermal/thermal_zone0/temp";    // 毫摄氏度；可指向普通文件模拟
+        std::chrono::milliseconds interval{1000};   // 采样与决策周期
+        double hot_c = 75.0;                // 达到此温度视为过热
+        double cool_c = 65.0;               // 低于此温度才允许升档
+        double critical_c = 82.0;           // 达到此温度立即降档，不等待连续采样
+        double miss_ratio = 0.2;            // 周期内超过期限的比例高于此值视为过载，低于其一半视为宽裕
+        std::map<std::string, double, std::less<>> deadlines_ms;    // 阶段名 -> 期限（毫秒）
+        int down_after = 2;                 // 连续过热或过载的周期数达到后降一档
+        int up_after = 10;                  // 连续宽裕的周期数达到后升一档
+        int settle = 15;                    // 降档后温度回落需要时间，这么多个周期内不再因过热（未到 critical_c）继续降档
+        int max_up_after = 120;             // 升档等待按倍数退避的上限
+        std::vector<OperatingPoint> ladder; // 第 0 档为满负荷，越往后负载越低
+        std::string state_file;             // 每个周期写入当前状态（JSON），供监控读取；空则不写
+    };
+
+    struct GovernorState {
+        size_t level = 0;
+        std::string name;
+        double temperature_c = NAN;         // 读不到温度时为 NaN，只按期限调节
+        std::string worst_stage;            // 本周期超时比例最高的阶段
+        double worst_miss_ratio = 0.0;
+        std::string reason = "start";       // 最近一次换档的原因：critical、hot、deadline、recovered
+        uint64_t steps_down = 0;
+        uint64_t steps_up = 0;
+    };
+
+    // record 可由任意线程调用；poll、evaluate、point、state 只在同一个线程（主循环）中调用
+    class Governor {
+    public:
+        explicit Governor(GovernorConfig config);
+
+        // 阶段编号，未配置期限的阶段返回 -1（record 忽略）
+        [[nodiscard]] int stage(std::string_view name) const;
+        // 一次阶段耗时
+        void record(int stage, double ms);
+
+        // 到采样周期时读取温度与各阶段的超时比例并决策，写出状态文件；档位变化时返回 true
+        bool poll(Clock::time_point now = Clock::now());
+        // 一次决策，不读温度也不清零计数；返回决策后的档位
+        size_t evaluate(double temperature_c, double miss_ratio);
+
+        [[nodiscard]] const OperatingPoint& point() const { return config.ladder[level]; }
+        [[nodiscard]] GovernorState state() const;
+
+    private:
+        struct Stage {
+            std::string name;
+            double budget_ms = 0.0;
+            std::atomic<uint64_t> samples{0};
+            std::atomic<uint64_t> misses{0};
+        };
+
+        double readTemperature();
+        void writeState() const;
+
+        GovernorConfig config;
+        std::unique_ptr<Stage[]> stages;
+        size_t stage_count = 0;
+        size_t level = 0;
+        int pressure_count = 0;
+        int relaxed_count = 0;
+        int up_after;
+        int samples_since_up = -1;          // 上次升档后的周期数，-1 表示未升过档
+        int samples_since_down = -1;        // 上次降档后的周期数
+        Clock::time_point last_poll;
+        bool thermal_warned = false;
+        GovernorState current;
+    };
+}
+
+#endif //GOVERNOR_H
@@ -0,0 +1,146 @@
+#include "Governor.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+GOV::Governor::Governor(GovernorConfig config) : config(std::move(config)), up_after(std::max(1, this->config.up_after)) {
+    if (this->config.ladder.empty()) this->config.ladder.push_back({"full"});
+    stage_count = this->config.deadlines_ms.size();
+    stages = std::make_unique<Stage[]>(stage_count);
+    size_t i = 0;
+    for (const auto& [name, budget] : this->config.deadlines_ms) {
+        stages[i].name = name;
+        stages[i].budget_ms = budget;
+        i++;
+    }
+    current.name = point().name;
+}
+
+int GOV::Governor::stage(std::string_view name) const {
+    for (size_t i = 0; i < stage_count; i++) {
+        if (stages[i].name == name) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+void GOV::Governor::record(int stage, double ms) {
+    if (stage < 0) return;
+    Stage& s = stages[stage];
+    s.samples.fetch_add(1, std::memory_order_relaxed);
+    if (ms > s.budget_ms) s.misses.fetch_add(1, std::memory_order_relaxed);
+}
+
+double GOV::Governor::readTemperature() {
+    // sysfs 中为毫摄氏度
+    std::ifstream file(config.thermal_path);
+    long milli = 0;
+    if (file >> milli) return static_cast<double>(milli) / 1000.0;
+    if (!thermal_warned) {
+        thermal_warned = true;
+        std::cerr << "Governor: cannot read " << config.thermal_path << ", adjusting by deadlines only." << std::endl;
+    }
+    return NAN;
+}
+
+bool GOV::Governor::poll(Clock::time_point now) {
+    if (now - last_poll < config.interval) return false;
+    last_poll = now;
+    current.temperature_c = readTemperature();
+    current.worst_stage.clear();
+    current.worst_miss_ratio = 0.0;
+    for (size_t i = 0; i < stage_count; i++) {
+        const uint64_t samples = stages[i].samples.exchange(0, std::memory_order_relaxed);
+        const uint64_t misses = stages[i].misses.exchange(0, std::memory_order_relaxed);
+        // 本周期没有样本（如推理间隔较长）的阶段不参与
+        if (samples == 0) continue;
+        const double ratio = static_cast<double>(misses) / static_cast<double>(samples);
+        if (current.worst_stage.empty() || ratio > current.worst_miss_ratio) {
+            current.worst_stage = stages[i].name;
+            current.worst_miss_ratio = ratio;
+        }
+    }
+    const size_t before = level;
+    evaluate(current.temperature_c, current.worst_miss_ratio);
+    writeState();
+    return level != before;
+}
+
+size_t GOV::Governor::evaluate(double temperature_c, double miss_ratio) {
+    const bool thermal = !std::isnan(temperature_c);
+    const bool critical = thermal && temperature_c >= config.critical_c;
+    const bool hot = thermal && temperature_c >= config.hot_c;
+    const bool overloaded = miss_ratio > config.miss_ratio;
+    const bool relaxed = (!thermal || temperature_c < config.cool_c) && miss_ratio < config.miss_ratio / 2;
+
+    if (samples_since_up >= 0) samples_since_up++;
+    if (samples_since_down >= 0) samples_since_down++;
+    if (hot || overloaded) {
+        relaxed_count = 0;
+        // 期限超时在降档后的下一个周期即可见效，过热则要等温度回落
+        const bool settled = overloaded || samples_since_down < 0 || samples_since_down >= config.settle;
+        if ((critical || (++pressure_count >= config.down_after && settled)) && level + 1 < config.ladder.size()) {
+            pressure_count = 0;
+            samples_since_down = 0;
+            // 升档后不久又降档：上一档负载过高，加倍升档等待
+            if (samples_since_up >= 0 && samples_since_up < 2 * up_after) {
+                up_after = std::min(up_after * 2, std::max(config.max_up_after, 1));
+            }
+            samples_since_up = -1;
+            level++;
+            current.steps_down++;
+            current.reason = critical ? "critical" : hot ? "hot" : "deadline";
+        }
+        return level;
+    }
+    pressure_count = 0;
+    // 升档后稳定运行足够久，升档等待逐步恢复
+    if (samples_since_up == 2 * up_after) {
+        up_after = std::max(std::max(1, config.up_after), up_after / 2);
+    }
+    // 温度在 cool_c 与 hot_c 之间或期限余量不足时保持当前档
+    if (!relaxed) {
+        relaxed_count = 0;
+        return level;
+    }
+    if (++relaxed_count >= up_after && level > 0) {
+        relaxed_count = 0;
+        samples_since_up = 0;
+        level--;
+        current.steps_up++;
+        current.reason = "recovered";
+    }
+    return level;
+}
+
+GOV::GovernorState GOV::Governor::state() const {
+    GovernorState result = current;
+    result.level = level;
+    result.name = point().name;
+    return result;
+}
+
+void GOV::Governor::writeState() const {
+    if (config.state_file.empty()) return;
+    const GovernorState s = state();
+    const OperatingPoint& p = point();
+    char text[512];
+    const double temperature = std::isnan(s.temperature_c) ? -1.0 : s.temperature_c;
+    std::snprintf(text, sizeof(text),
+                  "{\"level\":%zu,\"levels\":%zu,\"name\":\"%s\",\"temp_c\":%.1f,\"reason\":\"%s\",\"worst_stage\":\"%s\","
+                  "\"miss_ratio\":%.3f,\"detect_interval_ms\":%d,\"input\":[%d,%d],\"stream_rung\":%d,\"capture_fps\":%d,"
+                  "\"steps_down\":%llu,\"steps_up\":%llu}\n",
+                  s.level, config.ladder.size(), s.name.c_str(), temperature, s.reason.c_str(), s.worst_stage.c_str(),
+                  s.worst_miss_ratio, p.detect_interval_ms, p.input_width, p.input_height, p.stream_rung, p.capture_fps,
+                  static_cast<unsigned long long>(s.steps_down), static_cast<unsigned long long>(s.steps_up));
+    // 先写临时文件再改名，读取方不会读到写了一半的内容
+    const std::string temp = config.state_file + ".tmp";
+    {
+        std::ofstream file(temp, std::ios::trunc);
+        file << text;
+        if (!file) return;
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp, config.state_file, ec);
+}
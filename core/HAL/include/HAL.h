@@ -16,9 +16,11 @@ namespace HAL {
     namespace I2C{}
     namespace SPI{}
     namespace UART{}
+    namespace IO{}
 }
 
 #include "HAL_GPIO.h"
+#include "HAL_I2C.h"
 #include "HAL_UART.h"
 
 #endif //HAL_H
@@ -0,0 +1,40 @@
+#ifndef HAL_I2C_H
+#define HAL_I2C_H
+
+#include "HAL.h"
+#include <cstdint>
+#include <string>
+
+namespace HAL::I2C {
+    struct Config {
+        std::string device;     // 设备路径，例如 "/dev/i2c-1"
+        uint8_t address;        // 7 位从机地址
+    };
+
+    // Linux i2c-dev 主机端：寄存器读写，连续读用 I2C_RDWR 一次完成"写寄存器地址 + 重复起始 + 读"，
+    // 中间不释放总线，适合读取 FIFO 等自增/不自增的数据寄存器
+    class I2c {
+    public:
+        I2c();
+        ~I2c();
+
+        HAL::HardwareStatus i2cInit(const Config& config);
+        HAL::HardwareStatus i2cWriteReg(uint8_t reg, uint8_t value) const;
+        HAL::HardwareStatus i2cReadReg(uint8_t reg, uint8_t& value) const;
+        // 从 reg 开始连续读取 size 字节。超过 MAX_TRANSFER 时分段，每段都重新从 reg 读，
+        // 因此长读取只适用于 FIFO 这类地址不自增的数据寄存器
+        HAL::HardwareStatus i2cReadRegs(uint8_t reg, uint8_t* data, size_t size) const;
+        [[nodiscard]] HAL::HardwareStatus i2cGetStatus() const;
+
+        // 多数 i2c 适配器单次消息长度上限
+        static constexpr size_t MAX_TRANSFER = 255;
+    private:
+        int fd_;
+        uint8_t address_;
+    public:
+        I2c(const I2c&) = delete;
+        I2c& operator=(const I2c&) = delete;
+    };
+}
+
+#endif //HAL_I2C_H
@@ -0,0 +1,96 @@
+#ifndef HAL_REACTOR_H
+#define HAL_REACTOR_H
+
+#include "HAL.h"
+#include "HAL_UART.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace HAL::IO {
+    using Clock = std::chrono::steady_clock;
+
+    // 描述符就绪时的回调，参数为 epoll 事件（EPOLLIN/EPOLLOUT/EPOLLHUP…）
+    using FdHandler = std::function<void(uint32_t events)>;
+    using Task = std::function<void()>;
+    using TimerId = uint64_t;
+
+    // 时间轮：TICK_MS 一格，WHEEL_SLOTS 格一圈，超过一圈的定时器按圈数留在格中。
+    // 增加与取消都是 O(1)（取消需在所在格中查找，格内通常只有几个定时器）
+    constexpr int TICK_MS = 10;
+    constexpr size_t WHEEL_SLOTS = 512;
+    constexpr int MAX_EVENTS = 32;
+
+    // 单线程 I/O 事件循环：一个线程用 epoll 同时等待任意多个串口（以及将来的 I2C/GPIO 事件描述符），
+    // 就绪后在本线程中调用各设备的协议处理，超时（如 AT 命令的应答期限）由时间轮处理。
+    // 除 reactorPost 与 reactorStop 外，其余接口须在 reactorRun 之前或在回调（即事件循环线程）中调用
+    class Reactor {
+    public:
+        Reactor();
+        ~Reactor();
+
+        HAL::HardwareStatus reactorInit();
+        // 注册描述符（水平触发），同一描述符重复注册时替换回调与事件
+        HAL::HardwareStatus reactorAdd(int fd, uint32_t events, FdHandler handler);
+        HAL::HardwareStatus reactorModify(int fd, uint32_t events);
+        void reactorRemove(int fd);
+        // 注册串口：可读时读入全部数据并按行交给 onLines；设备出错或关闭时注销并调用 onClose
+        HAL::HardwareStatus reactorAddUart(HAL::UART::Uart& uart, HAL::UART::LineCallback onLines, Task onClose = {});
+
+        // delay 后在事件循环线程中调用一次 task，精度为一格
+        TimerId reactorAddTimer(std::chrono::milliseconds delay, Task task);
+        // 取消尚未触发的定时器，已触发或不存在时返回 false
+        bool reactorCancelTimer(TimerId id);
+
+        // 任意线程调用：把 task 交给事件循环线程执行
+        void reactorPost(Task task);
+        // 阻塞运行直到 reactorStop 或所有描述符都已注销且没有定时器
+        void reactorRun();
+        // 任意线程调用，可早于 reactorRun；停止后不能再次运行
+        void reactorStop();
+
+        [[nodiscard]] size_t reactorFdCount() const { return handlers.size(); }
+        [[nodiscard]] size_t reactorTimerCount() const { return timer_slot.size(); }
+        // 事件循环被唤醒的次数，用于确认空闲时没有空转
+        [[nodiscard]] uint64_t reactorWakeups() const { return wakeups.load(std::memory_order_relaxed); }
+    private:
+        struct Timer {
+            TimerId id;
+            uint64_t expiry;    // 到期的格号
+            Task task;
+        };
+
+        [[nodiscard]] uint64_t tickOf(Clock::time_point t) const;
+        [[nodiscard]] int pollTimeout() const;
+        void advanceTimers();
+        void runPosted();
+
+        int epoll_fd;
+        int wake_fd;            // eventfd，reactorPost/reactorStop 用来唤醒 epoll_wait
+        std::atomic<bool> stopping{false};
+        std::atomic<uint64_t> wakeups{0};
+
+        // 回调以 shared_ptr 保存：回调中注销自身时，正在执行的回调对象不会被析构
+        std::unordered_map<int, std::shared_ptr<FdHandler>> handlers;
+
+        Clock::time_point start;
+        uint64_t current_tick = 0;      // 已处理到的格号
+        TimerId next_timer = 1;
+        std::vector<std::vector<Timer>> wheel;
+        std::unordered_map<TimerId, size_t> timer_slot;     // 未触发的定时器所在的格
+
+        std::mutex post_mutex;
+        std::vector<Task> posted;
+        std::vector<Task> running;      // 与 posted 交换，避免执行时持锁
+    public:
+        Reactor(const Reactor&) = delete;
+        Reactor& operator=(const Reactor&) = delete;
+    };
+}
+
+#endif //HAL_REACTOR_H
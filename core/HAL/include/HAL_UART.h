@@ -4,6 +4,12 @@
 #include "HAL.h"
 #include <iostream>
 #include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <sys/types.h>
 
 
 namespace HAL::UART{
@@ -14,6 +20,17 @@ namespace HAL::UART{
         unsigned int dataBits;
         unsigned int stopBits;
     };
+
+    // 接收缓冲大小，需大于最长的一行（NMEA 句子最长 82 字节）
+    constexpr size_t LINE_BUFFER_SIZE = 4096;
+
+    // 一批完整的行，视图指向 Uart 内部缓冲，只在回调期间有效
+    using LineBatch = std::span<const std::string_view>;
+    using LineCallback = std::function<void(LineBatch lines)>;
+
+    // 串口以非阻塞方式打开，无数据时在 poll 中休眠，不再空转。
+    // 数据读入固定大小的缓冲并原地切分成行（去掉 \r\n），只有未完整的行尾在下次读入前移到缓冲开头，
+    // 每行不产生堆分配
     class Uart {
     public:
         Uart(); // 构造函数
@@ -21,17 +38,60 @@ namespace HAL::UART{
 
         HAL::HardwareStatus uartInit(const Config& config);
         HAL::HardwareStatus uartWrite(const uint8_t* data, size_t size) const;
+        // 阻塞读取一行并拷贝返回，读取失败返回空字符串
         std::string uartReadLine();
+        // 读取一行，line 指向内部缓冲，下次读取前有效。
+        // timeoutMs < 0 一直等待；超时返回 TIMEOUT，设备出错或被关闭返回 ERROR
+        HAL::HardwareStatus uartReadLine(std::string_view& line, int timeoutMs);
+        // 等待数据（最多 timeoutMs），读入当前可读的全部数据，把其中所有完整的行一次交给 callback
+        HAL::HardwareStatus uartReadLines(const LineCallback& callback, int timeoutMs);
+        // 文件描述符，供 epoll 等事件循环注册；可读时调用 uartReadLines(callback, 0)
+        [[nodiscard]] int uartGetFd() const { return fd_; }
+        // 因一行超过缓冲大小而丢弃的次数
+        [[nodiscard]] uint64_t uartOverflows() const { return overflows_; }
         [[nodiscard]] HAL::HardwareStatus uartGetStatus() const;
     private:
         int fd_; // 文件描述符
-        std::string buffer; // 缓冲区用于存储未完成的行数据
+        char rx_[LINE_BUFFER_SIZE]; // 接收缓冲
+        size_t head_ = 0;       // 未取走数据的起点
+        size_t tail_ = 0;       // 已读入数据的终点
+        size_t scan_ = 0;       // 已查找过换行符的位置
+        bool discarding_ = false;   // 溢出后丢弃数据直到下一个换行符
+        uint64_t overflows_ = 0;
+        std::vector<std::string_view> batch_;   // 批量回调复用的行列表
         static void setOptions(int fd, const Config& config);
+        bool nextLine(std::string_view& line);
+        HAL::HardwareStatus fill(int timeoutMs);
         // 禁止拷贝构造和赋值操作
     public:
         Uart(const Uart&) = delete;
         Uart& operator=(const Uart&) = delete;
     };
+
+    // 伪终端：从端可当作串口设备交给 Uart 打开，主端模拟外设收发，
+    // 用于没有硬件时的基准测试、回放与调试
+    class PseudoTerminal {
+    public:
+        PseudoTerminal();
+        ~PseudoTerminal();
+
+        HAL::HardwareStatus ptyInit();
+        // 从端设备路径，作为 Config::device
+        [[nodiscard]] const std::string& ptyDevice() const { return device_; }
+        // 以"外设"身份发送数据，全部写入后返回
+        HAL::HardwareStatus ptyWrite(const uint8_t* data, size_t size) const;
+        HAL::HardwareStatus ptyWrite(std::string_view text) const;
+        // 读取程序写给"外设"的数据，返回读到的字节数，无数据或出错时返回 -1
+        ssize_t ptyRead(uint8_t* data, size_t size) const;
+        void ptyClose();
+        [[nodiscard]] int ptyGetFd() const { return master_; }
+    private:
+        int master_;
+        std::string device_;
+    public:
+        PseudoTerminal(const PseudoTerminal&) = delete;
+        PseudoTerminal& operator=(const PseudoTerminal&) = delete;
+    };
 }
 
 #endif //HAL_UART_H
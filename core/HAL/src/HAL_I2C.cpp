@@ -0,0 +1,75 @@
+#include "HAL_I2C.h"
+#include <fcntl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+using namespace HAL::I2C;
+
+I2c::I2c() : fd_(-1), address_(0) {}
+
+I2c::~I2c() {
+    if (fd_ != -1) {
+        close(fd_);
+    }
+}
+
+HAL::HardwareStatus I2c::i2cInit(const Config& config) {
+    if (fd_ != -1) {
+        close(fd_);
+    }
+    fd_ = open(config.device.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd_ == -1) {
+        std::cerr << "Failed to open " << config.device << ": " << strerror(errno) << std::endl;
+        return HAL::ERROR;
+    }
+    if (ioctl(fd_, I2C_SLAVE, config.address) < 0) {
+        std::cerr << "Failed to select I2C address 0x" << std::hex << static_cast<int>(config.address) << std::dec
+                  << ": " << strerror(errno) << std::endl;
+        close(fd_);
+        fd_ = -1;
+        return HAL::ERROR;
+    }
+    address_ = config.address;
+    return HAL::OK;
+}
+
+HAL::HardwareStatus I2c::i2cWriteReg(uint8_t reg, uint8_t value) const {
+    if (fd_ == -1) return HAL::ERROR;
+    const uint8_t buffer[2] = {reg, value};
+    if (write(fd_, buffer, sizeof buffer) != sizeof buffer) {
+        return errno == EBUSY ? HAL::BUSY : HAL::ERROR;
+    }
+    return HAL::OK;
+}
+
+HAL::HardwareStatus I2c::i2cReadReg(uint8_t reg, uint8_t& value) const {
+    return i2cReadRegs(reg, &value, 1);
+}
+
+HAL::HardwareStatus I2c::i2cReadRegs(uint8_t reg, uint8_t* data, size_t size) const {
+    if (fd_ == -1) return HAL::ERROR;
+    while (size > 0) {
+        const size_t chunk = std::min(size, MAX_TRANSFER);
+        i2c_msg messages[2] = {
+            {address_, 0, 1, &reg},
+            {address_, I2C_M_RD, static_cast<uint16_t>(chunk), data},
+        };
+        i2c_rdwr_ioctl_data transfer = {messages, 2};
+        if (ioctl(fd_, I2C_RDWR, &transfer) != 2) {
+            return errno == EBUSY ? HAL::BUSY : HAL::ERROR;
+        }
+        data += chunk;
+        size -= chunk;
+    }
+    return HAL::OK;
+}
+
+HAL::HardwareStatus I2c::i2cGetStatus() const {
+    return fd_ == -1 ? HAL::ERROR : HAL::OK;
+}
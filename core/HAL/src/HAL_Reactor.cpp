@@ -0,0 +1,222 @@
+#include "HAL_Reactor.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+using namespace HAL::IO;
+
+Reactor::Reactor() : epoll_fd(-1), wake_fd(-1), start(Clock::now()), wheel(WHEEL_SLOTS) {}
+
+Reactor::~Reactor() {
+    if (wake_fd != -1) {
+        close(wake_fd);
+    }
+    if (epoll_fd != -1) {
+        close(epoll_fd);
+    }
+}
+
+HAL::HardwareStatus Reactor::reactorInit() {
+    if (epoll_fd != -1) {
+        return HAL::OK;
+    }
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd == -1 || wake_fd == -1) {
+        std::cerr << "Failed to create epoll instance: " << strerror(errno) << std::endl;
+        return HAL::ERROR;
+    }
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = wake_fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &ev) != 0) {
+        std::cerr << "Failed to register wakeup fd: " << strerror(errno) << std::endl;
+        return HAL::ERROR;
+    }
+    start = Clock::now();
+    current_tick = 0;
+    return HAL::OK;
+}
+
+HAL::HardwareStatus Reactor::reactorAdd(int fd, uint32_t events, FdHandler handler) {
+    if (epoll_fd == -1 || fd < 0) {
+        return HAL::ERROR;
+    }
+    epoll_event ev{};
+    ev.events = events;
+    ev.data.fd = fd;
+    const bool exists = handlers.contains(fd);
+    if (epoll_ctl(epoll_fd, exists ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &ev) != 0) {
+        std::cerr << "Failed to register fd " << fd << ": " << strerror(errno) << std::endl;
+        return HAL::ERROR;
+    }
+    handlers[fd] = std::make_shared<FdHandler>(std::move(handler));
+    return HAL::OK;
+}
+
+HAL::HardwareStatus Reactor::reactorModify(int fd, uint32_t events) {
+    if (!handlers.contains(fd)) {
+        return HAL::ERROR;
+    }
+    epoll_event ev{};
+    ev.events = events;
+    ev.data.fd = fd;
+    return epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev) == 0 ? HAL::OK : HAL::ERROR;
+}
+
+void Reactor::reactorRemove(int fd) {
+    if (handlers.erase(fd) > 0) {
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    }
+}
+
+HAL::HardwareStatus Reactor::reactorAddUart(HAL::UART::Uart& uart, HAL::UART::LineCallback onLines, Task onClose) {
+    const int fd = uart.uartGetFd();
+    return reactorAdd(fd, EPOLLIN, [this, &uart, fd, onLines = std::move(onLines), onClose = std::move(onClose)](uint32_t) {
+        // 水平触发：缓冲读满时剩余数据会让 epoll 立即再次就绪
+        if (uart.uartReadLines(onLines, 0) == HAL::ERROR) {
+            // 先保存关闭回调：注销会析构本回调及其捕获
+            Task closed = onClose;
+            reactorRemove(fd);
+            if (closed) closed();
+        }
+    });
+}
+
+uint64_t Reactor::tickOf(Clock::time_point t) const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(t - start).count() / TICK_MS;
+}
+
+TimerId Reactor::reactorAddTimer(std::chrono::milliseconds delay, Task task) {
+    // 向上取整到格，至少一格，保证不早于 delay 触发
+    const uint64_t ticks = std::max<int64_t>(1, (delay.count() + TICK_MS - 1) / TICK_MS);
+    const uint64_t expiry = std::max(current_tick, tickOf(Clock::now())) + ticks;
+    const TimerId id = next_timer++;
+    const size_t slot = expiry % WHEEL_SLOTS;
+    wheel[slot].push_back({id, expiry, std::move(task)});
+    timer_slot[id] = slot;
+    return id;
+}
+
+bool Reactor::reactorCancelTimer(TimerId id) {
+    const auto it = timer_slot.find(id);
+    if (it == timer_slot.end()) {
+        return false;
+    }
+    auto& slot = wheel[it->second];
+    // 正在触发的格已移出时间轮，找不到也无妨：触发前会再查 timer_slot
+    std::erase_if(slot, [id](const Timer& timer) { return timer.id == id; });
+    timer_slot.erase(it);
+    return true;
+}
+
+void Reactor::advanceTimers() {
+    const uint64_t now = tickOf(Clock::now());
+    if (timer_slot.empty()) {
+        current_tick = now;
+        return;
+    }
+    // 落后超过一圈时每格只需处理一次
+    uint64_t tick = now - current_tick > WHEEL_SLOTS ? now - WHEEL_SLOTS : current_tick;
+    std::vector<Timer> due;
+    while (tick < now && !timer_slot.empty()) {
+        ++tick;
+        current_tick = tick;
+        auto& slot = wheel[tick % WHEEL_SLOTS];
+        if (slot.empty()) continue;
+        // 移出整格再触发：回调中可以增加或取消定时器
+        due.swap(slot);
+        for (auto& timer : due) {
+            if (timer.expiry > now) {
+                slot.push_back(std::move(timer));   // 还有几圈
+            }
+            else if (timer_slot.erase(timer.id) > 0) {
+                timer.task();
+            }
+        }
+        due.clear();
+    }
+    current_tick = now;
+}
+
+int Reactor::pollTimeout() const {
+    if (timer_slot.empty()) {
+        return -1;
+    }
+    // 睡到下一个非空格（最多一圈），长定时器不会让空闲的事件循环每格醒来一次
+    uint64_t tick = current_tick + 1;
+    while (tick < current_tick + WHEEL_SLOTS && wheel[tick % WHEEL_SLOTS].empty()) {
+        ++tick;
+    }
+    const auto next = start + std::chrono::milliseconds(tick * TICK_MS);
+    // 向上取整，避免不足 1ms 时以 0 超时空转
+    const auto wait = std::chrono::ceil<std::chrono::milliseconds>(next - Clock::now()).count();
+    return static_cast<int>(std::max<int64_t>(0, wait));
+}
+
+void Reactor::reactorPost(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(post_mutex);
+        posted.push_back(std::move(task));
+    }
+    const uint64_t one = 1;
+    [[maybe_unused]] ssize_t n = write(wake_fd, &one, sizeof(one));
+}
+
+void Reactor::runPosted() {
+    {
+        std::lock_guard<std::mutex> lock(post_mutex);
+        running.swap(posted);
+    }
+    for (auto& task : running) {
+        task();
+    }
+    running.clear();
+}
+
+void Reactor::reactorStop() {
+    stopping.store(true, std::memory_order_relaxed);
+    const uint64_t one = 1;
+    [[maybe_unused]] ssize_t n = write(wake_fd, &one, sizeof(one));
+}
+
+void Reactor::reactorRun() {
+    if (epoll_fd == -1) {
+        return;
+    }
+    epoll_event events[MAX_EVENTS];
+    current_tick = std::max(current_tick, tickOf(Clock::now()));
+    while (!stopping.load(std::memory_order_relaxed)) {
+        runPosted();
+        if (handlers.empty() && timer_slot.empty()) {
+            std::lock_guard<std::mutex> lock(post_mutex);
+            if (posted.empty()) break;
+            continue;
+        }
+        const int ready = epoll_wait(epoll_fd, events, MAX_EVENTS, pollTimeout());
+        if (ready < 0 && errno != EINTR) {
+            std::cerr << "epoll_wait failed: " << strerror(errno) << std::endl;
+            break;
+        }
+        wakeups.fetch_add(1, std::memory_order_relaxed);
+        for (int i = 0; i < ready; i++) {
+            const int fd = events[i].data.fd;
+            if (fd == wake_fd) {
+                uint64_t count;
+                [[maybe_unused]] ssize_t n = read(wake_fd, &count, sizeof(count));
+                continue;
+            }
+            // 同一批事件中前面的回调可能已注销该描述符
+            const auto it = handlers.find(fd);
+            if (it == handlers.end()) continue;
+            const auto handler = it->second;
+            (*handler)(events[i].events);
+        }
+        advanceTimers();
+    }
+}
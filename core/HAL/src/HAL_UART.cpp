@@ -1,8 +1,11 @@
 #include "HAL_UART.h"
 #include <fcntl.h>
+#include <poll.h>
 #include <termios.h>
 #include <condition_variable>
 #include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
 #include <cstring> // memset
 
 using namespace HAL::UART;
@@ -43,7 +46,7 @@ void Uart::setOptions(int fd, const Config& config) {
 
     tty.c_oflag &= ~OPOST; // 原始输出模式
 
-    tty.c_cc[VTIME] = 10;    // 设置等待时间
+    tty.c_cc[VTIME] = 0;     // 非阻塞读取，等待由 poll 完成
     tty.c_cc[VMIN] = 0;
 
     tcflush(fd, TCIFLUSH);
@@ -57,49 +60,198 @@ HAL::HardwareStatus Uart::uartInit(const Config& config) {
     if (fd_ != -1) {
         close(fd_);
     }
-    fd_ = open(config.device.c_str(), O_RDWR | O_NOCTTY);
+    fd_ = open(config.device.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
     if (fd_ < 0) {
         return HAL::ERROR;
     }
     setOptions(fd_, config);
+    head_ = tail_ = scan_ = 0;
+    discarding_ = false;
 
     return HAL::OK;
 }
 
 HAL::HardwareStatus Uart::uartWrite(const uint8_t* data, size_t size) const {
-    ssize_t written = write(fd_, data, size);
-    if (written == static_cast<ssize_t>(size)) {
-        return HAL::OK;
-    } else {
+    // 非阻塞模式下发送缓冲可能暂满，等待可写后继续
+    while (size > 0) {
+        ssize_t written = write(fd_, data, size);
+        if (written > 0) {
+            data += written;
+            size -= written;
+        } else if (written == -1 && (errno == EAGAIN || errno == EINTR)) {
+            pollfd pfd{fd_, POLLOUT, 0};
+            if (poll(&pfd, 1, 1000) <= 0) {
+                return HAL::TIMEOUT;
+            }
+        } else {
+            return HAL::ERROR;
+        }
+    }
+    return HAL::OK;
+}
+
+bool Uart::nextLine(std::string_view& line) {
+    while (scan_ < tail_) {
+        auto* eol = static_cast<char*>(memchr(rx_ + scan_, '\n', tail_ - scan_));
+        if (eol == nullptr) {
+            scan_ = tail_;
+            return false;
+        }
+        const size_t end = eol - rx_;
+        size_t len = end - head_;
+        if (len > 0 && rx_[head_ + len - 1] == '\r') len--;
+        line = std::string_view(rx_ + head_, len);
+        head_ = scan_ = end + 1;
+        if (discarding_) {
+            // 溢出行的剩余部分
+            discarding_ = false;
+            continue;
+        }
+        return true;
+    }
+    return false;
+}
+
+HAL::HardwareStatus Uart::fill(int timeoutMs) {
+    if (fd_ < 0) {
+        return HAL::ERROR;
+    }
+    // 已取走的行让出空间：只移动尚未完整的行尾
+    if (head_ > 0) {
+        memmove(rx_, rx_ + head_, tail_ - head_);
+        tail_ -= head_;
+        scan_ -= head_;
+        head_ = 0;
+    }
+    if (tail_ == sizeof(rx_)) {
+        // 整个缓冲都没有换行符：丢弃并从下一个换行符重新同步
+        overflows_++;
+        head_ = tail_ = scan_ = 0;
+        discarding_ = true;
+    }
+
+    pollfd pfd{fd_, POLLIN, 0};
+    int ready = poll(&pfd, 1, timeoutMs);
+    if (ready == 0) {
+        return HAL::TIMEOUT;
+    }
+    if (ready < 0) {
+        return errno == EINTR ? HAL::TIMEOUT : HAL::ERROR;
+    }
+
+    // 读入当前可读的全部数据（直到缓冲满或暂无数据）
+    bool got = false;
+    while (tail_ < sizeof(rx_)) {
+        ssize_t bytesRead = read(fd_, rx_ + tail_, sizeof(rx_) - tail_);
+        if (bytesRead > 0) {
+            tail_ += bytesRead;
+            got = true;
+        } else if (bytesRead == -1 && (errno == EAGAIN || errno == EINTR)) {
+            break;
+        } else {
+            if (got) break;
+            // 读到文件尾（伪终端主端已关闭）或设备出错
+            if (bytesRead == -1) std::cerr << "Read error: " << strerror(errno) << std::endl;
+            return HAL::ERROR;
+        }
+    }
+    if (!got && (pfd.revents & (POLLHUP | POLLERR))) {
         return HAL::ERROR;
     }
+    return HAL::OK;
 }
 
 std::string Uart::uartReadLine() {
-    char buffer[256];
-    ssize_t bytesRead;
+    std::string_view line;
+    if (uartReadLine(line, -1) != HAL::OK) {
+        return ""; // 返回空字符串表示读取失败
+    }
+    return std::string(line);
+}
 
-    while (true) {
-        bytesRead = read(fd_, buffer, sizeof(buffer) - 1);
-        if (bytesRead > 0) {
-            buffer[bytesRead] = '\0'; // 确保字符串以 null 结尾
-            this->buffer += buffer;   // 将读取到的数据添加到内部缓冲区
-
-            // 查找换行符并提取完整行
-            size_t pos = this->buffer.find('\n');
-            if (pos != std::string::npos) {
-                std::string line = this->buffer.substr(0, pos);
-                this->buffer = this->buffer.substr(pos + 1); // 去掉已提取的行
-                return line;
-            }
-        } else if (bytesRead == -1 && errno != EAGAIN) {
-            std::cerr << "Read error: " << strerror(errno) << std::endl;
-            return ""; // 返回空字符串表示读取失败
+HAL::HardwareStatus Uart::uartReadLine(std::string_view& line, int timeoutMs) {
+    while (!nextLine(line)) {
+        if (const HAL::HardwareStatus status = fill(timeoutMs); status != HAL::OK) {
+            return status;
         }
     }
+    return HAL::OK;
+}
+
+HAL::HardwareStatus Uart::uartReadLines(const LineCallback& callback, int timeoutMs) {
+    // 缓冲中可能还有上次未取走的完整行，先取出再等待
+    batch_.clear();
+    std::string_view line;
+    while (nextLine(line)) batch_.push_back(line);
+
+    HAL::HardwareStatus status = HAL::OK;
+    if (batch_.empty()) {
+        status = fill(timeoutMs);
+        while (nextLine(line)) batch_.push_back(line);
+    }
+    if (!batch_.empty()) {
+        callback(LineBatch(batch_));
+        return HAL::OK;
+    }
+    return status;
 }
 
 HAL::HardwareStatus Uart::uartGetStatus() const {
     // 这里可以添加更详细的错误检测逻辑
     return fd_ != -1 ? HAL::OK : HAL::ERROR;
-}
\ No newline at end of file
+}
+
+PseudoTerminal::PseudoTerminal() : master_(-1) {}
+
+PseudoTerminal::~PseudoTerminal() {
+    ptyClose();
+}
+
+HAL::HardwareStatus PseudoTerminal::ptyInit() {
+    ptyClose();
+    master_ = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master_ < 0 || grantpt(master_) != 0 || unlockpt(master_) != 0) {
+        ptyClose();
+        return HAL::ERROR;
+    }
+    device_ = ptsname(master_);
+
+    // 原始模式：主端写入的字节原样到达从端，不做行编辑与换行转换
+    struct termios tty;
+    if (tcgetattr(master_, &tty) == 0) {
+        cfmakeraw(&tty);
+        tcsetattr(master_, TCSANOW, &tty);
+    }
+    return HAL::OK;
+}
+
+HAL::HardwareStatus PseudoTerminal::ptyWrite(const uint8_t* data, size_t size) const {
+    while (size > 0) {
+        ssize_t written = write(master_, data, size);
+        if (written > 0) {
+            data += written;
+            size -= written;
+        } else if (written == -1 && errno == EINTR) {
+            continue;
+        } else {
+            return HAL::ERROR;
+        }
+    }
+    return HAL::OK;
+}
+
+HAL::HardwareStatus PseudoTerminal::ptyWrite(std::string_view text) const {
+    return ptyWrite(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+}
+
+ssize_t PseudoTerminal::ptyRead(uint8_t* data, size_t size) const {
+    ssize_t bytesRead = read(master_, data, size);
+    return bytesRead > 0 ? bytesRead : -1;
+}
+
+void PseudoTerminal::ptyClose() {
+    if (master_ != -1) {
+        close(master_);
+        master_ = -1;
+    }
+}
@@ -0,0 +1,200 @@
+#ifndef RECORD_H
+#define RECORD_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// 多传感器会话日志：只追加的二进制文件，带时间戳的定型记录，结尾附索引便于按时间定位。
+//
+//   FileHeader | Record* | INDEX 记录 | Footer
+//   Record = RecordHeader + payload（补齐到 8 字节）
+//
+// 时间戳为相对会话开始的纳秒数（steady_clock）。写入中途掉电时没有索引与 Footer，
+// 读取端顺序扫描到第一条不完整的记录为止，之前的数据仍可回放
+namespace RECORD {
+    using Clock = std::chrono::steady_clock;
+
+    enum RecordType : uint16_t {
+        FRAME_JPEG = 1,     // 相机帧，JPEG 压缩
+        PACKET = 2,         // 编码后的视频包，flags 含 FLAG_KEYFRAME
+        UART_LINE = 3,      // 串口一行原始数据（不含 \r\n）
+        IMU_SAMPLE = 4,     // ImuRecord
+        INDEX = 0xFFFE,     // IndexEntry 数组
+    };
+
+    constexpr uint32_t FLAG_KEYFRAME = 1u << 0;
+
+    constexpr char FILE_MAGIC[8] = {'E', 'V', 'L', 'O', 'G', '0', '1', '\0'};
+    constexpr char FOOTER_MAGIC[8] = {'E', 'V', 'I', 'N', 'D', 'E', 'X', '\0'};
+    constexpr uint32_t RECORD_SYNC = 0x31525645;    // "EVR1"，用于校验与崩溃后的截断检测
+    constexpr size_t RECORD_ALIGN = 8;
+
+    struct FileHeader {
+        char magic[8];
+        uint64_t wall_start_ns;     // 会话开始的系统时间（UNIX 纳秒），仅用于显示
+        uint64_t reserved[2];
+    };
+
+    struct RecordHeader {
+        uint32_t sync;
+        uint16_t type;
+        uint16_t channel;           // 同类设备的编号，例如第几路相机、第几个串口
+        uint32_t size;              // payload 字节数，不含补齐
+        uint32_t flags;
+        uint64_t timestamp_ns;
+    };
+
+    struct IndexEntry {
+        uint64_t timestamp_ns;
+        uint64_t offset;            // 记录头在文件中的偏移
+    };
+
+    struct Footer {
+        char magic[8];
+        uint64_t index_offset;      // INDEX 记录头的偏移
+        uint64_t record_count;      // 不含 INDEX 记录
+    };
+
+    // 六轴采样，单位同 IMU::ImuSample
+    struct ImuRecord {
+        float accel[3];
+        float gyro[3];
+    };
+
+    static_assert(sizeof(FileHeader) == 32 && sizeof(RecordHeader) == 24 && sizeof(IndexEntry) == 16 && sizeof(Footer) == 24);
+
+    struct WriterConfig {
+        size_t queue_capacity = 1024;   // 排队的记录数上限，超出时丢弃新记录
+        size_t max_pending_frames = 4;  // 排队等待压缩的帧数上限（帧占内存大、压缩慢）
+        double max_frame_fps = 10.0;    // 每路相机最多记录的帧率，0 为不限
+        int jpeg_quality = 85;
+        std::chrono::milliseconds index_interval{1000};     // 非帧记录至少每隔多久记一条索引
+    };
+
+    // 日志写入：各 write* 只把数据放进队列后立即返回（帧只增加 cv::Mat 引用计数，不拷贝像素），
+    // JPEG 压缩与写盘都在写线程中完成，不阻塞采集与检测。队列满时丢弃并计数
+    class LogWriter {
+    public:
+        explicit LogWriter(std::string path, const WriterConfig& config = {});
+        ~LogWriter();
+        LogWriter(const LogWriter&) = delete;
+        LogWriter& operator=(const LogWriter&) = delete;
+
+        bool open();
+        // 写完队列中剩余的记录，追加索引与 Footer
+        void close();
+
+        // 帧在压缩完成前不得被改写（采集每帧使用新的 cv::Mat 即可满足）
+        bool writeFrame(Clock::time_point timestamp, const cv::Mat& image, uint16_t channel = 0);
+        bool writePacket(Clock::time_point timestamp, const uint8_t* data, size_t size, bool keyframe, uint16_t channel = 0);
+        bool writeLine(Clock::time_point timestamp, std::string_view line, uint16_t channel = 0);
+        bool writeImu(Clock::time_point timestamp, const ImuRecord& sample, uint16_t channel = 0);
+
+        [[nodiscard]] uint64_t written() const { return written_count.load(std::memory_order_relaxed); }
+        [[nodiscard]] uint64_t dropped() const { return dropped_count.load(std::memory_order_relaxed); }
+        [[nodiscard]] uint64_t bytes() const { return byte_count.load(std::memory_order_relaxed); }
+
+    private:
+        struct Item {
+            RecordType type;
+            uint16_t channel;
+            uint32_t flags;
+            uint64_t timestamp_ns;
+            cv::Mat image;                  // FRAME_JPEG 待压缩的帧
+            std::vector<uint8_t> payload;   // 其他类型的数据
+        };
+
+        bool enqueue(Item item);
+        void writeLoop();
+        void writeRecord(const Item& item, const uint8_t* data, size_t size);
+        uint64_t toNs(Clock::time_point timestamp) const;
+
+        std::string path;
+        WriterConfig config;
+        std::ofstream file;
+        Clock::time_point start;
+        uint64_t offset = 0;
+        std::vector<IndexEntry> index;
+        uint64_t last_index_ns = 0;
+        std::vector<uchar> jpeg;            // 压缩输出缓冲，容量复用
+        std::vector<Clock::time_point> last_frame;  // 各路相机上次记录帧的时间
+
+        std::deque<Item> queue;
+        size_t pending_frames = 0;
+        bool stopping = false;
+        std::mutex mtx;
+        std::condition_variable queue_cv;
+        std::thread writer;
+
+        std::atomic<uint64_t> written_count{0};
+        std::atomic<uint64_t> dropped_count{0};
+        std::atomic<uint64_t> byte_count{0};
+    };
+
+    // 记录视图：payload 直接指向映射的文件，读取器存在期间有效
+    struct RecordView {
+        RecordType type;
+        uint16_t channel;
+        uint32_t flags;
+        uint64_t timestamp_ns;
+        std::span<const uint8_t> payload;
+        uint64_t offset;
+    };
+
+    // 以 mmap 只读映射整个日志：记录不经拷贝，按顺序读取或按时间定位
+    class LogReader {
+    public:
+        LogReader() = default;
+        ~LogReader();
+        LogReader(const LogReader&) = delete;
+        LogReader& operator=(const LogReader&) = delete;
+
+        bool open(const std::string& path);
+        void close();
+
+        // 读取下一条记录（跳过 INDEX），到结尾返回 false
+        bool next(RecordView& record);
+        // 定位到第一条时间戳不小于 timestamp_ns 的记录
+        void seek(uint64_t timestamp_ns);
+        void rewind() { cursor = first_record; }
+
+        [[nodiscard]] const FileHeader& header() const { return *reinterpret_cast<const FileHeader*>(data); }
+        [[nodiscard]] std::span<const IndexEntry> indexEntries() const { return entries; }
+        [[nodiscard]] uint64_t recordCount() const { return record_count; }
+        // 第一条与最后一条记录的时间戳（纳秒）
+        [[nodiscard]] uint64_t firstTimestamp() const { return first_ns; }
+        [[nodiscard]] uint64_t lastTimestamp() const { return last_ns; }
+        // 没有 Footer（写入中断）时为 false，此时索引由打开时扫描得到
+        [[nodiscard]] bool complete() const { return has_footer; }
+
+    private:
+        // 校验 offset 处的记录是否完整，返回下一条记录的偏移，无效时返回 0
+        [[nodiscard]] uint64_t validate(uint64_t offset) const;
+        void scan();
+
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+        uint64_t first_record = sizeof(FileHeader);
+        uint64_t end = 0;               // 有效记录的结束位置
+        uint64_t cursor = 0;
+        std::span<const IndexEntry> entries;
+        std::vector<IndexEntry> scanned;    // 没有 Footer 时扫描得到的索引
+        uint64_t record_count = 0;
+        uint64_t first_ns = 0;
+        uint64_t last_ns = 0;
+        bool has_footer = false;
+    };
+}
+
+#endif //RECORD_H
@@ -0,0 +1,74 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "Record.h"
+#include "HAL_UART.h"
+#include "SpscRing.h"
+#include <map>
+#include <memory>
+
+namespace RECORD {
+    // 回放得到的六轴采样，时间已映射到本次回放的 steady_clock
+    struct ReplayedImu {
+        Clock::time_point timestamp;
+        ImuRecord sample;
+    };
+
+    // 按记录的时间节奏（可加速）把会话日志送回原来的接口：
+    //  - 串口行写入伪终端主端，程序照常用 HAL::UART::Uart 打开 uartDevice() 返回的从端；
+    //  - 帧交给 readFrame()，由 DualLensCamera 在回放模式下调用，JPEG 在读取线程中解码；
+    //  - 六轴采样放进无锁环形缓冲，由 popImu() 取出。
+    // 回放线程只搬运 mmap 中的数据，不做解码
+    class LogReplay {
+    public:
+        // speed 为回放倍速，<= 0 表示不等待、尽快回放
+        explicit LogReplay(std::string path, double speed = 1.0, bool loop = false);
+        ~LogReplay();
+        LogReplay(const LogReplay&) = delete;
+        LogReplay& operator=(const LogReplay&) = delete;
+
+        bool open();
+        // 为串口通道创建伪终端，返回从端路径；须在 start 之前调用，失败返回空字符串
+        std::string uartDevice(uint16_t channel = 0);
+        // 从 offset_ns（相对会话开始）处开始回放
+        void start(uint64_t offset_ns = 0);
+        void stop();
+        [[nodiscard]] bool finished() const { return done.load(std::memory_order_acquire); }
+
+        // 阻塞等待该路相机的下一帧；回放结束返回 false
+        bool readFrame(cv::Mat& frame, uint16_t channel = 0);
+        // 该路相机的画面尺寸（解码日志中的第一帧得到），没有该路帧时为空；须在 start 之前调用
+        cv::Size frameSize(uint16_t channel = 0);
+        bool popImu(ReplayedImu& sample) { return imu_ring.pop(sample); }
+
+        [[nodiscard]] const LogReader& reader() const { return log; }
+        [[nodiscard]] uint64_t framesSkipped() const;
+
+    private:
+        struct FrameSlot {
+            std::span<const uint8_t> jpeg;  // 指向映射的文件
+            bool fresh = false;
+            uint64_t skipped = 0;           // 读取端来不及取走而被覆盖的帧
+        };
+
+        void run(uint64_t offset_ns);
+        void dispatch(const RecordView& record, Clock::time_point local);
+
+        std::string path;
+        double speed;
+        bool loop;
+        LogReader log;
+        std::map<uint16_t, std::unique_ptr<HAL::UART::PseudoTerminal>> terminals;
+
+        mutable std::mutex frame_mutex;
+        std::condition_variable frame_cv;
+        std::map<uint16_t, FrameSlot> frames;
+
+        SYNC::SpscRing<ReplayedImu, 1024> imu_ring;
+        std::atomic<bool> running{false};
+        std::atomic<bool> done{false};
+        std::thread worker;
+    };
+}
+
+#endif //REPLAY_H
@@ -0,0 +1,323 @@
+#include "Record.h"
+#include "Runtime.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace RECORD {
+
+namespace {
+    constexpr uint64_t padded(uint64_t size) {
+        return (size + RECORD_ALIGN - 1) / RECORD_ALIGN * RECORD_ALIGN;
+    }
+}
+
+// ---------------- LogWriter ----------------
+
+LogWriter::LogWriter(std::string path, const WriterConfig& config) : path(std::move(path)), config(config) {}
+
+LogWriter::~LogWriter() {
+    close();
+}
+
+bool LogWriter::open() {
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cerr << "Failed to create log: " << path << std::endl;
+        return false;
+    }
+    start = Clock::now();
+    FileHeader header{};
+    std::memcpy(header.magic, FILE_MAGIC, sizeof header.magic);
+    header.wall_start_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    file.write(reinterpret_cast<const char*>(&header), sizeof header);
+    offset = sizeof header;
+    stopping = false;
+    writer = std::thread(&LogWriter::writeLoop, this);
+    return true;
+}
+
+void LogWriter::close() {
+    if (!writer.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    queue_cv.notify_all();
+    writer.join();
+
+    // 索引与 Footer 写在最后，读取端据此判断文件是否完整
+    Item item{INDEX, 0, 0, 0, {}, {}};
+    const uint64_t index_offset = offset;
+    const uint64_t records = written_count.load();
+    writeRecord(item, reinterpret_cast<const uint8_t*>(index.data()), index.size() * sizeof(IndexEntry));
+    Footer footer{};
+    std::memcpy(footer.magic, FOOTER_MAGIC, sizeof footer.magic);
+    footer.index_offset = index_offset;
+    footer.record_count = records;
+    file.write(reinterpret_cast<const char*>(&footer), sizeof footer);
+    file.close();
+    std::cout << "Log closed: " << path << ", " << records << " records, " << dropped_count.load() << " dropped." << std::endl;
+}
+
+uint64_t LogWriter::toNs(Clock::time_point timestamp) const {
+    return timestamp > start ? std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp - start).count() : 0;
+}
+
+bool LogWriter::enqueue(Item item) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (stopping || !writer.joinable() || queue.size() >= config.queue_capacity) {
+            dropped_count.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (item.type == FRAME_JPEG) pending_frames++;
+        queue.push_back(std::move(item));
+    }
+    queue_cv.notify_one();
+    return true;
+}
+
+bool LogWriter::writeFrame(Clock::time_point timestamp, const cv::Mat& image, uint16_t channel) {
+    if (image.empty()) return false;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (last_frame.size() <= channel) last_frame.resize(channel + 1);
+        if (config.max_frame_fps > 0 && last_frame[channel] != Clock::time_point{} &&
+            timestamp - last_frame[channel] < std::chrono::duration<double>(0.9 / config.max_frame_fps)) {
+            return false;   // 按帧率抽帧，不计入丢弃
+        }
+        if (pending_frames >= config.max_pending_frames) {
+            dropped_count.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        last_frame[channel] = timestamp;
+    }
+    return enqueue({FRAME_JPEG, channel, 0, toNs(timestamp), image, {}});
+}
+
+bool LogWriter::writePacket(Clock::time_point timestamp, const uint8_t* data, size_t size, bool keyframe, uint16_t channel) {
+    return enqueue({PACKET, channel, keyframe ? FLAG_KEYFRAME : 0u, toNs(timestamp), {}, std::vector<uint8_t>(data, data + size)});
+}
+
+bool LogWriter::writeLine(Clock::time_point timestamp, std::string_view line, uint16_t channel) {
+    return enqueue({UART_LINE, channel, 0, toNs(timestamp), {}, std::vector<uint8_t>(line.begin(), line.end())});
+}
+
+bool LogWriter::writeImu(Clock::time_point timestamp, const ImuRecord& sample, uint16_t channel) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&sample);
+    return enqueue({IMU_SAMPLE, channel, 0, toNs(timestamp), {}, std::vector<uint8_t>(bytes, bytes + sizeof sample)});
+}
+
+void LogWriter::writeLoop() {
+    RT::ThreadScope scope("record");
+    while (true) {
+        Item item;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            queue_cv.wait(lock, [this] { return !queue.empty() || stopping; });
+            if (queue.empty()) break;
+            item = std::move(queue.front());
+            queue.pop_front();
+        }
+
+        if (item.type == FRAME_JPEG) {
+            const bool ok = cv::imencode(".jpg", item.image, jpeg, {cv::IMWRITE_JPEG_QUALITY, config.jpeg_quality});
+            item.image.release();
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                pending_frames--;
+            }
+            if (!ok) {
+                dropped_count.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            writeRecord(item, jpeg.data(), jpeg.size());
+        }
+        else {
+            writeRecord(item, item.payload.data(), item.payload.size());
+        }
+    }
+}
+
+void LogWriter::writeRecord(const Item& item, const uint8_t* data, size_t size) {
+    // 帧与关键帧都建索引，其他记录按时间间隔建索引，保证任意时刻附近都能定位
+    if (item.type != INDEX) {
+        const bool seekable = item.type == FRAME_JPEG || (item.type == PACKET && (item.flags & FLAG_KEYFRAME));
+        const auto interval = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(config.index_interval).count());
+        if (seekable || index.empty() || item.timestamp_ns >= last_index_ns + interval) {
+            index.push_back({item.timestamp_ns, offset});
+            last_index_ns = item.timestamp_ns;
+        }
+    }
+
+    const RecordHeader header{RECORD_SYNC, item.type, item.channel, static_cast<uint32_t>(size), item.flags, item.timestamp_ns};
+    static constexpr char zeros[RECORD_ALIGN] = {};
+    const uint64_t padding = padded(size) - size;
+    file.write(reinterpret_cast<const char*>(&header), sizeof header);
+    file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+    file.write(zeros, static_cast<std::streamsize>(padding));
+    if (!file) {
+        std::cerr << "Failed to write log: " << path << std::endl;
+        return;
+    }
+    offset += sizeof header + size + padding;
+    if (item.type != INDEX) written_count.fetch_add(1, std::memory_order_relaxed);
+    byte_count.store(offset, std::memory_order_relaxed);
+}
+
+// ---------------- LogReader ----------------
+
+LogReader::~LogReader() {
+    close();
+}
+
+bool LogReader::open(const std::string& path) {
+    close();
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        std::cerr << "Failed to open log: " << path << std::endl;
+        return false;
+    }
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(FileHeader)) {
+        std::cerr << "Log too small: " << path << std::endl;
+        ::close(fd);
+        return false;
+    }
+    size = static_cast<size_t>(st.st_size);
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);    // 映射建立后即可关闭描述符
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Failed to map log: " << path << std::endl;
+        size = 0;
+        return false;
+    }
+    data = static_cast<const uint8_t*>(mapping);
+    madvise(mapping, size, MADV_SEQUENTIAL);
+    if (std::memcmp(header().magic, FILE_MAGIC, sizeof FILE_MAGIC) != 0) {
+        std::cerr << "Not an EchoVision log: " << path << std::endl;
+        close();
+        return false;
+    }
+
+    // 有完整的 Footer 时直接使用文件中的索引，否则顺序扫描
+    end = size;
+    has_footer = false;
+    if (size >= sizeof(FileHeader) + sizeof(Footer)) {
+        Footer footer;
+        std::memcpy(&footer, data + size - sizeof footer, sizeof footer);
+        end = size - sizeof footer;
+        if (std::memcmp(footer.magic, FOOTER_MAGIC, sizeof FOOTER_MAGIC) == 0 && footer.index_offset >= first_record &&
+            validate(footer.index_offset) == end) {
+            RecordHeader index_header;
+            std::memcpy(&index_header, data + footer.index_offset, sizeof index_header);
+            if (index_header.type == INDEX) {
+                entries = {reinterpret_cast<const IndexEntry*>(data + footer.index_offset + sizeof(RecordHeader)),
+                           index_header.size / sizeof(IndexEntry)};
+                record_count = footer.record_count;
+                end = footer.index_offset;
+                has_footer = true;
+            }
+        }
+    }
+    if (!has_footer) {
+        end = size;
+        scan();
+        std::cerr << "Log has no index (recording interrupted?), scanned " << record_count << " records." << std::endl;
+    }
+
+    cursor = first_record;
+    RecordView record{};
+    first_ns = next(record) ? record.timestamp_ns : 0;
+    // 最后一条记录在最后一个索引点之后不远处
+    cursor = entries.empty() ? first_record : entries.back().offset;
+    last_ns = first_ns;
+    while (next(record)) last_ns = std::max(last_ns, record.timestamp_ns);
+    cursor = first_record;
+    return true;
+}
+
+void LogReader::close() {
+    if (data) {
+        munmap(const_cast<uint8_t*>(data), size);
+    }
+    data = nullptr;
+    size = 0;
+    end = 0;
+    cursor = 0;
+    entries = {};
+    scanned.clear();
+    record_count = 0;
+    has_footer = false;
+}
+
+uint64_t LogReader::validate(uint64_t offset) const {
+    if (offset + sizeof(RecordHeader) > end) return 0;
+    RecordHeader header;
+    std::memcpy(&header, data + offset, sizeof header);
+    if (header.sync != RECORD_SYNC) return 0;
+    const uint64_t next_offset = offset + sizeof header + padded(header.size);
+    return next_offset <= end ? next_offset : 0;
+}
+
+void LogReader::scan() {
+    uint64_t offset = first_record;
+    uint64_t last_index_ns = 0;
+    constexpr uint64_t INTERVAL_NS = 1000000000ull;
+    while (const uint64_t next_offset = validate(offset)) {
+        RecordHeader header;
+        std::memcpy(&header, data + offset, sizeof header);
+        if (header.type != INDEX) {
+            const bool seekable = header.type == FRAME_JPEG || (header.type == PACKET && (header.flags & FLAG_KEYFRAME));
+            if (seekable || scanned.empty() || header.timestamp_ns >= last_index_ns + INTERVAL_NS) {
+                scanned.push_back({header.timestamp_ns, offset});
+                last_index_ns = header.timestamp_ns;
+            }
+            record_count++;
+        }
+        offset = next_offset;
+    }
+    end = offset;   // 丢弃末尾不完整的记录
+    entries = scanned;
+}
+
+bool LogReader::next(RecordView& record) {
+    while (cursor < end) {
+        const uint64_t next_offset = validate(cursor);
+        if (next_offset == 0) {
+            cursor = end;
+            return false;
+        }
+        RecordHeader header;
+        std::memcpy(&header, data + cursor, sizeof header);
+        record = {static_cast<RecordType>(header.type), header.channel, header.flags, header.timestamp_ns,
+                  {data + cursor + sizeof header, header.size}, cursor};
+        cursor = next_offset;
+        if (header.type != INDEX) return true;
+    }
+    return false;
+}
+
+void LogReader::seek(uint64_t timestamp_ns) {
+    // 从最后一个不晚于目标时间的索引点开始向后找
+    const auto it = std::upper_bound(entries.begin(), entries.end(), timestamp_ns,
+                                     [](uint64_t t, const IndexEntry& e) { return t < e.timestamp_ns; });
+    cursor = it == entries.begin() ? first_record : std::prev(it)->offset;
+    RecordView record{};
+    while (true) {
+        const uint64_t here = cursor;
+        if (!next(record)) return;      // 目标时间晚于所有记录，停在结尾
+        if (record.timestamp_ns >= timestamp_ns) {
+            cursor = here;
+            return;
+        }
+    }
+}
+
+} // namespace RECORD
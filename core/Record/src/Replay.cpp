@@ -0,0 +1,160 @@
+#include "Replay.h"
+#include "Runtime.h"
+#include <cstring>
+#include <iostream>
+
+namespace RECORD {
+
+LogReplay::LogReplay(std::string path, double speed, bool loop) : path(std::move(path)), speed(speed), loop(loop) {}
+
+LogReplay::~LogReplay() {
+    stop();
+}
+
+bool LogReplay::open() {
+    if (!log.open(path)) return false;
+    std::cout << "Replaying " << path << ": " << log.recordCount() << " records, "
+              << (log.lastTimestamp() - log.firstTimestamp()) / 1e9 << " s" << std::endl;
+    return true;
+}
+
+std::string LogReplay::uartDevice(uint16_t channel) {
+    auto& terminal = terminals[channel];
+    if (!terminal) {
+        terminal = std::make_unique<HAL::UART::PseudoTerminal>();
+        if (terminal->ptyInit() != HAL::OK) {
+            std::cerr << "Failed to create pseudo-terminal for UART channel " << channel << std::endl;
+            terminals.erase(channel);
+            return {};
+        }
+    }
+    return terminal->ptyDevice();
+}
+
+cv::Size LogReplay::frameSize(uint16_t channel) {
+    log.rewind();
+    RecordView record{};
+    cv::Size size;
+    while (log.next(record)) {
+        if (record.type == FRAME_JPEG && record.channel == channel) {
+            const cv::Mat encoded(1, static_cast<int>(record.payload.size()), CV_8UC1, const_cast<uint8_t*>(record.payload.data()));
+            size = cv::imdecode(encoded, cv::IMREAD_COLOR).size();
+            break;
+        }
+    }
+    log.rewind();
+    return size;
+}
+
+void LogReplay::start(uint64_t offset_ns) {
+    if (running.exchange(true)) return;
+    done = false;
+    worker = std::thread(&LogReplay::run, this, offset_ns);
+}
+
+void LogReplay::stop() {
+    running = false;
+    frame_cv.notify_all();
+    if (worker.joinable()) worker.join();
+    for (auto& [channel, terminal] : terminals) {
+        terminal->ptyClose();   // 读串口的一方随即收到错误并退出
+    }
+}
+
+void LogReplay::run(uint64_t offset_ns) {
+    RT::ThreadScope scope("replay");
+    do {
+        log.seek(std::max(offset_ns, log.firstTimestamp()));
+        const Clock::time_point begin = Clock::now();
+        uint64_t base_ns = 0;
+        bool first = true;
+        RecordView record{};
+        while (running.load(std::memory_order_relaxed) && log.next(record)) {
+            if (first) {
+                base_ns = record.timestamp_ns;
+                first = false;
+            }
+            // 记录时间 -> 本次回放的本地时间
+            const double elapsed = (record.timestamp_ns - std::min(record.timestamp_ns, base_ns)) / 1e9;
+            Clock::time_point local = begin;
+            if (speed > 0) {
+                local += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(elapsed / speed));
+                std::this_thread::sleep_until(local);
+            }
+            else {
+                local = Clock::now();
+            }
+            dispatch(record, local);
+        }
+        offset_ns = 0;
+    } while (loop && running.load(std::memory_order_relaxed));
+
+    {
+        std::lock_guard<std::mutex> lock(frame_mutex);
+        done.store(true, std::memory_order_release);
+    }
+    frame_cv.notify_all();
+}
+
+void LogReplay::dispatch(const RecordView& record, Clock::time_point local) {
+    switch (record.type) {
+        case FRAME_JPEG: {
+            {
+                std::lock_guard<std::mutex> lock(frame_mutex);
+                FrameSlot& slot = frames[record.channel];
+                if (slot.fresh) slot.skipped++;     // 与真实相机一样，读取慢时只保留最新一帧
+                slot.jpeg = record.payload;
+                slot.fresh = true;
+            }
+            frame_cv.notify_all();
+            break;
+        }
+        case UART_LINE: {
+            const auto it = terminals.find(record.channel);
+            if (it == terminals.end()) break;
+            const std::string_view line(reinterpret_cast<const char*>(record.payload.data()), record.payload.size());
+            if (it->second->ptyWrite(line) != HAL::OK || it->second->ptyWrite("\r\n") != HAL::OK) {
+                std::cerr << "UART replay write failed on channel " << record.channel << std::endl;
+            }
+            break;
+        }
+        case IMU_SAMPLE: {
+            if (record.payload.size() != sizeof(ImuRecord)) break;
+            ReplayedImu sample{local, {}};
+            std::memcpy(&sample.sample, record.payload.data(), sizeof(ImuRecord));
+            imu_ring.push(sample);
+            break;
+        }
+        default:
+            // 编码后的视频包目前只用于离线分析，回放时忽略
+            break;
+    }
+}
+
+bool LogReplay::readFrame(cv::Mat& frame, uint16_t channel) {
+    std::span<const uint8_t> jpeg;
+    {
+        std::unique_lock<std::mutex> lock(frame_mutex);
+        frame_cv.wait(lock, [&] {
+            return frames[channel].fresh || done.load(std::memory_order_acquire) || !running.load(std::memory_order_relaxed);
+        });
+        FrameSlot& slot = frames[channel];
+        if (!slot.fresh) return false;
+        jpeg = slot.jpeg;
+        slot.fresh = false;
+    }
+    // mmap 中的数据在回放器存在期间一直有效，解码不必持锁
+    const cv::Mat encoded(1, static_cast<int>(jpeg.size()), CV_8UC1, const_cast<uint8_t*>(jpeg.data()));
+    // 解码到调用者的缓冲，尺寸不变时复用（帧池中的图像）
+    cv::imdecode(encoded, cv::IMREAD_COLOR, &frame);
+    return !frame.empty();
+}
+
+uint64_t LogReplay::framesSkipped() const {
+    std::lock_guard<std::mutex> lock(frame_mutex);
+    uint64_t total = 0;
+    for (const auto& [channel, slot] : frames) total += slot.skipped;
+    return total;
+}
+
+} // namespace RECORD
@@ -0,0 +1,84 @@
+#ifndef RUNTIME_H
+#define RUNTIME_H
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <sys/types.h>
+
+// 线程放置：按流水线角色为线程设置 CPU 亲和性与调度策略，并统计各线程的 CPU 时间与被动上下文切换。
+// 角色名：
+//   flow     执行器工作线程（采集、检测、显示、推流分发等流水线节点在其上执行）
+//   io       串口事件循环 encode   编码   mux  封装写出   convert  联播降采样
+//   fusion   融合        alert    危险提示   storage  录像写盘   snapshot  拍照压缩与写盘   record / replay  会话日志
+//   uplink   遥测上报
+// 线程可带实例名（如 flow:0），配置中 "角色:实例名" 优先于 "角色"
+namespace RT {
+    enum class SchedPolicy {
+        OTHER,      // 普通分时调度，可设 nice
+        FIFO,       // 实时调度，需要 CAP_SYS_NICE 或 root，否则退回 OTHER
+    };
+
+    struct ThreadConfig {
+        std::vector<int> cpus;              // 允许运行的 CPU，空为不限制
+        SchedPolicy policy = SchedPolicy::OTHER;
+        int priority = 0;                   // FIFO 优先级 1~99
+        int nice = 0;                       // OTHER 的 nice 值，-20~19，负值同样需要权限
+    };
+
+    struct RuntimeConfig {
+        std::map<std::string, ThreadConfig, std::less<>> threads;  // 角色名（或 角色:实例名）-> 配置，未列出的角色不做设置
+        int flowWorkers = 0;                // 执行器线程数，0 为按 CPU 核数与流水线数自动确定
+        int ortThreads = 0;                 // ORT 算子内线程数（含发起推理的线程），0 为 ORT 默认
+        std::vector<int> ortCpus;           // ORT 线程池线程依次绑定的 CPU
+        int encoderThreads = 0;             // 编码器线程数，0 为 CPU 核数
+        std::vector<int> encoderCpus;       // 编码器内部线程允许运行的 CPU
+    };
+
+    // 设置全局线程放置，须在创建各线程之前调用；未调用时线程只命名与登记，不改变亲和性与调度
+    void configure(const RuntimeConfig& config);
+    const RuntimeConfig& config();
+
+    // 放在线程函数开头：按角色命名当前线程、应用亲和性与调度策略并登记，
+    // 析构时记下该线程最终的 CPU 时间与上下文切换次数。没有权限时打印一次提示后继续运行
+    class ThreadScope {
+    public:
+        explicit ThreadScope(std::string_view role, std::string_view instance = {});
+        ~ThreadScope();
+        ThreadScope(const ThreadScope&) = delete;
+        ThreadScope& operator=(const ThreadScope&) = delete;
+    private:
+        size_t slot;
+    };
+
+    // 临时修改当前线程的亲和性，析构时恢复。用于让编码器等库内部创建的线程继承指定的 CPU 集合
+    class ScopedAffinity {
+    public:
+        explicit ScopedAffinity(const std::vector<int>& cpus);
+        ~ScopedAffinity();
+        ScopedAffinity(const ScopedAffinity&) = delete;
+        ScopedAffinity& operator=(const ScopedAffinity&) = delete;
+    private:
+        bool changed = false;
+        std::vector<uint8_t> saved;     // 原 cpu_set_t
+    };
+
+    struct ThreadStats {
+        std::string role;
+        pid_t tid = 0;
+        bool running = false;
+        double cpuMs = 0.0;                 // 用户态 + 内核态
+        uint64_t voluntarySwitches = 0;     // 主动让出（等待 I/O、锁等）
+        uint64_t involuntarySwitches = 0;   // 被抢占，实时线程上这个数增长说明与其他线程争用 CPU
+        std::string placement;              // 实际生效的亲和性与调度策略
+    };
+
+    // 所有登记过的线程，运行中的从 /proc 读取，已退出的为退出时的值
+    std::vector<ThreadStats> threadStats();
+    void report(std::ostream& out);
+}
+
+#endif //RUNTIME_H
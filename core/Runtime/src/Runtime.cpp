@@ -0,0 +1,215 @@
+#include "Runtime.h"
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+
+namespace {
+    RT::RuntimeConfig runtime_config;
+    std::mutex registry_mutex;
+    std::vector<RT::ThreadStats> registry;
+    std::atomic<bool> warned_fifo{false};
+    std::atomic<bool> warned_nice{false};
+
+    pid_t currentTid() {
+        return static_cast<pid_t>(syscall(SYS_gettid));
+    }
+
+    // 去掉进程不允许使用（cgroup/taskset 限制或不存在）的 CPU
+    bool buildMask(const std::vector<int>& cpus, cpu_set_t& mask) {
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return false;
+        CPU_ZERO(&mask);
+        for (int cpu : cpus) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed)) CPU_SET(cpu, &mask);
+        }
+        return CPU_COUNT(&mask) > 0;
+    }
+
+    std::string describeCpus(const cpu_set_t& mask) {
+        std::string text;
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (!CPU_ISSET(cpu, &mask)) continue;
+            if (!text.empty()) text += ',';
+            text += std::to_string(cpu);
+        }
+        return text;
+    }
+
+    std::string applyConfig(const RT::ThreadConfig& config, std::string_view role) {
+        std::ostringstream placement;
+        if (!config.cpus.empty()) {
+            cpu_set_t mask;
+            if (buildMask(config.cpus, mask) && pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask) == 0) {
+                placement << "cpus " << describeCpus(mask);
+            }
+            else {
+                std::cerr << "Thread " << role << ": none of the configured CPUs is available, affinity unchanged." << std::endl;
+                placement << "cpus any";
+            }
+        }
+        else {
+            placement << "cpus any";
+        }
+
+        if (config.policy == RT::SchedPolicy::FIFO) {
+            sched_param param{};
+            param.sched_priority = std::clamp(config.priority, sched_get_priority_min(SCHED_FIFO), sched_get_priority_max(SCHED_FIFO));
+            const int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+            if (err == 0) {
+                placement << ", fifo " << param.sched_priority;
+                return placement.str();
+            }
+            // 没有权限时退回普通调度，nice 仍按配置尝试
+            if (!warned_fifo.exchange(true)) {
+                std::cerr << "SCHED_FIFO unavailable (" << strerror(err) << "), real-time threads fall back to SCHED_OTHER." << std::endl;
+            }
+        }
+        if (config.nice != 0) {
+            if (setpriority(PRIO_PROCESS, static_cast<id_t>(currentTid()), config.nice) == 0) {
+                placement << ", nice " << config.nice;
+                return placement.str();
+            }
+            if (!warned_nice.exchange(true)) {
+                std::cerr << "Failed to set thread nice value (" << strerror(errno) << "), keeping default." << std::endl;
+            }
+        }
+        placement << ", other";
+        return placement.str();
+    }
+
+    // /proc/self/task/<tid>/stat 第 14、15 项为用户态与内核态时间（时钟滴答）
+    bool readProcStats(RT::ThreadStats& stats) {
+        const std::string base = "/proc/self/task/" + std::to_string(stats.tid);
+        std::ifstream stat(base + "/stat");
+        std::string line;
+        if (!std::getline(stat, line)) return false;
+        // 线程名可能含空格，从最后一个 ')' 之后开始数字段（第 3 项起）
+        const size_t paren = line.rfind(')');
+        if (paren == std::string::npos) return false;
+        std::istringstream fields(line.substr(paren + 2));
+        std::string field;
+        uint64_t utime = 0, stime = 0;
+        for (int index = 3; fields >> field; index++) {
+            if (index == 14) utime = std::stoull(field);
+            if (index == 15) {
+                stime = std::stoull(field);
+                break;
+            }
+        }
+        stats.cpuMs = static_cast<double>(utime + stime) * 1000.0 / static_cast<double>(sysconf(_SC_CLK_TCK));
+
+        std::ifstream status(base + "/status");
+        while (std::getline(status, line)) {
+            if (line.starts_with("voluntary_ctxt_switches:")) {
+                stats.voluntarySwitches = std::stoull(line.substr(line.find(':') + 1));
+            }
+            else if (line.starts_with("nonvoluntary_ctxt_switches:")) {
+                stats.involuntarySwitches = std::stoull(line.substr(line.find(':') + 1));
+            }
+        }
+        return true;
+    }
+}
+
+void RT::configure(const RuntimeConfig& config) {
+    runtime_config = config;
+}
+
+const RT::RuntimeConfig& RT::config() {
+    return runtime_config;
+}
+
+RT::ThreadScope::ThreadScope(std::string_view role, std::string_view instance) {
+    std::string name(role);
+    if (!instance.empty()) {
+        name.append(":").append(instance);
+    }
+    // 线程名最长 15 字节，top -H、perf 中可按角色区分
+    pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+
+    ThreadStats stats;
+    stats.role = name;
+    stats.tid = currentTid();
+    stats.running = true;
+    auto it = runtime_config.threads.find(name);
+    if (it == runtime_config.threads.end()) it = runtime_config.threads.find(role);
+    if (it != runtime_config.threads.end()) {
+        stats.placement = applyConfig(it->second, name);
+    }
+    else {
+        stats.placement = "default";
+    }
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    slot = registry.size();
+    registry.push_back(std::move(stats));
+}
+
+RT::ThreadScope::~ThreadScope() {
+    rusage usage{};
+    const bool ok = getrusage(RUSAGE_THREAD, &usage) == 0;
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    ThreadStats& stats = registry[slot];
+    stats.running = false;
+    if (ok) {
+        stats.cpuMs = (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000.0 + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.0;
+        stats.voluntarySwitches = usage.ru_nvcsw;
+        stats.involuntarySwitches = usage.ru_nivcsw;
+    }
+}
+
+RT::ScopedAffinity::ScopedAffinity(const std::vector<int>& cpus) {
+    if (cpus.empty()) return;
+    cpu_set_t old_mask, mask;
+    if (pthread_getaffinity_np(pthread_self(), sizeof(old_mask), &old_mask) != 0 || !buildMask(cpus, mask)) return;
+    if (pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask) != 0) return;
+    saved.resize(sizeof(old_mask));
+    std::memcpy(saved.data(), &old_mask, sizeof(old_mask));
+    changed = true;
+}
+
+RT::ScopedAffinity::~ScopedAffinity() {
+    if (!changed) return;
+    cpu_set_t old_mask;
+    std::memcpy(&old_mask, saved.data(), sizeof(old_mask));
+    pthread_setaffinity_np(pthread_self(), sizeof(old_mask), &old_mask);
+}
+
+std::vector<RT::ThreadStats> RT::threadStats() {
+    std::vector<ThreadStats> result;
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        result = registry;
+    }
+    for (auto& stats : result) {
+        if (stats.running) readProcStats(stats);
+    }
+    return result;
+}
+
+void RT::report(std::ostream& out) {
+    const auto flags = out.flags();
+    const auto precision = out.precision();
+    out << std::left << std::setw(16) << "thread" << std::setw(8) << "tid" << std::right << std::setw(12) << "cpu ms"
+        << std::setw(10) << "vol cs" << std::setw(10) << "invol cs" << "  placement" << std::endl;
+    out << std::fixed << std::setprecision(1);
+    for (const auto& stats : threadStats()) {
+        out << std::left << std::setw(16) << stats.role << std::setw(8) << stats.tid << std::right << std::setw(12) << stats.cpuMs
+            << std::setw(10) << stats.voluntarySwitches << std::setw(10) << stats.involuntarySwitches
+            << "  " << stats.placement << (stats.running ? "" : " (exited)") << std::endl;
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
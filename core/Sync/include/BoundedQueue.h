@@ -0,0 +1,77 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace SYNC {
+    // 释放元素引用的资源但保留已分配的存储：有 reset() 的（智能指针、带缓冲的结果结构）调用 reset()，
+    // 有 clear() 的容器调用 clear()，其余重置为 T{}
+    template <typename T>
+    void recycle(T& value) {
+        if constexpr (requires { value.reset(); }) value.reset();
+        else if constexpr (requires { value.clear(); }) value.clear();
+        else value = T{};
+    }
+
+    // 容量在运行时确定的环形队列，槽位构造时一次分配，之后入队出队不再分配内存。
+    // 元素复制赋值进槽位、出队时与调用者交换，元素自带的缓冲（如 vector）在槽位与调用者之间轮转复用。
+    // 满时覆盖最旧的元素并计数（消费者总是处理最新的数据）。不加锁，由调用者负责同步
+    template <typename T>
+    class BoundedQueue {
+    public:
+        explicit BoundedQueue(size_t capacity) : slots(capacity > 0 ? capacity : 1) {}
+        BoundedQueue(const BoundedQueue&) = delete;
+        BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+        // 返回 false 表示覆盖了最旧的元素。复制赋值进槽位，槽位已有足够容量时不分配内存
+        bool push(const T& value) {
+            const bool kept = makeRoom();
+            slots[(head + count) % slots.size()] = value;
+            count++;
+            return kept;
+        }
+
+        bool push(T&& value) {
+            const bool kept = makeRoom();
+            slots[(head + count) % slots.size()] = std::move(value);
+            count++;
+            return kept;
+        }
+
+        // 为空时返回 false。元素与 value 交换后槽位经 recycle 释放引用，value 原有的缓冲留在槽位中供下次入队复用
+        bool pop(T& value) {
+            if (count == 0) return false;
+            using std::swap;
+            swap(value, slots[head]);
+            recycle(slots[head]);
+            head = (head + 1) % slots.size();
+            count--;
+            return true;
+        }
+
+        [[nodiscard]] size_t size() const { return count; }
+        [[nodiscard]] bool empty() const { return count == 0; }
+        [[nodiscard]] size_t capacity() const { return slots.size(); }
+        [[nodiscard]] uint64_t overwritten() const { return overwritten_count; }
+
+    private:
+        // 满时丢弃最旧的元素；被覆盖的元素在赋值时释放
+        bool makeRoom() {
+            if (count < slots.size()) return true;
+            head = (head + 1) % slots.size();
+            count--;
+            overwritten_count++;
+            return false;
+        }
+
+        std::vector<T> slots;
+        size_t head = 0;
+        size_t count = 0;
+        uint64_t overwritten_count = 0;
+    };
+}
+
+#endif //BOUNDED_QUEUE_H
@@ -0,0 +1,64 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace SYNC {
+    // 单写多读的顺序锁：写者从不等待，读者拷贝数据后检查序号，写入过程中读到的数据会被丢弃重读。
+    // 数据按 64 位字存放在原子变量中，并发读写不构成数据竞争；适合小的、可平凡拷贝的状态快照
+    template <typename T>
+    class SeqLock {
+        static_assert(std::is_trivially_copyable_v<T>, "SeqLock 只能保存可平凡拷贝的类型");
+    public:
+        SeqLock() { store(T{}); sequence.store(0, std::memory_order_relaxed); }
+        SeqLock(const SeqLock&) = delete;
+        SeqLock& operator=(const SeqLock&) = delete;
+
+        // 只允许一个写线程
+        void store(const T& value) {
+            uint64_t buffer[WORDS] = {};
+            std::memcpy(buffer, &value, sizeof(T));
+            const uint64_t seq = sequence.load(std::memory_order_relaxed);
+            sequence.store(seq + 1, std::memory_order_relaxed);     // 奇数：写入中
+            std::atomic_thread_fence(std::memory_order_release);
+            for (size_t i = 0; i < WORDS; ++i) {
+                words[i].store(buffer[i], std::memory_order_relaxed);
+            }
+            sequence.store(seq + 2, std::memory_order_release);
+        }
+
+        // 读到一致的快照返回 true；恰逢写入时返回 false
+        bool tryLoad(T& value) const {
+            const uint64_t before = sequence.load(std::memory_order_acquire);
+            if (before & 1) return false;
+            uint64_t buffer[WORDS];
+            for (size_t i = 0; i < WORDS; ++i) {
+                buffer[i] = words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) != before) return false;
+            std::memcpy(&value, buffer, sizeof(T));
+            return true;
+        }
+
+        // 重试直到读到一致的快照；写入只需几十纳秒，读者至多重试几次
+        T load() const {
+            T value;
+            while (!tryLoad(value)) {}
+            return value;
+        }
+
+        // 已完成的写入次数，可用于判断是否有新数据
+        [[nodiscard]] uint64_t version() const { return sequence.load(std::memory_order_acquire) / 2; }
+
+    private:
+        static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+        alignas(64) std::atomic<uint64_t> sequence{0};
+        std::atomic<uint64_t> words[WORDS];
+    };
+}
+
+#endif //SEQLOCK_H
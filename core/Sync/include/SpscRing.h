@@ -0,0 +1,66 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace SYNC {
+    // 单生产者单消费者无锁环形缓冲。生产者从不阻塞：满时丢弃新元素并计数，
+    // 以免消费者处理慢时拖住实时线程
+    template <typename T, size_t Capacity>
+    class SpscRing {
+        static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "容量必须是 2 的幂");
+    public:
+        SpscRing() = default;
+        SpscRing(const SpscRing&) = delete;
+        SpscRing& operator=(const SpscRing&) = delete;
+
+        // 仅生产者线程调用
+        bool push(const T& value) {
+            const size_t head = head_index.load(std::memory_order_relaxed);
+            if (head - cached_tail >= Capacity) {
+                cached_tail = tail_index.load(std::memory_order_acquire);
+                if (head - cached_tail >= Capacity) {
+                    dropped_count.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+            }
+            slots[head & MASK] = value;
+            head_index.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        // 仅消费者线程调用，为空时返回 false
+        bool pop(T& value) {
+            const size_t tail = tail_index.load(std::memory_order_relaxed);
+            if (tail == cached_head) {
+                cached_head = head_index.load(std::memory_order_acquire);
+                if (tail == cached_head) return false;
+            }
+            value = slots[tail & MASK];
+            tail_index.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        [[nodiscard]] size_t size() const {
+            return head_index.load(std::memory_order_acquire) - tail_index.load(std::memory_order_acquire);
+        }
+        [[nodiscard]] bool empty() const { return size() == 0; }
+        [[nodiscard]] uint64_t dropped() const { return dropped_count.load(std::memory_order_relaxed); }
+        static constexpr size_t capacity() { return Capacity; }
+
+    private:
+        static constexpr size_t MASK = Capacity - 1;
+        // 生产者与消费者各自的索引分处不同缓存行，避免伪共享
+        alignas(64) std::atomic<size_t> head_index{0};
+        size_t cached_tail = 0;     // 生产者缓存的消费者位置
+        alignas(64) std::atomic<size_t> tail_index{0};
+        size_t cached_head = 0;     // 消费者缓存的生产者位置
+        alignas(64) std::atomic<uint64_t> dropped_count{0};
+        std::array<T, Capacity> slots{};
+    };
+}
+
+#endif //SPSC_RING_H
@@ -0,0 +1,64 @@
+#ifndef DETECTION_LOG_H
+#define DETECTION_LOG_H
+
+#include <opencv2/opencv.hpp>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace PIPE {
+    // 一个检测到的目标，坐标归一化到左镜头画面 [0,1]
+    struct DetectedObject {
+        int classId = 0;
+        float confidence = 0.f;
+        cv::Rect2f box;
+        bool near = false;                  // 框高超过 near_obstacle_ratio，触发了事件录像
+        double bearingDeg = -1.0;           // 目标的绝对方位（航向 + 画面中的水平偏角），无航向时为负
+    };
+
+    // 一帧的检测结果
+    struct DetectionRecord {
+        std::string_view source;
+        uint64_t sequence = 0;
+        std::chrono::steady_clock::time_point captureTime;
+        bool positioned = false;            // 采集时刻的融合位置是否有效
+        double latitude = 0.0;
+        double longitude = 0.0;
+        std::vector<DetectedObject> objects;
+    };
+
+    // 检测结果按帧写成 JSON Lines，供其他程序读取，代替逐个目标打印到终端。每行形如
+    //   {"source":"main","seq":12,"t":35.412,"unix_ms":1700000000123,"lat":..,"lon":..,
+    //    "objects":[{"class":"person","id":0,"conf":0.873,"box":[x,y,w,h],"near":true,"bearing":271.5}]}
+    // t 为 steady_clock 秒（与会话日志一致），lat/lon 与 bearing 只在有效时出现。多条流水线共用，写入加锁
+    class DetectionLog {
+    public:
+        // path 为 "-" 时写到标准输出
+        DetectionLog(std::string path, std::vector<std::string> classNames);
+        ~DetectionLog();
+        DetectionLog(const DetectionLog&) = delete;
+        DetectionLog& operator=(const DetectionLog&) = delete;
+
+        bool open();
+        void write(const DetectionRecord& record);
+        void close();
+        [[nodiscard]] uint64_t written() const;
+
+    private:
+        void appendEscaped(std::string_view text);
+
+        std::string path;
+        std::vector<std::string> class_names;
+        std::ofstream file;
+        std::ostream* out = nullptr;
+        mutable std::mutex mtx;
+        std::string line;                   // 复用的行缓冲
+        uint64_t count = 0;
+    };
+}
+
+#endif //DETECTION_LOG_H
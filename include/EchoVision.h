@@ -11,12 +11,11 @@
 #define __VISUAL
 #endif
 
-#define CAM_WIDTH 3840
-#define CAM_HEIGHT 1080
-#define CAM_FPS 30
-#define PICTURE_DIR "./SaveImage/"
-#define VIDEO_DIR "./SaveVideo/"
+// 相机模式、检测阈值、推流各路与队列深度等运行参数见配置文件（示例为仓库根目录的 echovision.yaml）
+#define DEFAULT_CONFIG_PATH "./echovision.yaml"
+// 运行期间报告各流水线帧率与延迟的间隔
+#define STATS_REPORT_SECONDS 10
 
-#define APP_SERVICE_INIT(func) int main(void){func();}
+#define APP_SERVICE_INIT(func) int main(int argc, char** argv){return func(argc, argv);}
 
 #endif // MAIN_H
@@ -0,0 +1,165 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "Config.h"
+#include "DetectionLog.h"
+#include "DetectorPool.h"
+#include "DualLensCamera.h"
+#include "Frame.h"
+#include "Governor.h"
+#include "Graph.h"
+#include "Metadata.h"
+#include "Telemetry.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class SnapshotService;
+namespace ALERT { class AlertEngine; }
+namespace FUSION { class FusionEngine; }
+namespace LIVE { class Simulcast; class EventRing; }
+namespace OVERLAY { class Compositor; }
+namespace RECORD { class LogWriter; class LogReplay; }
+
+// 一条 采集 -> 检测 -> 推流 流水线。同一进程可运行多条，各自有相机（或回放源）、帧池、数据流图、
+// 联播与录像，共享执行器、检测器池、危险提示、融合位姿与会话日志。
+// 图中的节点：
+//   capture（源）─┬─> detect ─┬─> display（开启显示时）
+//                 │           └─> detections（配置了检测结果日志或遥测上报时）
+//                 └─> stream
+// 帧边满时覆盖最旧的帧，检测与推流总是处理最新画面；各节点在共享执行器上运行，不占用专门的线程。
+// 性能调节降档时按工作点拉长推理间隔（其间的帧只推流不检测）、抽帧采集并限制推流档位
+namespace PIPE {
+    using Clock = std::chrono::steady_clock;
+
+    // 各流水线共享的服务，生命周期长于所有流水线；不需要的可为空
+    struct SharedServices {
+        const CONFIG::PipelineConfig* config = nullptr;
+        FLOW::Executor* executor = nullptr;
+        ONNX::DetectorPool* detectors = nullptr;
+        ALERT::AlertEngine* alerts = nullptr;
+        FUSION::FusionEngine* fusion = nullptr;
+        SnapshotService* snapshots = nullptr;
+        DetectionLog* detectionLog = nullptr;
+        NET::TelemetryUplink* telemetry = nullptr;
+        GOV::Governor* governor = nullptr;          // 接收推理耗时与采集到检测完成的延迟
+        std::shared_ptr<RECORD::LogWriter> sessionLog;
+    };
+
+    struct PipelineStats {
+        std::string name;
+        uint64_t captured = 0;
+        uint64_t detected = 0;
+        uint64_t dropped = 0;           // 检测、显示或推流来不及处理而被覆盖的帧
+        double captureFps = 0.0;
+        double detectFps = 0.0;
+        // 最近 LATENCY_WINDOW 帧的采集到检测完成延迟（毫秒）
+        double p50Ms = 0.0, p90Ms = 0.0, p99Ms = 0.0, maxMs = 0.0;
+    };
+
+    class Pipeline {
+    public:
+        static constexpr size_t LATENCY_WINDOW = 1024;
+
+        // index 为会话日志中这一路相机的通道号
+        Pipeline(const CONFIG::SourceConfig& source, uint16_t index, const SharedServices& shared);
+        ~Pipeline();
+        Pipeline(const Pipeline&) = delete;
+        Pipeline& operator=(const Pipeline&) = delete;
+
+        // 打开相机（replay 非空时从回放器读取 source.channel 通道）、联播与录像并建图，失败时返回 false
+        bool init(std::shared_ptr<RECORD::LogReplay> replay);
+        // 开始调度各节点
+        bool start();
+        // 请求停止：采集节点不再读取，检测、显示与推流处理完边中的帧后结束
+        void stop();
+        // 等待所有节点结束（相机断开、回放结束或 stop 之后）
+        void join();
+        [[nodiscard]] bool finished() const { return graph.finished(); }
+
+        // 任意线程调用：推理间隔、采集帧率与推流最高档立即生效；网络输入尺寸由检测器池统一设置
+        void setOperatingPoint(const GOV::OperatingPoint& point);
+
+        [[nodiscard]] const std::string& name() const { return source.name; }
+        [[nodiscard]] PipelineStats stats() const;
+        [[nodiscard]] FLOW::GraphStats graphStats() const { return graph.stats(); }
+
+    private:
+        // 检测节点送往显示与日志节点的结果，检测框为左镜头原图坐标
+        struct Detected {
+            FRAME::FramePtr frame;
+            std::vector<ONNX::OutputDet> output;
+
+            // 边与节点处理完后调用：归还帧，保留 output 的容量
+            void reset() {
+                frame.reset();
+                output.clear();
+            }
+        };
+
+        void buildGraph();
+        bool capture(FRAME::FramePtr& frame);
+        // 检测、危险提示与障碍物事件，结果随推流以 SEI 发出；有下游节点时输出检测结果
+        bool detect(FRAME::FramePtr& frame, Detected& result);
+        // 显示层画面，请求叠加时由合成器画上检测框与标签
+        void display(Detected& result);
+        // 按帧输出结构化检测结果（检测结果日志、遥测上报），附采集时刻的位置与各目标方位
+        void logDetections(Detected& result);
+        void stream(FRAME::FramePtr& frame);
+        [[nodiscard]] bool isNear(const ONNX::OutputDet& det, const cv::Rect& left) const;
+        bool initStream();
+        [[nodiscard]] cv::Size displaySize(const cv::Rect& full) const;
+
+        CONFIG::SourceConfig source;
+        uint16_t index;
+        SharedServices shared;
+        size_t detector_stream = 0;
+        std::string window;
+
+        std::unique_ptr<DualLensCamera> camera;
+        std::unique_ptr<LIVE::Simulcast> simulcast;
+        std::shared_ptr<LIVE::EventRing> event_ring;
+
+        // 只在采集节点中使用。消费者释放后帧回到池中，相机直接读入上一次的图像缓冲
+        FRAME::FramePool pool;
+        uint64_t sequence = 0;
+        uint64_t read_count = 0;
+
+        // 当前工作点，由 setOperatingPoint 写入
+        std::atomic<int> detect_interval_ms{0};
+        std::atomic<int> capture_divisor{1};    // 每这么多帧解码一帧
+        Clock::time_point last_inference;       // 只在检测节点中使用
+        int detect_stage = -1;
+        int latency_stage = -1;
+
+        // 检测、显示与日志节点各自复用的缓冲
+        std::vector<ONNX::OutputDet> output;
+        std::vector<LIVE::Detection> detections;
+        cv::Mat canvas;
+        std::vector<ONNX::OutputDet> overlay;
+        std::unique_ptr<OVERLAY::Compositor> compositor;    // 只在显示窗口请求叠加时创建
+        DetectionRecord record;
+        NET::DetectionEvent telemetry_event;
+
+        mutable std::mutex stats_mutex;
+        uint64_t captured = 0;
+        uint64_t detected = 0;
+        Clock::time_point started;
+        Clock::time_point stopped;
+        bool pool_reported = false;
+        std::vector<double> latencies;      // 环形，LATENCY_WINDOW 条
+        size_t latency_next = 0;
+
+        // 最后声明：析构时先等各节点结束，节点中用到的上述成员此时仍然有效
+        FLOW::Graph graph;
+        FLOW::Edge<FRAME::FramePtr>* detect_edge = nullptr;
+        FLOW::Edge<FRAME::FramePtr>* stream_edge = nullptr;
+        FLOW::Edge<Detected>* display_edge = nullptr;
+        FLOW::Edge<Detected>* log_edge = nullptr;
+    };
+}
+
+#endif //PIPELINE_H
@@ -6,7 +6,9 @@
 #define DUALLENSCAMERA_H
 
 #include <opencv2/opencv.hpp>
+#include "Replay.h"
 #include <iostream>
+#include <memory>
 #include <string>
 #include <thread>
 #include <sys/stat.h>
@@ -14,21 +16,22 @@
 class DualLensCamera {
 public:
     DualLensCamera(int device, int width, int height, int fps);
-    ~DualLensCamera();
+    // 回放模式：帧来自会话日志而不是摄像头，其余流程不变
+    explicit DualLensCamera(std::shared_ptr<RECORD::LogReplay> replay, uint16_t channel = 0);
 
     [[nodiscard]] bool isTrueCamera(int width, int height) const;
-    void startRecording(const std::string& folder, int& counter);
-    void stopRecording();
-    void takeSnapshot(const std::string& folder, int& counter);
     bool readFrame(cv::Mat& frame);
-    void setupVideoWriters(const std::string& folder, int& counter);
-    void cleanup();
+    // 取出并丢弃一帧：摄像头只取出不解码 MJPEG，用于降低采集帧率而不改变相机模式
+    bool skipFrame();
     static void makeShotFolder(const std::string& folder);
 
+    // 拍照由 SnapshotService 对流水线中已有的帧异步完成，不再额外读取摄像头
+    // 录像不再在这里单独编码，由 LIVE::Streamer 的编码输出分发给 LIVE::SegmentRecorder / LIVE::EventRing
     cv::VideoCapture cap;
-    cv::VideoWriter writer_left, writer_right, writer_merge;
-    std::string videoFolder;
-    bool recording = false;
+private:
+    std::shared_ptr<RECORD::LogReplay> replay;
+    uint16_t replay_channel = 0;
+    cv::Mat skipped;        // 回放时丢弃的帧
 };
 
 typedef struct {
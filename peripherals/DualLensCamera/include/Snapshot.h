@@ -0,0 +1,71 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <opencv2/opencv.hpp>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 需要保存的视图，可按位组合
+enum SnapshotView : unsigned {
+    SNAPSHOT_LEFT = 1u << 0,
+    SNAPSHOT_RIGHT = 1u << 1,
+    SNAPSHOT_MERGE = 1u << 2,     // 左右拼接，即采集原图
+    SNAPSHOT_ALL = SNAPSHOT_LEFT | SNAPSHOT_RIGHT | SNAPSHOT_MERGE,
+};
+
+// 异步拍照：直接使用流水线中已有的帧（不再额外读摄像头），各视图在工作线程中并行 JPEG 编码，
+// 编码结果放在复用的缓冲中交给写盘线程。调用者只登记任务，不会被编码或磁盘阻塞；
+// 工作线程以较低优先级运行，积压过多时新的请求直接丢弃，不影响采集、检测与推流
+class SnapshotService {
+public:
+    explicit SnapshotService(const std::string& folder, size_t workers = 2, int quality = 90, size_t max_pending = 8);
+    ~SnapshotService();
+    SnapshotService(const SnapshotService&) = delete;
+    SnapshotService& operator=(const SnapshotService&) = delete;
+
+    // 对 frame 拍照并立即返回编号；frame 在编码完成前不得被改写（采集每帧使用新的 cv::Mat 即可满足）。
+    // 文件名为视图、本地时间与编号，如 left_20250305_142530_7.jpg，重启后不会覆盖之前的照片。积压过多时返回 -1
+    int request(const cv::Mat& frame, unsigned views = SNAPSHOT_ALL);
+
+    [[nodiscard]] uint64_t saved() const;
+    [[nodiscard]] uint64_t dropped() const;
+
+private:
+    struct EncodeTask {
+        cv::Mat image;           // 视图区域，与原帧共享数据
+        std::string path;
+    };
+    struct WriteTask {
+        std::vector<uchar> buffer;
+        std::string path;
+    };
+
+    void encodeLoop();
+    void writeLoop();
+    std::vector<uchar> takeBuffer();
+    void returnBuffer(std::vector<uchar> buffer);
+
+    std::filesystem::path folder;
+    std::vector<int> params;
+    size_t max_pending;
+    int counter = 0;
+
+    std::deque<EncodeTask> encode_queue;
+    std::deque<WriteTask> write_queue;
+    std::vector<std::vector<uchar>> buffer_pool;   // 编码输出缓冲，容量在多次拍照间复用
+    uint64_t saved_count = 0;
+    uint64_t dropped_count = 0;
+    bool stopping = false;
+    bool encoders_done = false;
+    mutable std::mutex mtx;
+    std::condition_variable encode_cv, write_cv;
+    std::vector<std::thread> encoders;
+    std::thread writer;
+};
+
+#endif //SNAPSHOT_H
@@ -0,0 +1,155 @@
+#include "Snapshot.h"
+#include "Runtime.h"
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// 降低当前线程的调度优先级（Linux 下 nice 值按线程生效）
+static void lowerThreadPriority() {
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 10);
+}
+
+SnapshotService::SnapshotService(const std::string& folder, const size_t workers, const int quality, const size_t max_pending)
+    : folder(folder), params{cv::IMWRITE_JPEG_QUALITY, quality}, max_pending(std::max<size_t>(max_pending, 1)) {
+    std::error_code ec;
+    std::filesystem::create_directories(this->folder, ec);
+    if (ec) {
+        std::cerr << "无法创建照片目录 " << folder << ": " << ec.message() << std::endl;
+    }
+    for (size_t i = 0; i < std::max<size_t>(workers, 1); ++i) {
+        encoders.emplace_back(&SnapshotService::encodeLoop, this);
+    }
+    writer = std::thread(&SnapshotService::writeLoop, this);
+}
+
+SnapshotService::~SnapshotService() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    // 先等编码线程处理完已登记的任务，再让写盘线程写完
+    encode_cv.notify_all();
+    for (auto& t : encoders) t.join();
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        encoders_done = true;
+    }
+    write_cv.notify_all();
+    writer.join();
+}
+
+int SnapshotService::request(const cv::Mat& frame, const unsigned views) {
+    if (frame.empty() || (views & SNAPSHOT_ALL) == 0) {
+        return -1;
+    }
+    const cv::Rect left(0, 0, frame.cols / 2, frame.rows);
+    const cv::Rect right(frame.cols / 2, 0, frame.cols / 2, frame.rows);
+
+    int id;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (encode_queue.size() + write_queue.size() >= max_pending) {
+            dropped_count++;
+            return -1;
+        }
+        id = counter++;
+        // 编号每次启动从 0 开始，加上本地时间避免覆盖上次的照片
+        const std::time_t now = std::time(nullptr);
+        std::tm local{};
+        localtime_r(&now, &local);
+        char stamp[32];
+        std::strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S_", &local);
+        const std::string suffix = stamp + std::to_string(id) + ".jpg";
+        // 各视图只是原帧上的区域，不拷贝像素；拼接图就是原帧本身，无需 hconcat
+        if (views & SNAPSHOT_LEFT) encode_queue.push_back({frame(left), (folder / ("left_" + suffix)).string()});
+        if (views & SNAPSHOT_RIGHT) encode_queue.push_back({frame(right), (folder / ("right_" + suffix)).string()});
+        if (views & SNAPSHOT_MERGE) encode_queue.push_back({frame, (folder / ("merge_" + suffix)).string()});
+    }
+    encode_cv.notify_all();
+    return id;
+}
+
+uint64_t SnapshotService::saved() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return saved_count;
+}
+
+uint64_t SnapshotService::dropped() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return dropped_count;
+}
+
+std::vector<uchar> SnapshotService::takeBuffer() {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (buffer_pool.empty()) {
+        return {};
+    }
+    std::vector<uchar> buffer = std::move(buffer_pool.back());
+    buffer_pool.pop_back();
+    return buffer;
+}
+
+void SnapshotService::returnBuffer(std::vector<uchar> buffer) {
+    std::lock_guard<std::mutex> lock(mtx);
+    buffer.clear();     // 保留容量
+    buffer_pool.push_back(std::move(buffer));
+}
+
+void SnapshotService::encodeLoop() {
+    lowerThreadPriority();
+    RT::ThreadScope scope("snapshot");
+    while (true) {
+        EncodeTask task;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            encode_cv.wait(lock, [this] { return !encode_queue.empty() || stopping; });
+            if (encode_queue.empty()) break;
+            task = std::move(encode_queue.front());
+            encode_queue.pop_front();
+        }
+
+        std::vector<uchar> buffer = takeBuffer();
+        if (!cv::imencode(".jpg", task.image, buffer, params)) {
+            std::cerr << "Failed to encode snapshot: " << task.path << std::endl;
+            returnBuffer(std::move(buffer));
+            continue;
+        }
+        task.image.release();   // 尽早释放对原帧的引用
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            write_queue.push_back({std::move(buffer), std::move(task.path)});
+        }
+        write_cv.notify_one();
+    }
+}
+
+void SnapshotService::writeLoop() {
+    lowerThreadPriority();
+    RT::ThreadScope scope("snapshot");
+    while (true) {
+        WriteTask task;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            // 停止时编码线程已全部退出，写完剩余任务即可结束
+            write_cv.wait(lock, [this] { return !write_queue.empty() || encoders_done; });
+            if (write_queue.empty()) break;
+            task = std::move(write_queue.front());
+            write_queue.pop_front();
+        }
+
+        std::ofstream file(task.path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(task.buffer.data()), static_cast<std::streamsize>(task.buffer.size()));
+        if (file) {
+            std::cout << "Snapshot saved into: " << task.path << std::endl;
+            std::lock_guard<std::mutex> lock(mtx);
+            saved_count++;
+        }
+        else {
+            std::cerr << "Failed to write snapshot: " << task.path << std::endl;
+        }
+        returnBuffer(std::move(task.buffer));
+    }
+}
@@ -1,90 +1,79 @@
 #ifndef GNSS_H
 #define GNSS_H
 
-#include <thread>
-#include <mutex>
-#include <queue>
-#include <condition_variable>
+#include <functional>
 #include <iomanip>
-#include <variant>
 
 #include "HAL_UART.h"
+#include "HAL_Reactor.h"
+#include "NMEA.h"
+#include "NavState.h"
+#include "SeqLock.h"
+#include "SpscRing.h"
 
 
 
 namespace GNSS {
-    // 解析 GNGGA 句子
-    typedef struct {
-        std::string time;       // UTC 时间 (hhmmss.sss)
-        double latitude;        // 纬度
-        char lat_direction;     // 纬度方向 (N/S)
-        double longitude;       // 经度
-        char lon_direction;     // 经度方向 (E/W)
-        int quality;            // 定位质量
-        int satellites;         // 使用的卫星数量
-        double hdop;            // 水平精度因子
-        double altitude;        // 海拔高度
-        double geoid_height;    // 地球椭球高度
-    } GNGGA;
+    // 兼容旧名称：任意发送者（GN/GP/BD…）的 GGA、RMC 都解析到这两个结构
+    using GNGGA = GGA;
+    using GNRMC = RMC;
 
-    // 解析 GNRMC 句子
-    typedef struct {
-        std::string time;       // UTC 时间 (hhmmss.sss)
-        char status;            // 状态 (A=有效, V=无效)
-        double latitude;        // 纬度
-        char lat_direction;     // 纬度方向 (N/S)
-        double longitude;       // 经度
-        char lon_direction;     // 经度方向 (E/W)
-        double speed;           // 地面速度 (节)
-        double course;          // 航向 (度)
-        std::string date;       // 日期 (ddmmyy)
-    } GNRMC;
+    // GNSS 读取与发布：读线程解析 NMEA，按历元合并为 NavState 后
+    // 1) 写入 SeqLock，任意线程随时取最新状态，不会阻塞也不会被阻塞；
+    // 2) 追加到 SPSC 环形缓冲，供需要每一个历元的单个消费者（轨迹记录等）按序读取
     class Location {
         public:
+        static constexpr size_t HISTORY_SIZE = 256;
+        static constexpr int STOP_POLL_MS = 200;
+        using History = SYNC::SpscRing<NavState, HISTORY_SIZE>;
+
         Location();
         ~Location();
+        // 阻塞读取串口直到其关闭或调用 stop
         void locationService(HAL::UART::Uart& uart);
-        bool parseGNGGA(const std::string& sentence, GNGGA& gngga);
-        bool parseGNRMC(const std::string& sentence, GNRMC& gnrmc);
+        void stop() { stopping.store(true, std::memory_order_relaxed); }
+        // 不单独占用线程：把串口注册到事件循环，由事件循环线程读取与解析，串口关闭时自动注销
+        HAL::HardwareStatus attach(HAL::IO::Reactor& reactor, HAL::UART::Uart& uart);
+        // 在 locationService 中每读到一行原始数据时调用（解析之前），用于记录会话日志；须在启动前设置
+        void setLineTap(std::function<void(std::string_view line)> tap) { line_tap = std::move(tap); }
+        // 处理一行 NMEA，满一个历元时发布；locationService 之外也可由事件循环或回放调用（只能有一个调用线程）
+        void handleLine(std::string_view line);
+
+        // 最新导航状态，任意线程调用；sequence 为 0 表示还没有数据
+        [[nodiscard]] NavState latest() const { return current.load(); }
+        // 最新状态为有效定位时返回 true
+        bool latestFix(NavState& state) const;
+        // 历史历元，只允许一个线程消费；消费太慢时新历元被丢弃（见 History::dropped）
+        History& history() { return history_ring; }
+
+        bool parseGNGGA(std::string_view sentence, GNGGA& gngga);
+        bool parseGNRMC(std::string_view sentence, GNRMC& gnrmc);
         void printInfo(const GNGGA& gngga);
         void printInfo(const GNRMC& gnrmc);
-    };
-    class MessageQueue {
+        void printInfo(const NavState& state);
+        [[nodiscard]] const NmeaParser& parser() const { return nmea; }
     private:
-        std::queue<std::variant<GNGGA, GNRMC>> queue; // 存储解析后的数据
-        std::mutex mtx;
-        std::condition_variable condition_v;
-        bool stopFlag = false; // 停止标志
+        // 新句子的 UTC 时间与未发布的历元不同时，先发布旧历元
+        void beginEpoch(const UtcTime& time);
+        void publish();
+        void handleLines(HAL::UART::LineBatch lines);
+        void printSummary() const;
 
+        NmeaParser nmea;
+        Sentence sentence;
+        NavState pending;
+        bool has_gga = false;
+        bool has_rmc = false;
+        bool gga_fix = false;
+        bool rmc_fix = false;
+        uint64_t published = 0;
+        std::atomic<bool> stopping{false};
+        std::function<void(std::string_view)> line_tap;
+        SYNC::SeqLock<NavState> current;
+        History history_ring;
     public:
-        // 添加消息到队列
-        template <typename T>
-        void push(const T& message) {
-            std::lock_guard<std::mutex> lock(mtx);
-            queue.push(message);
-            condition_v.notify_one(); // 通知等待的线程
-        }
-
-        // 从队列中获取消息
-        std::variant<GNGGA, GNRMC> pop() {
-            std::unique_lock<std::mutex> lock(mtx);
-            condition_v.wait(lock, [this] { return !queue.empty() || stopFlag; }); // 等待直到队列非空或停止
-            if (!queue.empty()) {
-                auto message = queue.front();
-                queue.pop();
-                return message;
-            }
-            return {};
-        }
-
-        // 设置停止标志
-        void stop() {
-            {
-                std::lock_guard<std::mutex> lock(mtx);
-                stopFlag = true;
-            }
-            condition_v.notify_all(); // 通知所有等待的线程
-        }
+        Location(const Location&) = delete;
+        Location& operator=(const Location&) = delete;
     };
 }
 
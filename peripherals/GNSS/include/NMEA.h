@@ -0,0 +1,145 @@
+#ifndef NMEA_H
+#define NMEA_H
+
+#include <cstdint>
+#include <string_view>
+#include <variant>
+
+namespace GNSS {
+    // 发送者（talker ID），多系统接收机对每个星座分别输出 GSV 等句子
+    enum class Talker : uint8_t {
+        GP,         // GPS
+        GL,         // GLONASS
+        GA,         // Galileo
+        GB,         // 北斗（GB 或 BD）
+        GQ,         // QZSS
+        GI,         // NavIC
+        GN,         // 多系统联合解
+        Unknown
+    };
+
+    struct UtcTime {
+        int hour = 0;
+        int minute = 0;
+        double second = 0.0;
+        bool valid = false;
+    };
+
+    struct UtcDate {
+        int day = 0;
+        int month = 0;
+        int year = 0;           // 四位年份
+        bool valid = false;
+    };
+
+    // 经纬度均为十进制度，南纬、西经为负
+    struct GGA {
+        Talker talker = Talker::Unknown;
+        UtcTime time;
+        double latitude = 0.0;
+        char lat_direction = 0; // 纬度方向 (N/S)
+        double longitude = 0.0;
+        char lon_direction = 0; // 经度方向 (E/W)
+        int quality = 0;        // 定位质量，0 为未定位
+        int satellites = 0;     // 使用的卫星数量
+        double hdop = 0.0;      // 水平精度因子
+        double altitude = 0.0;  // 海拔高度（米）
+        double geoid_height = 0.0;  // 大地水准面高度（米）
+    };
+
+    struct RMC {
+        Talker talker = Talker::Unknown;
+        UtcTime time;
+        char status = 'V';      // 状态 (A=有效, V=无效)
+        double latitude = 0.0;
+        char lat_direction = 0;
+        double longitude = 0.0;
+        char lon_direction = 0;
+        double speed = 0.0;     // 地面速度（节）
+        double course = 0.0;    // 航向（度）
+        UtcDate date;
+        char mode = 0;          // 定位模式 (A/D/E/N)，NMEA 2.3 起
+    };
+
+    struct GSA {
+        static constexpr int MAX_PRN = 12;
+        Talker talker = Talker::Unknown;
+        char mode = 0;          // M=手动, A=自动
+        int fix_type = 1;       // 1=未定位, 2=2D, 3=3D
+        int prn[MAX_PRN] = {};  // 参与解算的卫星号
+        int prn_count = 0;
+        double pdop = 0.0;
+        double hdop = 0.0;
+        double vdop = 0.0;
+        int system_id = 0;      // NMEA 4.11 起的 GNSS 系统号，0 表示未给出
+    };
+
+    struct GSV {
+        static constexpr int MAX_SATELLITES = 4;
+        struct Satellite {
+            int prn = 0;
+            int elevation = 0;  // 度
+            int azimuth = 0;    // 度
+            int snr = -1;       // dB-Hz，未跟踪时为 -1
+        };
+        Talker talker = Talker::Unknown;
+        int total_messages = 0;
+        int message_number = 0;
+        int satellites_in_view = 0;
+        Satellite satellites[MAX_SATELLITES];
+        int satellite_count = 0;    // 本句中的卫星数
+        int signal_id = 0;      // NMEA 4.11 起的信号号，0 表示未给出
+    };
+
+    struct VTG {
+        Talker talker = Talker::Unknown;
+        double course_true = 0.0;       // 真北航向（度）
+        double course_magnetic = 0.0;   // 磁北航向（度）
+        double speed_knots = 0.0;
+        double speed_kmh = 0.0;
+        char mode = 0;
+    };
+
+    using Sentence = std::variant<std::monostate, GGA, RMC, GSA, GSV, VTG>;
+
+    enum class ParseResult {
+        OK,
+        Unsupported,    // 校验通过但不是支持的句子类型
+        BadChecksum,
+        Malformed
+    };
+
+    // NMEA 0183 解析：直接在输入的 string_view 上逐字段处理，数值用 std::from_chars 转换，
+    // 解析一句不产生任何堆分配。输入为一行（可带结尾的 \r\n）
+    class NmeaParser {
+    public:
+        // requireChecksum 为 false 时允许没有 *hh 的句子（有则仍会校验）
+        explicit NmeaParser(bool requireChecksum = true) : require_checksum(requireChecksum) {}
+
+        // 返回 OK 以外的结果时 out 为 std::monostate
+        ParseResult parse(std::string_view line, Sentence& out);
+
+        // 仅校验 *hh，成功时 payload 为 '$' 与 '*' 之间的内容
+        static bool verifyChecksum(std::string_view line, std::string_view& payload, bool requireChecksum = true);
+
+        [[nodiscard]] uint64_t parsed() const { return counts[static_cast<int>(ParseResult::OK)]; }
+        [[nodiscard]] uint64_t count(ParseResult result) const { return counts[static_cast<int>(result)]; }
+
+    private:
+        bool require_checksum;
+        uint64_t counts[4] = {};
+    };
+
+    // 单独解析某一类句子（payload 为校验后 '$' 与 '*' 之间的内容）
+    bool parseGGA(std::string_view payload, GGA& out);
+    bool parseRMC(std::string_view payload, RMC& out);
+    bool parseGSA(std::string_view payload, GSA& out);
+    bool parseGSV(std::string_view payload, GSV& out);
+    bool parseVTG(std::string_view payload, VTG& out);
+
+    // ddmm.mmmm（纬度）或 dddmm.mmmm（经度）转换为十进制度
+    double nmeaToDegrees(double ddmm);
+    const char* talkerName(Talker talker);
+}
+
+#endif //NMEA_H
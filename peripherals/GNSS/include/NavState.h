@@ -0,0 +1,28 @@
+#ifndef NAV_STATE_H
+#define NAV_STATE_H
+
+#include "NMEA.h"
+#include <chrono>
+#include <cstdint>
+
+namespace GNSS {
+    // 一个定位历元的导航状态（同一 UTC 时间的 GGA/RMC/VTG 合并而成）。
+    // 可平凡拷贝，经 SeqLock 发布，任意线程都能无锁读取
+    struct NavState {
+        uint64_t sequence = 0;          // 发布序号，从 1 开始；0 表示尚未收到任何历元
+        std::chrono::steady_clock::time_point received;  // 本机收到该历元的时间，与帧采集时间同一时钟
+        UtcTime time;
+        UtcDate date;
+        double latitude = 0.0;          // 十进制度，南纬为负
+        double longitude = 0.0;         // 十进制度，西经为负
+        double altitude = 0.0;          // 海拔（米）
+        double speed = 0.0;             // 地面速度（米/秒）
+        double course = 0.0;            // 真北航向（度）
+        double hdop = 0.0;
+        int quality = 0;                // GGA 定位质量
+        int satellites = 0;             // 参与解算的卫星数
+        bool valid = false;             // 当前历元是否有有效定位
+    };
+}
+
+#endif //NAV_STATE_H
@@ -2,6 +2,9 @@
 #include "HAL_UART.h"
 #include <iostream>
 
+// 1 节 = 1852 米/小时
+static constexpr double KNOT_TO_MPS = 1852.0 / 3600.0;
+
 
 GNSS::Location::Location() {
     // 初始化代码
@@ -10,113 +13,173 @@ GNSS::Location::Location() {
 
 GNSS::Location::~Location() = default;
 
-void GNSS::Location::locationService(HAL::UART::Uart &uart) {
-    MessageQueue messageQueue;
-    std::thread readerThread([&]() {
-        while (true) {
-            std::string line = uart.uartReadLine();
-            if (line.empty()) continue;
-            if (line.find("$GNGGA") != std::string::npos) {
-                GNGGA gngga;
-                if (parseGNGGA(line, gngga)) {
-                    messageQueue.push(gngga);
-                }
-            } else if (line.find("$GNRMC") != std::string::npos) {
-                GNRMC gnrmc;
-                if (parseGNRMC(line, gnrmc)) {
-                    messageQueue.push(gnrmc);
-                }
-            }
-        }
-    });
-    std::thread writerThread([&]() {
-        while (true) {
-            auto message = messageQueue.pop();
-            if (std::holds_alternative<GNGGA>(message)) {
-                printInfo(std::get<GNGGA>(message));
-            } else if (std::holds_alternative<GNRMC>(message)) {
-                printInfo(std::get<GNRMC>(message));
-            } else {
-                break; // 如果接收到空值，退出循环
-            }
-        }
-    });
-
-    readerThread.join();
-    writerThread.join();
+void GNSS::Location::handleLines(HAL::UART::LineBatch lines) {
+    for (std::string_view line : lines) {
+        if (line_tap) line_tap(line);
+        handleLine(line);
+    }
 }
 
-bool GNSS::Location::parseGNGGA(const std::string& sentence, GNGGA& gngga) {
-    std::istringstream iss(sentence);
-    std::string token;
-    std::vector<std::string> tokens;
+void GNSS::Location::printSummary() const {
+    std::cerr << "GNSS UART closed. 已解析 " << nmea.parsed() << " 句，校验失败 "
+              << nmea.count(ParseResult::BadChecksum) << " 句，格式错误 "
+              << nmea.count(ParseResult::Malformed) << " 句，发布 " << published << " 个历元" << std::endl;
+}
 
-    while (std::getline(iss, token, ',')) {
-        tokens.push_back(token);
-    }
+void GNSS::Location::locationService(HAL::UART::Uart &uart) {
+    // 无数据时阻塞在 poll 中；每次读到的所有完整句子一起处理，直接解析缓冲中的视图
+    const auto onLines = [this](HAL::UART::LineBatch lines) { handleLines(lines); };
+    // 定时醒来检查停止标志
+    while (!stopping.load(std::memory_order_relaxed) && uart.uartReadLines(onLines, STOP_POLL_MS) != HAL::ERROR) {}
+    printSummary();
+}
 
-    if (tokens.size() < 15 || tokens[0] != "$GNGGA") return false;
+HAL::HardwareStatus GNSS::Location::attach(HAL::IO::Reactor& reactor, HAL::UART::Uart& uart) {
+    return reactor.reactorAddUart(uart, [this](HAL::UART::LineBatch lines) { handleLines(lines); },
+                                  [this] { printSummary(); });
+}
 
-    gngga.time = tokens[1];
-    gngga.latitude = tokens[2].empty() ? 0.0 : std::stod(tokens[2]) / 100.0;
-    gngga.lat_direction = tokens[3][0];
-    gngga.longitude = tokens[4].empty() ? 0.0 : std::stod(tokens[4]) / 100.0;
-    gngga.lon_direction = tokens[5][0];
-    gngga.quality = std::stoi(tokens[6]);
-    gngga.satellites = std::stoi(tokens[7]);
-    gngga.hdop = tokens[8].empty() ? 0.0 : std::stod(tokens[8]);
-    gngga.altitude = tokens[9].empty() ? 0.0 : std::stod(tokens[9]);
-    gngga.geoid_height = tokens[11].empty() ? 0.0 : std::stod(tokens[11]);
+static bool sameTime(const GNSS::UtcTime& a, const GNSS::UtcTime& b) {
+    return a.valid == b.valid && a.hour == b.hour && a.minute == b.minute && a.second == b.second;
+}
 
-    return true;
+void GNSS::Location::beginEpoch(const UtcTime& time) {
+    if ((has_gga || has_rmc) && !sameTime(pending.time, time)) {
+        publish();  // 上一历元缺少 GGA 或 RMC，按已有字段发布
+    }
+    pending.time = time;
 }
 
-bool GNSS::Location::parseGNRMC(const std::string& sentence, GNRMC& gnrmc) {
-    std::istringstream iss(sentence);
-    std::string token;
-    std::vector<std::string> tokens;
+void GNSS::Location::handleLine(std::string_view line) {
+    if (nmea.parse(line, sentence) != ParseResult::OK) return;
+
+    if (const auto* gga = std::get_if<GGA>(&sentence)) {
+        beginEpoch(gga->time);
+        pending.latitude = gga->latitude;
+        pending.longitude = gga->longitude;
+        pending.altitude = gga->altitude;
+        pending.quality = gga->quality;
+        pending.satellites = gga->satellites;
+        pending.hdop = gga->hdop;
+        gga_fix = gga->quality > 0;
+        has_gga = true;
+    } else if (const auto* rmc = std::get_if<RMC>(&sentence)) {
+        beginEpoch(rmc->time);
+        if (!has_gga) {
+            // GGA 的位置带高度且精度位数相同，两者都有时以 GGA 为准
+            pending.latitude = rmc->latitude;
+            pending.longitude = rmc->longitude;
+        }
+        pending.date = rmc->date;
+        pending.speed = rmc->speed * KNOT_TO_MPS;
+        pending.course = rmc->course;
+        rmc_fix = rmc->status == 'A';
+        has_rmc = true;
+    } else if (const auto* vtg = std::get_if<VTG>(&sentence)) {
+        // VTG 没有时间字段，只补充当前历元的速度与航向
+        if (has_gga || has_rmc) {
+            pending.speed = vtg->speed_kmh / 3.6;
+            pending.course = vtg->course_true;
+        }
+        return;
+    } else {
+        return;
+    }
 
-    while (std::getline(iss, token, ',')) {
-        tokens.push_back(token);
+    if (has_gga && has_rmc) {
+        publish();
     }
+}
+
+void GNSS::Location::publish() {
+    pending.sequence = ++published;
+    pending.received = std::chrono::steady_clock::now();
+    pending.valid = (!has_gga || gga_fix) && (!has_rmc || rmc_fix);
+    current.store(pending);
+    history_ring.push(pending);
 
+    pending = NavState{};
+    has_gga = has_rmc = false;
+    gga_fix = rmc_fix = false;
+}
 
-    if (tokens.size() < 13 || tokens[0] != "$GNRMC") return false;
+bool GNSS::Location::latestFix(NavState& state) const {
+    state = current.load();
+    return state.sequence != 0 && state.valid;
+}
 
-    gnrmc.time = tokens[1];
-    gnrmc.status = tokens[2][0];
-    gnrmc.latitude = tokens[3].empty() ? 0.0 : std::stod(tokens[3]) / 100.0;
-    gnrmc.lat_direction = tokens[4][0];
-    gnrmc.longitude = tokens[5].empty() ? 0.0 : std::stod(tokens[5]) / 100.0;
-    gnrmc.lon_direction = tokens[6][0];
-    gnrmc.speed = tokens[7].empty() ? 0.0 : std::stod(tokens[7]);
-    gnrmc.course = tokens[8].empty() ? 0.0 : std::stod(tokens[8]);
-    gnrmc.date = tokens[9];
+// 只接受对应类型的句子，发送者不限（GN/GP/BD…）
+bool GNSS::Location::parseGNGGA(std::string_view sentence, GNGGA& gngga) {
+    Sentence parsed;
+    if (nmea.parse(sentence, parsed) != ParseResult::OK || !std::holds_alternative<GGA>(parsed)) return false;
+    gngga = std::get<GGA>(parsed);
+    return true;
+}
 
+bool GNSS::Location::parseGNRMC(std::string_view sentence, GNRMC& gnrmc) {
+    Sentence parsed;
+    if (nmea.parse(sentence, parsed) != ParseResult::OK || !std::holds_alternative<RMC>(parsed)) return false;
+    gnrmc = std::get<RMC>(parsed);
     return true;
 }
 
+namespace GNSS {
+namespace {
+std::ostream& operator<<(std::ostream& os, const UtcTime& time) {
+    if (!time.valid) return os << "--:--:--";
+    const auto fill = os.fill('0');
+    const auto flags = os.flags();
+    const auto precision = os.precision(2);
+    os << std::setw(2) << time.hour << ':' << std::setw(2) << time.minute << ':'
+       << std::fixed << std::setw(5) << time.second;
+    os.fill(fill);
+    os.flags(flags);
+    os.precision(precision);
+    return os;
+}
+
+std::ostream& operator<<(std::ostream& os, const UtcDate& date) {
+    if (!date.valid) return os << "----/--/--";
+    const auto fill = os.fill('0');
+    os << date.year << '/' << std::setw(2) << date.month << '/' << std::setw(2) << date.day;
+    os.fill(fill);
+    return os;
+}
+}
+}
+
 
 void GNSS::Location::printInfo(const GNGGA& gngga) {
-    std::cout << "GNGGA 定位信息:" << std::endl;
+    std::cout << talkerName(gngga.talker) << " GGA 定位信息:" << std::endl;
     std::cout << "UTC时间: " << gngga.time << std::endl;
-    std::cout << "纬度: " << gngga.latitude << " " << gngga.lat_direction << std::endl;
-    std::cout << "经度: " << gngga.longitude << " " << gngga.lon_direction << std::endl;
+    std::cout << "纬度: " << std::setprecision(8) << gngga.latitude << " " << gngga.lat_direction << std::endl;
+    std::cout << "经度: " << gngga.longitude << " " << gngga.lon_direction << std::setprecision(6) << std::endl;
     std::cout << "定位质量: " << gngga.quality << std::endl;
     std::cout << "卫星数量: " << gngga.satellites << std::endl;
     std::cout << "海拔高度: " << gngga.altitude << " 米" << std::endl;
-    std::cout << "地球椭球高度: " << gngga.geoid_height << " 米" << std::endl;
+    std::cout << "大地水准面高度: " << gngga.geoid_height << " 米" << std::endl;
     std::cout << "----------------------------------------" << std::endl;
 }
 
 void GNSS::Location::printInfo(const GNRMC& gnrmc) {
-    std::cout << "GNRMC 定位信息:" << std::endl;
+    std::cout << talkerName(gnrmc.talker) << " RMC 定位信息:" << std::endl;
     std::cout << "时间: " << gnrmc.time << std::endl;
     std::cout << "日期: " << gnrmc.date << std::endl;
     std::cout << "状态: " << (gnrmc.status == 'A' ? "有效" : "无效") << std::endl;
-    std::cout << "纬度: " << gnrmc.latitude << " " << gnrmc.lat_direction << std::endl;
-    std::cout << "经度: " << gnrmc.longitude << " " << gnrmc.lon_direction << std::endl;
+    std::cout << "纬度: " << std::setprecision(8) << gnrmc.latitude << " " << gnrmc.lat_direction << std::endl;
+    std::cout << "经度: " << gnrmc.longitude << " " << gnrmc.lon_direction << std::setprecision(6) << std::endl;
     std::cout << "速度: " << gnrmc.speed << " 节" << std::endl;
     std::cout << "航向: " << gnrmc.course << " 度" << std::endl;
+    if (gnrmc.mode) std::cout << "定位模式: " << gnrmc.mode << std::endl;
     std::cout << "----------------------------------------" << std::endl;
-}
\ No newline at end of file
+}
+
+void GNSS::Location::printInfo(const NavState& state) {
+    std::cout << "导航状态 #" << state.sequence << (state.valid ? "" : "（无定位）") << ":" << std::endl;
+    std::cout << "UTC: " << state.date << " " << state.time << std::endl;
+    std::cout << "位置: " << std::setprecision(8) << state.latitude << ", " << state.longitude << std::setprecision(6)
+              << "  海拔 " << state.altitude << " 米" << std::endl;
+    std::cout << "速度: " << state.speed << " 米/秒  航向: " << state.course << " 度" << std::endl;
+    std::cout << "卫星数量: " << state.satellites << "  HDOP: " << state.hdop << std::endl;
+    std::cout << "----------------------------------------" << std::endl;
+}
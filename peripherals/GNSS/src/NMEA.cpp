@@ -0,0 +1,334 @@
+#include "NMEA.h"
+#include <charconv>
+#include <cmath>
+
+namespace GNSS {
+
+namespace {
+
+// 按逗号依次取字段，字段为输入的子视图
+class FieldReader {
+public:
+    explicit FieldReader(std::string_view payload) : rest(payload) {}
+
+    // 没有剩余字段时返回 false，空字段返回 true 且 field 为空
+    bool next(std::string_view& field) {
+        if (done) return false;
+        const size_t comma = rest.find(',');
+        if (comma == std::string_view::npos) {
+            field = rest;
+            done = true;
+        }
+        else {
+            field = rest.substr(0, comma);
+            rest.remove_prefix(comma + 1);
+        }
+        return true;
+    }
+
+    std::string_view next() {
+        std::string_view field;
+        next(field);
+        return field;
+    }
+
+    [[nodiscard]] bool empty() const { return done; }
+
+private:
+    std::string_view rest;
+    bool done = false;
+};
+
+template <typename T>
+bool toNumber(std::string_view field, T& value) {
+    if (field.empty()) return false;
+    const char* end = field.data() + field.size();
+    const auto [ptr, ec] = std::from_chars(field.data(), end, value);
+    return ec == std::errc() && ptr == end;
+}
+
+// 空字段保持默认值；非空但无法解析视为格式错误
+template <typename T>
+bool optionalNumber(std::string_view field, T& value) {
+    return field.empty() || toNumber(field, value);
+}
+
+char toChar(std::string_view field) {
+    return field.empty() ? 0 : field.front();
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// hhmmss.ss
+bool parseTime(std::string_view field, UtcTime& time) {
+    time = UtcTime{};
+    if (field.empty()) return true;
+    if (field.size() < 6) return false;
+    if (!toNumber(field.substr(0, 2), time.hour) || !toNumber(field.substr(2, 2), time.minute) ||
+        !toNumber(field.substr(4), time.second)) {
+        return false;
+    }
+    time.valid = time.hour < 24 && time.minute < 60 && time.second < 61.0;
+    return time.valid;
+}
+
+// ddmmyy
+bool parseDate(std::string_view field, UtcDate& date) {
+    date = UtcDate{};
+    if (field.empty()) return true;
+    if (field.size() != 6) return false;
+    if (!toNumber(field.substr(0, 2), date.day) || !toNumber(field.substr(2, 2), date.month) ||
+        !toNumber(field.substr(4, 2), date.year)) {
+        return false;
+    }
+    date.year += 2000;
+    date.valid = date.day >= 1 && date.day <= 31 && date.month >= 1 && date.month <= 12;
+    return date.valid;
+}
+
+// 经纬度字段 + 方向字段，结果为带符号的十进制度
+bool parseCoordinate(std::string_view value, std::string_view direction, double& degrees, char& hemisphere) {
+    degrees = 0.0;
+    hemisphere = toChar(direction);
+    if (value.empty()) return true;
+    double ddmm;
+    if (!toNumber(value, ddmm)) return false;
+    degrees = nmeaToDegrees(ddmm);
+    if (hemisphere == 'S' || hemisphere == 'W') degrees = -degrees;
+    return true;
+}
+
+Talker parseTalker(std::string_view id) {
+    if (id == "GP") return Talker::GP;
+    if (id == "GL") return Talker::GL;
+    if (id == "GA") return Talker::GA;
+    if (id == "GB" || id == "BD") return Talker::GB;
+    if (id == "GQ" || id == "QZ") return Talker::GQ;
+    if (id == "GI") return Talker::GI;
+    if (id == "GN") return Talker::GN;
+    return Talker::Unknown;
+}
+
+} // namespace
+
+double nmeaToDegrees(double ddmm) {
+    const double degrees = std::floor(ddmm / 100.0);
+    return degrees + (ddmm - degrees * 100.0) / 60.0;
+}
+
+const char* talkerName(Talker talker) {
+    switch (talker) {
+        case Talker::GP: return "GPS";
+        case Talker::GL: return "GLONASS";
+        case Talker::GA: return "Galileo";
+        case Talker::GB: return "BeiDou";
+        case Talker::GQ: return "QZSS";
+        case Talker::GI: return "NavIC";
+        case Talker::GN: return "GNSS";
+        default: return "Unknown";
+    }
+}
+
+bool NmeaParser::verifyChecksum(std::string_view line, std::string_view& payload, bool requireChecksum) {
+    while (!line.empty() && (line.back() == '\r' || line.back() == '\n')) {
+        line.remove_suffix(1);
+    }
+    if (line.size() < 2 || line.front() != '$') return false;
+    line.remove_prefix(1);
+
+    const size_t star = line.find('*');
+    if (star == std::string_view::npos) {
+        payload = line;
+        return !requireChecksum;
+    }
+    if (line.size() != star + 3) return false;
+    const int high = hexValue(line[star + 1]);
+    const int low = hexValue(line[star + 2]);
+    if (high < 0 || low < 0) return false;
+
+    payload = line.substr(0, star);
+    unsigned char sum = 0;
+    for (const char c : payload) {
+        sum ^= static_cast<unsigned char>(c);
+    }
+    return sum == ((high << 4) | low);
+}
+
+ParseResult NmeaParser::parse(std::string_view line, Sentence& out) {
+    const auto finish = [this](ParseResult result) {
+        counts[static_cast<int>(result)]++;
+        return result;
+    };
+
+    out.emplace<std::monostate>();
+    std::string_view payload;
+    if (!verifyChecksum(line, payload, require_checksum)) {
+        // 没有以 '$' 开头或 *hh 不完整的行也算作校验失败（多为串口上截断的半句）
+        return finish(ParseResult::BadChecksum);
+    }
+
+    // 地址字段：两字符发送者 + 三字符句子类型；'P' 开头的厂商私有句子不解析
+    const std::string_view address = payload.substr(0, payload.find(','));
+    if (address.size() != 5 || address.front() == 'P') {
+        return finish(ParseResult::Unsupported);
+    }
+    const std::string_view type = address.substr(2);
+
+    bool ok;
+    if (type == "GGA") ok = parseGGA(payload, out.emplace<GGA>());
+    else if (type == "RMC") ok = parseRMC(payload, out.emplace<RMC>());
+    else if (type == "GSA") ok = parseGSA(payload, out.emplace<GSA>());
+    else if (type == "GSV") ok = parseGSV(payload, out.emplace<GSV>());
+    else if (type == "VTG") ok = parseVTG(payload, out.emplace<VTG>());
+    else {
+        return finish(ParseResult::Unsupported);
+    }
+    if (!ok) {
+        out.emplace<std::monostate>();
+        return finish(ParseResult::Malformed);
+    }
+    return finish(ParseResult::OK);
+}
+
+// $xxGGA,time,lat,N,lon,E,quality,satellites,hdop,altitude,M,geoid,M,age,station
+bool parseGGA(std::string_view payload, GGA& out) {
+    FieldReader fields(payload);
+    out = GGA{};
+    out.talker = parseTalker(fields.next().substr(0, 2));
+
+    const std::string_view time = fields.next();
+    const std::string_view lat = fields.next();
+    const std::string_view lat_dir = fields.next();
+    const std::string_view lon = fields.next();
+    const std::string_view lon_dir = fields.next();
+    const std::string_view quality = fields.next();
+    const std::string_view satellites = fields.next();
+    const std::string_view hdop = fields.next();
+    const std::string_view altitude = fields.next();
+    fields.next();  // 高度单位
+    const std::string_view geoid = fields.next();
+    if (fields.empty()) return false;   // 字段不足
+
+    return parseTime(time, out.time) &&
+           parseCoordinate(lat, lat_dir, out.latitude, out.lat_direction) &&
+           parseCoordinate(lon, lon_dir, out.longitude, out.lon_direction) &&
+           optionalNumber(quality, out.quality) &&
+           optionalNumber(satellites, out.satellites) &&
+           optionalNumber(hdop, out.hdop) &&
+           optionalNumber(altitude, out.altitude) &&
+           optionalNumber(geoid, out.geoid_height);
+}
+
+// $xxRMC,time,status,lat,N,lon,E,speed,course,date,magvar,E[,mode[,navstatus]]
+bool parseRMC(std::string_view payload, RMC& out) {
+    FieldReader fields(payload);
+    out = RMC{};
+    out.talker = parseTalker(fields.next().substr(0, 2));
+
+    const std::string_view time = fields.next();
+    const std::string_view status = fields.next();
+    const std::string_view lat = fields.next();
+    const std::string_view lat_dir = fields.next();
+    const std::string_view lon = fields.next();
+    const std::string_view lon_dir = fields.next();
+    const std::string_view speed = fields.next();
+    const std::string_view course = fields.next();
+    std::string_view date;
+    if (!fields.next(date)) return false;
+    fields.next();  // 磁偏角
+    fields.next();  // 磁偏角方向
+    std::string_view mode;
+    if (fields.next(mode)) out.mode = toChar(mode);
+
+    out.status = status.empty() ? 'V' : status.front();
+    return parseTime(time, out.time) &&
+           parseCoordinate(lat, lat_dir, out.latitude, out.lat_direction) &&
+           parseCoordinate(lon, lon_dir, out.longitude, out.lon_direction) &&
+           optionalNumber(speed, out.speed) &&
+           optionalNumber(course, out.course) &&
+           parseDate(date, out.date);
+}
+
+// $xxGSA,mode,fix,prn1..prn12,pdop,hdop,vdop[,systemid]
+bool parseGSA(std::string_view payload, GSA& out) {
+    FieldReader fields(payload);
+    out = GSA{};
+    out.talker = parseTalker(fields.next().substr(0, 2));
+
+    out.mode = toChar(fields.next());
+    if (!optionalNumber(fields.next(), out.fix_type)) return false;
+    for (int i = 0; i < GSA::MAX_PRN; ++i) {
+        std::string_view prn;
+        if (!fields.next(prn)) return false;
+        if (prn.empty()) continue;
+        if (!toNumber(prn, out.prn[out.prn_count])) return false;
+        out.prn_count++;
+    }
+    std::string_view vdop;
+    if (!optionalNumber(fields.next(), out.pdop) || !optionalNumber(fields.next(), out.hdop) ||
+        !fields.next(vdop) || !optionalNumber(vdop, out.vdop)) {
+        return false;
+    }
+    std::string_view system_id;
+    return !fields.next(system_id) || optionalNumber(system_id, out.system_id);
+}
+
+// $xxGSV,total,number,inview{,prn,elevation,azimuth,snr}*[,signalid]
+bool parseGSV(std::string_view payload, GSV& out) {
+    FieldReader fields(payload);
+    out = GSV{};
+    out.talker = parseTalker(fields.next().substr(0, 2));
+
+    std::string_view in_view;
+    if (!toNumber(fields.next(), out.total_messages) || !toNumber(fields.next(), out.message_number) ||
+        !fields.next(in_view) || !optionalNumber(in_view, out.satellites_in_view)) {
+        return false;
+    }
+    // 卫星按 4 个字段一组；最后若只剩 1 个字段则为 NMEA 4.11 的信号号
+    std::string_view group[4];
+    while (true) {
+        int n = 0;
+        while (n < 4 && fields.next(group[n])) n++;
+        if (n == 0) break;
+        if (n == 1) return optionalNumber(group[0], out.signal_id);
+        if (n < 4 || out.satellite_count == GSV::MAX_SATELLITES) return false;
+        GSV::Satellite& sat = out.satellites[out.satellite_count];
+        if (!toNumber(group[0], sat.prn) || !optionalNumber(group[1], sat.elevation) ||
+            !optionalNumber(group[2], sat.azimuth) || !optionalNumber(group[3], sat.snr)) {
+            return false;
+        }
+        out.satellite_count++;
+    }
+    return true;
+}
+
+// $xxVTG,course,T,course,M,speed,N,speed,K[,mode]
+bool parseVTG(std::string_view payload, VTG& out) {
+    FieldReader fields(payload);
+    out = VTG{};
+    out.talker = parseTalker(fields.next().substr(0, 2));
+
+    const std::string_view course_true = fields.next();
+    fields.next();
+    const std::string_view course_magnetic = fields.next();
+    fields.next();
+    const std::string_view knots = fields.next();
+    fields.next();
+    std::string_view kmh;
+    if (!fields.next(kmh)) return false;
+    fields.next();
+    std::string_view mode;
+    if (fields.next(mode)) out.mode = toChar(mode);
+
+    return optionalNumber(course_true, out.course_true) &&
+           optionalNumber(course_magnetic, out.course_magnetic) &&
+           optionalNumber(knots, out.speed_knots) &&
+           optionalNumber(kmh, out.speed_kmh);
+}
+
+} // namespace GNSS
@@ -0,0 +1,63 @@
+#ifndef IMU_H
+#define IMU_H
+
+#include "HAL.h"
+#include <opencv2/opencv.hpp>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace IMU {
+    using Clock = std::chrono::steady_clock;
+
+    // 一次六轴采样，坐标为传感器坐标系
+    struct ImuSample {
+        Clock::time_point timestamp;    // 与帧采集时间同一时钟
+        cv::Vec3d accel;                // 米/秒²，静止时约为 +g 朝上
+        cv::Vec3d gyro;                 // 弧度/秒，右手系
+    };
+
+    // 六轴数据来源：硬件（MPU6050）或日志回放，融合模块只依赖这个接口
+    class ImuSource {
+    public:
+        virtual ~ImuSource() = default;
+        // 把已到达的采样按时间顺序追加到 samples。没有数据时最多等待 timeoutMs（0 为立即返回），
+        // 超时返回 TIMEOUT，设备出错或回放结束返回 ERROR
+        virtual HAL::HardwareStatus readSamples(std::vector<ImuSample>& samples, int timeoutMs) = 0;
+        [[nodiscard]] virtual double sampleRate() const = 0;
+    };
+
+    // 回放日志格式：每行 "t,ax,ay,az,gx,gy,gz"，t 为相对首个采样的秒数，单位同 ImuSample，'#' 开头为注释
+    void writeCsv(std::ostream& os, const ImuSample& sample, Clock::time_point origin);
+
+    struct ReplayConfig {
+        std::string path;
+        bool realtime = true;   // 按日志时间节奏送出；为 false 时尽快送出，时间戳仍按日志间隔
+        bool loop = false;      // 结束后从头循环
+    };
+
+    // 从日志回放，用于没有硬件时调试与测试融合算法。时间戳映射到回放开始时刻之后
+    class ImuReplay : public ImuSource {
+    public:
+        explicit ImuReplay(ReplayConfig config);
+        // 读取整个日志，成功且至少有两个采样时返回 true
+        bool open();
+        HAL::HardwareStatus readSamples(std::vector<ImuSample>& samples, int timeoutMs) override;
+        [[nodiscard]] double sampleRate() const override { return rate; }
+        [[nodiscard]] size_t size() const { return offsets.size(); }
+
+        // 尽快回放时单次最多送出的采样数
+        static constexpr size_t BATCH = 64;
+    private:
+        ReplayConfig config;
+        std::vector<Clock::duration> offsets;   // 相对首个采样的时间
+        std::vector<ImuSample> samples;         // timestamp 字段在送出时填写
+        size_t next = 0;
+        double rate = 0.0;
+        bool started = false;
+        Clock::time_point origin;               // 本轮回放的时间原点
+    };
+}
+
+#endif //IMU_H
@@ -0,0 +1,34 @@
+#ifndef IMU_LOG_H
+#define IMU_LOG_H
+
+#include "IMU.h"
+#include "Record.h"
+#include "Replay.h"
+#include <memory>
+
+namespace IMU {
+    // 透传另一个数据源，同时把读到的采样写入会话日志
+    class RecordingImuSource : public ImuSource {
+    public:
+        RecordingImuSource(std::unique_ptr<ImuSource> source, std::shared_ptr<RECORD::LogWriter> writer, uint16_t channel = 0);
+        HAL::HardwareStatus readSamples(std::vector<ImuSample>& samples, int timeoutMs) override;
+        [[nodiscard]] double sampleRate() const override { return source->sampleRate(); }
+    private:
+        std::unique_ptr<ImuSource> source;
+        std::shared_ptr<RECORD::LogWriter> writer;
+        uint16_t channel;
+    };
+
+    // 从会话日志回放六轴采样（LogReplay 只回放一路六轴数据）
+    class LogImuSource : public ImuSource {
+    public:
+        LogImuSource(std::shared_ptr<RECORD::LogReplay> replay, double rate);
+        HAL::HardwareStatus readSamples(std::vector<ImuSample>& samples, int timeoutMs) override;
+        [[nodiscard]] double sampleRate() const override { return rate; }
+    private:
+        std::shared_ptr<RECORD::LogReplay> replay;
+        double rate;
+    };
+}
+
+#endif //IMU_LOG_H
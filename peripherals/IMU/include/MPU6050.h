@@ -0,0 +1,45 @@
+#ifndef MPU6050_H
+#define MPU6050_H
+
+#include "IMU.h"
+#include "HAL_I2C.h"
+
+namespace IMU {
+    struct Mpu6050Config {
+        HAL::I2C::Config bus{"/dev/i2c-1", 0x68};   // AD0 接高电平时地址为 0x69
+        int sampleRate = 200;       // Hz，4~1000
+        int accelRangeG = 4;        // 2/4/8/16
+        int gyroRangeDps = 500;     // 250/500/1000/2000
+        int dlpf = 3;               // 数字低通档位 1~6，3 约 44Hz 带宽
+    };
+
+    // MPU6050 以固定采样率把加速度与角速度写入片内 FIFO（每组 12 字节，1024 字节约 85 组），
+    // 每次读取先取 FIFO 字节数，再一次突发读出所有完整采样，不用逐个寄存器轮询。
+    // FIFO 中的采样没有时间戳：按采样周期排列，并以读取时刻缓慢校正时钟漂移
+    class MPU6050 : public ImuSource {
+    public:
+        MPU6050();
+        HAL::HardwareStatus init(const Mpu6050Config& config);
+        HAL::HardwareStatus readSamples(std::vector<ImuSample>& samples, int timeoutMs) override;
+        [[nodiscard]] double sampleRate() const override { return rate; }
+        // FIFO 溢出（读取太慢）而清空的次数
+        [[nodiscard]] uint64_t overflows() const { return overflow_count; }
+
+    private:
+        HAL::HardwareStatus resetFifo();
+        // 返回 count 个新采样中第一个的时间戳
+        Clock::time_point firstTimestamp(size_t count, Clock::time_point now);
+
+        HAL::I2C::I2c i2c;
+        double rate = 0.0;
+        Clock::duration period{};
+        double accel_scale = 0.0;   // LSB -> 米/秒²
+        double gyro_scale = 0.0;    // LSB -> 弧度/秒
+        std::vector<uint8_t> fifo;  // 读出缓冲，容量复用
+        Clock::time_point next_stamp;   // 下一个采样的预计时间
+        bool clock_valid = false;
+        uint64_t overflow_count = 0;
+    };
+}
+
+#endif //MPU6050_H
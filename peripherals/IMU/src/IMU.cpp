@@ -0,0 +1,92 @@
+#include "IMU.h"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+using namespace IMU;
+
+void IMU::writeCsv(std::ostream& os, const ImuSample& sample, Clock::time_point origin) {
+    os << std::chrono::duration<double>(sample.timestamp - origin).count() << ','
+       << sample.accel[0] << ',' << sample.accel[1] << ',' << sample.accel[2] << ','
+       << sample.gyro[0] << ',' << sample.gyro[1] << ',' << sample.gyro[2] << '\n';
+}
+
+ImuReplay::ImuReplay(ReplayConfig config) : config(std::move(config)) {}
+
+bool ImuReplay::open() {
+    std::ifstream file(config.path);
+    if (!file) {
+        std::cerr << "Failed to open IMU log: " << config.path << std::endl;
+        return false;
+    }
+    offsets.clear();
+    samples.clear();
+    std::string line;
+    double first = 0.0;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream iss(line);
+        double t;
+        ImuSample sample{};
+        if (!(iss >> t >> sample.accel[0] >> sample.accel[1] >> sample.accel[2]
+                  >> sample.gyro[0] >> sample.gyro[1] >> sample.gyro[2])) {
+            std::cerr << "Skipping malformed IMU log line: " << line << std::endl;
+            continue;
+        }
+        if (offsets.empty()) first = t;
+        offsets.push_back(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(t - first)));
+        samples.push_back(sample);
+    }
+    if (offsets.size() < 2) {
+        std::cerr << "IMU log has too few samples: " << config.path << std::endl;
+        return false;
+    }
+    rate = (offsets.size() - 1) / std::chrono::duration<double>(offsets.back()).count();
+    next = 0;
+    started = false;
+    return true;
+}
+
+HAL::HardwareStatus ImuReplay::readSamples(std::vector<ImuSample>& out, int timeoutMs) {
+    if (offsets.empty()) return HAL::ERROR;
+    const Clock::time_point now = Clock::now();
+    if (!started) {
+        origin = now;
+        started = true;
+    }
+    if (next == offsets.size()) {
+        if (!config.loop) return HAL::ERROR;
+        // 下一轮接在上一轮之后，时间戳保持递增
+        origin += offsets.back() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / rate));
+        next = 0;
+    }
+
+    if (!config.realtime) {
+        const size_t end = std::min(next + BATCH, offsets.size());
+        for (; next < end; ++next) {
+            out.push_back(samples[next]);
+            out.back().timestamp = origin + offsets[next];
+        }
+        return HAL::OK;
+    }
+
+    // 按日志节奏：没有到期的采样时等到下一个采样或超时
+    const Clock::time_point due = origin + offsets[next];
+    if (due > now) {
+        const Clock::time_point deadline = now + std::chrono::milliseconds(std::max(timeoutMs, 0));
+        if (due > deadline) {
+            std::this_thread::sleep_until(deadline);
+            return HAL::TIMEOUT;
+        }
+        std::this_thread::sleep_until(due);
+    }
+    const Clock::time_point until = std::max(Clock::now(), due);
+    while (next < offsets.size() && origin + offsets[next] <= until) {
+        out.push_back(samples[next]);
+        out.back().timestamp = origin + offsets[next];
+        ++next;
+    }
+    return HAL::OK;
+}
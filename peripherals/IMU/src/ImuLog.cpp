@@ -0,0 +1,40 @@
+#include "ImuLog.h"
+#include <thread>
+
+using namespace IMU;
+
+RecordingImuSource::RecordingImuSource(std::unique_ptr<ImuSource> source, std::shared_ptr<RECORD::LogWriter> writer, uint16_t channel)
+    : source(std::move(source)), writer(std::move(writer)), channel(channel) {}
+
+HAL::HardwareStatus RecordingImuSource::readSamples(std::vector<ImuSample>& samples, int timeoutMs) {
+    const size_t first = samples.size();
+    const HAL::HardwareStatus status = source->readSamples(samples, timeoutMs);
+    for (size_t i = first; i < samples.size(); ++i) {
+        const ImuSample& s = samples[i];
+        const RECORD::ImuRecord record{
+            {static_cast<float>(s.accel[0]), static_cast<float>(s.accel[1]), static_cast<float>(s.accel[2])},
+            {static_cast<float>(s.gyro[0]), static_cast<float>(s.gyro[1]), static_cast<float>(s.gyro[2])}};
+        writer->writeImu(s.timestamp, record, channel);
+    }
+    return status;
+}
+
+LogImuSource::LogImuSource(std::shared_ptr<RECORD::LogReplay> replay, double rate) : replay(std::move(replay)), rate(rate) {}
+
+HAL::HardwareStatus LogImuSource::readSamples(std::vector<ImuSample>& samples, int timeoutMs) {
+    const Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(std::max(timeoutMs, 0));
+    RECORD::ReplayedImu entry;
+    while (true) {
+        bool any = false;
+        while (replay->popImu(entry)) {
+            const RECORD::ImuRecord& r = entry.sample;
+            samples.push_back({entry.timestamp, cv::Vec3d(r.accel[0], r.accel[1], r.accel[2]),
+                               cv::Vec3d(r.gyro[0], r.gyro[1], r.gyro[2])});
+            any = true;
+        }
+        if (any) return HAL::OK;
+        if (replay->finished()) return HAL::ERROR;
+        if (Clock::now() >= deadline) return HAL::TIMEOUT;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
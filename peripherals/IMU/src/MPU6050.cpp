@@ -0,0 +1,158 @@
+#include "MPU6050.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+using namespace IMU;
+
+// 寄存器地址，见 MPU-6000/MPU-6050 Register Map
+namespace {
+    constexpr uint8_t REG_SMPLRT_DIV = 0x19;
+    constexpr uint8_t REG_CONFIG = 0x1A;
+    constexpr uint8_t REG_GYRO_CONFIG = 0x1B;
+    constexpr uint8_t REG_ACCEL_CONFIG = 0x1C;
+    constexpr uint8_t REG_FIFO_EN = 0x23;
+    constexpr uint8_t REG_INT_ENABLE = 0x38;
+    constexpr uint8_t REG_INT_STATUS = 0x3A;
+    constexpr uint8_t REG_USER_CTRL = 0x6A;
+    constexpr uint8_t REG_PWR_MGMT_1 = 0x6B;
+    constexpr uint8_t REG_FIFO_COUNTH = 0x72;
+    constexpr uint8_t REG_FIFO_R_W = 0x74;
+    constexpr uint8_t REG_WHO_AM_I = 0x75;
+
+    constexpr uint8_t FIFO_ACCEL_GYRO = 0x78;   // XG/YG/ZG/ACCEL，按地址顺序先加速度后角速度
+    constexpr uint8_t USER_FIFO_EN = 0x40;
+    constexpr uint8_t USER_FIFO_RESET = 0x04;
+    constexpr uint8_t INT_FIFO_OFLOW = 0x10;     // INT_ENABLE 中的 FIFO_OFLOW_EN 与 INT_STATUS 中的 FIFO_OFLOW_INT
+    constexpr uint8_t PWR_DEVICE_RESET = 0x80;
+    constexpr uint8_t PWR_CLOCK_PLL_XGYRO = 0x01;
+
+    constexpr size_t SAMPLE_BYTES = 12;
+    constexpr size_t FIFO_SIZE = 1024;
+    constexpr double GRAVITY = 9.80665;
+
+    int16_t be16(const uint8_t* p) {
+        return static_cast<int16_t>((p[0] << 8) | p[1]);
+    }
+}
+
+MPU6050::MPU6050() {
+    fifo.reserve(FIFO_SIZE);
+}
+
+HAL::HardwareStatus MPU6050::init(const Mpu6050Config& config) {
+    if (i2c.i2cInit(config.bus) != HAL::OK) {
+        return HAL::ERROR;
+    }
+    uint8_t who = 0;
+    if (i2c.i2cReadReg(REG_WHO_AM_I, who) != HAL::OK || (who & 0x7E) != 0x68) {
+        std::cerr << "MPU6050 not found, WHO_AM_I = 0x" << std::hex << static_cast<int>(who) << std::dec << std::endl;
+        return HAL::ERROR;
+    }
+
+    int afs, fs;
+    switch (config.accelRangeG) {
+        case 2: afs = 0; break;
+        case 4: afs = 1; break;
+        case 8: afs = 2; break;
+        case 16: afs = 3; break;
+        default: std::cerr << "Unsupported accel range: " << config.accelRangeG << std::endl; return HAL::ERROR;
+    }
+    switch (config.gyroRangeDps) {
+        case 250: fs = 0; break;
+        case 500: fs = 1; break;
+        case 1000: fs = 2; break;
+        case 2000: fs = 3; break;
+        default: std::cerr << "Unsupported gyro range: " << config.gyroRangeDps << std::endl; return HAL::ERROR;
+    }
+    // 开启 DLPF 时陀螺输出率为 1kHz，采样率 = 1kHz / (1 + SMPLRT_DIV)
+    const int divider = std::clamp(1000 / std::max(config.sampleRate, 1) - 1, 0, 255);
+    rate = 1000.0 / (1 + divider);
+    period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / rate));
+    accel_scale = GRAVITY * (1 << afs) / 16384.0;
+    gyro_scale = (250.0 * (1 << fs) / 32768.0) * M_PI / 180.0;
+
+    if (i2c.i2cWriteReg(REG_PWR_MGMT_1, PWR_DEVICE_RESET) != HAL::OK) {
+        std::cerr << "MPU6050 reset failed." << std::endl;
+        return HAL::ERROR;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    const bool ok =
+        i2c.i2cWriteReg(REG_PWR_MGMT_1, PWR_CLOCK_PLL_XGYRO) == HAL::OK &&     // 唤醒，陀螺 PLL 时钟比内部振荡器稳定
+        i2c.i2cWriteReg(REG_SMPLRT_DIV, static_cast<uint8_t>(divider)) == HAL::OK &&
+        i2c.i2cWriteReg(REG_CONFIG, static_cast<uint8_t>(std::clamp(config.dlpf, 1, 6))) == HAL::OK &&
+        i2c.i2cWriteReg(REG_GYRO_CONFIG, static_cast<uint8_t>(fs << 3)) == HAL::OK &&
+        i2c.i2cWriteReg(REG_ACCEL_CONFIG, static_cast<uint8_t>(afs << 3)) == HAL::OK &&
+        i2c.i2cWriteReg(REG_FIFO_EN, FIFO_ACCEL_GYRO) == HAL::OK &&
+        i2c.i2cWriteReg(REG_INT_ENABLE, INT_FIFO_OFLOW) == HAL::OK &&     // 未开启时 INT_STATUS 不置溢出位
+        resetFifo() == HAL::OK;
+    if (!ok) {
+        std::cerr << "MPU6050 configuration failed." << std::endl;
+        return HAL::ERROR;
+    }
+    std::cout << "MPU6050 initialized at " << rate << " Hz." << std::endl;
+    return HAL::OK;
+}
+
+HAL::HardwareStatus MPU6050::resetFifo() {
+    clock_valid = false;
+    if (i2c.i2cWriteReg(REG_USER_CTRL, USER_FIFO_RESET) != HAL::OK) return HAL::ERROR;
+    return i2c.i2cWriteReg(REG_USER_CTRL, USER_FIFO_EN);
+}
+
+Clock::time_point MPU6050::firstTimestamp(const size_t count, const Clock::time_point now) {
+    // 最新的采样约在读取时刻产生；与采样时钟推算值相差过大（首次读取或溢出后）时直接对齐，
+    // 否则每次只校正 1/16 的偏差，平滑晶振与读取时刻的抖动
+    const Clock::time_point predicted_last = next_stamp + period * static_cast<long>(count - 1);
+    const Clock::duration error = now - predicted_last;
+    if (!clock_valid || std::chrono::abs(error) > period * 5) {
+        next_stamp = now - period * static_cast<long>(count - 1);
+        clock_valid = true;
+    }
+    else {
+        next_stamp += error / 16;
+    }
+    const Clock::time_point first = next_stamp;
+    next_stamp += period * static_cast<long>(count);
+    return first;
+}
+
+HAL::HardwareStatus MPU6050::readSamples(std::vector<ImuSample>& samples, int timeoutMs) {
+    const Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(std::max(timeoutMs, 0));
+    size_t bytes = 0;
+    while (true) {
+        uint8_t status = 0;
+        uint8_t count[2];
+        if (i2c.i2cReadReg(REG_INT_STATUS, status) != HAL::OK ||
+            i2c.i2cReadRegs(REG_FIFO_COUNTH, count, sizeof count) != HAL::OK) {
+            return HAL::ERROR;
+        }
+        const size_t fifo_count = static_cast<size_t>(count[0]) << 8 | count[1];
+        if ((status & INT_FIFO_OFLOW) || fifo_count >= FIFO_SIZE) {
+            // 溢出后 FIFO 中的数据可能错位，清空重新开始；FIFO 已满时视同溢出，不依赖中断状态位
+            overflow_count++;
+            if (resetFifo() != HAL::OK) return HAL::ERROR;
+            continue;
+        }
+        bytes = fifo_count / SAMPLE_BYTES * SAMPLE_BYTES;
+        if (bytes > 0) break;
+        const Clock::time_point now = Clock::now();
+        if (now >= deadline) return HAL::TIMEOUT;
+        std::this_thread::sleep_for(std::min<Clock::duration>(period, deadline - now));
+    }
+
+    fifo.resize(bytes);
+    if (i2c.i2cReadRegs(REG_FIFO_R_W, fifo.data(), bytes) != HAL::OK) {
+        return HAL::ERROR;
+    }
+    const size_t n = bytes / SAMPLE_BYTES;
+    Clock::time_point stamp = firstTimestamp(n, Clock::now());
+    for (size_t i = 0; i < n; ++i, stamp += period) {
+        const uint8_t* p = fifo.data() + i * SAMPLE_BYTES;
+        samples.push_back({stamp,
+                           cv::Vec3d(be16(p), be16(p + 2), be16(p + 4)) * accel_scale,
+                           cv::Vec3d(be16(p + 6), be16(p + 8), be16(p + 10)) * gyro_scale});
+    }
+    return HAL::OK;
+}
@@ -0,0 +1,73 @@
+// 查看会话日志的内容
+// 用法: log_dump <会话日志> [起始秒]
+//   先输出概要（记录数、时长、是否完整），再逐条输出记录：相对时间（秒）、类型、通道与内容摘要
+#include "Record.h"
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+
+namespace {
+    const char* typeName(RECORD::RecordType type) {
+        switch (type) {
+            case RECORD::FRAME_JPEG: return "frame";
+            case RECORD::PACKET: return "packet";
+            case RECORD::UART_LINE: return "uart";
+            case RECORD::IMU_SAMPLE: return "imu";
+            default: return "unknown";
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <log> [start seconds]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    RECORD::LogReader reader;
+    if (!reader.open(argv[1])) {
+        std::cerr << "Failed to open log: " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+    const double duration = (reader.lastTimestamp() - reader.firstTimestamp()) / 1e9;
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << reader.recordCount() << " records, " << duration << "s, " << reader.indexEntries().size() << " index entries"
+              << (reader.complete() ? "" : " (incomplete, index rebuilt by scan)") << std::endl;
+
+    if (argc > 2) {
+        reader.seek(static_cast<uint64_t>(std::stod(argv[2]) * 1e9));
+    }
+
+    std::map<RECORD::RecordType, uint64_t> counts;
+    RECORD::RecordView record{};
+    while (reader.next(record)) {
+        counts[record.type]++;
+        std::cout << record.timestamp_ns / 1e9 << "  " << typeName(record.type) << "[" << record.channel << "]  ";
+        switch (record.type) {
+            case RECORD::UART_LINE:
+                std::cout << std::string_view(reinterpret_cast<const char*>(record.payload.data()), record.payload.size());
+                break;
+            case RECORD::IMU_SAMPLE: {
+                if (record.payload.size() < sizeof(RECORD::ImuRecord)) break;
+                RECORD::ImuRecord imu{};
+                std::memcpy(&imu, record.payload.data(), sizeof(imu));
+                std::cout << "a " << imu.accel[0] << "," << imu.accel[1] << "," << imu.accel[2]
+                          << "  g " << imu.gyro[0] << "," << imu.gyro[1] << "," << imu.gyro[2];
+                break;
+            }
+            case RECORD::PACKET:
+                std::cout << record.payload.size() << " bytes" << ((record.flags & RECORD::FLAG_KEYFRAME) ? " key" : "");
+                break;
+            default:
+                std::cout << record.payload.size() << " bytes";
+                break;
+        }
+        std::cout << std::endl;
+    }
+
+    for (const auto& [type, count] : counts) {
+        std::cerr << typeName(type) << ": " << count << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
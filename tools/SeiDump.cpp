@@ -0,0 +1,71 @@
+// 从推流或录像中提取检测结果 SEI
+// 用法: sei_dump <rtsp://... | 录像.mp4>
+//   每行输出一条检测结果：所在包的 pts、所描述画面的 pts（均为秒，同为输入流的时间轴）、帧序号与各检测框（归一化坐标）。
+//   所描述的是所在包或之前不久的画面
+#include "Metadata.h"
+#include <iomanip>
+#include <iostream>
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <url|file>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    avformat_network_init();
+    AVFormatContext* input = nullptr;
+    if (avformat_open_input(&input, argv[1], nullptr, nullptr) < 0 || avformat_find_stream_info(input, nullptr) < 0) {
+        std::cerr << "Failed to open input: " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+    const int index = av_find_best_stream(input, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (index < 0) {
+        std::cerr << "No video stream in input." << std::endl;
+        avformat_close_input(&input);
+        return EXIT_FAILURE;
+    }
+    const AVStream* stream = input->streams[index];
+
+    // MP4 中为 AVCC（长度前缀），extradata 以 1 开头；RTSP/裸流为 Annex B
+    int length_size = 0;
+    const AVCodecParameters* par = stream->codecpar;
+    if (par->extradata_size > 4 && par->extradata[0] == 1) {
+        length_size = (par->extradata[4] & 0x03) + 1;
+    }
+
+    AVPacket* pkt = av_packet_alloc();
+    std::vector<LIVE::FrameMetadata> metadata;
+    uint64_t total = 0;
+    std::cout << std::fixed << std::setprecision(3);
+    while (av_read_frame(input, pkt) >= 0) {
+        if (pkt->stream_index == index) {
+            metadata.clear();
+            LIVE::parseSei(pkt->data, pkt->size, length_size, pkt->pts, stream->time_base, metadata);
+            const double pkt_time = pkt->pts == AV_NOPTS_VALUE ? 0.0 : pkt->pts * av_q2d(stream->time_base);
+            for (const auto& meta : metadata) {
+                const double frame_time = meta.pts == AV_NOPTS_VALUE ? 0.0 : meta.pts * av_q2d(stream->time_base);
+                std::cout << "packet " << pkt_time << "s  frame " << frame_time << "s  seq " << meta.sequence
+                          << "  " << meta.detections.size() << " det";
+                for (const auto& det : meta.detections) {
+                    std::cout << "  [" << det.classId << " " << std::setprecision(2) << det.confidence
+                              << " " << std::setprecision(3) << det.box.x << "," << det.box.y << ","
+                              << det.box.width << "," << det.box.height;
+                    if (det.distance >= 0) std::cout << " " << det.distance << "m";
+                    std::cout << "]";
+                }
+                std::cout << std::endl;
+                total++;
+            }
+        }
+        av_packet_unref(pkt);
+    }
+
+    std::cerr << total << " metadata messages" << std::endl;
+    av_packet_free(&pkt);
+    avformat_close_input(&input);
+    avformat_network_deinit();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,130 @@
+// 遥测上报的本机接收端，用于联调与回归：监听端口，逐批校验、解码并打印事件
+// 用法: telemetry_recv <udp|tcp> <端口>
+//   每批先输出一行概要（设备、会话、批序号、字节数、事件数，批序号不连续时标出缺失数），再逐个输出事件
+//   UDP 时对每个校验通过的批回复确认，设备据此判断链路是否可用
+#include "Telemetry.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace {
+    const char* LEVELS[] = {"INFO", "WARNING", "DANGER"};
+
+    std::map<std::pair<uint32_t, uint32_t>, uint64_t> last_sequence;    // (设备, 会话) -> 批序号
+
+    void print(const NET::DetectionEvent& event) {
+        std::cout << "  detection  source " << event.source << " frame " << event.sequence;
+        if (event.positioned) std::cout << " at " << event.latitude << "," << event.longitude;
+        std::cout << ", " << event.objects.size() << " objects" << std::endl;
+        for (const auto& object : event.objects) {
+            std::cout << "    class " << object.classId << " conf " << std::setprecision(2) << object.confidence
+                      << std::setprecision(4) << " box [" << object.x << "," << object.y << "," << object.width << ","
+                      << object.height << "]" << (object.near ? " near" : "");
+            if (object.bearingDeg >= 0.0) std::cout << " bearing " << object.bearingDeg;
+            std::cout << std::setprecision(7) << std::endl;
+        }
+    }
+
+    void print(const NET::AlertEvent& event) {
+        std::cout << "  alert      track " << event.track << " class " << event.classId << " "
+                  << (event.level < std::size(LEVELS) ? LEVELS[event.level] : "?") << " bearing " << event.bearing;
+        if (event.distance >= 0.f) std::cout << " " << event.distance << "m";
+        std::cout << std::endl;
+    }
+
+    void print(const NET::FixEvent& event) {
+        std::cout << "  fix        " << event.latitude << "," << event.longitude << " alt " << event.altitude << "m speed "
+                  << event.speed << "m/s course " << event.course << " hdop " << event.hdop << " q" << event.quality << " "
+                  << event.satellites << " sats" << std::endl;
+    }
+
+    bool handle(const uint8_t* data, size_t size, NET::TelemetryBatch& batch) {
+        if (!NET::decodeBatch(data, size, batch)) {
+            std::cout << "invalid batch (" << size << " bytes)" << std::endl;
+            return false;
+        }
+        std::cout << "batch device " << batch.device << " session " << std::hex << batch.session << std::dec << " #"
+                  << batch.sequence << ", " << size << " bytes, " << batch.events.size() << " events";
+        auto [it, first] = last_sequence.try_emplace({batch.device, batch.session}, batch.sequence);
+        if (!first) {
+            // 补发的批可能晚于新批到达，只报告向前的缺口
+            if (batch.sequence > it->second + 1) std::cout << " (" << batch.sequence - it->second - 1 << " missing)";
+            it->second = std::max(it->second, batch.sequence);
+        }
+        std::cout << std::endl;
+        for (const auto& event : batch.events) {
+            const uint64_t ms = std::visit([](const auto& e) { return e.unixMs; }, event);
+            std::cout << ms / 1000 << "." << std::setw(3) << std::setfill('0') << ms % 1000 << std::setfill(' ');
+            std::visit([](const auto& e) { print(e); }, event);
+        }
+        return true;
+    }
+
+    bool readAll(int fd, uint8_t* data, size_t size) {
+        size_t offset = 0;
+        while (offset < size) {
+            const ssize_t n = recv(fd, data + offset, size - offset, 0);
+            if (n <= 0) return false;
+            offset += static_cast<size_t>(n);
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3 || (std::strcmp(argv[1], "udp") != 0 && std::strcmp(argv[1], "tcp") != 0)) {
+        std::cerr << "Usage: " << argv[0] << " <udp|tcp> <port>" << std::endl;
+        return EXIT_FAILURE;
+    }
+    const bool tcp = std::strcmp(argv[1], "tcp") == 0;
+    const int fd = socket(AF_INET, tcp ? SOCK_STREAM : SOCK_DGRAM, 0);
+    const int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(static_cast<uint16_t>(std::stoi(argv[2])));
+    if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || (tcp && listen(fd, 1) != 0)) {
+        std::cerr << "Failed to listen on " << argv[1] << " port " << argv[2] << ": " << std::strerror(errno) << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << std::fixed << std::setprecision(7);
+
+    std::vector<uint8_t> buffer(65536);
+    NET::TelemetryBatch batch;
+    if (!tcp) {
+        while (true) {
+            sockaddr_in peer{};
+            socklen_t peer_size = sizeof(peer);
+            const ssize_t n = recvfrom(fd, buffer.data(), buffer.size(), 0, reinterpret_cast<sockaddr*>(&peer), &peer_size);
+            if (n <= 0 || !handle(buffer.data(), static_cast<size_t>(n), batch)) continue;
+            const std::vector<uint8_t> ack = NET::encodeAck(batch);
+            sendto(fd, ack.data(), ack.size(), 0, reinterpret_cast<sockaddr*>(&peer), peer_size);
+        }
+    }
+    // 一次只服务一个连接，断开后等待重连
+    while (true) {
+        const int client = accept(fd, nullptr, nullptr);
+        if (client < 0) continue;
+        std::cout << "connected" << std::endl;
+        uint8_t length[4];
+        while (readAll(client, length, sizeof(length))) {
+            const uint32_t size = (uint32_t{length[0]} << 24) | (uint32_t{length[1]} << 16) | (uint32_t{length[2]} << 8) | length[3];
+            if (size > 16 * 1024 * 1024) break;
+            buffer.resize(std::max<size_t>(buffer.size(), size));
+            if (!readAll(client, buffer.data(), size)) break;
+            handle(buffer.data(), size, batch);
+        }
+        close(client);
+        std::cout << "disconnected" << std::endl;
+    }
+}